@@ -1062,6 +1062,10 @@ void BgpAttr::set_label_block(LabelBlockPtr label_block) {
     label_block_ = label_block;
 }
 
+void BgpAttr::set_olist(BgpOListPtr olist) {
+    olist_ = olist;
+}
+
 void BgpAttr::set_olist(const BgpOListSpec *olist_spec) {
     if (olist_spec) {
         olist_ = attr_db_->server()->olist_db()->Locate(*olist_spec);
@@ -1277,14 +1281,10 @@ std::size_t hash_value(BgpAttr const &attr) {
         boost::hash_combine(hash, attr.label_block_->last());
     }
 
-    if (attr.olist_) {
-        boost::hash_range(hash, attr.olist_->elements().begin(),
-                          attr.olist_->elements().end());
-    }
-    if (attr.leaf_olist_) {
-        boost::hash_range(hash, attr.leaf_olist_->elements().begin(),
-                          attr.leaf_olist_->elements().end());
-    }
+    // OLists are interned and compared by pointer, so hash the pointer
+    // instead of walking all the elements.
+    if (attr.olist_) boost::hash_combine(hash, attr.olist_.get());
+    if (attr.leaf_olist_) boost::hash_combine(hash, attr.leaf_olist_.get());
 
     if (attr.as_path_) boost::hash_combine(hash, *attr.as_path_);
     if (attr.aspath_4byte_) boost::hash_combine(hash, *attr.aspath_4byte_);
@@ -1374,6 +1374,15 @@ BgpAttrPtr BgpAttrDB::ReplaceEsiAndLocate(const BgpAttr *attr,
     return Locate(clone);
 }
 
+// Return a clone of attribute with updated olist.
+BgpAttrPtr BgpAttrDB::ReplaceOListAndLocate(const BgpAttr *attr,
+    BgpOListPtr olist) {
+    assert(!olist || olist->olist().subcode == BgpAttribute::OList);
+    BgpAttr *clone = new BgpAttr(*attr);
+    clone->set_olist(olist);
+    return Locate(clone);
+}
+
 // Return a clone of attribute with updated olist.
 BgpAttrPtr BgpAttrDB::ReplaceOListAndLocate(const BgpAttr *attr,
     const BgpOListSpec *olist_spec) {
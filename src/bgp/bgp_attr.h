@@ -871,6 +871,7 @@ public:
     void set_edge_discovery(const EdgeDiscoverySpec *edspec);
     void set_edge_forwarding(const EdgeForwardingSpec *efspec);
     void set_label_block(LabelBlockPtr label_block);
+    void set_olist(BgpOListPtr olist);
     void set_olist(const BgpOListSpec *olist_spec);
     void set_leaf_olist(const BgpOListSpec *leaf_olist_spec);
     void set_sub_protocol(const std::string &sub_protocol) {
@@ -1018,6 +1019,8 @@ public:
                                         const RouteDistinguisher &source_rd);
     BgpAttrPtr ReplaceEsiAndLocate(const BgpAttr *attr,
                                    const EthernetSegmentId &esi);
+    BgpAttrPtr ReplaceOListAndLocate(const BgpAttr *attr,
+                                     BgpOListPtr olist);
     BgpAttrPtr ReplaceOListAndLocate(const BgpAttr *attr,
                                      const BgpOListSpec *olist_spec);
     BgpAttrPtr ReplaceLeafOListAndLocate(const BgpAttr *attr,
@@ -24,6 +24,7 @@
 #include "bgp/routing-instance/routing_instance_analytics_types.h"
 #include "bgp/routing-instance/routing_instance_log.h"
 
+using std::lower_bound;
 using std::pair;
 using std::set;
 using std::sort;
@@ -290,6 +291,29 @@ void EvpnLocalMcastNode::TriggerUpdate() {
     AddInclusiveMulticastRoute();
 }
 
+//
+// Comparator to look up BgpOListElems by address. The elements of a BgpOList
+// are sorted with address as the primary key.
+//
+struct BgpOListElemAddressCompare {
+    bool operator()(const BgpOListElem *elem, const Ip4Address &address) {
+        return elem->address < address;
+    }
+};
+
+//
+// Return true if the BgpOList has an element with the given address.
+//
+static bool OListContainsAddress(const BgpOList *olist,
+    const Ip4Address &address) {
+    if (!olist)
+        return false;
+    BgpOList::Elements::const_iterator it =
+        lower_bound(olist->elements().begin(), olist->elements().end(),
+            address, BgpOListElemAddressCompare());
+    return (it != olist->elements().end() && (*it)->address == address);
+}
+
 //
 // Construct an UpdateInfo with the RibOutAttr that needs to be advertised to
 // the IPeer for the EvpnRoute associated with this EvpnLocalMcastNode. This
@@ -312,11 +336,23 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo(EvpnRoute *route) {
 
     EvpnState::SG sg = EvpnState::SG(route->GetPrefix().source(),
                                      route->GetPrefix().group());
+
+    // Use the shared BgpOList of regular nodes if possible. It contains
+    // the same elements as the BgpOList that would be built below, unless
+    // one of the regular nodes has the same address as this node.
+    BgpOListPtr olist;
+    if (!edge_replication_not_supported_ && !pbb_evpn_enable) {
+        olist = partition_->GetRegularNodeOList(sg);
+        if (OListContainsAddress(olist.get(), address_))
+            olist = NULL;
+    }
+
     // Go through list of EvpnRemoteMcastNodes and build the BgpOList.
     BgpOListSpec olist_spec(BgpAttribute::OList);
-    if (partition_->remote_mcast_node_list()->count(sg)) {
-        set<EvpnMcastNode*> nodes = (*partition_->remote_mcast_node_list())[sg];
-        BOOST_FOREACH(EvpnMcastNode *node, nodes) {
+    EvpnManagerPartition::EvpnMcastNodeList::const_iterator it =
+        partition_->remote_mcast_node_list()->find(sg);
+    if (!olist && it != partition_->remote_mcast_node_list()->end()) {
+        BOOST_FOREACH(EvpnMcastNode *node, it->second) {
             if (node->address() == address_)
                 continue;
             if (node->assisted_replication_leaf())
@@ -340,9 +376,9 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo(EvpnRoute *route) {
     // Go through list of leaf EvpnMcastNodes and build the leaf BgpOList.
     BgpOListSpec leaf_olist_spec(BgpAttribute::LeafOList);
     if (assisted_replication_supported_) {
-        if (partition_->leaf_node_list()->count(sg)) {
-            set<EvpnMcastNode*> nodes = (*partition_->leaf_node_list())[sg];
-            BOOST_FOREACH(EvpnMcastNode *node, nodes) {
+        it = partition_->leaf_node_list()->find(sg);
+        if (it != partition_->leaf_node_list()->end()) {
+            BOOST_FOREACH(EvpnMcastNode *node, it->second) {
                 if (node->replicator_address() != address_)
                     continue;
 
@@ -355,12 +391,19 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo(EvpnRoute *route) {
     }
 
     // Bail if both BgpOLists are empty.
-    if (olist_spec.elements.empty() && leaf_olist_spec.elements.empty())
+    bool olist_empty =
+        olist ? olist->elements().empty() : olist_spec.elements.empty();
+    if (olist_empty && leaf_olist_spec.elements.empty())
         return NULL;
 
     // Add BgpOList and leaf BgpOList to RibOutAttr for broadcast MAC route.
     BgpAttrDB *attr_db = partition_->server()->attr_db();
-    BgpAttrPtr attr = attr_db->ReplaceOListAndLocate(attr_.get(), &olist_spec);
+    BgpAttrPtr attr;
+    if (olist) {
+        attr = attr_db->ReplaceOListAndLocate(attr_.get(), olist);
+    } else {
+        attr = attr_db->ReplaceOListAndLocate(attr_.get(), &olist_spec);
+    }
     attr = attr_db->ReplaceLeafOListAndLocate(attr.get(), &leaf_olist_spec);
 
     UpdateInfo *uinfo = new UpdateInfo;
@@ -743,35 +786,75 @@ void EvpnManagerPartition::NotifyNodeRoute(EvpnMcastNode *node) {
 }
 
 //
-// Go through all replicator EvpnMcastNodes and notify associated Broadcast
-// MAC route.
+// Go through all replicator EvpnMcastNodes for the given SG and notify the
+// associated Broadcast MAC route.
+//
+// The leaf BgpOList of a replicator node is built only from the leaf nodes
+// with the same SG, so there's no need to notify nodes for other SGs.
 //
-void EvpnManagerPartition::NotifyReplicatorNodeRoutes() {
+void EvpnManagerPartition::NotifyReplicatorNodeRoutes(const SG &sg) {
     DBTablePartition *tbl_partition = GetTablePartition();
-    EvpnMcastNodeList::const_iterator it = replicator_node_list_.begin();
-    for (; it != replicator_node_list_.end(); it++) {
-        BOOST_FOREACH(EvpnMcastNode *node, it->second)
-            tbl_partition->Notify(node->route());
-    }
+    EvpnMcastNodeList::const_iterator it = replicator_node_list_.find(sg);
+    if (it == replicator_node_list_.end())
+        return;
+    BOOST_FOREACH(EvpnMcastNode *node, it->second)
+        tbl_partition->Notify(node->route());
 }
 
 //
-// Go through all ingress replication client EvpnMcastNodes and notify the
-// associated Broadcast MAC route.
+// Go through all ingress replication client EvpnMcastNodes for the given SG
+// and notify the associated Broadcast MAC route.
+//
+// Also invalidate the shared BgpOList of regular nodes for the SG since the
+// remote node list for the SG has changed.
 //
-void EvpnManagerPartition::NotifyIrClientNodeRoutes(
+void EvpnManagerPartition::NotifyIrClientNodeRoutes(const SG &sg,
     bool exclude_edge_replication_supported) {
+    regular_olist_map_.erase(sg);
     DBTablePartition *tbl_partition = GetTablePartition();
-    EvpnMcastNodeList::const_iterator it = ir_client_node_list_.begin();
-    for (; it != ir_client_node_list_.end(); it++) {
+    EvpnMcastNodeList::const_iterator it = ir_client_node_list_.find(sg);
+    if (it == ir_client_node_list_.end())
+        return;
+    BOOST_FOREACH(EvpnMcastNode *node, it->second) {
+        if (exclude_edge_replication_supported &&
+            !node->edge_replication_not_supported()) {
+            continue;
+        }
+        tbl_partition->Notify(node->route());
+    }
+}
+
+//
+// Get the BgpOList of regular nodes i.e. remote nodes that don't support
+// edge replication, for the given SG.
+//
+// This is the BgpOList for all local nodes that support edge replication,
+// so it's built and interned once and then shared by all of them instead
+// of being rebuilt for each local node when a remote node is added/deleted.
+// An empty BgpOList is not cached.
+//
+BgpOListPtr EvpnManagerPartition::GetRegularNodeOList(const SG &sg) {
+    OListMap::const_iterator olist_it = regular_olist_map_.find(sg);
+    if (olist_it != regular_olist_map_.end())
+        return olist_it->second;
+
+    BgpOListSpec olist_spec(BgpAttribute::OList);
+    EvpnMcastNodeList::const_iterator it = regular_node_list_.find(sg);
+    if (it != regular_node_list_.end()) {
         BOOST_FOREACH(EvpnMcastNode *node, it->second) {
-            if (exclude_edge_replication_supported &&
-                !node->edge_replication_not_supported()) {
+            if (node->assisted_replication_leaf())
                 continue;
-            }
-            tbl_partition->Notify(node->route());
+            const ExtCommunity *extcomm = node->attr()->ext_community();
+            BgpOListElem elem(node->address(), node->label(),
+                    extcomm ? extcomm->GetTunnelEncap() : vector<string>());
+            olist_spec.elements.push_back(elem);
         }
     }
+
+    BgpOListPtr olist = server()->olist_db()->Locate(olist_spec);
+    if (!olist_spec.elements.empty())
+        regular_olist_map_.insert(make_pair(sg, olist));
+    return olist;
 }
 
 //
@@ -791,12 +874,12 @@ void EvpnManagerPartition::AddMcastNode(EvpnMcastNode *node, EvpnRoute *rt) {
         remote_mcast_node_list_[sg].insert(node);
         if (node->assisted_replication_leaf()) {
             leaf_node_list_[sg].insert(node);
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(sg);
         } else if (node->edge_replication_not_supported()) {
             regular_node_list_[sg].insert(node);
-            NotifyIrClientNodeRoutes(false);
+            NotifyIrClientNodeRoutes(sg, false);
         } else if (!node->assisted_replication_leaf()) {
-            NotifyIrClientNodeRoutes(true);
+            NotifyIrClientNodeRoutes(sg, true);
         }
     }
 }
@@ -830,12 +913,12 @@ void EvpnManagerPartition::DeleteMcastNode(EvpnMcastNode *node,
     } else {
         RemoveMcastNodeFromList(sg, node, &remote_mcast_node_list_);
         if (RemoveMcastNodeFromList(sg, node, &leaf_node_list_)) {
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(sg);
         } else {
-            NotifyIrClientNodeRoutes(true);
+            NotifyIrClientNodeRoutes(sg, true);
         }
         if (RemoveMcastNodeFromList(sg, node, &regular_node_list_)) {
-            NotifyIrClientNodeRoutes(false);
+            NotifyIrClientNodeRoutes(sg, false);
         }
     }
     if (empty())
@@ -864,15 +947,15 @@ void EvpnManagerPartition::UpdateMcastNode(EvpnMcastNode *node, EvpnRoute *rt) {
         if (node->assisted_replication_leaf())
             leaf_node_list_[sg].insert(node);
         if (was_leaf || node->assisted_replication_leaf())
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(sg);
         if (!was_leaf || !node->assisted_replication_leaf())
-            NotifyIrClientNodeRoutes(true);
+            NotifyIrClientNodeRoutes(sg, true);
         bool was_regular = RemoveMcastNodeFromList(
                                    sg, node, &regular_node_list_);
         if (node->edge_replication_not_supported())
             regular_node_list_[sg].insert(node);
         if (was_regular || node->edge_replication_not_supported())
-            NotifyIrClientNodeRoutes(false);
+            NotifyIrClientNodeRoutes(sg, false);
     }
 }
 
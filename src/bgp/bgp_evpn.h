@@ -10,6 +10,7 @@
 #include <tbb/spin_rw_mutex.h>
 
 #include <list>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -354,6 +355,12 @@ private:
 // to be updated. Entries are added to the list using the TriggerMacRouteUpdate
 // method.
 //
+// An EvpnManagerPartition also caches the interned BgpOList of regular nodes
+// for each SG. This BgpOList is shared by all local nodes that support edge
+// replication, so a change in the remote node list for an SG results in one
+// rebuild of the BgpOList instead of one per local node. The cache entry for
+// an SG is invalidated whenever the remote node list for the SG changes.
+//
 class EvpnManagerPartition {
 public:
     typedef EvpnState::SG SG;
@@ -364,8 +371,10 @@ public:
 
     DBTablePartition *GetTablePartition();
     void NotifyNodeRoute(EvpnMcastNode *node);
-    void NotifyReplicatorNodeRoutes();
-    void NotifyIrClientNodeRoutes(bool exclude_edge_replication_supported);
+    void NotifyReplicatorNodeRoutes(const SG &sg);
+    void NotifyIrClientNodeRoutes(const SG &sg,
+        bool exclude_edge_replication_supported);
+    BgpOListPtr GetRegularNodeOList(const SG &sg);
     void AddMcastNode(EvpnMcastNode *node, EvpnRoute *route);
     void DeleteMcastNode(EvpnMcastNode *node, EvpnRoute *route);
     void UpdateMcastNode(EvpnMcastNode *node, EvpnRoute *route);
@@ -401,6 +410,7 @@ private:
     friend class BgpEvpnManagerTest;
 
     typedef std::set<EvpnRoute *> EvpnRouteList;
+    typedef std::map<SG, BgpOListPtr> OListMap;
 
     bool ProcessMacUpdateList();
     void DisableMacUpdateProcessing();
@@ -427,6 +437,7 @@ private:
     EvpnMcastNodeList leaf_node_list_;
     EvpnMcastNodeList regular_node_list_;
     EvpnMcastNodeList ir_client_node_list_;
+    OListMap regular_olist_map_;
     EvpnRouteList mac_update_list_;
     boost::scoped_ptr<TaskTrigger> mac_update_trigger_;
 
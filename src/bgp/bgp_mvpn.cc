@@ -403,6 +403,7 @@ MvpnManager::MvpnManager(MvpnTable *table, ErmVpnTable *ermvpn_table)
           ermvpn_table_delete_ref_(this, ermvpn_table->deleter()) {
     deleter_.reset(new DeleteActor(this));
     db_states_count_ = 0;
+    source_active_evaluations_ = 0;
 }
 
 MvpnManager::~MvpnManager() {
@@ -820,6 +821,7 @@ void MvpnProjectManagerPartition::RouteListener(DBEntryBase *db_entry) {
 
 // Process change to MVPN Type-5 SourceActive route.
 void MvpnManagerPartition::ProcessType5SourceActiveRoute(MvpnRoute *rt) {
+    manager_->source_active_evaluations_++;
     MvpnDBState *mvpn_dbstate = dynamic_cast<MvpnDBState *>(rt->GetState(
                                     table(), listener_id()));
 
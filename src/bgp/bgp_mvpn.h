@@ -102,6 +102,12 @@ private:
 //     present in the vrf, then it is notified so that sender agent can be
 //     updated with the right set of path attributes (PMSI) in order to be able
 //     to replicate multicast traffic in the data plane.
+//
+// Type7 join and Type4 leaf-ad changes notify the Type5 source active route
+// directly. No separate update list is kept for this: DBTablePartBase::Notify
+// does not enqueue a route which is already on the change list, hence all the
+// join/leave events for an <S,G> that are processed before the source active
+// route is walked result in a single re-evaluation of it.
 class MvpnManagerPartition {
 public:
     MvpnManagerPartition(MvpnManager *manager, int part_id);
@@ -174,6 +180,9 @@ public:
     virtual void Terminate();
     virtual void Initialize();
     size_t neighbors_count() const;
+    uint64_t source_active_evaluations() const {
+        return source_active_evaluations_;
+    }
     const NeighborMap &neighbors() const;
     void ReOriginateType1Route(const Ip4Address &old_identifier);
     void OriginateType1Route();
@@ -203,6 +212,7 @@ private:
     int listener_id_;
     int identifier_listener_id_;
     tbb::atomic<int> db_states_count_;
+    tbb::atomic<uint64_t> source_active_evaluations_;
     PartitionList partitions_;
 
     NeighborMap neighbors_;
@@ -34,6 +34,7 @@ public:
     virtual size_t PendingQueueSize() const = 0;
     virtual size_t ResolvedQueueSize() const = 0;
     virtual uint32_t GetDownServiceChainCount() const = 0;
+    virtual uint64_t GetRouteUpdateCount() const = 0;
     virtual bool IsQueueEmpty() const = 0;
     virtual bool FillServiceChainInfo(RoutingInstance *rtinstance,
         ShowServicechainInfo *info) const = 0;
@@ -5,12 +5,16 @@
 #include "bgp/routing-instance/path_resolver.h"
 
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
 
 #include "base/lifetime.h"
 #include "base/set_util.h"
 #include "base/task.h"
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/timer.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_peer_types.h"
 #include "bgp/bgp_server.h"
@@ -22,9 +26,15 @@
 #include "bgp/rtarget/rtarget_address.h"
 
 using std::make_pair;
+using std::sort;
 using std::string;
 using std::vector;
 
+const int PathResolver::kNexthopUpdateHoldTime =
+    getenv("CONTRAIL_BGP_RESOLVER_NEXTHOP_HOLD_TIME_MSECS") ?
+        strtol(getenv("CONTRAIL_BGP_RESOLVER_NEXTHOP_HOLD_TIME_MSECS"),
+               NULL, 0) : 0;
+
 //
 // Return true if the prefix for the BgpRoute is the same as given IpAddress.
 //
@@ -61,6 +71,22 @@ bool PathResolver::RoutePrefixMatch(const BgpRoute *route,
     return prefix.IsMoreSpecific(inet6_route->GetPrefix());
 }
 
+//
+// Hash function for ResolverNexthopMap.
+//
+size_t PathResolver::ResolverNexthopKeyHash::operator()(
+    const ResolverNexthopKey &key) const {
+    size_t seed = 0;
+    if (key.first.is_v4()) {
+        boost::hash_combine(seed, key.first.to_v4().to_ulong());
+    } else {
+        Ip6Address::bytes_type bytes = key.first.to_v6().to_bytes();
+        boost::hash_range(seed, bytes.begin(), bytes.end());
+    }
+    boost::hash_combine(seed, key.second);
+    return seed;
+}
+
 class PathResolver::DeleteActor : public LifetimeActor {
 public:
     explicit DeleteActor(PathResolver *resolver)
@@ -105,8 +131,14 @@ PathResolver::PathResolver(BgpTable *table)
           boost::bind(&PathResolver::ProcessResolverNexthopUpdateList, this),
           TaskScheduler::GetInstance()->GetTaskId("bgp::ResolverNexthop"),
           0)),
+      nexthop_update_hold_timer_(TimerManager::CreateTimer(
+          *table->server()->ioservice(), "Resolver nexthop hold timer",
+          TaskScheduler::GetInstance()->GetTaskId("bgp::ResolverNexthop"),
+          0)),
+      nexthop_update_hold_time_(kNexthopUpdateHoldTime),
       deleter_(new DeleteActor(this)),
       table_delete_ref_(this, table->deleter()) {
+    nexthop_update_count_ = 0;
     for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
         partitions_.push_back(new PathResolverPartition(part_id, this));
     }
@@ -127,6 +159,7 @@ PathResolver::~PathResolver() {
     STLDeleteValues(&partitions_);
     nexthop_reg_unreg_trigger_->Reset();
     nexthop_update_trigger_->Reset();
+    TimerManager::DeleteTimer(nexthop_update_hold_timer_);
 }
 
 //
@@ -195,10 +228,35 @@ void PathResolver::RegisterUnregisterResolverNexthop(
 // Add a ResolverNexthop to the update list and start the Task to process the
 // list.
 //
+// If a hold time is configured, start the hold timer instead when the first
+// ResolverNexthop is added to the list. Further changes to the same or other
+// ResolverNexthops till the timer fires get squashed into the list.
+//
 void PathResolver::UpdateResolverNexthop(ResolverNexthop *rnexthop) {
     tbb::mutex::scoped_lock lock(mutex_);
     nexthop_update_list_.insert(rnexthop);
+    if (nexthop_update_hold_time_ <= 0) {
+        nexthop_update_trigger_->Set();
+    } else if (!nexthop_update_hold_timer_->running()) {
+        nexthop_update_hold_timer_->Start(nexthop_update_hold_time_,
+            boost::bind(&PathResolver::NexthopUpdateHoldTimerExpired, this));
+    }
+}
+
+//
+// Handler for the nexthop update hold timer.
+// Start the Task to process the update list.
+//
+// The timer runs in context of bgp::ResolverNexthop Task, which is mutually
+// exclusive with the db::DBTable Task that adds entries to the update list.
+// Hence there's no window in which the timer is not running but the update
+// list has entries that haven't been scheduled for processing.
+//
+bool PathResolver::NexthopUpdateHoldTimerExpired() {
+    CHECK_CONCURRENCY("bgp::ResolverNexthop");
+
     nexthop_update_trigger_->Set();
+    return false;
 }
 
 //
@@ -281,6 +339,9 @@ void PathResolver::RemoveResolverNexthop(ResolverNexthop *rnexthop) {
     assert(loc != nexthop_map_.end());
     nexthop_map_.erase(loc);
     nexthop_update_list_.erase(rnexthop);
+    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+        partitions_[part_id]->RemoveResolverNexthop(rnexthop);
+    }
 }
 
 //
@@ -386,6 +447,10 @@ bool PathResolver::ProcessResolverNexthopRegUnregList() {
 //
 // Handle processing of all ResolverNexthops on the update list.
 //
+// Hand off each ResolverNexthop to the PathResolverPartitions that have at
+// least one dependent ResolverPath. The partitions expand the ResolverNexthop
+// into ResolverPaths concurrently, in context of the bgp::ResolverPath Task.
+//
 bool PathResolver::ProcessResolverNexthopUpdateList() {
     CHECK_CONCURRENCY("bgp::ResolverNexthop");
 
@@ -393,7 +458,12 @@ bool PathResolver::ProcessResolverNexthopUpdateList() {
          it != nexthop_update_list_.end(); ++it) {
         ResolverNexthop *rnexthop = *it;
         assert(!rnexthop->deleted());
-        rnexthop->TriggerAllResolverPaths();
+        nexthop_update_count_++;
+        for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+            if (rnexthop->empty(part_id))
+                continue;
+            partitions_[part_id]->TriggerNexthopResolution(rnexthop);
+        }
     }
     nexthop_update_list_.clear();
     return true;
@@ -512,6 +582,14 @@ size_t PathResolver::GetResolverNexthopUpdateListSize() const {
     return nexthop_update_list_.size();
 }
 
+//
+// Return the number of ResolverNexthop updates processed so far.
+// For testing only.
+//
+uint64_t PathResolver::GetResolverNexthopUpdateCount() const {
+    return nexthop_update_count_;
+}
+
 //
 // Disable processing of the path update list in all partitions.
 // For testing only.
@@ -599,10 +677,17 @@ void PathResolver::FillShowInfo(ShowPathResolver *spr, bool summary) const {
     if (summary)
         return;
 
-    vector<ShowPathResolverNexthop> sprn_list;
+    // Sort the keys since the map is not ordered.
+    vector<ResolverNexthopKey> nexthop_keys;
     for (ResolverNexthopMap::const_iterator it = nexthop_map_.begin();
          it != nexthop_map_.end(); ++it) {
-        const ResolverNexthop *rnexthop = it->second;
+        nexthop_keys.push_back(it->first);
+    }
+    sort(nexthop_keys.begin(), nexthop_keys.end());
+
+    vector<ShowPathResolverNexthop> sprn_list;
+    BOOST_FOREACH(const ResolverNexthopKey &key, nexthop_keys) {
+        const ResolverNexthop *rnexthop = nexthop_map_.find(key)->second;
         const BgpTable *table = rnexthop->table();
         ShowPathResolverNexthop sprn;
         sprn.set_address(rnexthop->address().to_string());
@@ -643,6 +728,7 @@ PathResolverPartition::PathResolverPartition(int part_id,
 //
 PathResolverPartition::~PathResolverPartition() {
     assert(rpath_update_list_.empty());
+    assert(rnexthop_update_list_.empty());
     rpath_update_trigger_->Reset();
 }
 
@@ -696,6 +782,28 @@ void PathResolverPartition::TriggerPathResolution(ResolverPath *rpath) {
     rpath_update_trigger_->Set();
 }
 
+//
+// Add a ResolverNexthop to the nexthop update list and start Task to process
+// the list.
+//
+void PathResolverPartition::TriggerNexthopResolution(
+    ResolverNexthop *rnexthop) {
+    CHECK_CONCURRENCY("bgp::ResolverNexthop");
+
+    rnexthop_update_list_.insert(rnexthop);
+    rpath_update_trigger_->Set();
+}
+
+//
+// Remove a ResolverNexthop from the nexthop update list.
+// Called when the ResolverNexthop is being removed from the PathResolver.
+//
+void PathResolverPartition::RemoveResolverNexthop(ResolverNexthop *rnexthop) {
+    CHECK_CONCURRENCY("bgp::Config");
+
+    rnexthop_update_list_.erase(rnexthop);
+}
+
 //
 // Add a ResolverPath to the update list and start Task to process the list.
 // This is used to defer re-evaluation of the ResolverPath when the update
@@ -758,6 +866,16 @@ ResolverPath *PathResolverPartition::RemoveResolverPath(const BgpPath *path) {
 bool PathResolverPartition::ProcessResolverPathUpdateList() {
     CHECK_CONCURRENCY("bgp::ResolverPath");
 
+    // Expand changed ResolverNexthops into their dependent ResolverPaths.
+    for (ResolverNexthopList::iterator it = rnexthop_update_list_.begin();
+         it != rnexthop_update_list_.end(); ++it) {
+        const ResolverNexthop *rnexthop = *it;
+        const ResolverNexthop::ResolverPathList &rpath_list =
+            rnexthop->rpath_lists_[part_id_];
+        rpath_update_list_.insert(rpath_list.begin(), rpath_list.end());
+    }
+    rnexthop_update_list_.clear();
+
     ResolverPathList update_list;
     rpath_update_list_.swap(update_list);
     for (ResolverPathList::iterator it = update_list.begin();
@@ -804,10 +922,22 @@ void PathResolverPartition::ResumeResolverPathUpdateProcessing() {
 
 //
 // Get size of the update list.
+// Includes ResolverPaths that are pending via the nexthop update list.
 // For testing only.
 //
 size_t PathResolverPartition::GetResolverPathUpdateListSize() const {
-    return rpath_update_list_.size();
+    if (rnexthop_update_list_.empty())
+        return rpath_update_list_.size();
+
+    ResolverPathList update_list = rpath_update_list_;
+    for (ResolverNexthopList::const_iterator it = rnexthop_update_list_.begin();
+         it != rnexthop_update_list_.end(); ++it) {
+        const ResolverNexthop *rnexthop = *it;
+        const ResolverNexthop::ResolverPathList &rpath_list =
+            rnexthop->rpath_lists_[part_id_];
+        update_list.insert(rpath_list.begin(), rpath_list.end());
+    }
+    return update_list.size();
 }
 
 //
@@ -1256,20 +1386,12 @@ ResolverRouteState *ResolverNexthop::GetResolverRouteState() {
 }
 
 //
-// Trigger update of resolved BgpPaths for all ResolverPaths that depend on
-// the ResolverNexthop. Actual update of the resolved BgpPaths happens when
-// the PathResolverPartitions process their update lists.
+// Return true if there are no dependent ResolverPaths in the partition.
 //
-void ResolverNexthop::TriggerAllResolverPaths() const {
+bool ResolverNexthop::empty(int part_id) const {
     CHECK_CONCURRENCY("bgp::ResolverNexthop");
 
-    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
-        for (ResolverPathList::iterator it = rpath_lists_[part_id].begin();
-             it != rpath_lists_[part_id].end(); ++it) {
-            ResolverPath *rpath = *it;
-            resolver_->GetPartition(part_id)->TriggerPathResolution(rpath);
-        }
-    }
+    return rpath_lists_[part_id].empty();
 }
 
 //
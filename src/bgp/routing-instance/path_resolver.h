@@ -6,6 +6,8 @@
 #define SRC_BGP_ROUTING_INSTANCE_PATH_RESOLVER_H_
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 #include <tbb/spin_rw_mutex.h>
 
@@ -38,6 +40,7 @@ class ResolverRouteState;
 class RoutingInstance;
 class ShowPathResolver;
 class TaskTrigger;
+class Timer;
 
 //
 // This represents an instance of the resolver per BgpTable. A BgpTable that
@@ -73,8 +76,17 @@ class TaskTrigger;
 // after the list is processed again.
 //
 // The update list is processed in the context of bgp::ResolverNexthop Task.
-// When an entry on this list is processed all it's dependent ResolverPaths
-// are queued for re-evaluation in the PathResolverPartition.
+// When an entry on this list is processed it's queued to the nexthop update
+// list in every PathResolverPartition. Each PathResolverPartition expands
+// the ResolverNexthop into its dependent ResolverPaths in context of its own
+// bgp::ResolverPath Task, so the fan-out of a nexthop with a large number of
+// dependent ResolverPaths is spread across all partitions.
+//
+// Processing of the update list can optionally be held down for a small
+// interval after the first change so that repeated changes to the same
+// ResolverNexthop (e.g. a flapping underlay nexthop) are squashed into a
+// single re-evaluation of the dependent ResolverPaths. The hold time is 0
+// by default i.e. the update list is processed right away.
 //
 // Concurrency Notes:
 //
@@ -113,6 +125,13 @@ public:
     bool nexthop_longest_match() const { return nexthop_longest_match_; }
     void set_nexthop_longest_match(bool flag) { nexthop_longest_match_ = flag; }
 
+    int nexthop_update_hold_time() const {
+        return nexthop_update_hold_time_;
+    }
+    void set_nexthop_update_hold_time(int hold_time_msecs) {
+        nexthop_update_hold_time_ = hold_time_msecs;
+    }
+
     void FillShowInfo(ShowPathResolver *spr, bool summary) const;
     static bool RoutePrefixMatch(const BgpRoute *route,
                                  const IpAddress &address);
@@ -124,9 +143,15 @@ private:
 
     class DeleteActor;
     typedef std::pair<IpAddress, BgpTable *> ResolverNexthopKey;
-    typedef std::map<ResolverNexthopKey, ResolverNexthop *> ResolverNexthopMap;
+    struct ResolverNexthopKeyHash {
+        size_t operator()(const ResolverNexthopKey &key) const;
+    };
+    typedef boost::unordered_map<ResolverNexthopKey, ResolverNexthop *,
+        ResolverNexthopKeyHash> ResolverNexthopMap;
     typedef std::set<ResolverNexthop *> ResolverNexthopList;
 
+    static const int kNexthopUpdateHoldTime;
+
     PathResolverPartition *GetPartition(int part_id);
     PathResolverPartition *GetPartition(int part_id) const;
 
@@ -139,6 +164,7 @@ private:
     bool ProcessResolverNexthopRegUnreg(ResolverNexthop *rnexthop);
     bool ProcessResolverNexthopRegUnregList();
     bool ProcessResolverNexthopUpdateList();
+    bool NexthopUpdateHoldTimerExpired();
 
     bool RouteListener(DBTablePartBase *root, DBEntryBase *entry);
 
@@ -152,6 +178,7 @@ private:
     void DisableResolverNexthopUpdateProcessing();
     void EnableResolverNexthopUpdateProcessing();
     size_t GetResolverNexthopUpdateListSize() const;
+    uint64_t GetResolverNexthopUpdateCount() const;
 
     void DisableResolverPathUpdateProcessing();
     void EnableResolverPathUpdateProcessing();
@@ -168,6 +195,9 @@ private:
     boost::scoped_ptr<TaskTrigger> nexthop_reg_unreg_trigger_;
     ResolverNexthopList nexthop_update_list_;
     boost::scoped_ptr<TaskTrigger> nexthop_update_trigger_;
+    Timer *nexthop_update_hold_timer_;
+    int nexthop_update_hold_time_;
+    tbb::atomic<uint64_t> nexthop_update_count_;
     ResolverNexthopList nexthop_delete_list_;
     std::vector<PathResolverPartition *> partitions_;
 
@@ -187,6 +217,13 @@ private:
 // ResolverPath class. The list is processed in context of bgp::ResolverPath
 // Task with the partition index as the Task instance id. This allows all the
 // PathResolverPartitions to work concurrently.
+//
+// The nexthop update list contains ResolverNexthops that have changed since
+// the list was last processed. It's populated from bgp::ResolverNexthop Task
+// and processed in the same bgp::ResolverPath Task as the update list, right
+// before it. All dependent ResolverPaths of the ResolverNexthop in this
+// partition are added to the update list, so a ResolverNexthop that changes
+// multiple times before the Task runs causes a single re-evaluation.
 
 // Mutual exclusion of db::DBTable and bgp::ResolverPath Tasks ensures that
 // it's safe to add/delete/update resolved BgpPaths from the bgp::ResolverPath
@@ -205,6 +242,7 @@ public:
     void StopPathResolution(const BgpPath *path);
 
     void TriggerPathResolution(ResolverPath *rpath);
+    void TriggerNexthopResolution(ResolverNexthop *rnexthop);
     void DeferPathResolution(ResolverPath *rpath);
 
     int part_id() const { return part_id_; }
@@ -220,12 +258,14 @@ private:
 
     typedef std::map<const BgpPath *, ResolverPath *> PathToResolverPathMap;
     typedef std::set<ResolverPath *> ResolverPathList;
+    typedef std::set<ResolverNexthop *> ResolverNexthopList;
 
     ResolverPath *CreateResolverPath(const BgpPath *path, BgpRoute *route,
         ResolverNexthop *rnexthop);
     ResolverPath *FindResolverPath(const BgpPath *path);
     ResolverPath *RemoveResolverPath(const BgpPath *path);
     bool ProcessResolverPathUpdateList();
+    void RemoveResolverNexthop(ResolverNexthop *rnexthop);
 
     void DisableResolverPathUpdateProcessing();
     void EnableResolverPathUpdateProcessing();
@@ -237,6 +277,7 @@ private:
     PathResolver *resolver_;
     PathToResolverPathMap rpath_map_;
     ResolverPathList rpath_update_list_;
+    ResolverNexthopList rnexthop_update_list_;
     boost::scoped_ptr<TaskTrigger> rpath_update_trigger_;
 
     DISALLOW_COPY_AND_ASSIGN(PathResolverPartition);
@@ -361,7 +402,8 @@ private:
 // the IP address being tracked, the ResolverNexthop is added to the update
 // list in the PathResolver. The PathResolver processes the entries in this
 // list in the context of the bgp::ResolverNexthop Task. The action is to
-// trigger re-evaluation of all ResolverPaths that use the ResolverNexthop.
+// queue the ResolverNexthop to all PathResolverPartitions, each of which
+// then triggers re-evaluation of its ResolverPaths that use it.
 //
 // When the last ResolverPath in a partition using a ResolverNexthop gets
 // removed, the ResolverNexthop is added to the registration/unregistration
@@ -401,8 +443,6 @@ public:
     void RemoveResolverPath(int part_id, ResolverPath *rpath);
     ResolverRouteState *GetResolverRouteState();
 
-    void TriggerAllResolverPaths() const;
-
     void ManagedDelete() { }
 
     IpAddress address() const { return address_; }
@@ -412,6 +452,7 @@ public:
     const BgpRoute *GetRoute() const;
     BgpRoute *GetRoute();
     bool empty() const;
+    bool empty(int part_id) const;
     bool registered() const { return registered_; }
     void set_registered() { registered_ = true; }
 
@@ -424,6 +465,7 @@ protected:
     ResolverRouteSet routes_;
 
 private:
+    friend class PathResolverPartition;
     typedef std::set<ResolverPath *> ResolverPathList;
 
     PathResolver *resolver_;
@@ -272,6 +272,7 @@ ServiceChain<T>::ServiceChain(ServiceChainMgrT *manager,
       dest_(dest),
       connected_(connected),
       connected_route_(NULL),
+      generation_(1),
       service_chain_addr_(addr),
       group_oper_state_up_(group ? false : true),
       connected_table_unregistered_(false),
@@ -282,6 +283,7 @@ ServiceChain<T>::ServiceChain(ServiceChainMgrT *manager,
       src_table_delete_ref_(this, src_table()->deleter()),
       dest_table_delete_ref_(this, dest_table()->deleter()),
       connected_table_delete_ref_(this, connected_table()->deleter()) {
+    update_all_pending_ = false;
     for (vector<string>::const_iterator it = subnets.begin();
          it != subnets.end(); ++it) {
         string prefix = *it;
@@ -503,29 +505,46 @@ string ServiceChain<T>::ToString() const {
     return (string("ServiceChain " ) + service_chain_addr_.to_string());
 }
 
+//
+// Update the connected route and the path ids of its ECMP paths.
+//
+// Return true if the connected route or the forwarding state of any of its
+// ECMP paths changed. The generation of the ServiceChain is incremented in
+// that case so that external connecting routes evaluated against the old
+// connected route are not skipped when they are notified again.
+//
 template <typename T>
-void ServiceChain<T>::SetConnectedRoute(BgpRoute *connected) {
+bool ServiceChain<T>::SetConnectedRoute(BgpRoute *connected) {
+    bool changed = (connected_route_ != connected);
+    ConnectedPathInfoList path_info;
     connected_route_ = connected;
     connected_path_ids_.clear();
-    if (!connected_route_)
-        return;
 
-    for (Route::PathList::iterator it = connected->GetPathList().begin();
-        it != connected->GetPathList().end(); ++it) {
-        BgpPath *path = static_cast<BgpPath *>(it.operator->());
+    if (connected) {
+        for (Route::PathList::iterator it = connected->GetPathList().begin();
+             it != connected->GetPathList().end(); ++it) {
+            BgpPath *path = static_cast<BgpPath *>(it.operator->());
 
-        // Infeasible paths are not considered.
-        if (!path->IsFeasible())
-            break;
+            // Infeasible paths are not considered.
+            if (!path->IsFeasible())
+                break;
 
-        // Bail if it's not ECMP with the best path.
-        if (connected_route_->BestPath()->PathCompare(*path, true))
-            break;
+            // Bail if it's not ECMP with the best path.
+            if (connected_route_->BestPath()->PathCompare(*path, true))
+                break;
 
-        // Use nexthop attribute of connected path as path id.
-        uint32_t path_id = path->GetAttr()->nexthop().to_v4().to_ulong();
-        connected_path_ids_.insert(path_id);
+            // Use nexthop attribute of connected path as path id.
+            uint32_t path_id = path->GetAttr()->nexthop().to_v4().to_ulong();
+            connected_path_ids_.insert(path_id);
+            path_info.push_back(ConnectedPathInfo(path));
+        }
     }
+
+    if (!changed && path_info == connected_path_info_)
+        return false;
+    connected_path_info_.swap(path_info);
+    IncrementGeneration();
+    return true;
 }
 
 template <typename T>
@@ -748,6 +767,7 @@ void ServiceChain<T>::UpdateServiceChainRoute(PrefixT prefix,
     bool aggregate) {
 
     CHECK_CONCURRENCY("bgp::ServiceChain");
+    manager_->IncrementRouteUpdateCount();
 
     /*
      * For re-origination within the same AF.
@@ -1291,6 +1311,11 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
         }
         case ServiceChainRequestT::CONNECTED_ROUTE_ADD_CHG: {
             assert(state);
+
+            // Skip if there are more requests for the connected route in
+            // the queue. The last one will process the current state.
+            if (state->refcnt() > 1)
+                break;
             if (route->IsDeleted() || !route->BestPath() ||
                 !route->BestPath()->IsFeasible())  {
                 break;
@@ -1301,10 +1326,13 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
                 state->reset_deleted();
             }
 
-            // Store the old path id list and populate the new one.
+            // Store the old path id list and populate the new one. There's
+            // nothing to re-originate if the forwarding state of the ECMP
+            // paths of the connected route did not change.
             typename ServiceChainT::ConnectedPathIdList path_ids =
                 info->GetConnectedPathIds();
-            info->SetConnectedRoute(route);
+            if (!info->SetConnectedRoute(route))
+                break;
 
             if (!info->group_oper_state_up())
                 break;
@@ -1325,15 +1353,28 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
             if (state->deleted()) {
                 state->reset_deleted();
             }
+
+            // Skip if there are more requests for the route in the queue.
+            // The last one will process the current state of the route.
+            if (state->refcnt() > 1)
+                break;
             info->ext_connecting_routes()->insert(route);
             if (!info->IsConnectedRouteValid())
                 break;
             if (!info->group_oper_state_up())
                 break;
+
+            // Skip if the route was already evaluated with the same best
+            // path attribute against the current connected route.
+            const BgpPath *path = route->BestPath();
+            const BgpAttr *attr = path ? path->GetAttr() : NULL;
+            if (state->IsEvaluated(attr, info->generation()))
+                break;
             RouteT *ext_route = dynamic_cast<RouteT *>(route);
             typename ServiceChainT::ConnectedPathIdList path_ids;
             info->UpdateServiceChainRoute(
                 ext_route->GetPrefix(), ext_route, path_ids, false);
+            state->SetEvaluated(attr, info->generation());
             break;
         }
         case ServiceChainRequestT::EXT_CONNECT_ROUTE_DELETE: {
@@ -1342,10 +1383,15 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
                 RouteT *inet_route = dynamic_cast<RouteT *>(route);
                 info->DeleteServiceChainRoute(inet_route->GetPrefix(), false);
             }
+            state->ClearEvaluated();
             info->RemoveMatchState(route, state);
             break;
         }
         case ServiceChainRequestT::UPDATE_ALL_ROUTES: {
+            // Clear the pending flag before looking at the state so that a
+            // subsequent enqueue is not coalesced into this request.
+            info->ClearUpdateAllPending();
+            info->IncrementGeneration();
             if (info->dest_table_unregistered())
                 break;
             if (info->connected_table_unregistered())
@@ -1361,6 +1407,7 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
             break;
         }
         case ServiceChainRequestT::DELETE_ALL_ROUTES: {
+            info->IncrementGeneration();
             DeleteServiceChainRoutes(info);
             break;
         }
@@ -1426,6 +1473,7 @@ ServiceChainMgr<T>::ServiceChainMgr(BgpServer *server)
           bind(&ServiceChainMgr::ProcessServiceChainGroups, this),
           TaskScheduler::GetInstance()->GetTaskId("bgp::ServiceChain"), 0)),
       aggregate_host_route_(false),
+      route_update_count_(0),
       deleter_(new DeleteActor(this)),
       server_delete_ref_(this, server->deleter()) {
     if (service_chain_task_id_ == -1) {
@@ -1927,10 +1975,16 @@ void ServiceChainMgr<T>::UpdateServiceChain(RoutingInstance *rtinstance,
     chain->set_group_oper_state_up(group_oper_state_up);
 
     // Post event to ServiceChain task to update/delete all routes.
+    // Duplicate UPDATE_ALL_ROUTES requests are coalesced. A pending one
+    // must not be reused across a DELETE_ALL_ROUTES since it would then
+    // be processed before the delete.
     typename ServiceChainRequestT::RequestType req_type;
     if (group_oper_state_up) {
+        if (!chain->SetUpdateAllPending())
+            return;
         req_type = ServiceChainRequestT::UPDATE_ALL_ROUTES;
     } else {
+        chain->ClearUpdateAllPending();
         req_type = ServiceChainRequestT::DELETE_ALL_ROUTES;
     }
     ServiceChainRequestT *req = new ServiceChainRequestT(
@@ -1993,7 +2047,10 @@ void ServiceChainMgr<T>::PeerRegistrationCallback(IPeer *peer, BgpTable *table,
     if (!chain)
         return;
 
-    // Post event to ServiceChain task to update all routes.
+    // Post event to ServiceChain task to update all routes, unless there's
+    // one already pending.
+    if (!chain->SetUpdateAllPending())
+        return;
     ServiceChainRequestT *req =
         new ServiceChainRequestT(ServiceChainRequestT::UPDATE_ALL_ROUTES, NULL,
                                 NULL, PrefixT(), ServiceChainPtr(chain));
@@ -7,6 +7,7 @@
 
 #include <boost/ptr_container/ptr_map.hpp>
 #include <boost/shared_ptr.hpp>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 
 #include <list>
@@ -65,12 +66,30 @@ typedef ConditionMatchPtr ServiceChainPtr;
 
 class ServiceChainState : public ConditionMatchState {
 public:
-    explicit ServiceChainState(ServiceChainPtr info) : info_(info) {
+    explicit ServiceChainState(ServiceChainPtr info)
+        : info_(info), generation_(0) {
     }
     ServiceChainPtr info() { return info_; }
 
+    // Used to skip re-origination of an external connecting route when
+    // neither its best path attribute nor the connected route generation
+    // of the service chain changed since it was last evaluated.
+    bool IsEvaluated(const BgpAttr *attr, uint64_t generation) const {
+        return (attr_.get() == attr && generation_ == generation);
+    }
+    void SetEvaluated(const BgpAttr *attr, uint64_t generation) {
+        attr_ = attr;
+        generation_ = generation;
+    }
+    void ClearEvaluated() {
+        attr_ = NULL;
+        generation_ = 0;
+    }
+
 private:
     ServiceChainPtr info_;
+    BgpAttrPtr attr_;
+    uint64_t generation_;
     DISALLOW_COPY_AND_ASSIGN(ServiceChainState);
 };
 
@@ -157,11 +176,17 @@ public:
     bool CompareServiceChainConfig(const ServiceChainConfig &config);
     void RemoveMatchState(BgpRoute *route, ServiceChainState *state);
 
-    void SetConnectedRoute(BgpRoute *connected);
+    bool SetConnectedRoute(BgpRoute *connected);
     bool IsConnectedRouteValid() const;
     const ConnectedPathIdList &GetConnectedPathIds() {
         return connected_path_ids_;
     }
+    uint64_t generation() const { return generation_; }
+    void IncrementGeneration() { generation_++; }
+    bool SetUpdateAllPending() {
+        return !update_all_pending_.fetch_and_store(true);
+    }
+    void ClearUpdateAllPending() { update_all_pending_ = false; }
 
     BgpRoute *connected_route() const { return connected_route_; }
     RoutingInstance *src_routing_instance() const { return src_; }
@@ -226,13 +251,40 @@ public:
     void set_group_oper_state_up(bool up) { group_oper_state_up_ = up; }
 
 private:
+    // Forwarding state of an ECMP path of the connected route, used to
+    // detect whether a change to the connected route needs re-origination
+    // of the service chain routes.
+    struct ConnectedPathInfo {
+        explicit ConnectedPathInfo(const BgpPath *path)
+            : path(path),
+              peer(path->GetPeer()),
+              attr(path->GetAttr()),
+              label(path->GetLabel()),
+              flags(path->GetFlags()) {
+        }
+        bool operator==(const ConnectedPathInfo &rhs) const {
+            return (path == rhs.path && peer == rhs.peer &&
+                attr == rhs.attr && label == rhs.label && flags == rhs.flags);
+        }
+
+        const BgpPath *path;
+        const IPeer *peer;
+        BgpAttrPtr attr;
+        uint32_t label;
+        uint32_t flags;
+    };
+    typedef std::vector<ConnectedPathInfo> ConnectedPathInfoList;
+
     ServiceChainMgrT *manager_;
     ServiceChainGroup *group_;
     RoutingInstance *src_;
     RoutingInstance *dest_;
     RoutingInstance *connected_;
     ConnectedPathIdList connected_path_ids_;
+    ConnectedPathInfoList connected_path_info_;
     BgpRoute *connected_route_;
+    uint64_t generation_;
+    tbb::atomic<bool> update_all_pending_;
     AddressT service_chain_addr_;
     PrefixToRouteListMap prefix_to_routelist_map_;
     ExtConnectRouteList ext_connect_routes_;
@@ -347,6 +399,11 @@ public:
     virtual size_t PendingQueueSize() const { return pending_chains_.size(); }
     virtual size_t ResolvedQueueSize() const { return chain_set_.size(); }
     virtual uint32_t GetDownServiceChainCount() const;
+    // Number of service chain route (re-)originations, for tests
+    virtual uint64_t GetRouteUpdateCount() const {
+        return route_update_count_;
+    }
+    void IncrementRouteUpdateCount() { route_update_count_++; }
     virtual bool IsQueueEmpty() const { return process_queue_->IsQueueEmpty(); }
     virtual bool ServiceChainIsPending(RoutingInstance *rtinstance,
         std::string *reason = NULL) const;
@@ -457,6 +514,7 @@ private:
     GroupMap group_map_;
     GroupSet group_set_;
     bool aggregate_host_route_;
+    uint64_t route_update_count_;
     int id_;
     int registration_id_;
     boost::scoped_ptr<DeleteActor> deleter_;
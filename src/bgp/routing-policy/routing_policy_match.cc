@@ -349,6 +349,140 @@ bool MatchExtCommunity::IsEqual(const RoutingPolicyMatch &community) const {
     return true;
 }
 
+template <typename T>
+class MatchPrefix<T>::PrefixTrie {
+public:
+    typedef typename AddressT::bytes_type KeyT;
+
+    PrefixTrie() : root_(NULL) {
+    }
+    ~PrefixTrie() {
+        delete root_;
+    }
+
+    void Insert(const PrefixMatch &prefix_match) {
+        int prefixlen = prefix_match.prefix.prefixlen();
+        KeyT key = MaskKey(prefix_match.prefix.addr().to_bytes(), prefixlen);
+        Node **link = &root_;
+        while (true) {
+            Node *node = *link;
+            if (!node) {
+                *link = new Node(key, prefixlen, prefix_match);
+                return;
+            }
+
+            int common =
+                CommonLength(node->key, key, std::min(node->len, prefixlen));
+            if (common == node->len) {
+                if (node->len == prefixlen) {
+                    node->matches.push_back(prefix_match);
+                    return;
+                }
+                link = &node->child[GetBit(key, node->len)];
+                continue;
+            }
+
+            // Prefixes diverge above the existing node - insert a new
+            // node at the common length and hang both below it.
+            Node *parent = new Node(MaskKey(key, common), common);
+            parent->child[GetBit(node->key, common)] = node;
+            *link = parent;
+            if (common == prefixlen) {
+                parent->matches.push_back(prefix_match);
+            } else {
+                parent->child[GetBit(key, common)] =
+                    new Node(key, prefixlen, prefix_match);
+            }
+            return;
+        }
+    }
+
+    //
+    // Walk down the trie along the bits of the prefix. Every node visited
+    // is a covering prefix of (or equal to) the given prefix, so only the
+    // match type and prefix equality need to be checked for its elements.
+    //
+    bool Match(const PrefixT &prefix) const {
+        int prefixlen = prefix.prefixlen();
+        KeyT key = prefix.addr().to_bytes();
+        for (const Node *node = root_; node && node->len <= prefixlen;
+             node = node->child[GetBit(key, node->len)]) {
+            if (CommonLength(node->key, key, node->len) != node->len)
+                return false;
+            BOOST_FOREACH(const PrefixMatch &prefix_match, node->matches) {
+                if (prefix_match.match_type == EXACT) {
+                    if (prefix == prefix_match.prefix)
+                        return true;
+                } else if (prefix_match.match_type == LONGER) {
+                    if (prefix != prefix_match.prefix)
+                        return true;
+                } else if (prefix_match.match_type == ORLONGER) {
+                    return true;
+                }
+            }
+            if (node->len == prefixlen)
+                break;
+        }
+        return false;
+    }
+
+private:
+    struct Node {
+        Node(const KeyT &key, int len) : key(key), len(len) {
+            child[0] = child[1] = NULL;
+        }
+        Node(const KeyT &key, int len, const PrefixMatch &prefix_match)
+            : key(key), len(len) {
+            child[0] = child[1] = NULL;
+            matches.push_back(prefix_match);
+        }
+        ~Node() {
+            delete child[0];
+            delete child[1];
+        }
+
+        KeyT key;
+        int len;
+        Node *child[2];
+        PrefixMatchList matches;
+    };
+
+    static int GetBit(const KeyT &key, int bit) {
+        return (key[bit / 8] >> (7 - (bit % 8))) & 0x1;
+    }
+
+    static KeyT MaskKey(const KeyT &key, int len) {
+        KeyT masked = key;
+        for (size_t idx = 0; idx < masked.size(); ++idx) {
+            int bits = len - static_cast<int>(idx * 8);
+            if (bits >= 8)
+                continue;
+            masked[idx] &= (bits <= 0) ? 0 : (0xFF << (8 - bits)) & 0xFF;
+        }
+        return masked;
+    }
+
+    // Number of leading bits, up to max_len, that are common to both keys.
+    static int CommonLength(const KeyT &lhs, const KeyT &rhs, int max_len) {
+        int len = 0;
+        for (size_t idx = 0; len < max_len; ++idx, len += 8) {
+            uint8_t diff = lhs[idx] ^ rhs[idx];
+            if (diff == 0)
+                continue;
+            while ((diff & 0x80) == 0) {
+                diff <<= 1;
+                len++;
+            }
+            return std::min(len, max_len);
+        }
+        return max_len;
+    }
+
+    Node *root_;
+
+    DISALLOW_COPY_AND_ASSIGN(PrefixTrie);
+};
+
 template <typename T>
 typename MatchPrefix<T>::MatchType MatchPrefix<T>::GetMatchType(
     const string &match_type_str) {
@@ -378,6 +512,11 @@ MatchPrefix<T>::MatchPrefix(const PrefixMatchConfigList &match_config_list) {
     typename PrefixMatchList::iterator it =
         unique(match_list_.begin(), match_list_.end());
     match_list_.erase(it, match_list_.end());
+
+    trie_.reset(new PrefixTrie());
+    BOOST_FOREACH(const PrefixMatch &prefix_match, match_list_) {
+        trie_->Insert(prefix_match);
+    }
 }
 
 template <typename T>
@@ -390,7 +529,16 @@ bool MatchPrefix<T>::Match(const BgpRoute *route, const BgpPath *path,
     const RouteT *in_route = dynamic_cast<const RouteT *>(route);
     if (in_route == NULL)
         return false;
-    const PrefixT &prefix = in_route->GetPrefix();
+    return MatchTrie(in_route->GetPrefix());
+}
+
+template <typename T>
+bool MatchPrefix<T>::MatchTrie(const PrefixT &prefix) const {
+    return trie_->Match(prefix);
+}
+
+template <typename T>
+bool MatchPrefix<T>::MatchLinear(const PrefixT &prefix) const {
     BOOST_FOREACH(const PrefixMatch &prefix_match, match_list_) {
         if (prefix_match.match_type == EXACT) {
             if (prefix == prefix_match.prefix)
@@ -410,7 +558,7 @@ bool MatchPrefix<T>::Match(const BgpRoute *route, const BgpPath *path,
 
 template <typename T>
 bool MatchPrefix<T>::IsEqual(const RoutingPolicyMatch &prefix) const {
-    const MatchPrefix in_prefix = static_cast<const MatchPrefix&>(prefix);
+    const MatchPrefix &in_prefix = static_cast<const MatchPrefix&>(prefix);
     return (in_prefix.match_list_ == match_list_);
 }
 
@@ -13,6 +13,8 @@
 #include <utility>
 #include <vector>
 
+#include <boost/scoped_ptr.hpp>
+
 #include "base/regex.h"
 #include "bgp/bgp_config.h"
 #include "bgp/inet/inet_route.h"
@@ -138,20 +140,22 @@ private:
 };
 const std::string MatchProtocolToString(MatchProtocol::MatchProtocolType protocol);
 
-template <typename T1, typename T2>
+template <typename T1, typename T2, typename T3>
 struct PrefixMatchBase {
     typedef T1 RouteT;
     typedef T2 PrefixT;
+    typedef T3 AddressT;
 };
 
-typedef PrefixMatchBase<InetRoute, Ip4Prefix> PrefixMatchInet;
-typedef PrefixMatchBase<Inet6Route, Inet6Prefix> PrefixMatchInet6;
+typedef PrefixMatchBase<InetRoute, Ip4Prefix, Ip4Address> PrefixMatchInet;
+typedef PrefixMatchBase<Inet6Route, Inet6Prefix, Ip6Address> PrefixMatchInet6;
 
 template <typename T>
 class MatchPrefix : public RoutingPolicyMatch {
 public:
     typedef typename T::RouteT RouteT;
     typedef typename T::PrefixT PrefixT;
+    typedef typename T::AddressT AddressT;
     enum MatchType {
         EXACT,
         LONGER,
@@ -189,7 +193,19 @@ private:
     template <typename U> friend class MatchPrefixTest;
     typedef std::vector<PrefixMatch> PrefixMatchList;
 
+    //
+    // Path compressed binary trie built from match_list_. Each node holds
+    // the PrefixMatch elements whose prefix ends at the node, so that a
+    // lookup only visits the covering prefixes of the route instead of
+    // scanning the entire list.
+    //
+    class PrefixTrie;
+
+    bool MatchLinear(const PrefixT &prefix) const;
+    bool MatchTrie(const PrefixT &prefix) const;
+
     PrefixMatchList match_list_;
+    boost::scoped_ptr<PrefixTrie> trie_;
 };
 
 typedef MatchPrefix<PrefixMatchInet> MatchPrefixInet;
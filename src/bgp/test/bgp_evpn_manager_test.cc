@@ -5,7 +5,9 @@
 #include <boost/foreach.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include "base/string_util.h"
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "bgp/bgp_factory.h"
 #include "bgp/bgp_evpn.h"
 #include "bgp/bgp_ribout_updates.h"
@@ -1751,6 +1753,62 @@ TEST_P(BgpEvpnManagerTest, Basic4) {
     VerifyAllXmppPeersNoInclusiveMulticastRoute();
 }
 
+static size_t GetScaleBgpPeerCount() {
+    char *env = getenv("BGP_EVPN_MANAGER_TEST_SCALE_PEER_COUNT");
+    size_t count = 64;
+    if (!env)
+        return count;
+    stringToInteger(string(env), count);
+    return count;
+}
+
+// Add Broadcast MAC routes from all XMPP peers.
+// Add Inclusive Multicast routes from an increasing number of BGP peers.
+// Measure the time taken to add one more BGP peer and the number of interned
+// OLists and attributes for each number of BGP peers.
+//
+// The number of BGP peers grows by 4x up to 64 by default. Set
+// BGP_EVPN_MANAGER_TEST_SCALE_PEER_COUNT (e.g. 2048) to run at scale.
+TEST_P(BgpEvpnManagerTest, ScaleBgpPeers) {
+    vector<size_t> bgp_peer_counts;
+    size_t max_bgp_peer_count = GetScaleBgpPeerCount();
+    for (size_t count = 16; count < max_bgp_peer_count; count *= 4) {
+        bgp_peer_counts.push_back(count);
+    }
+    bgp_peer_counts.push_back(max_bgp_peer_count);
+    AddAllXmppPeersBroadcastMacRoute();
+    VerifyAllXmppPeersInclusiveMulticastRoute();
+
+    BOOST_FOREACH(size_t bgp_peer_count, bgp_peer_counts) {
+        while (bgp_peers_.size() < bgp_peer_count) {
+            int idx = bgp_peers_.size() + 1;
+            Ip4Address address(Ip4Address::from_string("30.0.0.0").to_ulong() +
+                idx);
+            PeerMock *peer = new PeerMock(idx, address, false, 200 + idx);
+            bgp_peers_.push_back(peer);
+            if (bgp_peers_.size() < bgp_peer_count)
+                AddBgpPeerInclusiveMulticastRoute(peer, tag_);
+        }
+
+        uint64_t start = UTCTimestampUsec();
+        AddBgpPeerInclusiveMulticastRoute(bgp_peers_.back(), tag_);
+        task_util::WaitForIdle();
+        uint64_t elapsed = UTCTimestampUsec() - start;
+        VerifyAllXmppPeersAllUpdateInfo();
+        cout << "BGP peers: " << bgp_peer_count
+             << " add time: " << elapsed << " usec"
+             << " olists: " << server_->olist_db()->Size()
+             << " attrs: " << server_->attr_db()->Size() << endl;
+    }
+
+    DelAllBgpPeersInclusiveMulticastRoute();
+    TASK_UTIL_EXPECT_EQ(xmpp_peers_.size(), GetPartitionRemoteSize(tag_));
+    VerifyAllXmppPeersNoUpdateInfo();
+    DelAllXmppPeersBroadcastMacRoute();
+    TASK_UTIL_EXPECT_EQ(0, GetPartitionLocalSize(tag_));
+    TASK_UTIL_EXPECT_EQ(0, GetPartitionRemoteSize(tag_));
+}
+
 // Add Broadcast MAC routes from all XMPP peers with ISID value as tag.
 // Verify generated Inclusive Multicast routes in bgp.evpn.0.
 // Add Inclusive Multicast route from all BGP peers. In this test, the BGP peer
@@ -481,6 +481,15 @@ protected:
     void AddMvpnRoute(BgpTable *table, const string &prefix_str,
                       const string &target, BgpAttrSourceRd *source_rd = NULL,
                       bool add_leaf_req = false) {
+        EnqueueAddMvpnRoute(table, prefix_str, target, source_rd,
+                            add_leaf_req);
+        task_util::WaitForIdle();
+    }
+
+    void EnqueueAddMvpnRoute(BgpTable *table, const string &prefix_str,
+                             const string &target,
+                             BgpAttrSourceRd *source_rd = NULL,
+                             bool add_leaf_req = false) {
         for (size_t i = 0; i < paths_count_; i++) {
             MvpnPrefix prefix(MvpnPrefix::FromString(prefix_str));
             DBRequest add_req;
@@ -508,10 +517,14 @@ protected:
             add_req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
             table->Enqueue(&add_req);
         }
-        task_util::WaitForIdle();
     }
 
     void DeleteMvpnRoute(BgpTable *table, const string &prefix_str) {
+        EnqueueDeleteMvpnRoute(table, prefix_str);
+        task_util::WaitForIdle();
+    }
+
+    void EnqueueDeleteMvpnRoute(BgpTable *table, const string &prefix_str) {
         for (size_t i = 0; i < paths_count_; i++) {
             DBRequest delete_req;
             MvpnPrefix prefix(MvpnPrefix::FromString(prefix_str));
@@ -520,7 +533,6 @@ protected:
             delete_req.oper = DBRequest::DB_ENTRY_DELETE;
             table->Enqueue(&delete_req);
         }
-        task_util::WaitForIdle();
     }
 
     MvpnRoute *VerifyLeafADMvpnRoute(MvpnTable *table, const string &prefix,
@@ -2,8 +2,41 @@
  * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
  */
 
+#include "base/time_util.h"
 #include "bgp_mvpn_test.cc"
 
+static size_t GetScaleSGCount() {
+    char *env = getenv("BGP_MVPN_TEST_SCALE_SG_COUNT");
+    size_t count = 256;
+    if (!env)
+        return count;
+    stringToInteger(string(env), count);
+    return count;
+}
+
+// Number of receivers (Type-7 joins) per <S,G> in the scale test.
+static const size_t kScaleJoinCount = 4;
+
+// Encode group index into both of the lower octets so that more than 255
+// <S,G>s can be created for scale testing.
+static string scale_group(size_t gindex) {
+    ostringstream os;
+    os << "224.2." << (gindex >> 8) << "." << (gindex & 0xff);
+    return os.str();
+}
+
+static string scale_prefix5(size_t index, size_t gindex) {
+    ostringstream os;
+    os << "5-0.0.0.0:" << index << ",9.8.7.6," << scale_group(gindex);
+    return os.str();
+}
+
+static string scale_prefix7(size_t index, size_t gindex) {
+    ostringstream os;
+    os << "7-10.1.1.1:" << index << ",1,9.8.7.6," << scale_group(gindex);
+    return os.str();
+}
+
 // Receive Type-7 join route and ensure that Type-3 S-PMSI is generated.
 // Type-5 route comes in first followed by Type-7 join
 TEST_P(BgpMvpnTest, Type3_SPMSI_1) {
@@ -98,3 +131,77 @@ TEST_P(BgpMvpnTest, Type3_SPMSI_1) {
         TASK_UTIL_EXPECT_EQ(3, green_[i-1]->Size());
     }
 }
+
+// Scale variant of Type3_SPMSI_1 with a large number of <S,G>s, each with
+// multiple receivers. Joins for all <S,G>s are enqueued with the scheduler
+// stopped, so that join changes for the same <S,G> are coalesced into fewer
+// re-evaluations of its Type-5 source active route than there are joins.
+TEST_P(BgpMvpnTest, Type3_SPMSI_Scale) {
+    if (!preconfigure_pm_ || instances_set_count_ != 1 || groups_count_ != 1 ||
+            paths_count_ != 1) {
+        return;
+    }
+
+    VerifyInitialState(preconfigure_pm_);
+    size_t count = GetScaleSGCount();
+    for (size_t j = 1; j <= count; j++) {
+        AddType5MvpnRoute(red_[0], scale_prefix5(1, j), getRouteTarget(1, "1"),
+                          "10.1.1.1");
+    }
+    TASK_UTIL_EXPECT_EQ(4 + count + 1, master_->Size());
+    TASK_UTIL_EXPECT_EQ(count + 1, red_[0]->Size());
+
+    const MvpnManager *manager = red_[0]->manager();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    string target = "target:127.0.0.1:" +
+        integerToString(red_[0]->routing_instance()->index());
+    uint64_t evaluations = manager->source_active_evaluations();
+    uint64_t start = UTCTimestampUsec();
+    scheduler->Stop();
+    for (size_t j = 1; j <= count; j++) {
+        for (size_t k = 1; k <= kScaleJoinCount; k++)
+            EnqueueAddMvpnRoute(master_, scale_prefix7(k, j), target);
+    }
+    scheduler->Start();
+
+    // 4 local-ad + 1 remote-sa + joins + 1 local-spmsi per <S,G>
+    TASK_UTIL_EXPECT_EQ(4 + (2 + kScaleJoinCount) * count + 1,
+                        master_->Size());
+    TASK_UTIL_EXPECT_EQ(1 + (2 + kScaleJoinCount) * count, red_[0]->Size());
+    task_util::WaitForIdle();
+    uint64_t join_time = UTCTimestampUsec() - start;
+    uint64_t join_evaluations =
+        manager->source_active_evaluations() - evaluations;
+    EXPECT_GE(join_evaluations, count);
+    EXPECT_LT(join_evaluations, kScaleJoinCount * count);
+
+    evaluations = manager->source_active_evaluations();
+    start = UTCTimestampUsec();
+    scheduler->Stop();
+    for (size_t j = 1; j <= count; j++) {
+        for (size_t k = 1; k <= kScaleJoinCount; k++)
+            EnqueueDeleteMvpnRoute(master_, scale_prefix7(k, j));
+    }
+    scheduler->Start();
+    TASK_UTIL_EXPECT_EQ(4 + count + 1, master_->Size());
+    TASK_UTIL_EXPECT_EQ(1 + count, red_[0]->Size());
+    task_util::WaitForIdle();
+    uint64_t leave_time = UTCTimestampUsec() - start;
+    uint64_t leave_evaluations =
+        manager->source_active_evaluations() - evaluations;
+    EXPECT_GE(leave_evaluations, count);
+    EXPECT_LT(leave_evaluations, kScaleJoinCount * count);
+
+    std::cout << "SG count " << count << ", joins per SG " << kScaleJoinCount
+         << ": join " << join_time/1000 << " msecs, " << join_evaluations
+         << " source active evaluations, leave " << leave_time/1000
+         << " msecs, " << leave_evaluations << " source active evaluations"
+         << std::endl;
+
+    for (size_t j = 1; j <= count; j++)
+        DeleteMvpnRoute(red_[0], scale_prefix5(1, j));
+    TASK_UTIL_EXPECT_EQ(4 + 1, master_->Size());
+    TASK_UTIL_EXPECT_EQ(1, red_[0]->Size());
+    TASK_UTIL_EXPECT_EQ(1, blue_[0]->Size());
+    TASK_UTIL_EXPECT_EQ(3, green_[0]->Size());
+}
@@ -9,6 +9,7 @@
 #include <boost/foreach.hpp>
 #include <boost/program_options.hpp>
 
+#include "base/time_util.h"
 #include "sandesh/sandesh_types.h"
 #include "sandesh/sandesh.h"
 #include "sandesh/sandesh_trace.h"
@@ -110,6 +111,9 @@ static const char *config = "\
 // Overlay nexthop address family.
 static bool nexthop_family_is_inet;
 
+// Number of prefixes used by the nexthop flap scale test.
+static int nexthop_flap_path_count;
+
 //
 // Template structure to pass to fixture class template. Needed because
 // gtest fixture class template can accept only one template parameter.
@@ -581,6 +585,11 @@ protected:
         return table->path_resolver()->GetResolverNexthopUpdateListSize();
     }
 
+    uint64_t ResolverNexthopUpdateCount(const string &instance) {
+        BgpTable *table = GetTable(instance);
+        return table->path_resolver()->GetResolverNexthopUpdateCount();
+    }
+
     void DisableResolverPathUpdateProcessing(const string &instance) {
         PathResolver *resolver = GetTable(instance)->path_resolver();
         task_util::TaskFire(
@@ -607,6 +616,12 @@ protected:
         table->path_resolver()->ResumeResolverPathUpdateProcessing();
     }
 
+    void SetResolverNexthopUpdateHoldTime(const string &instance,
+        int hold_time_msecs) {
+        PathResolver *resolver = GetTable(instance)->path_resolver();
+        resolver->set_nexthop_update_hold_time(hold_time_msecs);
+    }
+
     size_t ResolverPathUpdateListSize(const string &instance) {
         BgpTable *table = GetTable(instance);
         return table->path_resolver()->GetResolverPathUpdateListSize();
@@ -3670,6 +3685,97 @@ TYPED_TEST(PathResolverTest, UnderlayLongestMatch2) {
     this->DeleteBgpPath(bgp_peer1, "blue", this->BuildPrefix(2));
 }
 
+//
+// BGP has a large number of prefixes, each with the same nexthop.
+// Change the XMPP path for the nexthop multiple times in quick succession
+// and measure the time taken for all resolved paths to reconverge, without
+// and with a hold time for nexthop updates.
+//
+// Verify that the changes are coalesced i.e. the ResolverNexthop is updated
+// fewer times than the XMPP path changed, and that all resolved paths end up
+// with the label from the last change.
+//
+TYPED_TEST(PathResolverTest, NexthopFlapScale) {
+    static const int kFlapCount = 8;
+    static const int kHoldTimes[] = { 0, 1000 };
+    PeerMock *bgp_peer1 = this->bgp_peer1_;
+    PeerMock *xmpp_peer1 = this->xmpp_peer1_;
+
+    for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+        this->AddBgpPath(bgp_peer1, "blue", this->BuildPrefix(idx),
+            this->BuildHostAddress(bgp_peer1->ToString()));
+    }
+
+    int label = 10000;
+    this->AddXmppPath(xmpp_peer1, "blue",
+        this->BuildPrefix(bgp_peer1->ToString(), 32),
+        this->BuildNextHopAddress("172.16.1.1"), label);
+    for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+        this->VerifyPathAttributes("blue", this->BuildPrefix(idx), bgp_peer1,
+            this->BuildNextHopAddress("172.16.1.1"), label);
+    }
+    TASK_UTIL_EXPECT_EQ(0, this->ResolverNexthopUpdateListSize("blue"));
+    TASK_UTIL_EXPECT_EQ(0, this->ResolverPathUpdateListSize("blue"));
+
+    for (size_t hold_idx = 0;
+         hold_idx < sizeof(kHoldTimes) / sizeof(kHoldTimes[0]); ++hold_idx) {
+        int hold_time = kHoldTimes[hold_idx];
+        this->SetResolverNexthopUpdateHoldTime("blue", hold_time);
+
+        // Without a hold time, hold off processing of the nexthop update
+        // list so that all the changes are seen before the first update.
+        if (!hold_time)
+            this->DisableResolverNexthopUpdateProcessing("blue");
+        uint64_t update_count = this->ResolverNexthopUpdateCount("blue");
+        uint64_t start = UTCTimestampUsec();
+        for (int flap = 0; flap < kFlapCount; ++flap) {
+            this->AddXmppPath(xmpp_peer1, "blue",
+                this->BuildPrefix(bgp_peer1->ToString(), 32),
+                this->BuildNextHopAddress("172.16.1.1"), ++label);
+        }
+        if (!hold_time) {
+            TASK_UTIL_EXPECT_EQ(1, this->ResolverNexthopUpdateListSize("blue"));
+            this->EnableResolverNexthopUpdateProcessing("blue");
+        }
+
+        for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+            this->VerifyPathAttributes("blue", this->BuildPrefix(idx),
+                bgp_peer1, this->BuildNextHopAddress("172.16.1.1"), label);
+        }
+        TASK_UTIL_EXPECT_EQ(0, this->ResolverNexthopUpdateListSize("blue"));
+        TASK_UTIL_EXPECT_EQ(0, this->ResolverPathUpdateListSize("blue"));
+        uint64_t elapsed = UTCTimestampUsec() - start;
+
+        update_count = this->ResolverNexthopUpdateCount("blue") - update_count;
+        EXPECT_LE(1U, update_count);
+        EXPECT_GT(static_cast<uint64_t>(kFlapCount), update_count);
+        for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+            EXPECT_FALSE(this->CheckPathAttributes("blue",
+                this->BuildPrefix(idx), bgp_peer1,
+                this->BuildNextHopAddress("172.16.1.1"), label - 1,
+                vector<uint32_t>(), set<string>(), LoadBalance(), 0,
+                CommunitySpec(), vector<uint16_t>()));
+        }
+
+        cout << "Reconverged " << nexthop_flap_path_count << " paths after "
+             << kFlapCount << " nexthop changes with hold time "
+             << hold_time << " msecs in " << elapsed / 1000
+             << " msecs with " << update_count << " nexthop updates" << endl;
+    }
+    this->SetResolverNexthopUpdateHoldTime("blue", 0);
+
+    this->DeleteXmppPath(xmpp_peer1, "blue",
+        this->BuildPrefix(bgp_peer1->ToString(), 32));
+    for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+        this->VerifyPathNoExists("blue", this->BuildPrefix(idx), bgp_peer1,
+            this->BuildNextHopAddress("172.16.1.1"));
+    }
+
+    for (int idx = 1; idx <= nexthop_flap_path_count; ++idx) {
+        this->DeleteBgpPath(bgp_peer1, "blue", this->BuildPrefix(idx));
+    }
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
@@ -3690,7 +3796,9 @@ static void process_command_line_args(int argc, const char **argv) {
     desc.add_options()
         ("help", "produce help message")
         ("nexthop-address-family", value<string>()->default_value("inet"),
-             "set nexthop address family (inet/inet6)");
+             "set nexthop address family (inet/inet6)")
+        ("nexthop-flap-path-count", value<int>()->default_value(256),
+             "set number of paths for the nexthop flap scale test");
     variables_map vm;
     store(parse_command_line(argc, argv, desc), vm);
     notify(vm);
@@ -3699,6 +3807,7 @@ static void process_command_line_args(int argc, const char **argv) {
         nexthop_family_is_inet =
             (vm["nexthop-address-family"].as<string>() == "inet");
     }
+    nexthop_flap_path_count = vm["nexthop-flap-path-count"].as<int>();
 }
 
 int path_resolver_test_main(int argc, const char **argv) {
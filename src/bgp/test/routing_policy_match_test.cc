@@ -4,8 +4,11 @@
 
 
 #include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
 
+#include "base/string_util.h"
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_path.h"
@@ -16,8 +19,11 @@
 #include "net/community_type.h"
 
 using boost::assign::list_of;
+using std::cout;
+using std::endl;
 using std::find;
 using std::string;
+using std::vector;
 
 class PeerMock : public IPeer {
 public:
@@ -1786,6 +1792,32 @@ protected:
                 match_prefix->match_list_.end());
     }
 
+    bool MatchLinear(const MatchPrefixT *match_prefix, const PrefixT &prefix) {
+        return match_prefix->MatchLinear(prefix);
+    }
+
+    bool MatchTrie(const MatchPrefixT *match_prefix, const PrefixT &prefix) {
+        return match_prefix->MatchTrie(prefix);
+    }
+
+    // Build a random prefix within 10.0.0.0/12 so that lists and lookups
+    // overlap enough to exercise all match types.
+    string BuildRandomPrefix(uint8_t min_plen, uint8_t max_plen) const {
+        uint8_t plen = min_plen + rand() % (max_plen - min_plen + 1);
+        uint32_t addr = (10 << 24) | ((rand() % 16) << 16) |
+            ((rand() % 256) << 8) | (rand() % 256);
+        addr &= plen ? (~0U << (Address::kMaxV4PrefixLen - plen)) : 0;
+        return BuildPrefix(Ip4Address(addr).to_string(), plen);
+    }
+
+    void BuildRandomConfig(size_t count, PrefixMatchConfigList *cfg_list) {
+        static const char *match_types[] = { "exact", "longer", "orlonger" };
+        for (size_t idx = 0; idx < count; ++idx) {
+            cfg_list->push_back(PrefixMatchConfig(BuildRandomPrefix(8, 32),
+                match_types[rand() % 3]));
+        }
+    }
+
     Address::Family family_;
     string ipv6_prefix_;
 };
@@ -2032,6 +2064,85 @@ TYPED_TEST(MatchPrefixTest, Match) {
     EXPECT_FALSE(match.Match(&route8, NULL, NULL));
 }
 
+//
+// Verify that the trie based lookup returns the same result as a linear
+// scan of the prefix list for random lists and random routes.
+//
+TYPED_TEST(MatchPrefixTest, MatchTrieVsLinear) {
+    srand(1);
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        PrefixMatchConfigList cfg_list;
+        this->BuildRandomConfig(rand() % 512, &cfg_list);
+        typename TestFixture::MatchPrefixT match(cfg_list);
+        for (int idx = 0; idx < 1000; ++idx) {
+            typename TestFixture::PrefixT prefix =
+                TestFixture::PrefixT::FromString(
+                    this->BuildRandomPrefix(0, 32));
+            EXPECT_EQ(this->MatchLinear(&match, prefix),
+                      this->MatchTrie(&match, prefix));
+        }
+    }
+}
+
+static size_t GetMatchScaleListSize() {
+    char *env = getenv("ROUTING_POLICY_MATCH_TEST_SCALE_LIST_SIZE");
+    size_t count = 1000;
+    if (!env)
+        return count;
+    stringToInteger(string(env), count);
+    return count;
+}
+
+//
+// Compare lookup cost of the trie against a linear scan of the list as
+// the size of the prefix list grows.
+//
+// The prefix list grows by 10x up to 1000 entries by default. Set
+// ROUTING_POLICY_MATCH_TEST_SCALE_LIST_SIZE (e.g. 50000) to run at scale.
+//
+TYPED_TEST(MatchPrefixTest, MatchScale) {
+    static const size_t kLookupCount = 1000;
+    vector<size_t> list_sizes;
+    size_t max_list_size = GetMatchScaleListSize();
+    for (size_t list_size = 10; list_size < max_list_size; list_size *= 10) {
+        list_sizes.push_back(list_size);
+    }
+    list_sizes.push_back(max_list_size);
+
+    srand(1);
+    vector<typename TestFixture::PrefixT> prefixes;
+    for (size_t idx = 0; idx < kLookupCount; ++idx) {
+        prefixes.push_back(TestFixture::PrefixT::FromString(
+            this->BuildRandomPrefix(8, 32)));
+    }
+
+    for (size_t list_idx = 0; list_idx < list_sizes.size(); ++list_idx) {
+        PrefixMatchConfigList cfg_list;
+        this->BuildRandomConfig(list_sizes[list_idx], &cfg_list);
+        typename TestFixture::MatchPrefixT match(cfg_list);
+
+        size_t linear_matches = 0;
+        uint64_t start = UTCTimestampUsec();
+        BOOST_FOREACH(const typename TestFixture::PrefixT &prefix, prefixes) {
+            linear_matches += this->MatchLinear(&match, prefix) ? 1 : 0;
+        }
+        uint64_t linear_usecs = UTCTimestampUsec() - start;
+
+        size_t trie_matches = 0;
+        start = UTCTimestampUsec();
+        BOOST_FOREACH(const typename TestFixture::PrefixT &prefix, prefixes) {
+            trie_matches += this->MatchTrie(&match, prefix) ? 1 : 0;
+        }
+        uint64_t trie_usecs = UTCTimestampUsec() - start;
+
+        EXPECT_EQ(linear_matches, trie_matches);
+        cout << "Prefix list size " << list_sizes[list_idx]
+             << ": " << kLookupCount << " lookups, linear "
+             << linear_usecs << " usecs, trie " << trie_usecs
+             << " usecs" << endl;
+    }
+}
+
 static void SetUp() {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
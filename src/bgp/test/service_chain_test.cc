@@ -13,6 +13,7 @@
 #include "base/regex.h"
 #include "base/task_annotations.h"
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config_ifmap.h"
 #include "bgp/bgp_config_parser.h"
 #include "bgp/bgp_factory.h"
@@ -54,6 +55,7 @@ using pugi::xml_document;
 using pugi::xml_node;
 using pugi::xml_parse_result;
 using std::auto_ptr;
+using std::cout;
 using std::endl;
 using std::ifstream;
 using std::istreambuf_iterator;
@@ -3653,6 +3655,103 @@ TYPED_TEST(ServiceChainTest, ExtConnectRoute) {
     this->DeleteConnectedRoute(NULL, this->BuildConnPrefix("1.1.2.3", 32));
 }
 
+//
+// Convergence of a large number of external connecting routes.
+//
+// 1. Add ext connect routes and then the connected route
+// 2. Change nexthop of the connected route - all routes are re-originated
+// 3. Re-add the connected route with the same attributes - no route is
+//    re-originated
+// 4. Update each ext connect route multiple times with the service chain
+//    queue disabled - only the last update for each route is re-originated
+//
+TYPED_TEST(ServiceChainTest, ExtConnectRouteConvergence) {
+    static const int kRouteCount = 4096;
+    static const int kUpdateCount = 4;
+    vector<string> instance_names = list_of("blue")("blue-i1")("red-i2")("red");
+    multimap<string, string> connections =
+        map_list_of("blue", "blue-i1") ("red-i2", "red");
+    this->NetworkConfig(instance_names, connections);
+    this->VerifyNetworkConfig(instance_names);
+
+    this->SetServiceChainInformation("blue-i1",
+        "controller/src/bgp/testdata/service_chain_1.xml");
+
+    vector<string> prefixes;
+    for (int idx = 0; idx < kRouteCount; ++idx) {
+        prefixes.push_back(this->BuildPrefix("10." +
+            integerToString(idx / 256) + "." +
+            integerToString(idx % 256) + ".0", 24));
+        this->AddRoute(NULL, "red", prefixes.back(), 100);
+    }
+    task_util::WaitForIdle();
+
+    uint64_t updates = this->service_chain_mgr_->GetRouteUpdateCount();
+    uint64_t start = UTCTimestampUsec();
+    this->AddConnectedRoute(NULL, this->BuildConnPrefix("1.1.2.3", 32), 100,
+                            this->BuildNextHopAddress("2.3.4.5"));
+    this->VerifyRouteAttributes("blue", prefixes.front(),
+                                this->BuildNextHopAddress("2.3.4.5"), "red");
+    this->VerifyRouteAttributes("blue", prefixes.back(),
+                                this->BuildNextHopAddress("2.3.4.5"), "red");
+    task_util::WaitForIdle();
+    cout << "Origination of " << kRouteCount << " routes took "
+         << (UTCTimestampUsec() - start) / 1000 << " msec" << endl;
+    EXPECT_LE(updates + kRouteCount,
+              this->service_chain_mgr_->GetRouteUpdateCount());
+
+    updates = this->service_chain_mgr_->GetRouteUpdateCount();
+    start = UTCTimestampUsec();
+    this->AddConnectedRoute(NULL, this->BuildConnPrefix("1.1.2.3", 32), 100,
+                            this->BuildNextHopAddress("2.3.4.6"));
+    this->VerifyRouteAttributes("blue", prefixes.front(),
+                                this->BuildNextHopAddress("2.3.4.6"), "red");
+    this->VerifyRouteAttributes("blue", prefixes.back(),
+                                this->BuildNextHopAddress("2.3.4.6"), "red");
+    task_util::WaitForIdle();
+    cout << "Connected route change took "
+         << (UTCTimestampUsec() - start) / 1000 << " msec" << endl;
+    EXPECT_LE(updates + kRouteCount,
+              this->service_chain_mgr_->GetRouteUpdateCount());
+
+    updates = this->service_chain_mgr_->GetRouteUpdateCount();
+    this->AddConnectedRoute(NULL, this->BuildConnPrefix("1.1.2.3", 32), 100,
+                            this->BuildNextHopAddress("2.3.4.6"));
+    task_util::WaitForIdle();
+    EXPECT_EQ(updates, this->service_chain_mgr_->GetRouteUpdateCount());
+
+    this->DisableServiceChainQ();
+    for (int count = 1; count <= kUpdateCount; ++count) {
+        BOOST_FOREACH(const string &prefix, prefixes) {
+            this->AddRoute(NULL, "red", prefix, 100 + count);
+        }
+    }
+    task_util::WaitForIdle();
+    updates = this->service_chain_mgr_->GetRouteUpdateCount();
+    start = UTCTimestampUsec();
+    this->EnableServiceChainQ();
+    TASK_UTIL_EXPECT_TRUE(this->IsServiceChainQEmpty());
+    task_util::WaitForIdle();
+    cout << "Processing " << kUpdateCount << " updates for " << kRouteCount
+         << " routes took " << (UTCTimestampUsec() - start) / 1000
+         << " msec" << endl;
+    EXPECT_EQ(updates + kRouteCount,
+              this->service_chain_mgr_->GetRouteUpdateCount());
+    this->VerifyRouteAttributes("blue", prefixes.front(),
+                                this->BuildNextHopAddress("2.3.4.6"), "red");
+    this->VerifyRouteAttributes("blue", prefixes.back(),
+                                this->BuildNextHopAddress("2.3.4.6"), "red");
+
+    BOOST_FOREACH(const string &prefix, prefixes) {
+        this->DeleteRoute(NULL, "red", prefix);
+    }
+    this->DeleteConnectedRoute(NULL, this->BuildConnPrefix("1.1.2.3", 32));
+    task_util::WaitForIdle();
+    BOOST_FOREACH(const string &prefix, prefixes) {
+        this->VerifyRouteNoExists("blue", prefix);
+    }
+}
+
 //
 // 1. Create Service Chain with 192.168.1.0/24 as vn subnet
 // 2. Add MX leaked route 10.1.1.0/24
@@ -15,10 +15,24 @@ using namespace pugi;
 
 void IFMapAgentParser::NodeRegister(const string &node, NodeParseFn parser) {
     pair<NodeParseMap::iterator, bool> result =
-            node_map_.insert(make_pair(node, parser));
+            node_map_.insert(make_pair(node, NodeParseEntry(parser)));
     assert(result.second);
 }
 
+// Find the table for an element type, using the table cached in the dispatch
+// entry when the type has a registered parser.
+IFMapTable *IFMapAgentParser::TableLookup(const char *name) {
+    NodeParseMap::iterator loc =
+        node_map_.find(name, ElementNameHash(), ElementNameEqual());
+    if (loc == node_map_.end()) {
+        return IFMapTable::FindTable(db_, name);
+    }
+    if (loc->second.table == NULL) {
+        loc->second.table = IFMapTable::FindTable(db_, name);
+    }
+    return loc->second.table;
+}
+
 void IFMapAgentParser::NodeClear() {
     node_map_.clear();
 }
@@ -32,16 +46,20 @@ void IFMapAgentParser::NodeParse(xml_node &node, DBRequest::DBOperation oper, ui
     else
         msg_type = DEL;
 
-    IFMapTable *table;
-    table = IFMapTable::FindTable(db_, name);
-    if(!table) {
+    // Locate the table and the decode function using the element type
+    NodeParseMap::iterator loc =
+        node_map_.find(name, ElementNameHash(), ElementNameEqual());
+    if (loc == node_map_.end()) {
         node_parse_errors_[msg_type]++;
         return;
     }
 
-    // Locate the decode function using id_name
-    NodeParseMap::const_iterator loc = node_map_.find(name);
-    if (loc == node_map_.end()) {
+    NodeParseEntry &entry = loc->second;
+    if (entry.table == NULL) {
+        entry.table = IFMapTable::FindTable(db_, name);
+    }
+    IFMapTable *table = entry.table;
+    if(!table) {
         node_parse_errors_[msg_type]++;
         return;
     }
@@ -52,7 +70,7 @@ void IFMapAgentParser::NodeParse(xml_node &node, DBRequest::DBOperation oper, ui
     // Invoke the decode routine
     req_key->id_type = name;
     req_key->id_seq_num = seq;
-    obj = loc->second(node, db_, &req_key->id_name);
+    obj = entry.parser(node, db_, &req_key->id_name);
     if (!obj) {
         node_parse_errors_[msg_type]++;
         delete req_key;
@@ -105,14 +123,14 @@ void IFMapAgentParser::LinkParse(xml_node &link, DBRequest::DBOperation oper, ui
     }
 
     name1 = first_node.attribute("type").value();
-    table = IFMapTable::FindTable(db_, name1);
+    table = TableLookup(name1);
     if(!table) {
         link_parse_errors_[msg_type]++;
         return;
     }
 
     name2 = second_node.attribute("type").value();
-    table = IFMapTable::FindTable(db_, name2);
+    table = TableLookup(name2);
     if(!table) {
         link_parse_errors_[msg_type]++;
         return;
@@ -6,8 +6,9 @@
 #define __DB_IFMAP_AGENT_PARSER_H__
 
 #include <list>
-#include <map>
+#include <cstring>
 #include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
 #include "db/db.h"
 #include "ifmap/ifmap_object.h"
 #include "ifmap/ifmap_table.h"
@@ -30,7 +31,41 @@ public:
 
     typedef boost::function< IFMapObject *(const pugi::xml_node, DB *,
                                                std::string *id_name) > NodeParseFn;
-    typedef std::map<std::string, NodeParseFn> NodeParseMap;
+
+    // Dispatch entry for an element type. The table is resolved on first use
+    // and cached, since IFMapTable::FindTable() builds the table name string
+    // on every call.
+    struct NodeParseEntry {
+        explicit NodeParseEntry(NodeParseFn fn) : parser(fn), table(NULL) { }
+        NodeParseFn parser;
+        IFMapTable *table;
+    };
+
+    // Hash and equality over element names that accept the const char *
+    // returned by pugi, so that dispatch does not construct a std::string
+    // per element.
+    struct ElementNameHash {
+        size_t operator()(const char *name) const {
+            size_t hash = 2166136261u;
+            for (; *name; ++name) {
+                hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+            }
+            return hash;
+        }
+        size_t operator()(const std::string &name) const {
+            return (*this)(name.c_str());
+        }
+    };
+    struct ElementNameEqual {
+        bool operator()(const char *lhs, const std::string &rhs) const {
+            return strcmp(lhs, rhs.c_str()) == 0;
+        }
+        bool operator()(const std::string &lhs, const std::string &rhs) const {
+            return lhs == rhs;
+        }
+    };
+    typedef boost::unordered_map<std::string, NodeParseEntry,
+                                 ElementNameHash, ElementNameEqual> NodeParseMap;
     void NodeRegister(const std::string &node, NodeParseFn parser);
     void NodeClear();
     void ConfigParse(const pugi::xml_node config, uint64_t seq);
@@ -59,6 +94,7 @@ private:
     uint64_t links_processed_[MAX];
     uint64_t node_parse_errors_[MAX];
     uint64_t link_parse_errors_[MAX];
+    IFMapTable *TableLookup(const char *name);
     void NodeParse(pugi::xml_node &node, DBRequest::DBOperation oper, uint64_t seq);
     void LinkParse(pugi::xml_node &node, DBRequest::DBOperation oper, uint64_t seq);
 };
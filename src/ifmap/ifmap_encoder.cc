@@ -12,90 +12,143 @@
 using namespace pugi;
 using namespace std;
 
-IFMapMessage::IFMapMessage() : op_type_(NONE), node_count_(0),
-    objects_per_message_(kObjectsPerMessage) {
-    // init empty document
-    Open();
+static const char *kMessageHead =
+    "<?xml version=\"1.0\"?>\n"
+    "<iq type=\"set\" from=\"network-control@contrailsystems.com\" to=\"";
+static const char *kConfigOpen = "\"><config>";
+static const char *kConfigClose = "</config></iq>\n";
+
+static const char *OpOpenTag(bool is_update) {
+    return is_update ? "<update>" : "<delete>";
+}
+
+static const char *OpCloseTag(bool is_update) {
+    return is_update ? "</update>" : "</delete>";
+}
+
+// Escape the characters that are not allowed as is in an attribute value.
+static void AppendEscapedAttribute(string *dest, const string &value) {
+    for (string::const_iterator it = value.begin(); it != value.end(); ++it) {
+        switch (*it) {
+        case '&':
+            *dest += "&amp;";
+            break;
+        case '<':
+            *dest += "&lt;";
+            break;
+        case '>':
+            *dest += "&gt;";
+            break;
+        case '"':
+            *dest += "&quot;";
+            break;
+        default:
+            *dest += *it;
+            break;
+        }
+    }
 }
 
-void IFMapMessage::Open() {
-    xml_node iq = doc_.append_child("iq");
-    // set iq (type, from, to) attributes
-    iq.append_attribute("type") = "set";
-    iq.append_attribute("from") = "network-control@contrailsystems.com";
-    iq.append_attribute("to") = "";
-    config_ = iq.append_child("config");
+IFMapMessage::IFMapMessage() : op_type_(NONE), node_count_(0),
+    objects_per_message_(kObjectsPerMessage), encode_cache_hits_(0),
+    encode_cache_misses_(0), messages_sent_(0) {
 }
 
+//
+// Build the complete message for the current receiver by wrapping the body
+// in the per-client envelope.
+//
 void IFMapMessage::Close() {
-    ostringstream oss;
-    doc_.save(oss);
-    str_ = oss.str();
+    str_.clear();
+    str_.reserve(receiver_.size() + body_.size() + 160);
+    str_ += kMessageHead;
+    str_ += receiver_;
+    str_ += kConfigOpen;
+    str_ += body_;
+    if (op_type_ != NONE)
+        str_ += OpCloseTag(op_type_ == UPDATE);
+    str_ += kConfigClose;
+    messages_sent_++;
 }
 
 void IFMapMessage::SetReceiverInMsg(const std::string &cli_identifier) {
-    xml_node iq = doc_.child("iq");
-    assert(iq);
-    xml_attribute iqattr = iq.attribute("to");
-    assert(iqattr);
-    std::string str(cli_identifier);
-    str += "/config";
-    iqattr.set_value(str.c_str());
+    receiver_.clear();
+    AppendEscapedAttribute(&receiver_, cli_identifier);
+    receiver_ += "/config";
 }
 
 void IFMapMessage::SetObjectsPerMessage(int num) {
     objects_per_message_ = num;
 }
 
-void IFMapMessage::EncodeUpdate(const IFMapUpdate *update) {
+void IFMapMessage::EncodeUpdate(IFMapUpdate *update) {
     // update is either of type UPDATE OR DELETE
-    if (update->IsUpdate()) {
-        if (op_type_ != UPDATE) {
-            op_node_ = config_.append_child("update");
-            op_type_ = UPDATE;
-        }
-        if (update->data().type == IFMapObjectPtr::NODE) {
-            EncodeNode(update);
-        } else if (update->data().type == IFMapObjectPtr::LINK) {
-            EncodeLink(update);
-        } else {
-            assert(0);
-        }
+    Op op = update->IsUpdate() ? UPDATE : DEL;
+    if (op_type_ != op) {
+        if (op_type_ != NONE)
+            body_ += OpCloseTag(op_type_ == UPDATE);
+        body_ += OpOpenTag(op == UPDATE);
+        op_type_ = op;
+    }
+
+    // Encode the update only if it has not been encoded before.
+    if (update->encoded()) {
+        encode_cache_hits_++;
     } else {
-        if (op_type_ != DEL) {
-            op_node_ = config_.append_child("delete");
-            op_type_ = DEL;
-        }
-        if (update->data().type == IFMapObjectPtr::NODE) {
-            EncodeNode(update);
-        } else if (update->data().type == IFMapObjectPtr::LINK) {
-            EncodeLink(update);
-        } else {
-            assert(0);
-        }
+        update->set_encoded(EncodeFragment(update));
+        encode_cache_misses_++;
     }
+    body_ += *update->encoded();
+
+    // Links are accounted twice towards objects_per_message_.
+    if (update->data().type == IFMapObjectPtr::LINK)
+        node_count_++;
     node_count_++;
 }
 
-void IFMapMessage::EncodeNode(const IFMapUpdate *update) {
+//
+// Encode the object in the update as a standalone xml fragment.
+//
+// The scratch document is cleared by removing its only child, so that the
+// memory pages allocated by pugixml get reused for the next fragment.
+//
+IFMapUpdate::EncodedPtr IFMapMessage::EncodeFragment(
+        const IFMapUpdate *update) {
+    xml_node parent = doc_.append_child("fragment");
+    if (update->data().type == IFMapObjectPtr::NODE) {
+        EncodeNode(update, &parent);
+    } else if (update->data().type == IFMapObjectPtr::LINK) {
+        EncodeLink(update, &parent);
+    } else {
+        assert(0);
+    }
+
+    ostringstream oss;
+    for (xml_node child = parent.first_child(); child;
+         child = child.next_sibling()) {
+        child.print(oss, "", format_raw);
+    }
+    doc_.remove_child(parent);
+    return IFMapUpdate::EncodedPtr(new string(oss.str()));
+}
+
+void IFMapMessage::EncodeNode(const IFMapUpdate *update, xml_node *parent) {
     IFMapNode *node = update->data().u.node;
     if (update->IsUpdate()) {
-        node->EncodeNodeDetail(&op_node_);
+        node->EncodeNodeDetail(parent);
     } else {
-        node->EncodeNode(&op_node_);
+        node->EncodeNode(parent);
     }
 }
 
-void IFMapMessage::EncodeLink(const IFMapUpdate *update) {
-    xml_node link_node = op_node_.append_child("link");
+void IFMapMessage::EncodeLink(const IFMapUpdate *update, xml_node *parent) {
+    xml_node link_node = parent->append_child("link");
 
     const IFMapLink *link = update->data().u.link;
 
     IFMapNode::EncodeNode(link->left_id(), &link_node);
     IFMapNode::EncodeNode(link->right_id(), &link_node);
     link->EncodeLinkInfo(&link_node);
-
-    node_count_++;
 }
 
 bool IFMapMessage::IsFull() {
@@ -108,20 +161,12 @@ bool IFMapMessage::IsEmpty() {
 
 //
 // Reset the IFMapMessage to initial state so that it can be used to build
-// the next config message.
-//
-// Using remove_child to remove the only child of the document is a better
-// way to clear the document than using reset. The pugixml library allocates
-// memory for a document in increments of 32KB pages and then manages smaller
-// allocations (nodes or attributes) using these pages. Calling reset method
-// on a document frees all the pages. In contrast, removing the only child
-// node of the document returns the smaller allocations to the free pool of
-// memory for the document, but doesn't free the pages themselves. This lets
-// the library reuse the same memory when building the tree for each message.
+// the next config message. The capacity of body_ is retained so that the
+// memory gets reused when building the next message.
 //
 void IFMapMessage::Reset() {
-    doc_.remove_child("iq");
+    body_.clear();
+    receiver_.clear();
     node_count_ = 0;
     op_type_ = NONE;
-    Open();
 }
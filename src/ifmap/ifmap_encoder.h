@@ -5,12 +5,25 @@
 #ifndef __ctrlplane__ifmap_encoder__
 #define __ctrlplane__ifmap_encoder__
 
+#include <stdint.h>
+#include <string>
 #include <pugixml/pugixml.hpp>
 
+#include "ifmap/ifmap_update.h"
+
 class IFMapNode;
 class IFMapLink;
-class IFMapUpdate;
 
+//
+// Builds config messages sent to ifmap clients.
+//
+// The xml for each update is encoded only once and cached in the IFMapUpdate
+// itself, so that it gets reused for all clients in the advertise set of the
+// update, even if the update gets sent to these clients as part of different
+// messages. The body of the message is built by concatenating the encoded
+// fragments and the per-client envelope is prepended to the body when the
+// message is closed for a given receiver.
+//
 class IFMapMessage {
 public:
     static const int kObjectsPerMessage = 16;
@@ -20,30 +33,37 @@ public:
     // set the 'to' field in the message
     void SetReceiverInMsg(const std::string &cli_identifier);
     void SetObjectsPerMessage(int num);
-    void EncodeUpdate(const IFMapUpdate *update);
+    void EncodeUpdate(IFMapUpdate *update);
     bool IsFull();
     bool IsEmpty();
     void Reset();
 
     const std::string &get_string() const { return str_; }
 
+    uint64_t encode_cache_hits() const { return encode_cache_hits_; }
+    uint64_t encode_cache_misses() const { return encode_cache_misses_; }
+    uint64_t messages_sent() const { return messages_sent_; }
+
 private:
     enum Op {
         NONE,
         UPDATE,
         DEL
     };
-    void Open();
-    void EncodeNode(const IFMapUpdate *update);
-    void EncodeLink(const IFMapUpdate *update);
-
-    pugi::xml_document doc_;
-    pugi::xml_node config_;
-    Op op_type_;             // the current  type of op_node_
-    pugi::xml_node op_node_;
+    IFMapUpdate::EncodedPtr EncodeFragment(const IFMapUpdate *update);
+    void EncodeNode(const IFMapUpdate *update, pugi::xml_node *parent);
+    void EncodeLink(const IFMapUpdate *update, pugi::xml_node *parent);
+
+    pugi::xml_document doc_; // scratch document used to encode fragments
+    Op op_type_;             // the current type of op element in body_
+    std::string body_;
+    std::string receiver_;
     std::string str_;
     int node_count_;
     int objects_per_message_;
+    uint64_t encode_cache_hits_;
+    uint64_t encode_cache_misses_;
+    uint64_t messages_sent_;
 };
 
 #endif /* defined(__ctrlplane__ifmap_encoder__) */
@@ -36,7 +36,8 @@ private:
 };
 
 IFMapExporter::IFMapExporter(IFMapServer *server)
-        : server_(server), link_table_(NULL) {
+        : server_(server), link_table_(NULL), config_revision_checks_(0),
+          config_crc_checks_(0) {
 }
 
 IFMapExporter::~IFMapExporter() {
@@ -171,6 +172,10 @@ bool IFMapExporter::UpdateAddChange(ObjectType *obj, IFMapState *state,
     IFMapUpdate *update = state->GetUpdate(IFMapListEntry::UPDATE);
     if (update != NULL) {
         update->AdvertiseReset(rm_set);
+        // Contents of the object changed, the cached encoding is stale.
+        if (change) {
+            update->ClearEncoded();
+        }
     }
 
     if (state->interest().empty()) {
@@ -660,16 +665,36 @@ bool IFMapExporter::FilterNeighbor(IFMapNode *lnode, IFMapLink *link) {
     return walker_->FilterNeighbor(lnode, link);
 }
 
+// Decide whether the config object of the node changed since it was last
+// exported. The config parser stamps a new revision on the object only when a
+// write changes its contents, so in steady state this is an integer
+// comparison. The CRC is only computed for objects without a revision and on
+// the first export of the node.
 bool IFMapExporter::ConfigChanged(IFMapNode *node) {
     IFMapNodeState *state = NodeStateLookup(node);
     bool changed = false;
     assert(state);
 
+    IFMapObject *object = node->Find(IFMapOrigin(IFMapOrigin::CASSANDRA));
+    uint64_t revision = object ? object->revision() : 0;
+    if (revision != 0) {
+        config_revision_checks_++;
+        if (state->revision() == revision) {
+            return false;
+        }
+        if (state->revision() != 0) {
+            state->SetRevision(revision);
+            return true;
+        }
+    }
+
+    config_crc_checks_++;
     IFMapExporter::crc32type node_crc = node->GetConfigCrc();
     if (state->crc() != node_crc) {
         changed = true;
         state->SetCrc(node_crc);
     }
+    state->SetRevision(revision);
 
     return changed;
 }
@@ -834,5 +859,6 @@ const IFMapTypenameWhiteList &IFMapExporter::get_traversal_white_list() const {
 
 void IFMapExporter::ResetLinkDeleteClients(const BitSet &bset) {
     walker_->ResetLinkDeleteClients(bset);
+    walker_->ResetPendingLinkAddClients(bset);
 }
 
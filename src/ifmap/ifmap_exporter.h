@@ -93,6 +93,9 @@ public:
     const IFMapTypenameWhiteList &get_traversal_white_list() const;
     void ResetLinkDeleteClients(const BitSet &bset);
 
+    uint64_t config_revision_checks() const { return config_revision_checks_; }
+    uint64_t config_crc_checks() const { return config_crc_checks_; }
+
 private:
     friend class XmppIfmapTest;
     class TableInfo;
@@ -140,6 +143,8 @@ private:
 
     DBTable *link_table_;
     ClientConfigTracker client_config_tracker_[TT_END];
+    uint64_t config_revision_checks_;
+    uint64_t config_crc_checks_;
 };
 
 #endif
@@ -69,13 +69,26 @@ private:
     const BitSet &bset_;
 };
 
+// Bulk mode can be turned off by setting IFMAP_GRAPH_WALKER_BULK_MODE to 0.
+static bool GetBulkMode() {
+    char *str = getenv("IFMAP_GRAPH_WALKER_BULK_MODE");
+    if (str) {
+        return (strtoul(str, NULL, 0) != 0);
+    }
+    return true;
+}
+
 IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
     : graph_(graph),
       exporter_(exporter),
       link_delete_walk_trigger_(new TaskTrigger(
           boost::bind(&IFMapGraphWalker::LinkDeleteWalk, this),
           TaskScheduler::GetInstance()->GetTaskId("db::IFMapTable"), 0)),
-      walk_client_index_(BitSet::npos) {
+      walk_client_index_(BitSet::npos),
+      bulk_mode_(GetBulkMode()),
+      link_add_walk_trigger_(new TaskTrigger(
+          boost::bind(&IFMapGraphWalker::LinkAddWalk, this),
+          TaskScheduler::GetInstance()->GetTaskId("db::IFMapTable"), 0)) {
     traversal_white_list_.reset(new IFMapTypenameWhiteList());
     AddNodesToWhitelist();
 }
@@ -106,6 +119,50 @@ void IFMapGraphWalker::ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode,
                   filter);
 }
 
+// Give the interest bits to rnode right away so that the interest of the link
+// being added can be computed by the caller, and defer the walk beyond rnode.
+// Bits of all the link adds reaching rnode are merged into a single walk.
+void IFMapGraphWalker::EnqueueLinkAdd(IFMapNode *rnode, const BitSet &bset) {
+    JoinVertex(rnode, bset);
+    NodeKey key(rnode->table(), rnode->name());
+    pending_link_adds_[key] |= bset;
+    link_add_walk_trigger_->Set();
+}
+
+bool IFMapGraphWalker::LinkAddWalk() {
+    ProcessPendingLinkAdds();
+    return true;
+}
+
+// Walk the graph from each node in the pending list with the union of the
+// interest bits of all the clients that reached it. The start node is looked
+// up by name since it may have gone away after the link add was deferred.
+void IFMapGraphWalker::ProcessPendingLinkAdds() {
+    PendingLinkAddMap pending;
+    pending.swap(pending_link_adds_);
+    for (PendingLinkAddMap::const_iterator iter = pending.begin();
+         iter != pending.end(); ++iter) {
+        IFMapNode *node = iter->first.first->FindNode(iter->first.second);
+        if ((node == NULL) || !node->IsVertexValid()) {
+            continue;
+        }
+        ProcessLinkAdd(NULL, node, iter->second);
+    }
+}
+
+// Forget the pending walks for clients that are going away.
+void IFMapGraphWalker::ResetPendingLinkAddClients(const BitSet &bset) {
+    for (PendingLinkAddMap::iterator iter = pending_link_adds_.begin(), next;
+         iter != pending_link_adds_.end(); iter = next) {
+        next = iter;
+        ++next;
+        iter->second.Reset(bset);
+        if (iter->second.empty()) {
+            pending_link_adds_.erase(iter);
+        }
+    }
+}
+
 void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &lhs,
                                IFMapNode *rnode, const BitSet &rhs) {
     IFMAP_DEBUG(LinkOper, "LinkAdd", lnode->ToString(), rnode->ToString(),
@@ -121,16 +178,27 @@ void IFMapGraphWalker::LinkAdd(IFMapLink *link, IFMapNode *lnode, const BitSet &
     if (!lhs.empty() && !rhs.Contains(lhs) &&
         traversal_white_list_->VertexFilter(rnode) &&
         traversal_white_list_->EdgeFilter(lnode, rnode, link))  {
-        ProcessLinkAdd(lnode, rnode, lhs);
+        if (bulk_mode_) {
+            EnqueueLinkAdd(rnode, lhs);
+        } else {
+            ProcessLinkAdd(lnode, rnode, lhs);
+        }
     }
     if (!rhs.empty() && !lhs.Contains(rhs) &&
         traversal_white_list_->VertexFilter(lnode) &&
         traversal_white_list_->EdgeFilter(rnode, lnode, link)) {
-        ProcessLinkAdd(rnode, lnode, rhs);
+        if (bulk_mode_) {
+            EnqueueLinkAdd(lnode, rhs);
+        } else {
+            ProcessLinkAdd(rnode, lnode, rhs);
+        }
     }
 }
 
 void IFMapGraphWalker::LinkRemove(const BitSet &bset) {
+    // Pending walks must be done before the interest gets recomputed, else
+    // they could add interest for nodes that are not reachable anymore.
+    ProcessPendingLinkAdds();
     OrLinkDeleteClients(bset);          // link_delete_clients_ | bset
     link_delete_walk_trigger_->Set();
 }
@@ -156,6 +224,7 @@ void IFMapGraphWalker::RecomputeInterest(DBGraphVertex *vertex, int bit) {
 }
 
 bool IFMapGraphWalker::LinkDeleteWalk() {
+    ProcessPendingLinkAdds();
     if (link_delete_clients_.empty()) {
         walk_client_index_ = BitSet::npos;
         return true;
@@ -5,6 +5,9 @@
 #ifndef __ctrlplane__ifmap_graph_walker__
 #define __ctrlplane__ifmap_graph_walker__
 
+#include <map>
+#include <string>
+
 #include "base/bitset.h"
 #include "base/queue_task.h"
 
@@ -16,15 +19,27 @@ class IFMapNode;
 class IFMapLink;
 class IFMapNodeState;
 class IFMapState;
+class IFMapTable;
 class TaskTrigger;
 struct IFMapTypenameWhiteList;
 
 // Computes the interest graph for the ifmap clients (i.e. vnc agent).
+//
+// In bulk mode (default), the propagation of interest triggered by link adds
+// is not done right away. The far end node of the link gets the interest bits
+// synchronously, but the walk beyond it is deferred and the bits are merged
+// with those of all other link adds that reach the same node. The deferred
+// walks are then done in one go, each one carrying the interest bits of all
+// the clients that reached the start node. When many clients subscribe at
+// once (e.g. control-node restart), shared parts of the graph are walked once
+// for all the clients instead of once per client.
 class IFMapGraphWalker {
 public:
     typedef std::set<IFMapState *> ReachableNodesSet;
     typedef ReachableNodesSet::const_iterator Rns_citer;
     typedef std::vector<ReachableNodesSet *> ReachableNodesTracker;
+    typedef std::pair<IFMapTable *, std::string> NodeKey;
+    typedef std::map<NodeKey, BitSet> PendingLinkAddMap;
 
     IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter);
     ~IFMapGraphWalker();
@@ -39,11 +54,17 @@ public:
     bool FilterNeighbor(IFMapNode *lnode, IFMapLink *link);
     const IFMapTypenameWhiteList &get_traversal_white_list() const;
     void ResetLinkDeleteClients(const BitSet &bset);
+    void ResetPendingLinkAddClients(const BitSet &bset);
+    bool bulk_mode() const { return bulk_mode_; }
+    size_t pending_link_adds() const { return pending_link_adds_.size(); }
 
 private:
     static const int kMaxLinkDeleteWalks = 1;
 
     void ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode, const BitSet &bset);
+    void EnqueueLinkAdd(IFMapNode *rnode, const BitSet &bset);
+    bool LinkAddWalk();
+    void ProcessPendingLinkAdds();
     void JoinVertex(DBGraphVertex *vertex, const BitSet &bset);
     void NotifyEdge(DBGraphEdge *edge, const BitSet &bset);
     void RecomputeInterest(DBGraphVertex *vertex, int bit);
@@ -67,6 +88,9 @@ private:
     BitSet link_delete_clients_;
     size_t walk_client_index_;
     ReachableNodesTracker new_reachable_nodes_tracker_;
+    bool bulk_mode_;
+    boost::scoped_ptr<TaskTrigger> link_add_walk_trigger_;
+    PendingLinkAddMap pending_link_adds_;
 };
 
 #endif /* defined(__ctrlplane__ifmap_graph_walker__) */
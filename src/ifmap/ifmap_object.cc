@@ -4,13 +4,25 @@
 
 #include "ifmap/ifmap_object.h"
 
+#include <tbb/atomic.h>
+
+// Revisions are drawn from a single counter so that a re-created object can
+// never reuse a revision seen on its predecessor.
+static tbb::atomic<uint64_t> revision_generator;
+
 IFMapObject::IFMapObject()
-    : refcount_(0), sequence_number_(0) {
+    : refcount_(0), sequence_number_(0), revision_(0) {
 }
 
 IFMapObject::~IFMapObject() {
 }
 
+// Called by the config parser after a write changed a property or the link
+// attribute data, see IFMapServerTable::Input().
+void IFMapObject::UpdateRevision() {
+    revision_ = ++revision_generator;
+}
+
 void IFMapObject::Release(IFMapObject *object) {
     if (!object->node_.is_linked()) {
         delete object;
@@ -36,6 +36,15 @@ public:
         sequence_number_ = sequence_number;
     }
     IFMapOrigin origin() const { return origin_; }
+
+    // Revision of the object contents. Bumped from a process wide monotonic
+    // counter when a write by the config parser actually changed a property
+    // or attribute, so that consumers can detect changes by comparing
+    // integers. A revision of 0 means the object was never stamped and
+    // consumers should fall back to CalculateCrc().
+    uint64_t revision() const { return revision_; }
+    void UpdateRevision();
+
     virtual bool ResolveStaleness() = 0; // return true if something was stale
     virtual boost::crc_32_type::value_type CalculateCrc() const = 0;
 
@@ -51,6 +60,7 @@ private:
     boost::intrusive::list_member_hook<> node_;
     mutable int refcount_;
     uint64_t sequence_number_;
+    uint64_t revision_;
     IFMapOrigin origin_;
     DISALLOW_COPY_AND_ASSIGN(IFMapObject);
 };
@@ -85,6 +95,7 @@ public:
     IFMapIdentifier();
     explicit IFMapIdentifier(int property_count);
 
+    // Return true if the stored value of the property changed.
     virtual bool SetProperty(const std::string &attr_key,
                              AutogenProperty *data) = 0;
     virtual void ClearProperty(const std::string &attr_key) = 0;
@@ -97,6 +108,7 @@ public:
     void TransferPropertyToOldProperty();
     bool ResolveStalePropertiesAndResetOld();
     bool IsPropertySet(int id) const {return property_set_.test(id);};
+    size_t PropertySetCount() const { return property_set_.count(); }
     virtual bool ResolveStaleness();
 
 protected:
@@ -111,6 +123,7 @@ private:
 class IFMapLinkAttr : public IFMapObject {
 public:
     IFMapLinkAttr();
+    // Return true if the stored data changed.
     virtual bool SetData(const AutogenProperty *data) = 0;
     virtual bool ResolveStaleness();
 
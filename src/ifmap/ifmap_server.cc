@@ -104,6 +104,7 @@ public:
                     // There could be stale properties
                     bool changed = object->ResolveStaleness();
                     if (changed) {
+                        object->UpdateRevision();
                         nodes_changed++;
                         ntable->Notify(node);
                     }
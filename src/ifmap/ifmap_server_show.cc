@@ -33,6 +33,7 @@
 #include "ifmap/ifmap_log_types.h"
 #include "ifmap/ifmap_table.h"
 #include "ifmap/ifmap_update.h"
+#include "ifmap/ifmap_update_sender.h"
 #include "ifmap/ifmap_uuid_mapper.h"
 
 #include <pugixml/pugixml.hpp>
@@ -1987,6 +1988,45 @@ void IFMapNodeTableListShowReq::HandleRequest() const {
     RequestPipeline rp(ps);
 }
 
+static bool IFMapUpdateSenderShowReqHandleRequest(
+    const Sandesh *sr, const RequestPipeline::PipeSpec ps, int stage,
+    int instNum, RequestPipeline::InstData *data) {
+    const IFMapUpdateSenderShowReq *request =
+        static_cast<const IFMapUpdateSenderShowReq *>(ps.snhRequest_.get());
+    IFMapSandeshContext *sctx =
+        static_cast<IFMapSandeshContext *>(request->module_context("IFMap"));
+
+    IFMapUpdateSender *sender = sctx->ifmap_server()->sender();
+    IFMapUpdateSenderStats stats;
+    stats.set_messages_sent(sender->messages_sent());
+    stats.set_encode_cache_hits(sender->encode_cache_hits());
+    stats.set_encode_cache_misses(sender->encode_cache_misses());
+
+    IFMapUpdateSenderShowResp *response = new IFMapUpdateSenderShowResp();
+    response->set_stats(stats);
+    response->set_context(request->context());
+    response->set_more(false);
+    response->Response();
+
+    // Return 'true' so that we are not called again
+    return true;
+}
+
+void IFMapUpdateSenderShowReq::HandleRequest() const {
+
+    RequestPipeline::StageSpec s0;
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+
+    s0.taskId_ = scheduler->GetTaskId("db::IFMapTable");
+    s0.cbFn_ = IFMapUpdateSenderShowReqHandleRequest;
+    s0.instances_.push_back(0);
+
+    RequestPipeline::PipeSpec ps(this);
+    ps.stages_ = boost::assign::list_of(s0)
+        .convert_to_container<vector<RequestPipeline::StageSpec> >();
+    RequestPipeline rp(ps);
+}
+
 class ShowConfigDBUUIDCache {
 public:
     static const uint32_t kMaxElementsPerRound = 50;
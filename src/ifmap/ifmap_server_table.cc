@@ -267,7 +267,9 @@ void IFMapServerTable::Input(DBTablePartition *partition, DBClient *client,
         if (request->oper == DBRequest::DB_ENTRY_ADD_CHANGE) {
             IFMapIdentifier *identifier = LocateIdentifier(first, data->origin,
                                                            key->id_seq_num);
-            identifier->SetProperty(data->metadata, data->content.get());
+            if (identifier->SetProperty(data->metadata, data->content.get())) {
+                identifier->UpdateRevision();
+            }
             partition->Change(first);
         } else {
             IFMapIdentifier *identifier = static_cast<IFMapIdentifier *>(
@@ -275,7 +277,11 @@ void IFMapServerTable::Input(DBTablePartition *partition, DBClient *client,
             if (identifier == NULL) {
                 return;
             }
+            size_t property_count = identifier->PropertySetCount();
             identifier->ClearProperty(data->metadata);
+            if (identifier->PropertySetCount() != property_count) {
+                identifier->UpdateRevision();
+            }
             // Figure out whether to delete the identifier.
             if (identifier->empty()) {
                 first->Remove(identifier);
@@ -340,7 +346,10 @@ void IFMapServerTable::Input(DBTablePartition *partition, DBClient *client,
             IFMapLinkAttr *link_attr = mtable->LocateLinkAttr(midnode,
                                                               data->origin,
                                                               key->id_seq_num);
-            mchanged |= link_attr->SetData(data->content.get());
+            if (link_attr->SetData(data->content.get())) {
+                link_attr->UpdateRevision();
+                mchanged = true;
+            }
         } else {
             IFMapObject *object = midnode->Find(data->origin);
             if (object == NULL) {
@@ -77,11 +77,11 @@ std::string IFMapMarker::ToString() {
 }
 
 IFMapState::IFMapState(IFMapNode *node)
-    : sig_(kInvalidSig), data_(node), crc_(0) {
+    : sig_(kInvalidSig), data_(node), crc_(0), revision_(0) {
 }
 
 IFMapState::IFMapState(IFMapLink *link)
-    : sig_(kInvalidSig), data_(link), crc_(0) {
+    : sig_(kInvalidSig), data_(link), crc_(0), revision_(0) {
 }
 
 IFMapState::~IFMapState() {
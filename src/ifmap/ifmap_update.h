@@ -8,6 +8,7 @@
 #include <boost/crc.hpp>      // for boost::crc_32_type
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/slist.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "base/bitset.h"
 #include "base/dependency.h"
@@ -84,6 +85,8 @@ struct IFMapListEntry {
 
 class IFMapUpdate : public IFMapListEntry {
 public:
+    typedef boost::shared_ptr<const std::string> EncodedPtr;
+
     IFMapUpdate(IFMapNode *node, bool positive);
     IFMapUpdate(IFMapLink *link, bool positive);
     virtual ~IFMapUpdate() { }
@@ -99,11 +102,18 @@ public:
     bool IsNode() const { return data_.IsNode(); }
     bool IsLink() const { return data_.IsLink(); }
 
+    // Encoded xml fragment for the object, shared by all messages that carry
+    // this update. Must be cleared whenever the contents of the object change.
+    const EncodedPtr &encoded() const { return encoded_; }
+    void set_encoded(EncodedPtr encoded) { encoded_ = encoded; }
+    void ClearEncoded() { encoded_.reset(); }
+
 private:
     friend class IFMapState;
     boost::intrusive::slist_member_hook<> node_;
     IFMapObjectPtr data_;
     BitSet advertise_;
+    EncodedPtr encoded_;
 };
 
 struct IFMapMarker : public IFMapListEntry {
@@ -152,6 +162,8 @@ public:
     virtual bool IsInvalid() const { return sig_ == kInvalidSig; }
     const crc32type &crc() const { return crc_; }
     void SetCrc(crc32type &crc) { crc_ = crc; }
+    uint64_t revision() const { return revision_; }
+    void SetRevision(uint64_t revision) { revision_ = revision; }
     virtual bool CanDelete() = 0;
     const IFMapObjectPtr &data() const { return data_; }
     IFMapNode *GetIFMapNode() const;
@@ -171,6 +183,8 @@ private:
     BitSet advertised_;
     UpdateList update_list_;
     crc32type crc_;
+    // Revision of the config object when it was last exported.
+    uint64_t revision_;
 };
 
 class IFMapNodeState : public IFMapState {
@@ -42,6 +42,14 @@ public:
         return send_blocked_.test(client_index);
     }
 
+    uint64_t encode_cache_hits() const {
+        return message_->encode_cache_hits();
+    }
+    uint64_t encode_cache_misses() const {
+        return message_->encode_cache_misses();
+    }
+    uint64_t messages_sent() const { return message_->messages_sent(); }
+
 private:
     class SendTask;
     friend class IFMapUpdateSenderTest;
@@ -5,6 +5,8 @@
 #include "ifmap/ifmap_exporter.h"
 
 #include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
 #include "base/test/task_test_util.h"
 #include "control-node/control_node.h"
 #include "db/db.h"
@@ -140,6 +142,22 @@ protected:
                                          metadata, content);
     }
 
+    // Add a node property with the origin of config read from the database,
+    // which is the config object the exporter checks for changes.
+    void IFMapMsgConfigNodeAdd(const string &type, const string &id,
+                               uint64_t sequence_number, const string &metadata,
+                               AutogenProperty *content) {
+        IFMapTable *table = IFMapTable::FindTable(&db_, type);
+        DBRequest request;
+        request.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        ifmap_test_util::IFMapNodeCommon(table, &request, type, id,
+                                         sequence_number, metadata, content);
+        IFMapServerTable::RequestData *data =
+            static_cast<IFMapServerTable::RequestData *>(request.data.get());
+        data->origin.set_origin(IFMapOrigin::CASSANDRA);
+        table->Enqueue(&request);
+    }
+
     void IFMapMsgNodeDelete(const string &type, const string &id,
                          uint64_t sequence_number, const string &metadata,
                          AutogenProperty *content) {
@@ -1282,6 +1300,120 @@ TEST_F(IFMapExporterTest, ConfigTracker) {
     TASK_UTIL_EXPECT_EQ(LinkTableSize(), 10);
 }
 
+static int GetChurnNodeCount() {
+    char *str = getenv("IFMAP_EXPORTER_TEST_CHURN_NODE_COUNT");
+    return str ? strtoul(str, NULL, 0) : 1000;
+}
+
+// Config churn must be detected by comparing revisions alone. Re-reading the
+// same config with a new sequence number must not move the revisions.
+TEST_F(IFMapExporterTest, ConfigChurnRevision) {
+    const int kNodeCount = GetChurnNodeCount();
+    const int kRounds = 10;
+
+    for (int idx = 0; idx < kNodeCount; ++idx) {
+        autogen::IdPermsType *prop = new autogen::IdPermsType();
+        prop->description = "round-0";
+        IFMapMsgConfigNodeAdd("virtual-router", "vr" + integerToString(idx),
+                              1, "id-perms", prop);
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_TRUE(TableLookup("virtual-router",
+        "vr" + integerToString(kNodeCount - 1)) != NULL);
+    uint64_t crc_checks = exporter_->config_crc_checks();
+
+    uint64_t start = UTCTimestampUsec();
+    for (int round = 1; round <= kRounds; ++round) {
+        for (int idx = 0; idx < kNodeCount; ++idx) {
+            autogen::IdPermsType *prop = new autogen::IdPermsType();
+            prop->description = "round-" + integerToString(round);
+            IFMapMsgConfigNodeAdd("virtual-router",
+                                  "vr" + integerToString(idx), 1, "id-perms",
+                                  prop);
+        }
+        task_util::WaitForIdle();
+    }
+    uint64_t elapsed = UTCTimestampUsec() - start;
+    cout << "Config churn: " << kRounds << " rounds of " << kNodeCount
+         << " nodes took " << elapsed / 1000 << " msec" << endl;
+    EXPECT_EQ(crc_checks, exporter_->config_crc_checks());
+
+    for (int idx = 0; idx < kNodeCount; ++idx) {
+        IFMapNode *node =
+            TableLookup("virtual-router", "vr" + integerToString(idx));
+        ASSERT_TRUE(node != NULL);
+        IFMapNodeState *state = exporter_->NodeStateLookup(node);
+        ASSERT_TRUE(state != NULL);
+        IFMapObject *object =
+            node->Find(IFMapOrigin(IFMapOrigin::CASSANDRA));
+        ASSERT_TRUE(object != NULL);
+        EXPECT_EQ(object->revision(), state->revision());
+    }
+
+    // Re-read the same config with a new sequence number.
+    IFMapNode *node = TableLookup("virtual-router", "vr0");
+    IFMapNodeState *state = exporter_->NodeStateLookup(node);
+    uint64_t revision = state->revision();
+    for (int idx = 0; idx < kNodeCount; ++idx) {
+        autogen::IdPermsType *prop = new autogen::IdPermsType();
+        prop->description = "round-" + integerToString(kRounds);
+        IFMapMsgConfigNodeAdd("virtual-router", "vr" + integerToString(idx),
+                              2, "id-perms", prop);
+    }
+    task_util::WaitForIdle();
+    EXPECT_EQ(crc_checks, exporter_->config_crc_checks());
+    EXPECT_EQ(revision, state->revision());
+    EXPECT_EQ(revision,
+              node->Find(IFMapOrigin(IFMapOrigin::CASSANDRA))->revision());
+}
+
+// Writing a property with the value it already has must neither stamp a new
+// revision nor advertise the node again.
+TEST_F(IFMapExporterTest, ConfigSameValueNoUpdate) {
+    server_->SetSender(new IFMapUpdateSenderMock(server_.get()));
+    TestClient c1("vr-test");
+    ClientSetup(&c1);
+
+    autogen::IdPermsType *prop = new autogen::IdPermsType();
+    prop->description = "initial";
+    IFMapMsgConfigNodeAdd("virtual-router", "vr-test", 1, "id-perms",
+                          prop);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(TableLookup("virtual-router", "vr-test") != NULL);
+    IFMapNode *node = TableLookup("virtual-router", "vr-test");
+    TASK_UTIL_EXPECT_TRUE(exporter_->NodeStateLookup(node) != NULL);
+    IFMapNodeState *state = exporter_->NodeStateLookup(node);
+    TASK_UTIL_EXPECT_TRUE(state->GetUpdate(IFMapListEntry::UPDATE) != NULL);
+    ProcessQueue();
+    EXPECT_TRUE(state->GetUpdate(IFMapListEntry::UPDATE) == NULL);
+    IFMapObject *object = node->Find(IFMapOrigin(IFMapOrigin::CASSANDRA));
+    ASSERT_TRUE(object != NULL);
+    uint64_t revision = object->revision();
+    EXPECT_EQ(revision, state->revision());
+
+    // Same value: no new revision, no update.
+    prop = new autogen::IdPermsType();
+    prop->description = "initial";
+    IFMapMsgConfigNodeAdd("virtual-router", "vr-test", 1, "id-perms",
+                          prop);
+    task_util::WaitForIdle();
+    EXPECT_EQ(revision, object->revision());
+    EXPECT_EQ(revision, state->revision());
+    EXPECT_TRUE(state->GetUpdate(IFMapListEntry::UPDATE) == NULL);
+
+    // Different value: new revision and update.
+    prop = new autogen::IdPermsType();
+    prop->description = "changed";
+    IFMapMsgConfigNodeAdd("virtual-router", "vr-test", 1, "id-perms",
+                          prop);
+    task_util::WaitForIdle();
+    EXPECT_NE(revision, object->revision());
+    EXPECT_EQ(object->revision(), state->revision());
+    TASK_UTIL_EXPECT_TRUE(state->GetUpdate(IFMapListEntry::UPDATE) != NULL);
+    ProcessQueue();
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     LoggingInit();
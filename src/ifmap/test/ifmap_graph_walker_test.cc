@@ -7,6 +7,9 @@
 #include <fstream>
 
 #include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
+#include "base/util.h"
 #include "base/test/task_test_util.h"
 #include "control-node/control_node.h"
 #include "db/db.h"
@@ -565,6 +568,67 @@ TEST_F(IFMapGraphWalkerTest, VrsubConfig) {
     c1.PrintNodes();
 }
 
+static size_t GetVrouterCount() {
+    char *env = getenv("IFMAP_GRAPH_WALKER_TEST_VROUTER_COUNT");
+    size_t count = 1000;
+    if (!env)
+        return count;
+    stringToInteger(string(env), count);
+    return count;
+}
+
+// Many VRs subscribe at the same time (e.g. after control-node restart), all
+// of them sharing the config hanging off the global-system-config.
+TEST_F(IFMapGraphWalkerTest, ManyVrsubStartup) {
+    ParseEventsJson("controller/src/ifmap/testdata/vr_gsc_config.json");
+    FeedEventsJson();
+    task_util::WaitForIdle();
+
+    const size_t kBgpRouterCount = 32;
+    size_t vr_count = GetVrouterCount();
+    ifmap_test_util::IFMapMsgLink(&db_, "global-system-config", "gsc1",
+        "global-vrouter-config", "gsc1:gvrc",
+        "global-system-config-global-vrouter-config");
+    for (size_t i = 1; i <= kBgpRouterCount; ++i) {
+        ifmap_test_util::IFMapMsgLink(&db_, "global-system-config", "gsc1",
+            "bgp-router", "gsc1:bgp" + integerToString(i),
+            "global-system-config-bgp-router");
+    }
+    for (size_t i = 2; i <= vr_count; ++i) {
+        ifmap_test_util::IFMapMsgLink(&db_, "global-system-config", "gsc1",
+            "virtual-router", "gsc1:vr" + integerToString(i),
+            "global-system-config-virtual-router");
+    }
+    task_util::WaitForIdle();
+
+    vector<IFMapClientMock *> clients;
+    uint64_t start = UTCTimestampUsec();
+    for (size_t i = 1; i <= vr_count; ++i) {
+        IFMapClientMock *client =
+            new IFMapClientMock("gsc1:vr" + integerToString(i));
+        server_->AddClient(client);
+        clients.push_back(client);
+    }
+    task_util::WaitForIdle();
+    uint64_t elapsed = UTCTimestampUsec() - start;
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        TASK_UTIL_EXPECT_EQ(1, clients[i]->NodeKeyCount("virtual-router"));
+        TASK_UTIL_EXPECT_EQ(1,
+            clients[i]->NodeKeyCount("global-vrouter-config"));
+        TASK_UTIL_EXPECT_EQ(kBgpRouterCount,
+            clients[i]->NodeKeyCount("bgp-router"));
+    }
+    cout << vr_count << " VRs subscribed in " << elapsed / 1000
+         << " msecs" << endl;
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        server_->DeleteClient(clients[i]);
+    }
+    task_util::WaitForIdle();
+    STLDeleteValues(&clients);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     LoggingInit();
@@ -37,8 +37,7 @@ public:
     enum Property {
         ATTR
     };
-    Tenant()
-        : attr_set_(false) {
+    Tenant() : IFMapIdentifier(1) {
     }
     virtual string ToString() const {
         string repr;
@@ -51,15 +50,17 @@ public:
         if (attr_key == "attr") {
             const TenantAttrData *dp =
                     static_cast<const TenantAttrData *>(data);
+            bool changed = !property_set_.test(ATTR) || attr_ != dp->data;
             attr_ = dp->data;
-            attr_set_ = true;
+            property_set_.set(ATTR);
+            return changed;
         }
-        return true;
+        return false;
     }
     virtual void ClearProperty(const string &attr_key) {
         if (attr_key == "attr") {
             attr_.clear();
-            attr_set_ = false;
+            property_set_.reset(ATTR);
         }
     }
     virtual boost::crc_32_type::value_type CalculateCrc() const {
@@ -67,12 +68,11 @@ public:
     }
 
     bool empty() const {
-        return !attr_set_;
+        return property_set_.none();
     }
 
 private:
     string attr_;
-    bool attr_set_;
 };
 
 class VirtualNetwork : public IFMapIdentifier {
@@ -497,6 +497,47 @@ TEST_F(IFMapServerTableTest, DuplicateLink) {
     EXPECT_EQ("y", vma->attr());
 }
 
+// Only writes that change the stored value stamp a new revision.
+TEST_F(IFMapServerTableTest, RevisionOnChange) {
+    IFMapSetProperty("tenant", "foo", "attr=baz");
+    Wait();
+    IFMapNode *node = TableLookup("tenant", "foo");
+    ASSERT_TRUE(node != NULL);
+    IFMapObject *tenant = node->GetObject();
+    ASSERT_TRUE(tenant != NULL);
+    uint64_t revision = tenant->revision();
+    EXPECT_NE(0U, revision);
+
+    IFMapSetProperty("tenant", "foo", "attr=baz");
+    Wait();
+    EXPECT_EQ(revision, tenant->revision());
+
+    IFMapSetProperty("tenant", "foo", "attr=zoo");
+    Wait();
+    EXPECT_LT(revision, tenant->revision());
+
+    IFMapMsgLinkAttr("vm-vswitch-association", "vswitch", "virtual-machine",
+                     "aa01", "vm1", "x");
+    Wait();
+    IFMapNode *attr_node =
+        TableLookup("vm-vswitch-association", "attr(aa01,vm1)");
+    ASSERT_TRUE(attr_node != NULL);
+    IFMapObject *vma = attr_node->GetObject();
+    ASSERT_TRUE(vma != NULL);
+    revision = vma->revision();
+    EXPECT_NE(0U, revision);
+
+    IFMapMsgLinkAttr("vm-vswitch-association", "vswitch", "virtual-machine",
+                     "aa01", "vm1", "x");
+    Wait();
+    EXPECT_EQ(revision, vma->revision());
+
+    IFMapMsgLinkAttr("vm-vswitch-association", "vswitch", "virtual-machine",
+                     "aa01", "vm1", "y");
+    Wait();
+    EXPECT_LT(revision, vma->revision());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     bool success = RUN_ALL_TESTS();
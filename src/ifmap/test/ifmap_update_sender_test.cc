@@ -5,6 +5,8 @@
 #include "ifmap/ifmap_update_sender.h"
 
 #include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
 #include "base/task.h"
 #include "base/test/task_test_util.h"
 #include "db/db.h"
@@ -27,7 +29,8 @@ using namespace std;
 class TestClient : public IFMapClient {
 public:
     TestClient(const string &addr)
-        : identifier_(addr), send_success_(true), send_update_cnt_(0) {
+        : identifier_(addr), send_success_(true), send_update_cnt_(0),
+          verbose_(true) {
     }
 
     virtual const string &identifier() const {
@@ -35,7 +38,8 @@ public:
     }
 
     virtual bool SendUpdate(const std::string &msg) {
-        cout << "Sending " << endl << msg << endl;
+        if (verbose_)
+            cout << "Sending " << endl << msg << endl;
         send_update_cnt_++;
         return send_success_;
     }
@@ -45,10 +49,13 @@ public:
     // Control if you want to block or continue sending
     void set_send_success(bool succ) { send_success_ = succ; }
 
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
 private:
     string identifier_;
     bool send_success_;
     int send_update_cnt_;
+    bool verbose_;
 };
 
 struct IFMapUpdateDeleter {
@@ -1231,6 +1238,90 @@ TEST_F(IFMapUpdateSenderTest, Bug228) {
     queue_->PrintQueue();
 }
 
+static size_t GetClientCount() {
+    char *env = getenv("IFMAP_UPDATE_SENDER_TEST_CLIENT_COUNT");
+    size_t count = 2000;
+    if (!env)
+        return count;
+    stringToInteger(string(env), count);
+    return count;
+}
+
+// Many clients sharing the same set of updates. Half of the clients are
+// blocked when the updates are sent first, and they receive the same updates
+// later as part of different messages. Every update must be encoded only
+// once regardless of the number of clients and messages.
+TEST_F(IFMapUpdateSenderTest, EncodeOnceManyClients) {
+    const size_t kUpdateCount = 64;
+    size_t client_count = GetClientCount();
+    vector<TestClient *> clients;
+    BitSet all_bs, blocked_bs;
+    for (size_t i = 0; i < client_count; ++i) {
+        TestClient *client = new TestClient("c" + integerToString(i));
+        client->set_verbose(false);
+        server_.ClientRegister(client);
+        server_.ClientExporterSetup(client);
+        queue_->Join(client->index());
+        all_bs.set(client->index());
+        if (i % 2)
+            blocked_bs.set(client->index());
+        clients.push_back(client);
+    }
+
+    for (size_t i = 0; i < kUpdateCount; ++i) {
+        IFMapUpdate *update =
+            CreateUpdate(("u" + integerToString(i)).c_str(), true);
+        update->AdvertiseOr(all_bs);
+        queue_->Enqueue(update);
+    }
+    uint64_t misses = sender_->encode_cache_misses();
+    uint64_t hits = sender_->encode_cache_hits();
+
+    // Send to the ready half of the clients.
+    task_util::TaskSchedulerStop();
+    for (size_t i = blocked_bs.find_first(); i != BitSet::npos;
+         i = blocked_bs.find_next(i)) {
+        SetSendBlocked(i);
+    }
+    uint64_t start = UTCTimestampUsec();
+    sender_->QueueActive();
+    task_util::TaskSchedulerStart();
+    task_util::WaitForIdle();
+    uint64_t ready_time = UTCTimestampUsec() - start;
+    TASK_UTIL_EXPECT_EQ(misses + kUpdateCount, sender_->encode_cache_misses());
+    TASK_UTIL_EXPECT_EQ(hits, sender_->encode_cache_hits());
+
+    // Unblock the other half, they are served from the encode cache.
+    task_util::TaskSchedulerStop();
+    start = UTCTimestampUsec();
+    for (size_t i = blocked_bs.find_first(); i != BitSet::npos;
+         i = blocked_bs.find_next(i)) {
+        sender_->SendActive(i);
+    }
+    task_util::TaskSchedulerStart();
+    task_util::WaitForIdle();
+    uint64_t blocked_time = UTCTimestampUsec() - start;
+    TASK_UTIL_EXPECT_EQ(misses + kUpdateCount, sender_->encode_cache_misses());
+    TASK_UTIL_EXPECT_EQ(hits + kUpdateCount, sender_->encode_cache_hits());
+
+    TASK_UTIL_EXPECT_EQ(1, queue_->size());
+    int messages = kUpdateCount / IFMapMessage::kObjectsPerMessage;
+    for (size_t i = 0; i < client_count; ++i) {
+        TASK_UTIL_EXPECT_EQ(messages, clients[i]->get_send_update_cnt());
+        TASK_UTIL_EXPECT_TRUE(queue_->GetMarker(clients[i]->index()) ==
+                              queue_->tail_marker());
+    }
+
+    cout << client_count << " clients, " << kUpdateCount << " updates: "
+         << ready_time / 1000 << " msecs for ready clients, "
+         << blocked_time / 1000 << " msecs for unblocked clients" << endl;
+
+    for (size_t i = 0; i < client_count; ++i) {
+        queue_->Leave(clients[i]->index());
+        delete clients[i];
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     bool success = RUN_ALL_TESTS();
@@ -323,19 +323,30 @@ void Agent::SetAgentTaskPolicy() {
     SetTaskPolicyOne(kTaskFlowStatsCollector, flow_stats_exclude_list,
                      sizeof(flow_stats_exclude_list) / sizeof(char *));
 
-    const char *session_stats_exclude_list[] = {
-        kTaskSessionStatsCollectorEvent,
-        AGENT_SHUTDOWN_TASKNAME,
-        AGENT_INIT_TASKNAME
-    };
-    SetTaskPolicyOne(kTaskSessionStatsCollector, session_stats_exclude_list,
-                     sizeof(session_stats_exclude_list) / sizeof(char *));
+    // Session stats collectors are partitioned on flow-table. Export walk of
+    // a collector runs with task instance of the collector and excludes only
+    // the event queue of same collector. So, collectors run in parallel
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    TaskPolicy session_stats_policy;
+    session_stats_policy.push_back
+        (TaskExclusion(scheduler->GetTaskId(AGENT_SHUTDOWN_TASKNAME)));
+    session_stats_policy.push_back
+        (TaskExclusion(scheduler->GetTaskId(AGENT_INIT_TASKNAME)));
+    int session_event_task_id =
+        scheduler->GetTaskId(kTaskSessionStatsCollectorEvent);
+    for (int i = 0; i < kSessionStatsCollectorCount; i++) {
+        session_stats_policy.push_back
+            (TaskExclusion(session_event_task_id, i));
+    }
+    scheduler->SetPolicy(scheduler->GetTaskId(kTaskSessionStatsCollector),
+                         session_stats_policy);
 
     const char *session_stats_event_exclude_list[] = {
         AGENT_SHUTDOWN_TASKNAME,
         AGENT_INIT_TASKNAME
     };
-    SetTaskPolicyOne(kTaskSessionStatsCollectorEvent, session_stats_exclude_list,
+    SetTaskPolicyOne(kTaskSessionStatsCollectorEvent,
+                     session_stats_event_exclude_list,
                      sizeof(session_stats_event_exclude_list) / sizeof(char *));
     const char *metadata_exclude_list[] = {
         "xmpp::StateMachine",
@@ -373,7 +384,6 @@ void Agent::SetAgentTaskPolicy() {
                      flow_stats_manager_exclude_list,
                      sizeof(flow_stats_manager_exclude_list) / sizeof(char *));
 
-    TaskScheduler *scheduler = TaskScheduler::GetInstance();
     scheduler->RegisterLog(boost::bind(&Agent::TaskTrace, this,
                                        _1, _2, _3, _4, _5));
 
@@ -368,6 +368,9 @@ public:
     static const uint32_t kDefaultFlowIndexSmLogCount = 0;
     // default number of threads for flow setup
     static const uint32_t kDefaultFlowThreadCount = 1;
+    // number of session stats collectors. Flows are partitioned across
+    // collectors based on flow-table index
+    static const int kSessionStatsCollectorCount = 4;
     // Log a message if latency in processing flow queue exceeds limit
     static const uint32_t kDefaultFlowLatencyLimit = 0;
     // Max number of threads
@@ -384,6 +387,8 @@ public:
     static const uint32_t kFlowKSyncTokens = 25;
     static const uint32_t kFlowDelTokens = 16;
     static const uint32_t kFlowUpdateTokens = 16;
+    // Percentage of flow revaluation budget when new flows are pending
+    static const uint32_t kFlowRevaluateShare = 25;
     static const uint32_t kMacLearningDefaultTokens = 256;
     static const uint8_t  kMinAapPrefixLen = 24;
     static const uint8_t kInvalidQueueId = 255;
@@ -710,6 +710,11 @@ void AgentParam::ParseFlowArguments
                           "FLOWS.del_tokens");
     GetOptValue<uint32_t>(var_map, flow_update_tokens_,
                           "FLOWS.update_tokens");
+    GetOptValue<uint32_t>(var_map, flow_revaluate_share_,
+                          "FLOWS.revaluate_share");
+    if (flow_revaluate_share_ == 0 || flow_revaluate_share_ > 100) {
+        flow_revaluate_share_ = Agent::kFlowRevaluateShare;
+    }
     GetOptValue<bool>(var_map, flow_hash_excl_rid_,
                       "FLOWS.hash_exclude_router_id");
     GetOptValue<uint16_t>(var_map, max_sessions_per_aggregate_,
@@ -1631,6 +1636,7 @@ void AgentParam::LogConfig() const {
     LOG(DEBUG, "Flow ksync-tokens           : " << flow_ksync_tokens_);
     LOG(DEBUG, "Flow del-tokens             : " << flow_del_tokens_);
     LOG(DEBUG, "Flow update-tokens          : " << flow_update_tokens_);
+    LOG(DEBUG, "Flow revaluate-share        : " << flow_revaluate_share_);
     LOG(DEBUG, "Pin flow netlink task to CPU: "
         << ksync_thread_cpu_pin_policy_);
     LOG(DEBUG, "Maximum sessions            : " << max_sessions_per_aggregate_);
@@ -1768,6 +1774,7 @@ AgentParam::AgentParam(bool enable_flow_options,
         flow_ksync_tokens_(Agent::kFlowKSyncTokens),
         flow_del_tokens_(Agent::kFlowDelTokens),
         flow_update_tokens_(Agent::kFlowUpdateTokens),
+        flow_revaluate_share_(Agent::kFlowRevaluateShare),
         flow_netlink_pin_cpuid_(0),
         stale_interface_cleanup_timeout_
         (Agent::kDefaultStaleInterfaceCleanupTimeout),
@@ -1838,6 +1845,7 @@ AgentParam::AgentParam(bool enable_flow_options,
     uint32_t default_pkt0_tx_buffers = Agent::kPkt0TxBufferCount;
     uint32_t default_stale_interface_cleanup_timeout = Agent::kDefaultStaleInterfaceCleanupTimeout;
     uint32_t default_flow_update_tokens = Agent::kFlowUpdateTokens;
+    uint32_t default_flow_revaluate_share = Agent::kFlowRevaluateShare;
     uint32_t default_flow_del_tokens = Agent::kFlowDelTokens;
     uint32_t default_flow_ksync_tokens = Agent::kFlowKSyncTokens;
     uint32_t default_flow_add_tokens = Agent::kFlowAddTokens;
@@ -2255,6 +2263,8 @@ AgentParam::AgentParam(bool enable_flow_options,
              "Number of delete-tokens")
             ("FLOWS.update_tokens", opt::value<uint32_t>()->default_value(default_flow_update_tokens),
              "Number of update-tokens")
+            ("FLOWS.revaluate_share", opt::value<uint32_t>()->default_value(default_flow_revaluate_share),
+             "Percentage of flow revaluation budget when new flows are pending")
             ("FLOWS.hash_exclude_router_id", opt::value<bool>(),
              "Exclude router-id in hash calculation")
             ("FLOWS.index_sm_log_count", opt::value<uint16_t>()->default_value(Agent::kDefaultFlowIndexSmLogCount),
@@ -260,6 +260,10 @@ public:
     uint32_t flow_ksync_tokens() const {return flow_ksync_tokens_;}
     uint32_t flow_del_tokens() const {return flow_del_tokens_;}
     uint32_t flow_update_tokens() const {return flow_update_tokens_;}
+    uint32_t flow_revaluate_share() const {return flow_revaluate_share_;}
+    void set_flow_revaluate_share(uint32_t share) {
+        flow_revaluate_share_ = share;
+    }
     uint32_t stale_interface_cleanup_timeout() const {
         return stale_interface_cleanup_timeout_;
     }
@@ -734,6 +738,7 @@ private:
     uint32_t flow_ksync_tokens_;
     uint32_t flow_del_tokens_;
     uint32_t flow_update_tokens_;
+    uint32_t flow_revaluate_share_;
     uint32_t flow_netlink_pin_cpuid_;
     uint32_t stale_interface_cleanup_timeout_;
 
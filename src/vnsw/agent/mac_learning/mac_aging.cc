@@ -1,6 +1,7 @@
 /*
  * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
  */
+#include <algorithm>
 #include <oper/vn.h>
 #include <oper/sg.h>
 #include <oper/vm.h>
@@ -40,7 +41,8 @@ void MacAgingEntry::FillSandesh(SandeshMacEntry *smac) const {
 }
 
 MacAgingTable::MacAgingTable(Agent *agent, const VrfEntry *vrf) :
-    agent_(agent), timeout_msec_(kDefaultAgingTimeout), vrf_(vrf) {
+    agent_(agent), last_key_(NULL), timeout_msec_(kDefaultAgingTimeout),
+    vrf_(vrf) {
 }
 
 MacAgingTable::~MacAgingTable() {
@@ -66,10 +68,7 @@ void MacAgingTable::Delete(MacLearningEntryPtr ptr) {
     }
 }
 
-void MacAgingTable::ReadStats(MacAgingEntry *ptr) {
-    MacPbbLearningEntry *entry =
-        dynamic_cast<MacPbbLearningEntry *>(ptr->mac_learning_entry().get());
-    uint32_t index = entry->index();
+void MacAgingTable::ReadStats(MacAgingEntry *ptr, uint32_t index) {
     vr_bridge_entry *vr_entry = agent_->ksync()->ksync_bridge_memory()->
                                     GetBridgeEntry(index);
     if (vr_entry == NULL) {
@@ -80,11 +79,11 @@ void MacAgingTable::ReadStats(MacAgingEntry *ptr) {
 }
 
 
-bool MacAgingTable::ShouldBeAged(MacAgingEntry *ptr,
+bool MacAgingTable::ShouldBeAged(MacAgingEntry *ptr, uint32_t index,
                                  uint64_t curr_time) {
     uint64_t packets = ptr->packets();
 
-    ReadStats(ptr);
+    ReadStats(ptr, index);
 
     if (packets == ptr->packets()) {
         if (curr_time - ptr->last_modified_time() > timeout_in_usecs()) {
@@ -148,9 +147,15 @@ MacAgingTable::CalculateEntriesPerIteration(uint32_t aging_table_entry_count) {
     return entry_count_per_iteration;
 }
 
-bool MacAgingTable::Run() {
-    uint64_t curr_time = UTCTimestampUsec();
+void MacAgingTable::Age(MacAgingEntry *ptr, uint32_t index,
+                        uint64_t curr_time) {
+    if (ShouldBeAged(ptr, index, curr_time)) {
+        SendDeleteMsg(ptr);
+    }
+}
 
+//Adds entries to be visited in this iteration to list
+bool MacAgingTable::Run(MacAgingScanList *list) {
     MacAgingEntryTable::const_iterator it = aging_table_.upper_bound(last_key_);
     if (it == aging_table_.end()) {
         it = aging_table_.begin();
@@ -159,9 +164,11 @@ bool MacAgingTable::Run() {
     uint32_t i = 0;
     uint32_t entries = CalculateEntriesPerIteration(aging_table_.size());
     while (it != aging_table_.end() && i < entries) {
-        if (it->second->deleted() == false &&
-                ShouldBeAged(it->second.get(), curr_time)) {
-            SendDeleteMsg(it->second.get());
+        if (it->second->deleted() == false) {
+            MacPbbLearningEntry *entry = dynamic_cast<MacPbbLearningEntry *>
+                (it->second->mac_learning_entry().get());
+            list->push_back(MacAgingScanEntry(entry->index(), it->second.get(),
+                                              this));
         }
         last_key_ = it->first;
         it++;
@@ -222,13 +229,22 @@ void MacAgingPartition::Delete(MacLearningEntryPtr mle) {
 
 bool MacAgingPartition::Run() {
     bool ret = false;
+    scan_list_.clear();
     MacAgingTableMap::iterator it = aging_table_map_.begin();
     for (;it != aging_table_map_.end(); it++) {
-        if (it->second.get() && it->second->Run()) {
+        if (it->second.get() && it->second->Run(&scan_list_)) {
             ret = true;
         }
     }
 
+    //Read stats from bridge table in order of index
+    std::sort(scan_list_.begin(), scan_list_.end());
+    uint64_t curr_time = UTCTimestampUsec();
+    MacAgingScanList::iterator scan_it = scan_list_.begin();
+    for (; scan_it != scan_list_.end(); scan_it++) {
+        scan_it->table_->Age(scan_it->entry_, scan_it->index_, curr_time);
+    }
+
     return ret;
 }
 
@@ -56,6 +56,25 @@ private:
 };
 typedef boost::shared_ptr<MacAgingEntry> MacAgingEntryPtr;
 
+class MacAgingTable;
+//Entry to be visited in an iteration of aging partition. Entries of all
+//VRFs in a partition are sorted on bridge index, so that stats are read
+//sequentially from vrouter bridge table
+struct MacAgingScanEntry {
+    MacAgingScanEntry(uint32_t index, MacAgingEntry *entry,
+                      MacAgingTable *table) :
+        index_(index), entry_(entry), table_(table) {}
+
+    bool operator<(const MacAgingScanEntry &rhs) const {
+        return index_ < rhs.index_;
+    }
+
+    uint32_t index_;
+    MacAgingEntry *entry_;
+    MacAgingTable *table_;
+};
+typedef std::vector<MacAgingScanEntry> MacAgingScanList;
+
 //Per VRF mac aging table
 class MacAgingTable {
 public:
@@ -74,7 +93,8 @@ public:
     void set_timeout(uint32_t msec) {
         timeout_msec_ = msec;
     }
-    bool Run();
+    bool Run(MacAgingScanList *list);
+    void Age(MacAgingEntry *ptr, uint32_t index, uint64_t curr_time);
     void Add(MacLearningEntryPtr ptr);
     void Delete(MacLearningEntryPtr ptr);
 
@@ -88,9 +108,9 @@ public:
     }
 
 private:
-    bool ShouldBeAged(MacAgingEntry *ptr, uint64_t curr_time);
+    bool ShouldBeAged(MacAgingEntry *ptr, uint32_t index, uint64_t curr_time);
     void SendDeleteMsg(MacAgingEntry *ptr);
-    void ReadStats(MacAgingEntry *ptr);
+    void ReadStats(MacAgingEntry *ptr, uint32_t index);
     void Trace(const std::string &str, MacAgingEntry *ptr);
     friend class MacAgingSandeshResp;
     Agent *agent_;
@@ -105,7 +125,8 @@ private:
 //for aging purpose. Timer for each partition gets
 //fired every 100ms and goes thru all the VRF entries.
 //No. of entries to be visited would be based on aging timeout
-//and no. of entries in tree.
+//and no. of entries in tree. Entries to be visited from all the
+//VRFs are collected and visited in order of bridge index.
 class MacAgingPartition {
 public:
     static const uint32_t kMinIterationTimeout = 1 * 100;
@@ -134,6 +155,7 @@ private:
     Timer *timer_;
     tbb::mutex mutex_;
     MacAgingTableMap aging_table_map_;
+    MacAgingScanList scan_list_;
     DISALLOW_COPY_AND_ASSIGN(MacAgingPartition);
 };
 #endif
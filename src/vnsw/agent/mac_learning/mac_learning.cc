@@ -35,13 +35,6 @@ void MacPbbLearningEntry::Delete() {
                   vrf()->GetName(), mac(), Ip4Address(0), 32, 0, NULL);
 }
 
-void MacPbbLearningEntry::AddWithToken() {
-    if (Add()) {
-        AddToken(mac_learning_table_->agent()->mac_learning_proto()->
-                 GetToken(MacLearningEntryRequest::ADD_MAC));
-    }
-}
-
 void MacPbbLearningEntry::Resync() {
     if (Add()) {
         AddToken(mac_learning_table_->agent()->mac_learning_proto()->
@@ -152,10 +145,12 @@ bool MacLearningRequestQueue::HandleEvent(MacLearningEntryRequestPtr ptr) {
 MacLearningPartition::MacLearningPartition(Agent *agent,
                                            MacLearningProto *proto,
                                            uint32_t id):
-    agent_(agent), id_(id),
+    agent_(agent), id_(id), route_updates_(0), route_updates_coalesced_(0),
     add_request_queue_(this, proto->add_tokens()),
     change_request_queue_(this, proto->change_tokens()),
     delete_request_queue_(this, proto->delete_tokens()) {
+    add_request_queue_.SetExitCallback
+        (boost::bind(&MacLearningPartition::RouteUpdateDone, this, _1));
     aging_partition_.reset(new MacAgingPartition(agent, id));
 }
 
@@ -233,13 +228,43 @@ void MacLearningPartition::Add(MacLearningEntryPtr ptr) {
         mac_learning_table_[key] = ptr;
     }
 
-    ptr->AddWithToken();
+    //Token is taken when the MAC is learnt, so that the add queue is
+    //throttled by learning rate even though route add is deferred. Tokens
+    //of a superseded entry are carried over by CopyToken above
+    ptr->AddToken(agent_->mac_learning_proto()->
+                  GetToken(MacLearningEntryRequest::ADD_MAC));
+
+    //Route add is done at the end of the run, if the MAC is learnt again
+    //in this run only latest entry is added
+    std::pair<MacLearningRouteUpdateMap::iterator, bool> ret =
+        route_update_map_.insert(std::make_pair(key, ptr));
+    if (ret.second == false) {
+        ret.first->second = ptr;
+        route_updates_coalesced_++;
+    }
     EnqueueMgmtReq(ptr, true);
     MacLearningEntryRequestPtr aging_req(new MacLearningEntryRequest(
                                    MacLearningEntryRequest::ADD_MAC, ptr));
     aging_partition_->Enqueue(aging_req);
 }
 
+// Invoked at end of a run of add request queue, adds route for the latest
+// entry of every MAC learnt in the run
+void MacLearningPartition::RouteUpdateDone(bool done) {
+    MacLearningRouteUpdateMap updates;
+    updates.swap(route_update_map_);
+    for (MacLearningRouteUpdateMap::iterator it = updates.begin();
+         it != updates.end(); ++it) {
+        MacLearningEntryPtr ptr = it->second;
+        if (ptr->deleted()) {
+            continue;
+        }
+
+        route_updates_++;
+        ptr->Add();
+    }
+}
+
 void MacLearningPartition::Delete(const MacLearningEntryPtr ptr) {
     if (ptr->deleted() == true) {
         return;
@@ -306,6 +331,35 @@ MacLearningPartition::Find(const MacLearningKey &key) {
     return it->second.get();
 }
 
+void MacLearningPartition::GetEntries(const MacLearningKey &key,
+                                      bool vrf_only, uint32_t count,
+                                      MacLearningEntrySortedTable *table) const {
+    if (count == 0) {
+        return;
+    }
+
+    //Keep count smallest keys greater than key
+    MacLearningEntryTable::const_iterator it = mac_learning_table_.begin();
+    for (; it != mac_learning_table_.end(); ++it) {
+        if (vrf_only && it->first.vrf_id_ != key.vrf_id_) {
+            continue;
+        }
+
+        if (it->first.IsLess(key) || it->first.IsEqual(key)) {
+            continue;
+        }
+
+        if (table->size() == count) {
+            MacLearningEntrySortedTable::iterator last = --table->end();
+            if (last->first.IsLess(it->first)) {
+                continue;
+            }
+            table->erase(last);
+        }
+        table->insert(MacLearningEntryPair(it->first, it->second));
+    }
+}
+
 MacLearningEntryPtr
 MacLearningPartition::TestGet(const MacLearningKey &key) {
     MacLearningEntryTable::iterator it = mac_learning_table_.find(key);
@@ -398,25 +452,24 @@ MacLearningSandeshResp::Run() {
             break;
         }
 
-        MacLearningKey key(vrf_id_, mac_);
-        MacLearningPartition::MacLearningEntryTable::const_iterator it;
+        //Partition is hashed, get the entries after the key in key order
+        MacLearningPartition::MacLearningEntrySortedTable table;
         if (user_given_mac_ != MacAddress::ZeroMac()) {
-            it = mp->mac_learning_table_.find(key);
+            MacLearningKey key(vrf_id_, user_given_mac_);
+            MacLearningPartition::MacLearningEntryTable::const_iterator it =
+                mp->mac_learning_table_.find(key);
+            if (it != mp->mac_learning_table_.end()) {
+                table.insert(MacLearningPartition::MacLearningEntryPair(
+                             it->first, it->second));
+            }
         } else {
-            it = mp->mac_learning_table_.upper_bound(key);
+            mp->GetEntries(MacLearningKey(vrf_id_, mac_), exact_match_,
+                           kMaxResponse - entries_count, &table);
         }
 
-        while (entries_count < kMaxResponse) {
-            if (exact_match_ && it->first.vrf_id_ != vrf_id_) {
-                break;
-            } else {
-                vrf_id_ = it->first.vrf_id_;
-            }
-
-            if (it == mp->mac_learning_table_.end()) {
-                break;
-            }
-
+        MacLearningPartition::MacLearningEntrySortedTable::const_iterator it =
+            table.begin();
+        for (; it != table.end(); it++) {
             const MacAgingTable *at =
                 mp->aging_partition()->Find(it->first.vrf_id_);
             //Find the aging entry
@@ -432,34 +485,21 @@ MacLearningSandeshResp::Run() {
             }
 
             entries_count++;
-            if (user_given_mac_ != MacAddress::ZeroMac()) {
-                break;
-            }
+            vrf_id_ = it->first.vrf_id_;
             mac_ = it->first.mac_;
-            it++;
         }
 
         if (entries_count >= kMaxResponse) {
             break;
         }
 
+        //All entries of partition are visited, move on to next partition
+        partition_id_++;
         if (exact_match_ == false) {
-            vrf_id_++;
-        }
-
-        if (it == mp->mac_learning_table_.end()) {
-            partition_id_++;
-            if (exact_match_ == false) {
-                vrf_id_ = 0;
-            }
+            vrf_id_ = 0;
         }
 
         if (user_given_mac_ != MacAddress::ZeroMac()) {
-            //If entry is found in current partition
-            //move on to next partition
-            if (it != mp->mac_learning_table_.end()) {
-                partition_id_++;
-            }
             mac_ = user_given_mac_;
         } else {
             mac_ = MacAddress::ZeroMac();
@@ -5,6 +5,7 @@
 #ifndef SRC_VNSW_AGENT_MAC_LEARNING_MAC_LEARNING_H_
 #define SRC_VNSW_AGENT_MAC_LEARNING_MAC_LEARNING_H_
 
+#include <boost/unordered_map.hpp>
 #include "cmn/agent.h"
 #include "mac_learning_key.h"
 #include "mac_learning_base.h"
@@ -22,7 +23,9 @@ class MacEntryResp;
  * MacLearningPartition:
  * A logical context for processing MAC learning requests in parallel
  * This modules learns the MAC entry and
- * 1> Enqueues a request for route add
+ * 1> Enqueues a request for route add. Route requests are batched till
+ *    end of a run of request queue, and only the latest entry of a MAC
+ *    learnt multiple times in the run results in route add
  * 2> Enqueues a request to MacLearningMgmt for dependency tracking
  * 3> Enqueues a request to MacAgingPartiton for aging
  *
@@ -46,6 +49,8 @@ class MacEntryResp;
  * maintains a per VRF list of MAC entries, upon timer expiry based on
  * aging timeout configured on VRF and no. of entries in VRF no. of entries
  * would be visited for stats and aged if no activity is seen on the entry.
+ * Entries visited from all VRFs are sorted on bridge index, so that stats
+ * are read sequentially from vrouter bridge table.
  *
  *                       ++++++++++++++++++++
  *                       +   Mac Aging X    +
@@ -83,7 +88,6 @@ public:
     virtual bool Add() = 0;
     virtual void Delete();
     virtual void Resync();
-    virtual void AddWithToken();
 
     MacLearningPartition* mac_learning_table() const {
         return mac_learning_table_;
@@ -207,9 +211,20 @@ class MacLearningPartition {
 public:
     typedef std::pair<MacLearningKey,
                       MacLearningEntryPtr> MacLearningEntryPair;
+    typedef boost::unordered_map<MacLearningKey,
+                                 MacLearningEntryPtr,
+                                 MacLearningKeyHash,
+                                 MacLearningKeyEqual> MacLearningEntryTable;
+    // Ordered view of entries, used for introspect
     typedef std::map<MacLearningKey,
                      MacLearningEntryPtr,
-                     MacLearningKeyCmp> MacLearningEntryTable;
+                     MacLearningKeyCmp> MacLearningEntrySortedTable;
+    // Latest entry learnt for the MAC in current run, its route add is
+    // pending
+    typedef boost::unordered_map<MacLearningKey,
+                                 MacLearningEntryPtr,
+                                 MacLearningKeyHash,
+                                 MacLearningKeyEqual> MacLearningRouteUpdateMap;
 
     MacLearningPartition(Agent *agent, MacLearningProto *proto,
                          uint32_t id);
@@ -220,9 +235,12 @@ public:
     void DeleteAll();
     void ReleaseToken(const MacLearningKey &key);
     MacLearningEntry* Find(const MacLearningKey &key);
+    void GetEntries(const MacLearningKey &key, bool vrf_only, uint32_t count,
+                    MacLearningEntrySortedTable *table) const;
     //To be used in test cases only
     MacLearningEntryPtr TestGet(const MacLearningKey &key);
     bool RequestHandler(MacLearningEntryRequestPtr ptr);
+    void RouteUpdateDone(bool done);
 
     Agent* agent() {
         return agent_;
@@ -236,6 +254,18 @@ public:
         return id_;
     }
 
+    size_t Size() const {
+        return mac_learning_table_.size();
+    }
+
+    uint64_t route_updates() const {
+        return route_updates_;
+    }
+
+    uint64_t route_updates_coalesced() const {
+        return route_updates_coalesced_;
+    }
+
     void Enqueue(MacLearningEntryRequestPtr req);
     void EnqueueMgmtReq(MacLearningEntryPtr ptr, bool add);
     void MayBeStartRunner(TokenPool *pool);
@@ -244,11 +274,18 @@ public:
         delete_request_queue_.SetQueueDisable(disable);
     }
 
+    void SetAddQueueDisable(bool disable) {
+        add_request_queue_.SetQueueDisable(disable);
+    }
+
 private:
     friend class MacLearningSandeshResp;
     Agent *agent_;
     uint32_t id_;
     MacLearningEntryTable mac_learning_table_;
+    MacLearningRouteUpdateMap route_update_map_;
+    uint64_t route_updates_;
+    uint64_t route_updates_coalesced_;
     MacLearningRequestQueue add_request_queue_;
     MacLearningRequestQueue change_request_queue_;
     MacLearningRequestQueue delete_request_queue_;
@@ -36,9 +36,6 @@ public:
 
     virtual uint32_t vrf_id() = 0;
 
-    virtual void AddWithToken() {
-    }
-
     virtual void AddToken(TokenPtr ptr) {
     }
 
@@ -109,6 +109,10 @@ public:
         queue_.set_disable(disable);
     }
 
+    void SetExitCallback(Queue::TaskExitCallback cb) {
+        queue_.SetExitCallback(cb);
+    }
+
 private:
     MacLearningPartition *partition_;
     TokenPool *pool_;
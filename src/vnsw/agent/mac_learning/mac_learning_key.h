@@ -5,6 +5,8 @@
 #ifndef SRC_VNSW_AGENT_MAC_LEARNING_MAC_LEARNING_KEY_H_
 #define SRC_VNSW_AGENT_MAC_LEARNING_MAC_LEARNING_KEY_H_
 
+#include <boost/functional/hash.hpp>
+
 struct  MacLearningKey {
     MacLearningKey(uint32_t vrf_id, const MacAddress &mac):
         vrf_id_(vrf_id), mac_(mac) {}
@@ -18,6 +20,23 @@ struct  MacLearningKey {
 
         return mac_ < rhs.mac_;
     }
+
+    bool IsEqual(const MacLearningKey &rhs) const {
+        return (vrf_id_ == rhs.vrf_id_ && mac_ == rhs.mac_);
+    }
+
+    // MacLearningProto::Hash() picks the partition from hash of VRF and
+    // MAC. Hash MAC as a 48 bit value here, so that keys within a partition
+    // spread across buckets
+    std::size_t Hash() const {
+        uint64_t mac = 0;
+        for (uint32_t i = 0; i < ETH_ALEN; i++) {
+            mac = (mac << 8) | mac_[i];
+        }
+        std::size_t val = boost::hash_value(mac);
+        boost::hash_combine(val, vrf_id_);
+        return val;
+    }
 };
 
 struct MacLearningKeyCmp {
@@ -25,4 +44,16 @@ struct MacLearningKeyCmp {
         return lhs.IsLess(rhs);
     }
 };
+
+struct MacLearningKeyHash {
+    std::size_t operator()(const MacLearningKey &key) const {
+        return key.Hash();
+    }
+};
+
+struct MacLearningKeyEqual {
+    bool operator()(const MacLearningKey &lhs, const MacLearningKey &rhs) const {
+        return lhs.IsEqual(rhs);
+    }
+};
 #endif
@@ -3,6 +3,7 @@
  */
 
 #include "base/os.h"
+#include "base/time_util.h"
 #include "testing/gunit.h"
 
 #include <sys/socket.h>
@@ -283,6 +284,115 @@ TEST_F(MacLearningTest, Test7) {
     WAIT_FOR(1000, 1000,(EvpnRouteGet("vrf1", smac, Ip4Address(0), 0) != NULL));
 }
 
+static uint32_t EvpnRouteCount(const MacAddress &base, uint32_t count) {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        MacAddress smac(base[0], base[1], base[2], (i >> 16) & 0xFF,
+                        (i >> 8) & 0xFF, i & 0xFF);
+        if (EvpnRouteGet("vrf1", smac, Ip4Address(0), 0) != NULL) {
+            found++;
+        }
+    }
+    return found;
+}
+
+static uint32_t EvpnRouteIntfCount(const MacAddress &base, uint32_t count,
+                                   const Interface *intf) {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        MacAddress smac(base[0], base[1], base[2], (i >> 16) & 0xFF,
+                        (i >> 8) & 0xFF, i & 0xFF);
+        AgentRoute *rt = EvpnRouteGet("vrf1", smac, Ip4Address(0), 0);
+        if (rt == NULL ||
+            rt->GetActiveNextHop()->GetType() != NextHop::INTERFACE) {
+            continue;
+        }
+        const InterfaceNH *intf_nh =
+            static_cast<const InterfaceNH *>(rt->GetActiveNextHop());
+        if (intf_nh->GetInterface() == intf) {
+            found++;
+        }
+    }
+    return found;
+}
+
+static void SetAddQueueDisable(Agent *agent, bool disable) {
+    for (uint32_t i = 0; i < agent->params()->mac_learning_thread_count();
+         i++) {
+        agent->mac_learning_proto()->Find(i)->SetAddQueueDisable(disable);
+    }
+}
+
+// Learning storm benchmark. AGENT_MAC_LEARNING_BENCH_COUNT MACs are learnt
+// on one interface and then moved to another interface. Every MAC is
+// learnt twice in the move step with add queue disabled, so that both
+// requests are handled in the same run and route add gets coalesced
+TEST_F(MacLearningTest, LearningStormBench) {
+    char env[100];
+    uint32_t count = 1024;
+    if (getenv("AGENT_MAC_LEARNING_BENCH_COUNT")) {
+        strcpy(env, getenv("AGENT_MAC_LEARNING_BENCH_COUNT"));
+        count = strtoul(env, NULL, 0);
+    }
+
+    const VmInterface *intf = static_cast<const VmInterface *>(VmPortGet(1));
+    const VmInterface *intf2 = static_cast<const VmInterface *>(VmPortGet(2));
+    const VmInterface *intf_list[] = {intf, intf2};
+    const char *step[] = {"Learn", "Move"};
+    uint32_t repeat[] = {1, 2};
+    MacAddress base(0x00, 0x00, 0x01, 0x00, 0x00, 0x00);
+
+    for (uint32_t j = 0; j < 2; j++) {
+        uint64_t start = ClockMonotonicUsec();
+        SetAddQueueDisable(agent_, true);
+        for (uint32_t i = 0; i < count; i++) {
+            MacAddress smac(base[0], base[1], base[2], (i >> 16) & 0xFF,
+                            (i >> 8) & 0xFF, i & 0xFF);
+            for (uint32_t k = 0; k < repeat[j]; k++) {
+                TxL2Packet(intf_list[j]->id(), smac.ToString().c_str(),
+                           "00:00:00:33:22:11", "1.1.1.1", "1.1.1.11", 1,
+                           i % 512, intf->vrf()->vrf_id(), 1, 1);
+            }
+        }
+        client->WaitForIdle();
+        SetAddQueueDisable(agent_, false);
+        client->WaitForIdle();
+        WAIT_FOR(1000, 10000,
+                 (EvpnRouteIntfCount(base, count, intf_list[j]) == count));
+        uint64_t learn_time = ClockMonotonicUsec() - start;
+        if (learn_time == 0)
+            learn_time = 1;
+
+        uint32_t mac_count = 0;
+        uint64_t route_updates = 0;
+        uint64_t coalesced = 0;
+        for (uint32_t i = 0;
+             i < agent_->params()->mac_learning_thread_count(); i++) {
+            MacLearningPartition *partition =
+                agent_->mac_learning_proto()->Find(i);
+            mac_count += partition->Size();
+            route_updates += partition->route_updates();
+            coalesced += partition->route_updates_coalesced();
+        }
+        EXPECT_EQ(count, mac_count);
+        EXPECT_EQ(count, EvpnRouteIntfCount(base, count, intf_list[j]));
+        if (j == 1) {
+            EXPECT_TRUE(coalesced != 0);
+        }
+        cout << step[j] << " MACs : " << count << " Time : " << learn_time
+            << " usec Rate : " << ((uint64_t)count * 1000000) / learn_time
+            << " MACs/sec Route updates : " << route_updates
+            << " Coalesced : " << coalesced << endl;
+    }
+
+    VmInterface::Delete(Agent::GetInstance()->interface_table(),
+                        MakeUuid(1), VmInterface::INSTANCE_MSG);
+    VmInterface::Delete(Agent::GetInstance()->interface_table(),
+                        MakeUuid(2), VmInterface::INSTANCE_MSG);
+    client->WaitForIdle();
+    WAIT_FOR(1000, 10000, (EvpnRouteCount(base, count) == 0));
+}
+
 int main(int argc, char *argv[]) {
     GETUSERARGS();
     client = TestInit(init_file, ksync_init);
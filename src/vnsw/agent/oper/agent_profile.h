@@ -63,11 +63,11 @@ public:
         FlowTokenStats token_stats_;
         WorkQueueStats pkt_handler_queue_;
         WorkQueueStats flow_mgmt_queue_;
-        WorkQueueStats flow_update_queue_;
         std::vector<WorkQueueStats> flow_event_queue_;
         std::vector<WorkQueueStats> flow_tokenless_queue_;
         std::vector<WorkQueueStats> flow_delete_queue_;
         std::vector<WorkQueueStats> flow_ksync_queue_;
+        std::vector<WorkQueueStats> flow_update_queue_;
         std::vector<WorkQueueStats> flow_stats_queue_;
         void Get();
         void Reset();
@@ -5,6 +5,7 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <vnc_cfg_types.h>
+#include <base/time_util.h>
 #include <base/util.h>
 #include <db/db_partition.h>
 
@@ -15,6 +16,7 @@
 #include <oper/operdb_init.h>
 #include <oper/ifmap_dependency_manager.h>
 #include <oper/config_manager.h>
+#include <oper/agent_profile_types.h>
 
 #include <oper/interface_common.h>
 #include <oper/health_check.h>
@@ -79,13 +81,55 @@ IFMapNode *ConfigHelper::FindLink(const char *type,
     return NULL;
 }
 
+// Histogram of the time entries spend in a change list
+class ConfigManagerLatencyStats {
+public:
+    ConfigManagerLatencyStats() : max_usec_(0) {
+        for (uint32_t i = 0; i < ConfigManager::kLatencyBucketCount; i++) {
+            histogram_[i] = 0;
+        }
+    }
+
+    void Update(uint64_t enqueue_time, uint64_t now) {
+        uint64_t usec = (now > enqueue_time) ? (now - enqueue_time) : 0;
+        if (usec > max_usec_)
+            max_usec_ = usec;
+
+        uint64_t bound = 1000;
+        uint32_t bucket = 0;
+        while (bucket < (ConfigManager::kLatencyBucketCount - 1) &&
+               usec >= bound) {
+            bound *= 10;
+            bucket++;
+        }
+        histogram_[bucket]++;
+    }
+
+    void Get(std::vector<uint64_t> *histogram, uint64_t *max_usec) const {
+        histogram->assign(histogram_,
+                          histogram_ + ConfigManager::kLatencyBucketCount);
+        *max_usec = max_usec_;
+    }
+
+private:
+    uint64_t histogram_[ConfigManager::kLatencyBucketCount];
+    uint64_t max_usec_;
+};
+
 class ConfigManagerNodeList {
 public:
     struct Node {
-        Node(IFMapDependencyManager::IFMapNodePtr state) : state_(state) { }
+        Node(IFMapDependencyManager::IFMapNodePtr state) :
+            state_(state), enqueue_time_(0) { }
+        Node(IFMapDependencyManager::IFMapNodePtr state,
+             uint64_t enqueue_time) :
+            state_(state), enqueue_time_(enqueue_time) { }
         ~Node() { }
 
         IFMapDependencyManager::IFMapNodePtr state_;
+        // Time of the first enqueue. Later enqueues of the same node are
+        // compressed and do not update it.
+        uint64_t enqueue_time_;
     };
 
     struct NodeCmp {
@@ -96,14 +140,16 @@ public:
     typedef std::set<Node, NodeCmp> NodeList;
     typedef NodeList::iterator NodeListIterator;
 
-    ConfigManagerNodeList(AgentDBTable *table) :
-        table_(table), oper_ifmap_table_(NULL), enqueue_count_(0),
-        process_count_(0) {
+    ConfigManagerNodeList(const char *name, ConfigManager::Priority priority,
+                          AgentDBTable *table) :
+        name_(name), priority_(priority), table_(table),
+        oper_ifmap_table_(NULL), enqueue_count_(0), process_count_(0) {
     }
 
-    ConfigManagerNodeList(OperIFMapTable *table) :
-        table_(NULL), oper_ifmap_table_(table), enqueue_count_(0),
-        process_count_(0) {
+    ConfigManagerNodeList(const char *name, ConfigManager::Priority priority,
+                          OperIFMapTable *table) :
+        name_(name), priority_(priority), table_(NULL),
+        oper_ifmap_table_(table), enqueue_count_(0), process_count_(0) {
     }
 
     ~ConfigManagerNodeList() {
@@ -112,7 +158,7 @@ public:
 
     bool Add(Agent *agent, ConfigManager *mgr, IFMapNode *node) {
         IFMapDependencyManager *dep = agent->oper_db()->dependency_manager();
-        Node n(dep->SetState(node));
+        Node n(dep->SetState(node), UTCTimestampUsec());
         list_.insert(n);
         enqueue_count_++;
         mgr->Start();
@@ -131,6 +177,7 @@ public:
 
     uint32_t Process(uint32_t weight) {
         uint32_t count = 0;
+        uint64_t now = weight ? UTCTimestampUsec() : 0;
         NodeListIterator it = list_.begin();
         while (weight && (it != list_.end())) {
             NodeListIterator prev = it++;
@@ -149,6 +196,7 @@ public:
                 oper_ifmap_table_->ProcessConfig(node);
             }
 
+            latency_.Update(prev->enqueue_time_, now);
             list_.erase(prev);
             weight--;
             count++;
@@ -158,16 +206,22 @@ public:
         return count;
     }
 
+    const std::string &name() const { return name_; }
+    ConfigManager::Priority priority() const { return priority_; }
     uint32_t Size() const { return list_.size(); }
     uint32_t enqueue_count() const { return enqueue_count_; }
     uint32_t process_count() const { return process_count_; }
+    const ConfigManagerLatencyStats &latency() const { return latency_; }
 
 private:
+    std::string name_;
+    ConfigManager::Priority priority_;
     AgentDBTable *table_;
     OperIFMapTable *oper_ifmap_table_;
     NodeList list_;
     uint32_t enqueue_count_;
     uint32_t process_count_;
+    ConfigManagerLatencyStats latency_;
     DISALLOW_COPY_AND_ASSIGN(ConfigManagerNodeList);
 };
 
@@ -175,13 +229,20 @@ class ConfigManagerDeviceVnList {
 public:
     struct DeviceVnEntry {
         DeviceVnEntry(const boost::uuids::uuid &dev,
-                      const boost::uuids::uuid &vn) : dev_(dev), vn_(vn) {
+                      const boost::uuids::uuid &vn) :
+            dev_(dev), vn_(vn), enqueue_time_(0) {
+        }
+
+        DeviceVnEntry(const boost::uuids::uuid &dev,
+                      const boost::uuids::uuid &vn, uint64_t enqueue_time) :
+            dev_(dev), vn_(vn), enqueue_time_(enqueue_time) {
         }
 
         ~DeviceVnEntry() { }
 
         boost::uuids::uuid dev_;
         boost::uuids::uuid vn_;
+        uint64_t enqueue_time_;
     };
 
     struct DeviceVnEntryCmp {
@@ -206,7 +267,7 @@ public:
 
     bool Add(Agent *agent, ConfigManager *mgr, const boost::uuids::uuid &dev,
              const boost::uuids::uuid &vn) {
-        list_.insert(DeviceVnEntry(dev, vn));
+        list_.insert(DeviceVnEntry(dev, vn, UTCTimestampUsec()));
         enqueue_count_++;
         mgr->Start();
         return true;
@@ -220,14 +281,17 @@ public:
 
     uint32_t Process(uint32_t weight) {
         uint32_t count = 0;
+        uint64_t now = weight ? UTCTimestampUsec() : 0;
         DeviceVnIterator it = list_.begin();
         while (weight && (it != list_.end())) {
             DeviceVnIterator prev = it++;
             DBRequest req;
             table_->ProcessConfig(prev->dev_, prev->vn_);
+            latency_.Update(prev->enqueue_time_, now);
             list_.erase(prev);
             weight--;
             count++;
+            process_count_++;
         }
         return count;
     }
@@ -235,12 +299,14 @@ public:
     uint32_t Size() const { return list_.size(); }
     uint32_t enqueue_count() const { return enqueue_count_; }
     uint32_t process_count() const { return process_count_; }
+    const ConfigManagerLatencyStats &latency() const { return latency_; }
 
 private:
     PhysicalDeviceVnTable *table_;
     DeviceVnList list_;
     uint32_t enqueue_count_;
     uint32_t process_count_;
+    ConfigManagerLatencyStats latency_;
     DISALLOW_COPY_AND_ASSIGN(ConfigManagerDeviceVnList);
 };
 
@@ -264,100 +330,102 @@ ConfigManager::~ConfigManager() {
     TimerManager::DeleteTimer(timer_);
 }
 
+ConfigManagerNodeList *ConfigManager::AddNodeList(
+    ConfigManagerNodeList *list) {
+    node_lists_.push_back(list);
+    return list;
+}
+
+// Lists are run in the order they are added here. Lists of the same priority
+// must be added in dependency order i.e. a list must be added after the lists
+// for objects it refers to. Lists on the critical path to forwarding must not
+// depend on NORMAL lists.
 void ConfigManager::Init() {
     AgentDBTable *intf_table = agent_->interface_table();
-    vmi_list_.reset(new ConfigManagerNodeList(intf_table));
-    physical_interface_list_.reset(new ConfigManagerNodeList(intf_table));
-    logical_interface_list_.reset(new ConfigManagerNodeList(intf_table));
-
-    device_list_.reset(new ConfigManagerNodeList
-                       (agent_->physical_device_table()));
-    sg_list_.reset(new ConfigManagerNodeList(agent_->sg_table()));
-    tag_list_.reset(new ConfigManagerNodeList(agent_->tag_table()));
-    vn_list_.reset(new ConfigManagerNodeList(agent_->vn_table()));
-    vrf_list_.reset(new ConfigManagerNodeList(agent_->vrf_table()));
-    vm_list_.reset(new ConfigManagerNodeList(agent_->vm_table()));
-    hc_list_.reset(new ConfigManagerNodeList
-                       (agent_->health_check_table()));
-    bridge_domain_list_.reset(new ConfigManagerNodeList(
-                                  agent_->bridge_domain_table()));
-    policy_set_list_.reset(new ConfigManagerNodeList(
-                                  agent_->policy_set_table()));
-    qos_config_list_.reset(new ConfigManagerNodeList(agent_->qos_config_table()));
+    OperDB *oper_db = agent()->oper_db();
+    node_lists_.clear();
+
+    global_vrouter_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("global-vrouter-config", CRITICAL, oper_db->global_vrouter())));
+    bgp_router_config_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("bgp-router", CRITICAL, oper_db->bgp_router_config())));
+    virtual_router_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("virtual-router", CRITICAL, oper_db->vrouter())));
+    global_qos_config_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("global-qos-config", CRITICAL, oper_db->global_qos_config())));
+    global_system_config_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("global-system-config", CRITICAL, oper_db->global_system_config())));
+    network_ipam_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("network-ipam", CRITICAL, oper_db->network_ipam())));
+    virtual_dns_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("virtual-DNS", NORMAL, oper_db->virtual_dns())));
+    sg_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("security-group", CRITICAL, agent_->sg_table())));
+    tag_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("tag", CRITICAL, agent_->tag_table())));
+    physical_interface_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("physical-interface", CRITICAL, intf_table)));
+    qos_queue_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("qos-queue", CRITICAL, agent_->qos_queue_table())));
+    forwarding_class_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("forwarding-class", CRITICAL, agent_->forwarding_class_table())));
+    qos_config_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("qos-config", CRITICAL, agent_->qos_config_table())));
+    vn_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("virtual-network", CRITICAL, agent_->vn_table())));
+    vm_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("virtual-machine", CRITICAL, agent_->vm_table())));
+    vrf_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("routing-instance", CRITICAL, agent_->vrf_table())));
+    bridge_domain_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("bridge-domain", CRITICAL, agent_->bridge_domain_table())));
+    policy_set_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("application-policy-set", CRITICAL, agent_->policy_set_table())));
+    logical_interface_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("logical-interface", CRITICAL, intf_table)));
+    vmi_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("virtual-machine-interface", CRITICAL, intf_table)));
+    hc_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("service-health-check", NORMAL, agent_->health_check_table())));
+    device_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("physical-router", NORMAL, agent_->physical_device_table())));
+    slo_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("security-logging-object", NORMAL, agent_->slo_table())));
+    mp_list_.reset(AddNodeList(new ConfigManagerNodeList
+        ("multicast-policy", NORMAL, agent_->mp_table())));
+
     device_vn_list_.reset(new ConfigManagerDeviceVnList
                           (agent_->physical_device_vn_table()));
-    qos_queue_list_.reset(new ConfigManagerNodeList(agent_->qos_queue_table()));
-    forwarding_class_list_.reset(new
-            ConfigManagerNodeList(agent_->forwarding_class_table()));
-    slo_list_.reset(new
-            ConfigManagerNodeList(agent_->slo_table()));
-    mp_list_.reset(new ConfigManagerNodeList(agent_->mp_table()));
-
-    OperDB *oper_db = agent()->oper_db();
-    global_vrouter_list_.reset
-        (new ConfigManagerNodeList(oper_db->global_vrouter()));
-    bgp_router_config_list_.reset
-        (new ConfigManagerNodeList(oper_db->bgp_router_config()));
-    virtual_router_list_.reset
-        (new ConfigManagerNodeList(oper_db->vrouter()));
-    global_qos_config_list_.reset
-        (new ConfigManagerNodeList(oper_db->global_qos_config()));
-    global_system_config_list_.reset
-        (new ConfigManagerNodeList(oper_db->global_system_config()));
-    network_ipam_list_.reset
-        (new ConfigManagerNodeList(oper_db->network_ipam()));
-    virtual_dns_list_.reset(new ConfigManagerNodeList(oper_db->virtual_dns()));
 }
 
 uint32_t ConfigManager::Size() const {
-    return
-        global_vrouter_list_->Size() +
-        bgp_router_config_list_->Size() +
-        virtual_router_list_->Size() +
-        global_qos_config_list_->Size() +
-        global_system_config_list_->Size() +
-        network_ipam_list_->Size() + + +
-        virtual_dns_list_->Size() +
-        vmi_list_->Size() +
-        physical_interface_list_->Size() +
-        logical_interface_list_->Size() +
-        device_list_->Size() +
-        sg_list_->Size() +
-        tag_list_->Size() +
-        vn_list_->Size() +
-        vrf_list_->Size() +
-        vm_list_->Size() +
-        hc_list_->Size() +
-        device_vn_list_->Size() +
-        qos_config_list_->Size() +
-        bridge_domain_list_->Size() +
-        policy_set_list_->Size() +
-        mp_list_->Size();
+    uint32_t size = device_vn_list_->Size();
+    for (NodeListVector::const_iterator it = node_lists_.begin();
+         it != node_lists_.end(); ++it) {
+        size += (*it)->Size();
+    }
+    return size;
+}
+
+uint32_t ConfigManager::Size(Priority priority) const {
+    uint32_t size = 0;
+    if (priority == NORMAL)
+        size += device_vn_list_->Size();
+    for (NodeListVector::const_iterator it = node_lists_.begin();
+         it != node_lists_.end(); ++it) {
+        if ((*it)->priority() == priority)
+            size += (*it)->Size();
+    }
+    return size;
 }
 
 uint32_t ConfigManager::ProcessCount() const {
-    return
-        global_vrouter_list_->process_count() +
-        bgp_router_config_list_->process_count() +
-        virtual_router_list_->process_count() +
-        global_qos_config_list_->process_count() +
-        global_system_config_list_->process_count() +
-        network_ipam_list_->process_count() +
-        virtual_dns_list_->process_count() +
-        vmi_list_->process_count() +
-        physical_interface_list_->process_count() +
-        logical_interface_list_->process_count() +
-        device_list_->process_count() +
-        sg_list_->process_count() +
-        tag_list_->process_count() +
-        vn_list_->process_count() +
-        vrf_list_->process_count() +
-        vm_list_->process_count() +
-        hc_list_->process_count() +
-        device_vn_list_->process_count() +
-        qos_config_list_->process_count() +
-        policy_set_list_->process_count() +
-        mp_list_->process_count();
+    uint32_t count = device_vn_list_->process_count();
+    for (NodeListVector::const_iterator it = node_lists_.begin();
+         it != node_lists_.end(); ++it) {
+        count += (*it)->process_count();
+    }
+    return count;
 }
 
 void ConfigManager::Start() {
@@ -398,36 +466,31 @@ bool ConfigManager::TriggerRun() {
     return (Size() == 0);
 }
 
-// Run the change-list
+// Run the lists of one priority, upto max_count entries
+uint32_t ConfigManager::Run(Priority priority, uint32_t max_count) {
+    uint32_t count = 0;
+    for (NodeListVector::const_iterator it = node_lists_.begin();
+         it != node_lists_.end() && count < max_count; ++it) {
+        if ((*it)->priority() == priority)
+            count += (*it)->Process(max_count - count);
+    }
+    if (priority == NORMAL)
+        count += device_vn_list_->Process(max_count - count);
+    return count;
+}
+
+// Run the change-list. CRITICAL lists are run first. NORMAL lists get what
+// is left of the run, and at least kNormalIterationCount entries.
 int ConfigManager::Run() {
     uint32_t max_count = kIterationCount;
     uint32_t count = 0;
 
-    count += global_vrouter_list_->Process(max_count - count);
-    count += bgp_router_config_list_->Process(max_count - count);
-    count += virtual_router_list_->Process(max_count - count);
-    count += global_qos_config_list_->Process(max_count - count);
-    count += global_system_config_list_->Process(max_count - count);
-    count += network_ipam_list_->Process(max_count - count);
-    count += virtual_dns_list_->Process(max_count - count);
-    count += sg_list_->Process(max_count - count);
-    count += tag_list_->Process(max_count - count);
-    count += physical_interface_list_->Process(max_count - count);
-    count += qos_queue_list_->Process(max_count - count);
-    count += forwarding_class_list_->Process(max_count - count);
-    count += qos_config_list_->Process(max_count - count);
-    count += vn_list_->Process(max_count - count);
-    count += vm_list_->Process(max_count - count);
-    count += vrf_list_->Process(max_count - count);
-    count += bridge_domain_list_->Process(max_count - count);
-    count += policy_set_list_->Process(max_count - count);
-    count += logical_interface_list_->Process(max_count - count);
-    count += hc_list_->Process(max_count - count);
-    count += vmi_list_->Process(max_count - count);
-    count += device_list_->Process(max_count - count);
-    count += device_vn_list_->Process(max_count - count);
-    count += slo_list_->Process(max_count - count);
-    count += mp_list_->Process(max_count - count);
+    uint32_t reserve = 0;
+    if (Size(NORMAL) != 0)
+        reserve = kNormalIterationCount;
+
+    count += Run(CRITICAL, max_count - reserve);
+    count += Run(NORMAL, max_count - count);
     return count;
 }
 
@@ -568,6 +631,54 @@ string ConfigManager::ProfileInfo() const {
     return str.str();
 }
 
+void ConfigManager::GetTypeStats
+(std::vector<SandeshConfigManagerTypeStats> *list) const {
+    for (NodeListVector::const_iterator it = node_lists_.begin();
+         it != node_lists_.end(); ++it) {
+        const ConfigManagerNodeList *node_list = *it;
+        SandeshConfigManagerTypeStats stats;
+        stats.set_type(node_list->name());
+        stats.set_priority(node_list->priority() == CRITICAL ?
+                           "critical" : "normal");
+        stats.set_queue_len(node_list->Size());
+        stats.set_enqueue_count(node_list->enqueue_count());
+        stats.set_process_count(node_list->process_count());
+        std::vector<uint64_t> histogram;
+        uint64_t max_usec = 0;
+        node_list->latency().Get(&histogram, &max_usec);
+        stats.set_latency_histogram(histogram);
+        stats.set_max_latency_usec(max_usec);
+        list->push_back(stats);
+    }
+
+    SandeshConfigManagerTypeStats stats;
+    stats.set_type("physical-router-virtual-network");
+    stats.set_priority("normal");
+    stats.set_queue_len(device_vn_list_->Size());
+    stats.set_enqueue_count(device_vn_list_->enqueue_count());
+    stats.set_process_count(device_vn_list_->process_count());
+    std::vector<uint64_t> histogram;
+    uint64_t max_usec = 0;
+    device_vn_list_->latency().Get(&histogram, &max_usec);
+    stats.set_latency_histogram(histogram);
+    stats.set_max_latency_usec(max_usec);
+    list->push_back(stats);
+}
+
+void SandeshConfigManagerStatsRequest::HandleRequest() const {
+    SandeshConfigManagerStatsResp *resp = new SandeshConfigManagerStatsResp();
+    ConfigManager *mgr = Agent::GetInstance()->config_manager();
+
+    resp->set_queue_len(mgr->Size());
+    resp->set_timeout(mgr->timeout());
+    resp->set_process_count(mgr->ProcessCount());
+    std::vector<SandeshConfigManagerTypeStats> list;
+    mgr->GetTypeStats(&list);
+    resp->set_types(list);
+    resp->set_context(context());
+    resp->Response();
+}
+
 // When traversing graph, check if an IFMapNode can be used. Conditions are,
 // - The node is not in deleted state
 // - The node was notified earlier
@@ -30,6 +30,13 @@
  * logical-interfaces
  * physical-device-vn
  * physical-router
+ *
+ * Each change list has a priority. Lists on the critical path to forwarding
+ * (VN, VRF, VMI and everything they depend on) are run ahead of the rest, in
+ * dependency order. Lists of lower priority are guaranteed a small share of
+ * each run so that they are not starved during config churn. Each list keeps
+ * a histogram of the time nodes spend queued, see
+ * SandeshConfigManagerStatsRequest.
  *****************************************************************************/
 
 #include <cmn/agent_cmn.h>
@@ -40,6 +47,7 @@
 class ConfigManagerNodeList;
 class ConfigManagerDeviceVnList;
 class IFMapAgentLinkTable;
+class SandeshConfigManagerTypeStats;
 
 class ConfigHelper {
 public:
@@ -59,10 +67,21 @@ private:
 
 class ConfigManager {
 public:
+    enum Priority {
+        CRITICAL,
+        NORMAL,
+        PRIORITY_COUNT
+    };
+
     // Number of changelist entries to pick in one run
     const static uint32_t kIterationCount = 64;
+    // Entries of one run reserved for NORMAL lists when they are not empty
+    const static uint32_t kNormalIterationCount = 8;
     const static uint32_t kMinTimeout = 1;
     const static uint32_t kMaxTimeout = 10;
+    // Queue latency histogram buckets. Upper bound of bucket i is
+    // 10^i msec, the last bucket is unbounded.
+    const static uint32_t kLatencyBucketCount = 6;
 
     ConfigManager(Agent *agent);
     virtual ~ConfigManager();
@@ -112,6 +131,8 @@ public:
     void AddPolicySetNode(IFMapNode *node);
     void AddProjectNode(IFMapNode *node);
     uint32_t PhysicalDeviceVnCount() const;
+    uint32_t Size(Priority priority) const;
+    void GetTypeStats(std::vector<SandeshConfigManagerTypeStats> *list) const;
     bool CanUseNode(IFMapNode *node);
     bool CanUseNode(IFMapNode *node, IFMapAgentTable *table);
     bool SkipNode(IFMapNode *node);
@@ -124,6 +145,10 @@ public:
     Agent *agent() { return agent_; }
 
 private:
+    typedef std::vector<ConfigManagerNodeList *> NodeListVector;
+    ConfigManagerNodeList *AddNodeList(ConfigManagerNodeList *list);
+    uint32_t Run(Priority priority, uint32_t max_count);
+
     Agent *agent_;
     std::auto_ptr<TaskTrigger> trigger_;
     Timer *timer_;
@@ -158,6 +183,8 @@ private:
     std::auto_ptr<ConfigManagerNodeList> global_system_config_list_;
     std::auto_ptr<ConfigManagerNodeList> project_list_;
 
+    // All node lists in the order they are run
+    NodeListVector node_lists_;
     uint64_t process_config_count_[kMaxTimeout + 1];
     boost::scoped_ptr<ConfigHelper> helper_;
     DISALLOW_COPY_AND_ASSIGN(ConfigManager);
@@ -66,7 +66,8 @@ void intrusive_ptr_release(IFMapNodeState *state) {
 
 IFMapDependencyManager::IFMapDependencyManager(DB *database, DBGraph *graph)
         : database_(database),
-          graph_(graph) {
+          graph_(graph), batch_count_(0), node_event_count_(0),
+          node_event_suppressed_(0), change_count_(0), change_suppressed_(0) {
     tracker_.reset(
         new IFMapDependencyTracker(
             database, graph,
@@ -246,13 +247,27 @@ void IFMapDependencyManager::Terminate() {
     event_map_.clear();
 }
 
+// Process one batch of changes. All node and link events received since the
+// last run are propagated together, so a node reachable from many changed
+// nodes is notified only once per batch. Nodes added to the change list by
+// the handlers are processed in the next batch.
 bool IFMapDependencyManager::ProcessChangeList() {
+    batch_count_++;
+    for (ChangeList::iterator iter = node_event_list_.begin();
+         iter != node_event_list_.end(); ++iter) {
+        (*iter)->set_node_event_pending(false);
+    }
+    node_event_list_.clear();
+
     tracker_->PropagateChanges();
     tracker_->Clear();
 
-    for (ChangeList::iterator iter = change_list_.begin();
-         iter != change_list_.end(); ++iter) {
+    ChangeList change_list;
+    change_list.swap(change_list_);
+    for (ChangeList::iterator iter = change_list.begin();
+         iter != change_list.end(); ++iter) {
         IFMapNodeState *state = iter->get();
+        state->set_on_change_list(false);
         IFMapTable *table = state->node()->table();
         EventMap::iterator loc = event_map_.find(table->Typename());
         if (loc == event_map_.end()) {
@@ -263,15 +278,37 @@ bool IFMapDependencyManager::ProcessChangeList() {
             loc->second(state->node(), state->object());
         }
     }
-    change_list_.clear();
     return true;
 }
 
+// Queue a node event to the tracker, unless one is already pending for the
+// node in this batch. Propagation only looks at the latest state of the graph,
+// so a second event for the same node adds nothing but walking all its edges
+// again.
+void IFMapDependencyManager::NodeEvent(IFMapNode *node) {
+    IFMapNodeState *state = IFMapNodeGet(node);
+    if (state && state->node_event_pending()) {
+        node_event_suppressed_++;
+        return;
+    }
+
+    node_event_count_++;
+    tracker_->NodeEvent(node);
+
+    // The node event puts the node on the change list, which sets the state
+    // if the node is not deleted.
+    state = IFMapNodeGet(node);
+    if (state) {
+        state->set_node_event_pending(true);
+        node_event_list_.push_back(IFMapNodePtr(state));
+    }
+}
+
 void IFMapDependencyManager::NodeObserver(
     DBTablePartBase *root, DBEntryBase *db_entry) {
 
     IFMapNode *node = static_cast<IFMapNode *>(db_entry);
-    tracker_->NodeEvent(node);
+    NodeEvent(node);
     trigger_->Set();
 }
 
@@ -323,13 +360,22 @@ void IFMapDependencyManager::LinkObserver(
 }
 
 void IFMapDependencyManager::ChangeListAdd(IFMapNode *node) {
-    IFMapNodeState *state = IFMapNodeGet(node);
+    IFMapNodePtr state(IFMapNodeGet(node));
     if (state == NULL) {
-        if (node->IsDeleted() == false)
-            change_list_.push_back(SetState(node));
-    } else {
-        change_list_.push_back(IFMapNodePtr(state));
+        if (node->IsDeleted())
+            return;
+        state = SetState(node);
+        if (state == NULL)
+            return;
+    }
+
+    if (state->on_change_list()) {
+        change_suppressed_++;
+        return;
     }
+    state->set_on_change_list(true);
+    change_list_.push_back(state);
+    change_count_++;
 }
 
 IFMapNodeState *
@@ -370,7 +416,7 @@ void IFMapDependencyManager::SetObject(IFMapNode *node, DBEntry *entry) {
 
     if (entry) {
         state->set_object(entry);
-        tracker_->NodeEvent(node);
+        NodeEvent(node);
         trigger_->Set();
     }
 }
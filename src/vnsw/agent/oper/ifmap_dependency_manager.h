@@ -39,7 +39,8 @@ class IFMapNodeState : public DBState {
     IFMapNodeState(IFMapDependencyManager *manager, IFMapNode *node)
             : manager_(manager), node_(node), object_(NULL),
             uuid_(boost::uuids::nil_uuid()), refcount_(0),
-            notify_(true), oper_db_request_enqueued_(false) {
+            notify_(true), oper_db_request_enqueued_(false),
+            on_change_list_(false), node_event_pending_(false) {
     }
 
     IFMapNode *node() { return node_; }
@@ -72,6 +73,14 @@ class IFMapNodeState : public DBState {
         return oper_db_request_enqueued_;
     }
 
+    // Set while the node is on the change list of the current batch
+    bool on_change_list() const { return on_change_list_; }
+    void set_on_change_list(bool flag) { on_change_list_ = flag; }
+
+    // Set while a node event for the node is pending with the tracker
+    bool node_event_pending() const { return node_event_pending_; }
+    void set_node_event_pending(bool flag) { node_event_pending_ = flag; }
+
   private:
     friend void intrusive_ptr_add_ref(IFMapNodeState *state);
     friend void intrusive_ptr_release(IFMapNodeState *state);
@@ -83,6 +92,8 @@ class IFMapNodeState : public DBState {
     int refcount_;
     bool notify_;
     bool oper_db_request_enqueued_;
+    bool on_change_list_;
+    bool node_event_pending_;
 };
 
 
@@ -162,6 +173,13 @@ public:
     void enable_trigger() {trigger_->set_enable();}
     void disable_trigger() {trigger_->set_disable();}
 
+    // Statistics
+    uint64_t batch_count() const { return batch_count_; }
+    uint64_t node_event_count() const { return node_event_count_; }
+    uint64_t node_event_suppressed() const { return node_event_suppressed_; }
+    uint64_t change_count() const { return change_count_; }
+    uint64_t change_suppressed() const { return change_suppressed_; }
+
 private:
     /*
      * IFMapNodeState (DBState) should exist:
@@ -180,6 +198,7 @@ private:
     void NodeObserver(DBTablePartBase *root, DBEntryBase *db_entry);
     void LinkObserver(DBTablePartBase *root, DBEntryBase *db_entry);
     void ChangeListAdd(IFMapNode *node);
+    void NodeEvent(IFMapNode *node);
 
     void IFMapNodeReset(IFMapNode *node);
 
@@ -190,7 +209,16 @@ private:
     std::auto_ptr<TaskTrigger> trigger_;
     TableMap table_map_;
     EventMap event_map_;
+    // Nodes to be notified in the next batch, in the order they were first
+    // added. A node is on the list at most once.
     ChangeList change_list_;
+    // Nodes with a node event pending with the tracker
+    ChangeList node_event_list_;
+    uint64_t batch_count_;
+    uint64_t node_event_count_;
+    uint64_t node_event_suppressed_;
+    uint64_t change_count_;
+    uint64_t change_suppressed_;
 };
 
 #endif
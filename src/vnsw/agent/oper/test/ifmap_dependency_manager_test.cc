@@ -10,6 +10,7 @@
 #include <boost/bind.hpp>
 
 #include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "db/db.h"
 #include "db/db_graph.h"
 #include "db/db_table_partition.h"
@@ -539,6 +540,78 @@ TEST_F(IFMapDependencyManagerTest, OperSeesDeletedConfigNode) {
     task_util::WaitForIdle();
 }
 
+// Repeated changes to a node within a batch must be coalesced, so that the
+// dependent service-instance is notified only once
+TEST_F(IFMapDependencyManagerTest, NodeEventCoalesce) {
+    typedef IFMapDependencyManagerTest_NodeEventCoalesce_Test TestClass;
+
+    ifmap_test_util::IFMapMsgNodeAdd(database_, "service-instance", "si-1");
+    ifmap_test_util::IFMapMsgNodeAdd(database_, "virtual-machine", "vm-1");
+    ifmap_test_util::IFMapMsgNodeAdd(database_,
+            "virtual-machine-interface", "vmi-1");
+    ifmap_test_util::IFMapMsgLink(database_, "service-instance", "si-1",
+                                  "virtual-machine", "vm-1",
+                                  "virtual-machine-service-instance");
+    ifmap_test_util::IFMapMsgLink(database_, "virtual-machine", "vm-1",
+                                  "virtual-machine-interface", "vmi-1",
+                                  "virtual-machine-interface-virtual-machine");
+    task_util::WaitForIdle();
+
+    dependency_manager_->Unregister("service-instance");
+    dependency_manager_->Register(
+        "service-instance",
+        boost::bind(&TestClass::ChangeEventHandler, this, _1, _2));
+
+    uint32_t count = 100;
+    if (const char *env = getenv("IFMAP_DEPENDENCY_TEST_UPDATE_COUNT"))
+        count = strtoul(env, NULL, 0);
+
+    uint64_t batch_count = dependency_manager_->batch_count();
+    uint64_t suppressed = dependency_manager_->node_event_suppressed();
+
+    dependency_manager_->disable_trigger();
+    change_list_.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        ifmap_test_util::IFMapMsgNodeAdd(database_, "virtual-machine", "vm-1");
+        task_util::WaitForIdle();
+    }
+    EXPECT_EQ(0U, change_list_.size());
+    EXPECT_EQ(count - 1, dependency_manager_->node_event_suppressed() -
+              suppressed);
+
+    uint64_t start = UTCTimestampUsec();
+    dependency_manager_->enable_trigger();
+    task_util::WaitForIdle();
+    cout << "Processed " << count << " updates in "
+         << (UTCTimestampUsec() - start) << " usec" << endl;
+
+    int seen = 0;
+    std::vector<IFMapNode *>::iterator it;
+    for (it = change_list_.begin(); it != change_list_.end(); it++) {
+        IFMapNode *n = *it;
+        if (n->name() == "si-1")
+            seen++;
+    }
+    EXPECT_EQ(1, seen);
+    EXPECT_LT(batch_count, dependency_manager_->batch_count());
+
+    dependency_manager_->Unregister("service-instance");
+    agent_->service_instance_table()->Initialize(agent_->cfg()->cfg_graph(),
+                dependency_manager_);
+    ifmap_test_util::IFMapMsgUnlink(database_, "service-instance", "si-1",
+                                  "virtual-machine", "vm-1",
+                                  "virtual-machine-service-instance");
+    ifmap_test_util::IFMapMsgUnlink(database_, "virtual-machine", "vm-1",
+                                  "virtual-machine-interface", "vmi-1",
+                                  "virtual-machine-interface-virtual-machine");
+    ifmap_test_util::IFMapMsgNodeDelete(database_, "service-instance", "si-1");
+    ifmap_test_util::IFMapMsgNodeDelete(database_, "virtual-machine", "vm-1");
+    ifmap_test_util::IFMapMsgNodeDelete(database_,
+            "virtual-machine-interface", "vmi-1");
+
+    task_util::WaitForIdle();
+}
+
 static void SetUp() {
 }
 
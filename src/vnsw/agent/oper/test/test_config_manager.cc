@@ -9,7 +9,9 @@
 #include "testing/gunit.h"
 #include "test/test_cmn_util.h"
 #include <boost/assign/list_of.hpp>
+#include "base/time_util.h"
 #include "base/util.h"
+#include "oper/agent_profile_types.h"
 #include "oper/config_manager.h"
 #include "oper/physical_device_vn.h"
 
@@ -156,6 +158,95 @@ TEST_F(ConfigManagerTest, intf_3) {
     DelInterface(ConfigManager::kIterationCount * 2);
 }
 
+// Port addresses and MACs are derived from the index in the last octet,
+// which limits the number of ports
+static const uint32_t kMaxRestartPortCount = 250;
+
+static uint32_t GetRestartPortCount() {
+    char *str = getenv("CONFIG_MANAGER_TEST_RESTART_PORT_COUNT");
+    return str ? strtoul(str, NULL, 0) : 200;
+}
+
+static const SandeshConfigManagerTypeStats *FindTypeStats(
+    const std::vector<SandeshConfigManagerTypeStats> &list,
+    const std::string &type) {
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].get_type() == type)
+            return &list[i];
+    }
+    return NULL;
+}
+
+// Simulate a restart: ports and unrelated physical-routers are all queued
+// at once. Report the time for all ports to become active and verify the
+// per type latency histograms.
+TEST_F(ConfigManagerTest, restart_1) {
+    uint32_t max_count = GetRestartPortCount();
+    ASSERT_LE(max_count, kMaxRestartPortCount)
+        << "CONFIG_MANAGER_TEST_RESTART_PORT_COUNT must not exceed "
+        << kMaxRestartPortCount;
+    struct PortInfo info[] = {
+        {"vnet", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1}
+    };
+
+    std::vector<SandeshConfigManagerTypeStats> list;
+    mgr_->GetTypeStats(&list);
+    const SandeshConfigManagerTypeStats *vmi_stats =
+        FindTypeStats(list, "virtual-machine-interface");
+    ASSERT_TRUE(vmi_stats != NULL);
+    EXPECT_EQ("critical", vmi_stats->get_priority());
+    uint32_t vmi_process_count = vmi_stats->get_process_count();
+
+    uint64_t start = UTCTimestampUsec();
+    for (uint32_t count = 1; count <= max_count; count++) {
+        char name[32];
+        sprintf(name, "restart-dev-%d", count);
+        AddPhysicalDevice(name, 100 + count);
+        MakePortInfo(info, count);
+        CreateVmportEnv(info, 1);
+    }
+
+    for (uint32_t count = 1; count <= max_count; count++) {
+        WAIT_FOR(1000, 1000, (VmPortActive(count) == true));
+    }
+    uint64_t elapsed = UTCTimestampUsec() - start;
+    cout << "Restart with " << max_count << " ports took "
+         << elapsed / 1000 << " msec" << endl;
+
+    client->WaitForIdle();
+    list.clear();
+    mgr_->GetTypeStats(&list);
+    vmi_stats = FindTypeStats(list, "virtual-machine-interface");
+    ASSERT_TRUE(vmi_stats != NULL);
+    EXPECT_LE(vmi_process_count + max_count, vmi_stats->get_process_count());
+    uint64_t histogram_count = 0;
+    const std::vector<uint64_t> &histogram =
+        vmi_stats->get_latency_histogram();
+    EXPECT_EQ((size_t)ConfigManager::kLatencyBucketCount, histogram.size());
+    for (size_t i = 0; i < histogram.size(); i++) {
+        histogram_count += histogram[i];
+    }
+    EXPECT_EQ(vmi_stats->get_process_count(), histogram_count);
+
+    const SandeshConfigManagerTypeStats *device_stats =
+        FindTypeStats(list, "physical-router");
+    ASSERT_TRUE(device_stats != NULL);
+    EXPECT_EQ("normal", device_stats->get_priority());
+    EXPECT_EQ(0U, device_stats->get_queue_len());
+
+    for (uint32_t count = 1; count <= max_count; count++) {
+        char name[32];
+        sprintf(name, "restart-dev-%d", count);
+        DeletePhysicalDevice(name);
+        MakePortInfo(info, count);
+        DeleteVmportEnv(info, 1, true);
+    }
+    client->WaitForIdle();
+    for (uint32_t count = 1; count <= max_count; count++) {
+        WAIT_FOR(1000, 1000, (VmPortFind(count) == false));
+    }
+}
+
 int main(int argc, char **argv) {
     GETUSERARGS();
     client = TestInit(init_file, ksync_init);
@@ -288,17 +288,20 @@ bool KSyncFlowEventQueue::HandleEvent(FlowEvent *event) {
 }
 
 UpdateFlowEventQueue::UpdateFlowEventQueue(Agent *agent, FlowProto *proto,
+                                           FlowTable *table,
                                            FlowTokenPool *pool,
                                            uint16_t latency_limit,
                                            uint32_t max_iterations) :
     FlowEventQueueBase(proto, "Flow Update Queue",
-                       agent->task_scheduler()->GetTaskId(kTaskFlowUpdate), 0,
-                       pool, latency_limit, max_iterations) {
+                       agent->task_scheduler()->GetTaskId(kTaskFlowUpdate),
+                       table->table_index(), pool, latency_limit,
+                       max_iterations),
+    flow_table_(table) {
 }
 
 UpdateFlowEventQueue::~UpdateFlowEventQueue() {
 }
 
 bool UpdateFlowEventQueue::HandleEvent(FlowEvent *event) {
-    return flow_proto_->FlowUpdateHandler(event);
+    return flow_proto_->FlowUpdateHandler(event, flow_table_);
 }
@@ -344,12 +344,14 @@ private:
 
 class UpdateFlowEventQueue : public FlowEventQueueBase {
 public:
-    UpdateFlowEventQueue(Agent *agent, FlowProto *proto,
+    UpdateFlowEventQueue(Agent *agent, FlowProto *proto, FlowTable *table,
                          FlowTokenPool *pool, uint16_t latency_limit,
                          uint32_t max_iterations);
     virtual ~UpdateFlowEventQueue();
 
     bool HandleEvent(FlowEvent *event);
+private:
+    FlowTable *flow_table_;
 };
 
 #endif //  __AGENT_FLOW_EVENT_H__
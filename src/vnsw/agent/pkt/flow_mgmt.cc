@@ -1,6 +1,9 @@
 #include <bitset>
 #include <boost/uuid/uuid_io.hpp>
+#include <base/time_util.h>
 #include "cmn/agent.h"
+#include "init/agent_param.h"
+#include "oper/agent_profile_types.h"
 #include "controller/controller_init.h"
 #include "oper/bgp_as_service.h"
 #include "oper/health_check.h"
@@ -36,7 +39,17 @@ FlowMgmtManager::FlowMgmtManager(Agent *agent, uint16_t table_index) :
     db_event_queue_(agent_->task_scheduler()->GetTaskId(kTaskFlowMgmt),
                     table_index,
                     boost::bind(&FlowMgmtManager::DBRequestHandler, this, _1),
-                    db_event_queue_.kMaxSize, 1) {
+                    db_event_queue_.kMaxSize, 1),
+    revaluate_pauses_(0),
+    revaluate_trigger_(new TaskTrigger
+                       (boost::bind(&FlowMgmtManager::RevaluateRun, this),
+                        agent_->task_scheduler()->GetTaskId(kTaskFlowMgmt),
+                        table_index)),
+    revaluate_timer_(TimerManager::CreateTimer
+                     (*(agent->event_manager())->io_service(),
+                      "FlowRevaluateTimer",
+                      agent_->task_scheduler()->GetTaskId(kTaskFlowMgmt),
+                      table_index)) {
     request_queue_.set_name("Flow management");
     request_queue_.set_measure_busy_time(agent->MeasureQueueDelay());
     db_event_queue_.set_name("Flow DB Event Queue");
@@ -70,6 +83,14 @@ void FlowMgmtManager::Shutdown() {
     request_queue_.Shutdown();
     db_event_queue_.Shutdown();
     flow_mgmt_dbclient_->Shutdown();
+    revaluate_trigger_->Reset();
+    if (revaluate_timer_) {
+        revaluate_timer_->Cancel();
+        TimerManager::DeleteTimer(revaluate_timer_);
+        revaluate_timer_ = NULL;
+    }
+    revaluate_job_tree_.clear();
+    STLDeleteValues(&revaluate_job_list_);
 }
 
 void FlowMgmtManager::InitLogQueue(Agent *agent) {
@@ -255,6 +276,204 @@ void FlowMgmtManager::FreeDBEntryEvent(FlowEvent::Event event, FlowMgmtKey *key,
     EnqueueFlowEvent(flow_resp);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Flow revaluation jobs
+/////////////////////////////////////////////////////////////////////////////
+void FlowMgmtManager::RevaluateFlows(FlowEvent::Event event, FlowMgmtKey *key,
+                                     const FlowMgmtEntry *entry) {
+    RevaluateStats *stats = &revaluate_stats_[key->type()];
+    const FlowMgmtEntry::FlowList &flow_list = entry->flow_list();
+    FlowMgmtEntry::FlowList::const_iterator it;
+
+    RevaluateJobTree::iterator job_it = revaluate_job_tree_.find(key);
+    if (job_it == revaluate_job_tree_.end() &&
+        entry->Size() <= kRevaluateInlineCount) {
+        for (it = flow_list.begin(); it != flow_list.end(); ++it) {
+            DBEntryEvent(event, key, it->flow_entry());
+            stats->flows_++;
+        }
+        return;
+    }
+
+    RevaluateJob *job = NULL;
+    if (job_it != revaluate_job_tree_.end()) {
+        // Job already pending for the DBEntry. Restart it with latest flows.
+        // Retain the enqueue time so that lag is computed from first change
+        job = job_it->second;
+        stats->coalesced_++;
+    } else {
+        FlowMgmtKey *job_key = key->Clone();
+        // Route keys dont clone the DBEntry
+        job_key->set_db_entry(key->db_entry());
+        job = new RevaluateJob(job_key, UTCTimestampUsec());
+        revaluate_job_tree_.insert(std::make_pair(job_key, job));
+        revaluate_job_list_.push_back(job);
+        stats->jobs_++;
+    }
+
+    job->event_ = event;
+    job->index_ = 0;
+    job->flow_list_.clear();
+    job->flow_list_.reserve(entry->Size());
+    for (it = flow_list.begin(); it != flow_list.end(); ++it) {
+        job->flow_list_.push_back(FlowEntryPtr(it->flow_entry()));
+    }
+    revaluate_trigger_->Set();
+}
+
+void FlowMgmtManager::CancelRevaluateJob(FlowMgmtKey *key) {
+    RevaluateJobTree::iterator it = revaluate_job_tree_.find(key);
+    if (it == revaluate_job_tree_.end())
+        return;
+
+    revaluate_stats_[key->type()].cancelled_++;
+    DeleteRevaluateJob(it->second);
+}
+
+void FlowMgmtManager::DeleteRevaluateJob(RevaluateJob *job) {
+    revaluate_job_tree_.erase(job->key_.get());
+    revaluate_job_list_.remove(job);
+    delete job;
+}
+
+// Number of revaluate events that can be enqueued in this run.
+// - Returns 0 if flow update queue of the table is already backed up
+// - If new flows are waiting on the flow-table, revaluation gets only its
+//   configured share of the budget
+uint32_t FlowMgmtManager::RevaluateBudget() const {
+    FlowProto *proto = agent_->pkt()->get_flow_proto();
+    size_t backlog = proto->FlowUpdateQueueLength(table_index_);
+    if (backlog >= kRevaluateMaxBacklog)
+        return 0;
+
+    uint32_t budget = kRevaluateBudget;
+    if (proto->FlowEventQueueLength(table_index_) != 0) {
+        budget = (budget * agent_->params()->flow_revaluate_share()) / 100;
+        if (budget == 0)
+            budget = 1;
+    }
+
+    if (budget > kRevaluateMaxBacklog - backlog)
+        budget = kRevaluateMaxBacklog - backlog;
+    return budget;
+}
+
+bool FlowMgmtManager::RevaluateRun() {
+    uint32_t budget = RevaluateBudget();
+    if (budget == 0) {
+        revaluate_pauses_++;
+        if (revaluate_timer_->running() == false) {
+            revaluate_timer_->Start(kRevaluateRetryMsec,
+                boost::bind(&FlowMgmtManager::RevaluateRetry, this));
+        }
+        return true;
+    }
+
+    while (budget && revaluate_job_list_.empty() == false) {
+        RevaluateJob *job = revaluate_job_list_.front();
+        RevaluateStats *stats = &revaluate_stats_[job->key_->type()];
+        while (budget && job->index_ < job->flow_list_.size()) {
+            FlowEntryPtr &flow = job->flow_list_[job->index_];
+            DBEntryEvent(job->event_, job->key_.get(), flow.get());
+            // Release the flow reference as soon as event is enqueued
+            flow = NULL;
+            job->index_++;
+            stats->flows_++;
+            budget--;
+        }
+
+        if (job->index_ < job->flow_list_.size())
+            break;
+
+        uint64_t lag = UTCTimestampUsec() - job->enqueue_time_;
+        stats->last_lag_usec_ = lag;
+        if (lag > stats->max_lag_usec_)
+            stats->max_lag_usec_ = lag;
+        DeleteRevaluateJob(job);
+    }
+
+    // Yield if more jobs are pending
+    return revaluate_job_list_.empty();
+}
+
+bool FlowMgmtManager::RevaluateRetry() {
+    revaluate_trigger_->Set();
+    return false;
+}
+
+static const char *RevaluateTypeName(FlowMgmtKey::Type type) {
+    switch (type) {
+    case FlowMgmtKey::INTERFACE:
+        return "interface";
+    case FlowMgmtKey::ACL:
+        return "acl";
+    case FlowMgmtKey::VN:
+        return "virtual-network";
+    case FlowMgmtKey::INET4:
+        return "inet4-route";
+    case FlowMgmtKey::INET6:
+        return "inet6-route";
+    case FlowMgmtKey::BRIDGE:
+        return "bridge-route";
+    case FlowMgmtKey::NH:
+        return "nexthop";
+    default:
+        break;
+    }
+    return NULL;
+}
+
+void SandeshFlowRevaluateStatsRequest::HandleRequest() const {
+    SandeshFlowRevaluateStatsResp *resp = new SandeshFlowRevaluateStatsResp();
+    Agent *agent = Agent::GetInstance();
+    std::vector<FlowMgmtManager *> mgr_list =
+        agent->pkt()->flow_mgmt_manager_list();
+
+    uint32_t pending_jobs = 0;
+    uint64_t pauses = 0;
+    std::vector<SandeshFlowRevaluateStats> list;
+    for (int type = FlowMgmtKey::INVALID; type < FlowMgmtKey::END; type++) {
+        const char *name = RevaluateTypeName((FlowMgmtKey::Type)type);
+        if (name == NULL)
+            continue;
+
+        SandeshFlowRevaluateStats stats;
+        uint64_t flows = 0, jobs = 0, coalesced = 0, cancelled = 0;
+        uint64_t last_lag = 0, max_lag = 0;
+        for (size_t i = 0; i < mgr_list.size(); i++) {
+            const FlowMgmtManager::RevaluateStats &s =
+                mgr_list[i]->revaluate_stats((FlowMgmtKey::Type)type);
+            flows += s.flows_;
+            jobs += s.jobs_;
+            coalesced += s.coalesced_;
+            cancelled += s.cancelled_;
+            if (s.last_lag_usec_ > last_lag)
+                last_lag = s.last_lag_usec_;
+            if (s.max_lag_usec_ > max_lag)
+                max_lag = s.max_lag_usec_;
+        }
+        stats.set_type(name);
+        stats.set_flows(flows);
+        stats.set_jobs(jobs);
+        stats.set_coalesced(coalesced);
+        stats.set_cancelled(cancelled);
+        stats.set_last_lag_usec(last_lag);
+        stats.set_max_lag_usec(max_lag);
+        list.push_back(stats);
+    }
+
+    for (size_t i = 0; i < mgr_list.size(); i++) {
+        pending_jobs += mgr_list[i]->RevaluateJobCount();
+        pauses += mgr_list[i]->revaluate_pauses();
+    }
+
+    resp->set_pending_jobs(pending_jobs);
+    resp->set_pauses(pauses);
+    resp->set_stats(list);
+    resp->set_context(context());
+    resp->Response();
+}
+
 void FlowMgmtManager::FlowUpdateQueueDisable(bool disabled) {
     request_queue_.set_disable(disabled);
     db_event_queue_.set_disable(disabled);
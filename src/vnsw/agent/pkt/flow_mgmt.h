@@ -4,7 +4,10 @@
 #ifndef __AGENT_FLOW_TABLE_MGMT_H__
 #define __AGENT_FLOW_TABLE_MGMT_H__
 
+#include <list>
 #include <boost/scoped_ptr.hpp>
+#include <base/task_trigger.h>
+#include <base/timer.h>
 #include "pkt/flow_table.h"
 #include <pkt/flow_mgmt/flow_mgmt_dbclient.h>
 #include <pkt/flow_mgmt/flow_mgmt_tree.h>
@@ -190,6 +193,23 @@
 //
 // When Flow Management Dbclient module receives FREE_DBENTRY event, it will
 // ignore the message if gen-id does not match with latest value.
+//
+// Revaluation jobs:
+// ----------------
+// An Add/Change of DBEntry with many dependent flows (ex: ACL or SG change on
+// a VM with lakhs of flows) would enqueue a revaluate event for every flow in
+// one go, starving flow setup on the flow-tables. When a DBEntry has more than
+// kRevaluateInlineCount flows, the flows are instead revaluated by a job for
+// the DBEntry,
+// - The job takes a snapshot of flows dependent on the DBEntry and enqueues
+//   revaluate events from a TaskTrigger, at most kRevaluateBudget per run
+// - A new change to the DBEntry while a job is pending restarts the job, so
+//   that a flow is revaluated only once per burst of changes
+// - Delete of the DBEntry cancels the job, since delete is enqueued for all
+//   flows anyway
+// - Jobs are paused while the flow update queue of the table has more than
+//   kRevaluateMaxBacklog entries. When new flows are waiting on the flow-table,
+//   the budget is reduced to "FLOWS.revaluate_share" percent
 ////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////
@@ -255,6 +275,51 @@ public:
     typedef std::map<FlowEntryPtr, FlowEntryInfo, FlowEntryRefCmp>
         FlowEntryTree;
 
+    // DBEntry with more flows than this are revaluated from a job
+    static const uint32_t kRevaluateInlineCount = 256;
+    // Max revaluate events enqueued in one run of the revaluate trigger
+    static const uint32_t kRevaluateBudget = 1024;
+    // Jobs are paused when flow update queue is longer than this
+    static const uint32_t kRevaluateMaxBacklog = 4096;
+    // Time after which paused jobs are resumed
+    static const uint32_t kRevaluateRetryMsec = 10;
+
+    // Revaluation statistics per FlowMgmtKey type
+    struct RevaluateStats {
+        RevaluateStats() :
+            flows_(0), jobs_(0), coalesced_(0), cancelled_(0),
+            last_lag_usec_(0), max_lag_usec_(0) {
+        }
+
+        // Number of flows revaluated, inline and from jobs
+        uint64_t flows_;
+        uint64_t jobs_;
+        // Jobs restarted by a change while pending
+        uint64_t coalesced_;
+        // Jobs cancelled by delete of DBEntry
+        uint64_t cancelled_;
+        // Time from the change of DBEntry to completion of its job
+        uint64_t last_lag_usec_;
+        uint64_t max_lag_usec_;
+    };
+
+    struct RevaluateJob {
+        RevaluateJob(FlowMgmtKey *key, uint64_t enqueue_time) :
+            key_(key), event_(FlowEvent::INVALID), index_(0),
+            enqueue_time_(enqueue_time) {
+        }
+
+        boost::scoped_ptr<FlowMgmtKey> key_;
+        FlowEvent::Event event_;
+        std::vector<FlowEntryPtr> flow_list_;
+        // Index of next flow to revaluate in flow_list_
+        size_t index_;
+        uint64_t enqueue_time_;
+    };
+    typedef std::map<FlowMgmtKey *, RevaluateJob *, FlowMgmtKeyCmp>
+        RevaluateJobTree;
+    typedef std::list<RevaluateJob *> RevaluateJobList;
+
     FlowMgmtManager(Agent *agent, uint16_t table_index);
     virtual ~FlowMgmtManager() { }
 
@@ -279,6 +344,16 @@ public:
                       FlowEntry *flow);
     void FreeDBEntryEvent(FlowEvent::Event event, FlowMgmtKey *key,
                           uint32_t gen_id);
+    // Enqueue event for all flows dependent on a DBEntry. Large flow lists
+    // are handled by a revaluation job
+    void RevaluateFlows(FlowEvent::Event event, FlowMgmtKey *key,
+                        const FlowMgmtEntry *entry);
+    void CancelRevaluateJob(FlowMgmtKey *key);
+    size_t RevaluateJobCount() const { return revaluate_job_list_.size(); }
+    const RevaluateStats &revaluate_stats(FlowMgmtKey::Type type) const {
+        return revaluate_stats_[type];
+    }
+    uint64_t revaluate_pauses() const { return revaluate_pauses_; }
 
     Agent *agent() const { return agent_; }
     uint16_t table_index() const { return table_index_; }
@@ -355,6 +430,10 @@ private:
     void SetAclFlowSandeshData(const AclDBEntry *acl, AclFlowResp &data,
                                const int last_count);
     void ControllerNotify(uint8_t index);
+    bool RevaluateRun();
+    bool RevaluateRetry();
+    uint32_t RevaluateBudget() const;
+    void DeleteRevaluateJob(RevaluateJob *job);
 
     Agent *agent_;
     uint16_t table_index_;
@@ -370,6 +449,13 @@ private:
     std::auto_ptr<FlowMgmtDbClient> flow_mgmt_dbclient_;
     FlowMgmtQueue request_queue_;
     FlowMgmtQueue db_event_queue_;
+    // Pending revaluation jobs. The list keeps jobs in FIFO order
+    RevaluateJobTree revaluate_job_tree_;
+    RevaluateJobList revaluate_job_list_;
+    RevaluateStats revaluate_stats_[FlowMgmtKey::END];
+    uint64_t revaluate_pauses_;
+    std::auto_ptr<TaskTrigger> revaluate_trigger_;
+    Timer *revaluate_timer_;
     static FlowMgmtQueue *log_queue_;
     DISALLOW_COPY_AND_ASSIGN(FlowMgmtManager);
 };
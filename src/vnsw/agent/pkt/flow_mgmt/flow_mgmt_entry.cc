@@ -39,13 +39,7 @@ bool FlowMgmtEntry::OperEntryAdd(FlowMgmtManager *mgr,
     if (event == FlowEvent::INVALID)
         return false;
 
-    FlowList::iterator it = flow_list_.begin();
-    while (it != flow_list_.end()) {
-        FlowMgmtKeyNode *node = &(*it);
-        mgr->DBEntryEvent(event, key, node->flow_entry());
-        it++;
-    }
-
+    mgr->RevaluateFlows(event, key, this);
     return true;
 }
 
@@ -67,6 +61,9 @@ bool FlowMgmtEntry::OperEntryDelete(FlowMgmtManager *mgr,
         gen_id_ = req->gen_id();
     }
 
+    // Flows are deleted/recomputed below, pending revaluation is not needed
+    mgr->CancelRevaluateJob(key);
+
     FlowEvent::Event event = req->GetResponseEvent();
     if (event == FlowEvent::INVALID)
         return false;
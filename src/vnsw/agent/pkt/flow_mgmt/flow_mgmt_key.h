@@ -5,6 +5,7 @@
 #ifndef __AGENT_PKT_FLOW_MGMT_KEY_H__
 #define __AGENT_PKT_FLOW_MGMT_KEY_H__
 
+#include <boost/functional/hash.hpp>
 #include <db/db_entry.h>
 #include <pkt/flow_event.h>
 
@@ -27,7 +28,7 @@ public:
     };
 
     FlowMgmtKey(Type type, const DBEntry *db_entry) :
-        type_(type), db_entry_(db_entry) {
+        type_(type), db_entry_(db_entry), hash_(0), hash_valid_(false) {
     }
 
     virtual ~FlowMgmtKey() { }
@@ -60,16 +61,51 @@ public:
         return Compare(rhs);
     }
 
+    bool IsEqual(const FlowMgmtKey *rhs) const {
+        if (type_ != rhs->type_)
+            return false;
+
+        if (UseDBEntry()) {
+            if (db_entry_ != rhs->db_entry_)
+                return false;
+        }
+
+        return (Compare(rhs) == false && rhs->Compare(this) == false);
+    }
+
+    // Hash of the key. Computed on first use and cached in the key
+    std::size_t Hash() const {
+        if (hash_valid_ == false) {
+            hash_ = ComputeHash();
+            hash_valid_ = true;
+        }
+        return hash_;
+    }
+
     FlowEvent::Event FreeDBEntryEvent() const;
     Type type() const { return type_; }
     const DBEntry *db_entry() const { return db_entry_; }
-    void set_db_entry(const DBEntry *db_entry) { db_entry_ = db_entry; }
+    void set_db_entry(const DBEntry *db_entry) {
+        db_entry_ = db_entry;
+        hash_valid_ = false;
+    }
 
 protected:
+    // Keys not using DBEntry as key must override to hash their fields
+    virtual std::size_t ComputeHash() const {
+        std::size_t hash = 0;
+        boost::hash_combine(hash, (int)type_);
+        if (UseDBEntry())
+            boost::hash_combine(hash, db_entry_);
+        return hash;
+    }
+
     Type type_;
     mutable const DBEntry *db_entry_;
 
 private:
+    mutable std::size_t hash_;
+    mutable bool hash_valid_;
     DISALLOW_COPY_AND_ASSIGN(FlowMgmtKey);
 };
 
@@ -79,6 +115,18 @@ struct FlowMgmtKeyCmp {
     }
 };
 
+struct FlowMgmtKeyHash {
+    std::size_t operator()(const FlowMgmtKey *key) const {
+        return key->Hash();
+    }
+};
+
+struct FlowMgmtKeyEqual {
+    bool operator()(const FlowMgmtKey *l, const FlowMgmtKey *r) const {
+        return l->IsEqual(r);
+    }
+};
+
 class AclFlowMgmtKey : public FlowMgmtKey {
 public:
     AclFlowMgmtKey(const AclDBEntry *acl, const AclEntryIDList *ace_id_list) :
@@ -219,6 +267,20 @@ public:
         return plen_ < rhs_key->plen_;
     }
 
+    virtual std::size_t ComputeHash() const {
+        std::size_t hash = 0;
+        boost::hash_combine(hash, (int)type_);
+        boost::hash_combine(hash, vrf_id_);
+        if (ip_.is_v4()) {
+            boost::hash_combine(hash, ip_.to_v4().to_ulong());
+        } else if (ip_.is_v6()) {
+            Ip6Address::bytes_type bytes = ip_.to_v6().to_bytes();
+            boost::hash_range(hash, bytes.begin(), bytes.end());
+        }
+        boost::hash_combine(hash, plen_);
+        return hash;
+    }
+
     class KeyCmp {
     public:
         static std::size_t BitLength(const InetRouteFlowMgmtKey *rt) {
@@ -309,6 +371,15 @@ public:
         return mac_ < rhs_key->mac_;
     }
 
+    virtual std::size_t ComputeHash() const {
+        std::size_t hash = 0;
+        boost::hash_combine(hash, (int)type_);
+        boost::hash_combine(hash, vrf_id_);
+        const uint8_t *data = mac_.GetData();
+        boost::hash_range(hash, data, data + MacAddress::size());
+        return hash;
+    }
+
     FlowMgmtKey *Clone() {
         return new BridgeRouteFlowMgmtKey(vrf_id(), mac_);
     }
@@ -368,6 +439,15 @@ public:
         return source_port_ < rhs_key->source_port_;
     }
 
+    virtual std::size_t ComputeHash() const {
+        std::size_t hash = 0;
+        boost::hash_combine(hash, (int)type_);
+        boost::hash_range(hash, uuid_.begin(), uuid_.end());
+        boost::hash_combine(hash, cn_index_);
+        boost::hash_combine(hash, source_port_);
+        return hash;
+    }
+
     const boost::uuids::uuid &uuid() const { return uuid_; }
     uint32_t source_port() const { return source_port_; }
     uint8_t cn_index() const { return cn_index_; }
@@ -30,14 +30,6 @@ void FlowMgmtTree::InsertEntry(FlowMgmtKey *key, FlowMgmtEntry *entry) {
     tree_[key] = entry;
 }
 
-FlowMgmtKey *FlowMgmtTree::LowerBound(FlowMgmtKey *key) {
-    Tree::iterator it = tree_.lower_bound(key);
-    if (it == tree_.end())
-        return NULL;
-
-    return it->first;
-}
-
 bool FlowMgmtTree::TryDelete(FlowMgmtKey *key, FlowMgmtEntry *entry) {
     if (entry->CanDelete() == false)
         return false;
@@ -396,6 +388,31 @@ bool RouteFlowMgmtTree::Delete(FlowMgmtKey *key, FlowEntry *flow,
     return ret;
 }
 
+void RouteFlowMgmtTree::InsertEntry(FlowMgmtKey *key, FlowMgmtEntry *entry) {
+    RouteFlowMgmtKey *route_key = static_cast<RouteFlowMgmtKey *>(key);
+    vrf_entry_count_[VrfKey(route_key->vrf_id(), key->type())]++;
+    FlowMgmtTree::InsertEntry(key, entry);
+}
+
+void RouteFlowMgmtTree::RemoveEntry(Tree::iterator it) {
+    RouteFlowMgmtKey *route_key = static_cast<RouteFlowMgmtKey *>(it->first);
+    VrfEntryCountMap::iterator count_it =
+        vrf_entry_count_.find(VrfKey(route_key->vrf_id(), it->first->type()));
+    assert(count_it != vrf_entry_count_.end());
+    if (--count_it->second == 0) {
+        vrf_entry_count_.erase(count_it);
+    }
+    FlowMgmtTree::RemoveEntry(it);
+}
+
+// The tree is not ordered, so number of entries per vrf is tracked to
+// find if vrf has any flows
+bool RouteFlowMgmtTree::HasVrfEntry(uint32_t vrf_id,
+                                    FlowMgmtKey::Type type) const {
+    return vrf_entry_count_.find(VrfKey(vrf_id, type)) !=
+        vrf_entry_count_.end();
+}
+
 void RouteFlowMgmtTree::SetDBEntry(const FlowMgmtRequest *req,
                                    FlowMgmtKey *key) {
     Tree::iterator it = tree_.find(key);
@@ -531,25 +548,13 @@ FlowMgmtEntry *InetRouteFlowMgmtTree::Allocate(const FlowMgmtKey *key) {
 
 bool InetRouteFlowMgmtTree::HasVrfFlows(uint32_t vrf,
                                         Agent::RouteTableType type) {
-    InetRouteFlowMgmtKey *next_key = NULL;
-
     if (type == Agent::INET4_UNICAST) {
-        InetRouteFlowMgmtKey key(vrf, Ip4Address(0), 0);
-        next_key = static_cast<InetRouteFlowMgmtKey *>(LowerBound(&key));
+        return HasVrfEntry(vrf, FlowMgmtKey::INET4);
     } else if (type == Agent::INET6_UNICAST) {
-        InetRouteFlowMgmtKey key(vrf, Ip6Address(), 0);
-        next_key = static_cast<InetRouteFlowMgmtKey *>(LowerBound(&key));
-    } else {
-        return false;
+        return HasVrfEntry(vrf, FlowMgmtKey::INET6);
     }
 
-    if (next_key == NULL)
-        return false;
-
-    if (next_key->vrf_id() != vrf)
-        return false;
-
-    return true;
+    return false;
 }
 
 bool InetRouteFlowMgmtTree::OperEntryAdd(const FlowMgmtRequest *req,
@@ -634,16 +639,7 @@ FlowMgmtEntry *BridgeRouteFlowMgmtTree::Allocate(const FlowMgmtKey *key) {
 
 bool BridgeRouteFlowMgmtTree::HasVrfFlows(uint32_t vrf,
                                           Agent::RouteTableType type) {
-    BridgeRouteFlowMgmtKey key(vrf, MacAddress::ZeroMac());
-    BridgeRouteFlowMgmtKey *next_key = static_cast<BridgeRouteFlowMgmtKey *>
-        (LowerBound(&key));
-    if (next_key == NULL)
-        return false;
-
-    if (next_key->vrf_id() != vrf)
-        return false;
-
-    return true;
+    return HasVrfEntry(vrf, FlowMgmtKey::BRIDGE);
 }
 
 /////////////////////////////////////////////////////////////////////////////
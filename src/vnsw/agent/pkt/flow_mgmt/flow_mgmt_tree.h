@@ -7,6 +7,7 @@
 
 #include <cstdlib>
 #include <map>
+#include <boost/unordered_map.hpp>
 #include <pkt/flow_mgmt/flow_mgmt_key.h>
 
 class FlowMgmtKeyNode;
@@ -16,9 +17,13 @@ class BgpAsAServiceFlowMgmtRequest;
 
 typedef std::map<FlowMgmtKey *, FlowMgmtKeyNode *, FlowMgmtKeyCmp> FlowMgmtKeyTree;
 
+// Dependency trees are looked up for every key of a flow on flow add/delete.
+// So, entries are kept in a hash table using hash cached in the FlowMgmtKey.
+// Trees needing ordered access maintain additional index of their own
 class FlowMgmtTree {
 public:
-    typedef std::map<FlowMgmtKey *, FlowMgmtEntry *, FlowMgmtKeyCmp> Tree;
+    typedef boost::unordered_map<FlowMgmtKey *, FlowMgmtEntry *,
+                                 FlowMgmtKeyHash, FlowMgmtKeyEqual> Tree;
     FlowMgmtTree(FlowMgmtManager *mgr) : mgr_(mgr) { }
     virtual ~FlowMgmtTree() {
         assert(tree_.size() == 0);
@@ -56,7 +61,6 @@ public:
 
     FlowMgmtEntry *Locate(FlowMgmtKey *key);
     FlowMgmtEntry *Find(FlowMgmtKey *key);
-    FlowMgmtKey *LowerBound(FlowMgmtKey *key);
     Tree &tree() { return tree_; }
     FlowMgmtManager *mgr() const { return mgr_; }
     static bool AddFlowMgmtKey(FlowMgmtKeyTree *tree, FlowMgmtKey *key);
@@ -145,6 +149,10 @@ private:
 
 class RouteFlowMgmtTree : public FlowMgmtTree {
 public:
+    // Number of entries in the tree per <vrf-id, key-type>
+    typedef std::pair<uint32_t, uint32_t> VrfKey;
+    typedef boost::unordered_map<VrfKey, uint32_t> VrfEntryCountMap;
+
     RouteFlowMgmtTree(FlowMgmtManager *mgr) : FlowMgmtTree(mgr) { }
     virtual ~RouteFlowMgmtTree() { }
     virtual bool HasVrfFlows(uint32_t vrf_id, Agent::RouteTableType type) = 0;
@@ -152,9 +160,15 @@ public:
     virtual bool Delete(FlowMgmtKey *key, FlowEntry *flow, FlowMgmtKeyNode *node);
     virtual bool OperEntryDelete(const FlowMgmtRequest *req, FlowMgmtKey *key);
     virtual bool OperEntryAdd(const FlowMgmtRequest *req, FlowMgmtKey *key);
+    virtual void InsertEntry(FlowMgmtKey *key, FlowMgmtEntry *entry);
+    virtual void RemoveEntry(Tree::iterator it);
+
+protected:
+    bool HasVrfEntry(uint32_t vrf_id, FlowMgmtKey::Type type) const;
 
 private:
     void SetDBEntry(const FlowMgmtRequest *req, FlowMgmtKey *key);
+    VrfEntryCountMap vrf_entry_count_;
     DISALLOW_COPY_AND_ASSIGN(RouteFlowMgmtTree);
 };
 
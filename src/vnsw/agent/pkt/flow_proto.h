@@ -86,7 +86,7 @@ public:
     void CreateAuditEntry(const FlowKey &key, uint32_t flow_handle,
                           uint8_t gen_id);
     bool FlowEventHandler(FlowEvent *req, FlowTable *table);
-    bool FlowUpdateHandler(FlowEvent *req);
+    bool FlowUpdateHandler(FlowEvent *req, FlowTable *table);
     bool FlowDeleteHandler(FlowEvent *req, FlowTable *table);
     bool FlowKSyncMsgHandler(FlowEvent *req, FlowTable *table);
     void GrowFreeListRequest(FlowTable *table);
@@ -104,6 +104,8 @@ public:
     void DisableFlowKSyncQueue(uint32_t index, bool disabled);
     void DisableFlowDeleteQueue(uint32_t index, bool disabled);
     size_t FlowUpdateQueueLength();
+    size_t FlowUpdateQueueLength(uint16_t table_index);
+    size_t FlowEventQueueLength(uint16_t table_index);
 
     const FlowStats *flow_stats() const { return &stats_; }
 
@@ -148,8 +150,8 @@ private:
     std::vector<FlowEventQueue *> flow_tokenless_queue_;
     std::vector<DeleteFlowEventQueue *> flow_delete_queue_;
     std::vector<KSyncFlowEventQueue *> flow_ksync_queue_;
+    std::vector<UpdateFlowEventQueue *> flow_update_queue_;
     std::vector<FlowTable *> flow_table_list_;
-    UpdateFlowEventQueue flow_update_queue_;
     tbb::atomic<int> linklocal_flow_count_;
     bool use_vrouter_hash_;
     FlowTraceFilter ipv4_trace_filter_;
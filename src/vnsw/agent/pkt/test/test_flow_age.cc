@@ -160,6 +160,66 @@ TEST_F(FlowTest, FlowAge_3) {
     flow_stats_collector_->SetFlowAgeTime(bkp_age_time);
 }
 
+static uint64_t AgeingFlowsScanned(FlowStatsCollectorObject *obj) {
+    uint64_t count = 0;
+    for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
+        count += obj->GetCollector(i)->ageing_flows_scanned();
+    }
+    return count;
+}
+
+// Verify ageing scan visits the flows in batches and updates scan stats
+TEST_F(FlowTest, FlowAge_ScanStats) {
+    int tmp_age_time = 10 * 1000;
+    int bkp_age_time = flow_stats_collector_->GetFlowAgeTime();
+    flow_stats_collector_->SetFlowAgeTime(tmp_age_time);
+
+    TestFlow flow[] = {
+        {
+            TestFlowPkt(Address::INET, vm1_ip, vm2_ip, 1, 0, 0, "vrf5",
+                    flow0->id(), 1),
+            {
+                new VerifyVn("vn5", "vn5"),
+            }
+        },
+        {
+            TestFlowPkt(Address::INET, vm2_ip, vm1_ip, 1, 0, 0, "vrf5",
+                    flow1->id(), 2),
+            {
+                new VerifyVn("vn5", "vn5"),
+            }
+        }
+    };
+
+    CreateFlow(flow, 2);
+    EXPECT_EQ(2U, get_flow_proto()->FlowCount());
+
+    // Flows with traffic are visited, but not aged
+    uint64_t scanned = AgeingFlowsScanned(flow_stats_collector_);
+    KSyncSockTypeMap::IncrFlowStats(1, 1, 30);
+    KSyncSockTypeMap::IncrFlowStats(2, 1, 30);
+    client->EnqueueFlowAge();
+    client->WaitForIdle();
+    EXPECT_EQ(2U, get_flow_proto()->FlowCount());
+    EXPECT_LE(scanned + 2, AgeingFlowsScanned(flow_stats_collector_));
+
+    // Idle flows are aged
+    usleep(tmp_age_time + 10);
+    client->EnqueueFlowAge();
+    client->WaitForIdle();
+    WAIT_FOR(100, 1, (0U == get_flow_proto()->FlowCount()));
+
+    for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
+        FlowStatsCollector *fsc = flow_stats_collector_->GetCollector(i);
+        cout << "Collector " << i << " flows scanned "
+            << fsc->ageing_flows_scanned() << " scan time "
+            << fsc->ageing_scan_time() << " usec scans "
+            << fsc->ageing_scans() << endl;
+    }
+
+    flow_stats_collector_->SetFlowAgeTime(bkp_age_time);
+}
+
 TEST_F(FlowTest, Flow_introspect_delete_all) {
     EXPECT_EQ(0U, get_flow_proto()->FlowCount());
 
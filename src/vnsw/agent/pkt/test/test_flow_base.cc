@@ -765,8 +765,8 @@ protected:
         return flow_proto_->flow_ksync_queue_[table_index];
     }
 
-    UpdateFlowEventQueue *GetUpdateFlowEventQueue() {
-        return &flow_proto_->flow_update_queue_;
+    UpdateFlowEventQueue *GetUpdateFlowEventQueue(uint32_t table_index) {
+        return flow_proto_->flow_update_queue_[table_index];
     }
 
 protected:
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <base/os.h>
 #include <base/address_util.h>
+#include <base/time_util.h>
 #include "test/test_cmn_util.h"
 #include "test_flow_util.h"
 #include "ksync/ksync_sock_user.h"
@@ -123,6 +124,120 @@ TEST_F(FlowTest, FlowDeleteInterface) {
     client->WaitForIdle();
 }
 
+bool FlowMgmtRevaluateCompleted(Agent *agent) {
+    std::vector<FlowMgmtManager *>::const_iterator it =
+        agent->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent->pkt()->flow_mgmt_manager_iterator_end()) {
+        if (0 != (*it)->RevaluateJobCount()) {
+            return false;
+        }
+        it++;
+    }
+    return FlowModuleDbEventCompleted(agent);
+}
+
+static uint64_t FlowMgmtRevaluatedFlows(Agent *agent, FlowMgmtKey::Type type,
+                                        uint64_t *max_lag) {
+    uint64_t flows = 0;
+    std::vector<FlowMgmtManager *>::const_iterator it =
+        agent->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent->pkt()->flow_mgmt_manager_iterator_end()) {
+        const FlowMgmtManager::RevaluateStats &stats =
+            (*it)->revaluate_stats(type);
+        flows += stats.flows_;
+        if (max_lag && stats.max_lag_usec_ > *max_lag)
+            *max_lag = stats.max_lag_usec_;
+        it++;
+    }
+    return flows;
+}
+
+// Change of an interface with large number of flows must revaluate every
+// flow, without flooding the flow update queue
+TEST_F(FlowTest, FlowRevaluateScale) {
+    uint32_t count = 2000;
+    if (const char *env = getenv("FLOW_REVALUATE_SCALE_COUNT"))
+        count = strtoul(env, NULL, 0);
+
+    KSyncSockTypeMap *sock = static_cast<KSyncSockTypeMap *>(KSyncSock::Get(0));
+    sock->set_is_incremental_index(true);
+    struct PortInfo input[] = {
+        {"vif0", 11, "11.1.1.11", "00:00:00:01:01:11", 5, 6},
+        {"vif1", 12, "11.1.1.12", "00:00:00:01:01:12", 5, 6},
+    };
+    CreateVmportEnv(input, 2);
+    client->WaitForIdle();
+    WAIT_FOR(1000, 1000, VmPortActive(input, 0));
+    WAIT_FOR(1000, 1000, VmPortActive(input, 1));
+
+    InterfaceRef intf(VmInterfaceGet(input[0].intf_id));
+    for (uint32_t i = 1; i <= count; i++) {
+        TxTcpPacket(intf->id(), "11.1.1.11", "11.1.1.12", 30, 40 + i, false,
+                    (i * 2) - 1, VrfGet("vrf5")->vrf_id());
+    }
+    client->WaitForIdle();
+    WAIT_FOR(10000, 1000, (2 * count == get_flow_proto()->FlowCount()));
+    WAIT_FOR(1000, 1000, (FlowMgmtUpdateCompleted(agent())));
+    WAIT_FOR(1000, 1000, (FlowModuleDbEventCompleted(agent())));
+    client->WaitForIdle();
+
+    uint64_t flows = FlowMgmtRevaluatedFlows(agent(), FlowMgmtKey::INTERFACE,
+                                             NULL);
+    std::vector<FlowMgmtManager::RevaluateStats> old_stats;
+    std::vector<FlowMgmtManager *>::const_iterator it =
+        agent()->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent()->pkt()->flow_mgmt_manager_iterator_end()) {
+        old_stats.push_back((*it)->revaluate_stats(FlowMgmtKey::INTERFACE));
+        it++;
+    }
+
+    uint64_t start = UTCTimestampUsec();
+    it = agent()->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent()->pkt()->flow_mgmt_manager_iterator_end()) {
+        (*it)->ChangeDBEntryEvent(intf.get(), 0);
+        it++;
+    }
+    WAIT_FOR(10000, 1000, (FlowMgmtRevaluateCompleted(agent())));
+    client->WaitForIdle();
+
+    uint64_t max_lag = 0;
+    uint64_t revaluated = FlowMgmtRevaluatedFlows(agent(),
+                                                  FlowMgmtKey::INTERFACE,
+                                                  &max_lag) - flows;
+    cout << "Revaluated " << revaluated << " flows in "
+         << (UTCTimestampUsec() - start) << " usec, max job lag "
+         << max_lag << " usec" << endl;
+    EXPECT_GE(revaluated, count);
+    EXPECT_LE(get_flow_proto()->FlowUpdateQueueLength(),
+              (size_t)FlowMgmtManager::kRevaluateMaxBacklog);
+
+    // A single change of the interface must result in one job in a flow
+    // table with more than kRevaluateInlineCount flows of the interface, and
+    // inline revaluation otherwise. Nothing to coalesce or cancel.
+    size_t idx = 0;
+    it = agent()->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent()->pkt()->flow_mgmt_manager_iterator_end()) {
+        const FlowMgmtManager::RevaluateStats &stats =
+            (*it)->revaluate_stats(FlowMgmtKey::INTERFACE);
+        uint64_t table_flows = stats.flows_ - old_stats[idx].flows_;
+        uint64_t jobs = stats.jobs_ - old_stats[idx].jobs_;
+        EXPECT_EQ((table_flows > FlowMgmtManager::kRevaluateInlineCount) ?
+                  1U : 0U, jobs);
+        EXPECT_EQ(old_stats[idx].coalesced_, stats.coalesced_);
+        EXPECT_EQ(old_stats[idx].cancelled_, stats.cancelled_);
+        it++;
+        idx++;
+    }
+
+    DeleteVmportEnv(input, 2, true);
+    client->WaitForIdle();
+    WAIT_FOR(10000, 1000, (0 == get_flow_proto()->FlowCount()));
+    WAIT_FOR(1000, 1000, (FlowMgmtUpdateCompleted(agent())));
+    client->WaitForIdle();
+    sock->set_is_incremental_index(false);
+    client->WaitForIdle();
+}
+
 int main(int argc, char *argv[]) {
     GETUSERARGS();
 
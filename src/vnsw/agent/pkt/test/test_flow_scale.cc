@@ -3,9 +3,11 @@
  */
 
 #include "base/os.h"
+#include "base/time_util.h"
 #include "test/test_cmn_util.h"
 #include "test_pkt_util.h"
 #include "pkt/flow_proto.h"
+#include "pkt/flow_mgmt.h"
 
 struct PortInfo input[] = {
     {"vnet1", 1, "1.1.1.1", "00:00:01:01:01:01", 1, 1},
@@ -101,6 +103,140 @@ TEST_F(FlowTest, FlowScaling_2) {
     EXPECT_TRUE(free_queue_->max_queue_len() <= (uint32_t)(count/4));
 }
 
+// Measure flow setup rate. Run with config files having different
+// "FLOWS.thread_count" to measure scaling with number of flow tables
+TEST_F(FlowTest, FlowSetupRate) {
+    char env[100];
+    int count = 1000;
+    if (getenv("AGENT_FLOW_SETUP_RATE_COUNT")) {
+        strcpy(env, getenv("AGENT_FLOW_SETUP_RATE_COUNT"));
+        count = strtoul(env, NULL, 0);
+    }
+
+    uint32_t table_count = flow_proto_->flow_table_count();
+    for (uint32_t i = 0; i < table_count; i++) {
+        flow_proto_->DisableFlowEventQueue(i, true);
+    }
+
+    uint32_t intf_id = VmPortGetId(1);
+    for (int i = 0; i < count; i++) {
+        Ip4Address dip(0x05000000 + i);
+        TxTcpPacket(intf_id, vnet_addr, dip.to_string().c_str(),
+                    1000 + (i % 1000), 80, false);
+    }
+    client->WaitForIdle();
+
+    uint64_t start = UTCTimestampUsec();
+    for (uint32_t i = 0; i < table_count; i++) {
+        flow_proto_->DisableFlowEventQueue(i, false);
+    }
+    int flow_count = count * 2;
+    WAIT_FOR(flow_count * 10, 1000,
+             (flow_count == (int) flow_proto_->FlowCount()));
+    uint64_t setup_time = UTCTimestampUsec() - start;
+    EXPECT_EQ(flow_count, (int) flow_proto_->FlowCount());
+    client->WaitForIdle();
+
+    // Flows are spread over the flow tables, with both flows of a pair in
+    // the same table
+    int table_flow_count = 0;
+    for (uint32_t i = 0; i < table_count; i++) {
+        FlowTable *table = flow_proto_->GetTable(i);
+        table_flow_count += table->Size();
+        for (FlowTable::FlowEntryMap::iterator it = table->begin();
+             it != table->end(); ++it) {
+            FlowEntry *fe = it->second;
+            ASSERT_TRUE(fe->reverse_flow_entry() != NULL);
+            EXPECT_EQ(table, fe->reverse_flow_entry()->flow_table());
+        }
+    }
+    EXPECT_EQ(flow_count, table_flow_count);
+
+    if (setup_time == 0)
+        setup_time = 1;
+    cout << "Flow tables : " << table_count << " Flows : " << flow_count
+        << " Time : " << setup_time << " usec Rate : "
+        << ((uint64_t)flow_count * 1000000) / setup_time << " flows/sec"
+        << endl;
+}
+
+static void FlowMgmtQueueDisable(Agent *agent, bool disable) {
+    std::vector<FlowMgmtManager *>::const_iterator it =
+        agent->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent->pkt()->flow_mgmt_manager_iterator_end()) {
+        (*it)->FlowUpdateQueueDisable(disable);
+        it++;
+    }
+}
+
+static size_t FlowMgmtQueueLength(Agent *agent) {
+    size_t len = 0;
+    std::vector<FlowMgmtManager *>::const_iterator it =
+        agent->pkt()->flow_mgmt_manager_iterator_begin();
+    while (it != agent->pkt()->flow_mgmt_manager_iterator_end()) {
+        len += (*it)->FlowUpdateQueueLength();
+        it++;
+    }
+    return len;
+}
+
+// Measure time spent by flow-mgmt module per flow on add and delete of flows.
+// Requests to flow-mgmt are held in queue till all flows are created/deleted
+// and the time to drain the queues is measured
+TEST_F(FlowTest, FlowMgmtAddDeleteBench) {
+    char env[100];
+    int count = 1000;
+    if (getenv("AGENT_FLOW_MGMT_BENCH_COUNT")) {
+        strcpy(env, getenv("AGENT_FLOW_MGMT_BENCH_COUNT"));
+        count = strtoul(env, NULL, 0);
+    }
+
+    FlowMgmtQueueDisable(agent_, true);
+    for (int i = 0; i < count; i++) {
+        Ip4Address addr(0x05000000 + i);
+        TxIpPacket(vnet->id(), vnet_addr, addr.to_string().c_str(), 1);
+    }
+    int flow_count = count * 2;
+    WAIT_FOR(flow_count * 10, 10000,
+             (flow_count == (int) flow_proto_->FlowCount()));
+
+    uint64_t start = UTCTimestampUsec();
+    FlowMgmtQueueDisable(agent_, false);
+    WAIT_FOR(flow_count * 10, 1000, (FlowMgmtQueueLength(agent_) == 0));
+    uint64_t add_time = UTCTimestampUsec() - start;
+    client->WaitForIdle();
+
+    // Every flow from the interface must be tracked in flow-mgmt
+    uint64_t created = 0;
+    uint64_t aged = 0;
+    uint32_t active_flows = 0;
+    flow_proto_->InterfaceFlowCount(vnet, &created, &aged, &active_flows);
+    EXPECT_LE((uint32_t)count, active_flows);
+
+    FlowMgmtQueueDisable(agent_, true);
+    client->EnqueueFlowFlush();
+    WAIT_FOR(flow_count * 10, 10000, (0 == flow_proto_->FlowCount()));
+
+    start = UTCTimestampUsec();
+    FlowMgmtQueueDisable(agent_, false);
+    WAIT_FOR(flow_count * 10, 1000, (FlowMgmtQueueLength(agent_) == 0));
+    uint64_t del_time = UTCTimestampUsec() - start;
+    client->WaitForIdle();
+
+    // Deletes must find and release all the flow-mgmt entries of the flows
+    created = aged = 0;
+    active_flows = 0;
+    flow_proto_->InterfaceFlowCount(vnet, &created, &aged, &active_flows);
+    EXPECT_EQ(0U, active_flows);
+
+    cout << "Flow-mgmt add of " << flow_count << " flows : " << add_time
+        << " usec, " << (double)add_time / flow_count << " usec per flow"
+        << endl;
+    cout << "Flow-mgmt delete of " << flow_count << " flows : " << del_time
+        << " usec, " << (double)del_time / flow_count << " usec per flow"
+        << endl;
+}
+
 int main(int argc, char *argv[]) {
     int ret = 0;
 
@@ -39,7 +39,7 @@ public:
 
         strcpy(sg1_acl_name_, "sg_acl1" "egress-access-control-list");
         strcpy(sg2_acl_name_, "sg_acl2" "egress-access-control-list");
-        update_queue_ = GetUpdateFlowEventQueue();
+        update_queue_ = GetUpdateFlowEventQueue(0);
         event_queue_ = GetFlowEventQueue(0);
         delete_queue_ = GetDeleteFlowEventQueue(0);
     }
@@ -12,6 +12,9 @@
 #include "resource_manager/resource_manager.h"
 #include "resource_manager/resource_manager_types.h"
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 ResourceBackupManager::ResourceBackupManager(ResourceManager *mgr) :
     resource_manager_(mgr), agent_(mgr->agent()), sandesh_maps_(this),
@@ -82,6 +85,35 @@ uint32_t ResourceBackupManager::ReadResourceDataFromFile
     }
 }
 
+ResourceBackupFileMap::ResourceBackupFileMap(const std::string &file_name) :
+    data_(NULL), size_(0) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data_ = (uint8_t *)addr;
+            size_ = (uint32_t) st.st_size;
+            // Files are decoded front to back
+            madvise(addr, size_, MADV_SEQUENTIAL);
+        } else {
+            LOG(ERROR, "Resource backup mgr mmap failed for file "
+                << file_name);
+        }
+    }
+    close(fd);
+}
+
+ResourceBackupFileMap::~ResourceBackupFileMap() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+}
+
 ResourceSandeshMaps& ResourceBackupManager::sandesh_maps() {
     return sandesh_maps_;
 }
@@ -37,6 +37,23 @@ private:
     Op op_;
     DISALLOW_COPY_AND_ASSIGN(ResourceBackupReq);
 };
+// Read only mapping of a backup file. Snapshot and journal records are
+// decoded directly from the mapping on restore instead of copying the
+// whole file in to heap.
+class ResourceBackupFileMap {
+public:
+    explicit ResourceBackupFileMap(const std::string &file_name);
+    ~ResourceBackupFileMap();
+
+    uint8_t *data() const {return data_;}
+    uint32_t size() const {return size_;}
+
+private:
+    uint8_t *data_;
+    uint32_t size_;
+    DISALLOW_COPY_AND_ASSIGN(ResourceBackupFileMap);
+};
+
 //Backup manager is to Process the Resource data and store
 //it in to a file using Sandesh encoding.
 class ResourceBackupManager {
@@ -6,6 +6,10 @@
 #include <dirent.h>
 #include <cctype>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <cmn/agent.h>
 #include <boost/filesystem.hpp>
 #include <boost/functional/hash.hpp>
@@ -30,7 +34,9 @@ BackUpResourceTable::BackUpResourceTable(ResourceBackupManager *manager,
                                          const std::string &name,
                                          const std::string &file_name) :
     backup_manager_(manager), agent_(manager->agent()), name_(name),
-    last_modified_time_(UTCTimestampUsec()) {
+    last_modified_time_(UTCTimestampUsec()), fall_back_count_(0),
+    journal_fd_(-1), journal_size_(0), journal_records_(0),
+    snapshot_size_(0), snapshot_pending_(false) {
 
     if (!agent_->isMockMode()) {
         backup_dir_ = agent_->params()->restart_backup_dir();
@@ -44,6 +50,7 @@ BackUpResourceTable::BackUpResourceTable(ResourceBackupManager *manager,
         ->restart_backup_idle_timeout();
     file_name_str_ = backup_dir_ + "/" + file_name;
     file_name_prefix_ = file_name + "-";
+    journal_file_ = file_name_str_ + ".journal";
     boost::filesystem::path dir(backup_dir_.c_str());
     if (!boost::filesystem::exists(backup_dir_))
         boost::filesystem::create_directory(backup_dir_);
@@ -54,6 +61,7 @@ BackUpResourceTable::BackUpResourceTable(ResourceBackupManager *manager,
 }
 
 BackUpResourceTable::~BackUpResourceTable() {
+    CloseJournal();
     timer_->Cancel();
     TimerManager::DeleteTimer(timer_);
 }
@@ -80,11 +88,22 @@ void BackUpResourceTable::StartTimer() {
 // backup_idle_timeout_ and start the fallback count so that
 // after 6th itteration file can be updated.
 // if write to file fails trigger the timer.
+// Change is already persisted in journal, so file is written only when
+// journal needs compaction.
 void BackUpResourceTable::TriggerBackup() {
+    last_modified_time_ = UTCTimestampUsec();
+    if (CompactionRequired() == false)
+        return;
     if (timer_->running() == false)
         //Start Fallback timer.
         StartTimer();
-    last_modified_time_ = UTCTimestampUsec();
+}
+
+bool BackUpResourceTable::CompactionRequired() const {
+    if (snapshot_pending_ || snapshot_size_ == 0)
+        return true;
+    return (journal_size_ > std::max(snapshot_size_,
+                                      (uint64_t)kJournalMinCompactSize));
 }
 
 bool BackUpResourceTable::UpdateRequired() {
@@ -138,17 +157,204 @@ static bool RenameFile(const std::string &file_tmp_name,
 // This hash sum will be validated while reading the content.
 bool BackUpResourceTable::CalculateHashSum(const std::string &file_name,
                                            uint32_t *hashsum) {
-    std::auto_ptr<uint8_t> buffer;
-    uint32_t size = ResourceBackupManager::ReadResourceDataFromFile(file_name,
-                                                                    &(buffer));
-    if (size && buffer.get()) {
-        *hashsum = (uint32_t)boost::hash_range(buffer.get(),
-                                               buffer.get()+size);
+    ResourceBackupFileMap file_map(file_name);
+    if (file_map.size() && file_map.data()) {
+        *hashsum = (uint32_t)boost::hash_range(file_map.data(),
+                                               file_map.data() +
+                                               file_map.size());
         return true;
     }
     return false;
 }
 
+// Hash of a journal record covers header fields and encoded entry, torn or
+// corrupted records fail the check on replay.
+static uint32_t JournalHashSum(const BackUpResourceTable::JournalHeader &hdr,
+                               const uint8_t *data) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, hdr.op);
+    boost::hash_combine(seed, hdr.index);
+    boost::hash_combine(seed, hdr.length);
+    if (hdr.length) {
+        boost::hash_range(seed, data, data + hdr.length);
+    }
+    return (uint32_t)seed;
+}
+
+// Open journal for append, anything beyond valid_size is a torn record
+// from previous run and is dropped.
+void BackUpResourceTable::OpenJournal(uint32_t valid_size) {
+    CloseJournal();
+    journal_fd_ = open(journal_file_.c_str(), O_WRONLY | O_CREAT | O_APPEND,
+                       0644);
+    if (journal_fd_ < 0 || ftruncate(journal_fd_, valid_size) != 0) {
+        LOG(ERROR, "Resource backup mgr journal open failed " <<
+            journal_file_);
+        CloseJournal();
+        snapshot_pending_ = true;
+        return;
+    }
+    journal_size_ = valid_size;
+}
+
+void BackUpResourceTable::CloseJournal() {
+    if (journal_fd_ >= 0) {
+        close(journal_fd_);
+    }
+    journal_fd_ = -1;
+}
+
+// Append record to the journal. On failure journal is closed and snapshot
+// is forced, as a record missing in the middle of journal can not be
+// replayed.
+bool BackUpResourceTable::AppendJournal(JournalOp op, uint32_t index,
+                                        const uint8_t *data,
+                                        uint32_t length) {
+    if (journal_fd_ < 0) {
+        snapshot_pending_ = true;
+        return false;
+    }
+
+    // Backup directory removed underneath, journal is not reachable any more
+    struct stat st;
+    if (fstat(journal_fd_, &st) != 0 || st.st_nlink == 0) {
+        CloseJournal();
+        snapshot_pending_ = true;
+        return false;
+    }
+
+    JournalHeader hdr;
+    hdr.magic = kJournalMagic;
+    hdr.op = op;
+    hdr.reserved = 0;
+    hdr.index = index;
+    hdr.length = length;
+    hdr.hashsum = JournalHashSum(hdr, data);
+
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = const_cast<uint8_t *>(data);
+    iov[1].iov_len = length;
+    ssize_t size = sizeof(hdr) + length;
+    if (writev(journal_fd_, iov, length ? 2 : 1) != size) {
+        LOG(ERROR, "Resource backup mgr journal write failed " <<
+            journal_file_);
+        CloseJournal();
+        snapshot_pending_ = true;
+        return false;
+    }
+
+    journal_size_ += size;
+    journal_records_++;
+    return true;
+}
+
+void BackUpResourceTable::JournalDelete(uint32_t index) {
+    AppendJournal(JOURNAL_DELETE, index, NULL, 0);
+}
+
+// Encode the entry as a map sandesh with single element, same encoding as
+// snapshot is used so that replay can reuse the generated decoder.
+template <typename T1, typename T2>
+void BackUpResourceTable::JournalAdd(uint32_t index, const T2 &data) {
+    if (journal_fd_ < 0) {
+        snapshot_pending_ = true;
+        return;
+    }
+
+    std::map<uint32_t, T2> index_map;
+    index_map.insert(std::make_pair(index, data));
+    T1 sandesh_data;
+    sandesh_data.set_index_map(index_map);
+    sandesh_data.set_time_stamp(UTCTimestampUsec());
+
+    uint8_t buf[kJournalMaxRecordSize];
+    int error = 0;
+    int32_t length = sandesh_data.WriteBinary(buf, sizeof(buf), &error);
+    if (error != 0 || length <= 0) {
+        LOG(ERROR, "Sandesh Write Binary failed for journal " << index);
+        CloseJournal();
+        snapshot_pending_ = true;
+        return;
+    }
+    AppendJournal(JOURNAL_ADD, index, buf, (uint32_t)length);
+}
+
+// Scan the records and keep latest state per index. Add of an index which
+// is already present is ignored same as std::map insert done for live
+// entries. Returns length of valid journal, scan stops at first torn or
+// corrupted record.
+uint32_t BackUpResourceTable::ScanJournal(uint8_t *buf, uint32_t size,
+                                          JournalStateMap *state_map) {
+    uint32_t offset = 0;
+    journal_records_ = 0;
+    while (size - offset >= sizeof(JournalHeader)) {
+        JournalHeader hdr;
+        memcpy(&hdr, buf + offset, sizeof(hdr));
+        uint8_t *data = buf + offset + sizeof(hdr);
+        if (hdr.magic != kJournalMagic ||
+            (hdr.op != JOURNAL_ADD && hdr.op != JOURNAL_DELETE) ||
+            hdr.length > kJournalMaxRecordSize ||
+            hdr.length > size - offset - sizeof(hdr) ||
+            hdr.hashsum != JournalHashSum(hdr, data)) {
+            LOG(DEBUG, "Journal truncated at offset " << offset << " " <<
+                journal_file_);
+            break;
+        }
+
+        JournalState &state = (*state_map)[hdr.index];
+        if (hdr.op == JOURNAL_DELETE) {
+            state.deleted = true;
+            state.data = NULL;
+            state.length = 0;
+        } else if (state.data == NULL) {
+            state.data = data;
+            state.length = hdr.length;
+        }
+        offset += sizeof(hdr) + hdr.length;
+        journal_records_++;
+    }
+    return offset;
+}
+
+// Type T1 is map sandesh of journal records, T2 is index map restored from
+// snapshot. Only the surviving record of each index is decoded.
+template <typename T1, typename T2>
+void BackUpResourceTable::ReplayJournal(T2 *index_map) {
+    CloseJournal();
+    uint32_t valid_size = 0;
+    {
+        ResourceBackupFileMap journal(journal_file_);
+        if (journal.data()) {
+            JournalStateMap state_map;
+            valid_size = ScanJournal(journal.data(), journal.size(),
+                                     &state_map);
+            for (JournalStateMap::const_iterator it = state_map.begin();
+                 it != state_map.end(); ++it) {
+                if (it->second.deleted) {
+                    index_map->erase(it->first);
+                }
+                if (it->second.data == NULL) {
+                    continue;
+                }
+                T1 sandesh_data;
+                int error = 0;
+                sandesh_data.ReadBinary(it->second.data, it->second.length,
+                                        &error);
+                if (error != 0) {
+                    LOG(ERROR, "Sandesh Read Binary failed for journal " <<
+                        it->first);
+                    continue;
+                }
+                index_map->insert(sandesh_data.get_index_map().begin(),
+                                  sandesh_data.get_index_map().end());
+            }
+        }
+    }
+    OpenJournal(valid_size);
+}
+
 // Type T1 is Final output sandesh structure writes in to file
 // Type T2 index map for the specific table
 // Write the Map to file
@@ -185,7 +391,15 @@ bool BackUpResourceTable::WriteMapToFile(T1* sandesh_data,
         // rename the tmp file to new file by appending hashsum
         std::stringstream file_path;
         file_path << file_name_str() << "-" << hashsum;
-        return RenameFile(temp_file, file_path.str());
+        if (RenameFile(temp_file, file_path.str()) == false) {
+            return false;
+        }
+        // Snapshot has all the changes, start with empty journal.
+        snapshot_size_ = write_buff_size;
+        snapshot_pending_ = false;
+        journal_records_ = 0;
+        OpenJournal(0);
+        return true;
     }
 
     return false;
@@ -257,24 +471,29 @@ void BackUpResourceTable::ReadMapFromFile(T* sandesh_data,
         LOG(DEBUG, "File path not found " << file_path.str());
         return;
     }
-    std::auto_ptr<uint8_t> buffer;
-    uint32_t size = ResourceBackupManager::ReadResourceDataFromFile(file_path.str(),
-                                                                    &(buffer));
-    if (buffer.get()) {
+    ResourceBackupFileMap file_map(file_path.str());
+    uint8_t *buffer = file_map.data();
+    uint32_t size = file_map.size();
+    if (buffer) {
         if (size) {
-            uint32_t hashsum = (uint32_t)boost::hash_range(buffer.get(),
-                                                           buffer.get()+size);
+            uint32_t hashsum = (uint32_t)boost::hash_range(buffer,
+                                                           buffer + size);
             std::stringstream hash_value;
             hash_value << hashsum;
             // Check for hashsum present.
             if (std::string::npos !=
                     file_name.find(hash_value.str())) {
-                sandesh_data->ReadBinary(buffer.get(), size, &error);
+                sandesh_data->ReadBinary(buffer, size, &error);
                 if (error != 0) {
                     LOG(ERROR, "Sandesh Read Binary failed ");
+                } else {
+                    snapshot_size_ = size;
                 }
             }
         }
+    } else {
+        LOG(ERROR, "Resource backup mgr Open failed to read file " <<
+            file_path.str());
     }
 }
 
@@ -297,6 +516,7 @@ void VrfMplsBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<VrfMplsResourceMapSandesh>(&sandesh_data,
                                                backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<VrfMplsResourceMapSandesh, Map>(&map_);
 }
 
 void VrfMplsBackUpResourceTable::RestoreResource() {
@@ -335,6 +555,7 @@ void VlanMplsBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<VlanMplsResourceMapSandesh>(&sandesh_data,
                                                backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<VlanMplsResourceMapSandesh, Map>(&map_);
 }
 
 void VlanMplsBackUpResourceTable::RestoreResource() {
@@ -372,6 +593,7 @@ void RouteMplsBackUpResourceTable::ReadFromFile() {
     RouteMplsResourceMapSandesh sandesh_data;
     ReadMapFromFile<RouteMplsResourceMapSandesh>(&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<RouteMplsResourceMapSandesh, Map>(&map_);
 }
 
 void RouteMplsBackUpResourceTable::RestoreResource() {
@@ -409,6 +631,7 @@ void InterfaceMplsBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<InterfaceIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<InterfaceIndexResourceMapSandesh, Map>(&map_);
 }
 
 void InterfaceMplsBackUpResourceTable::RestoreResource() {
@@ -460,6 +683,7 @@ void VmInterfaceBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<VmInterfaceIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<VmInterfaceIndexResourceMapSandesh, Map>(&map_);
 }
 
 void VmInterfaceBackUpResourceTable::RestoreResource() {
@@ -498,6 +722,7 @@ void VrfBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<VrfIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<VrfIndexResourceMapSandesh, Map>(&map_);
 }
 
 void VrfBackUpResourceTable::RestoreResource() {
@@ -536,6 +761,7 @@ void QosBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<QosIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<QosIndexResourceMapSandesh, Map>(&map_);
 }
 
 void QosBackUpResourceTable::RestoreResource() {
@@ -574,6 +800,7 @@ void BgpAsServiceBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<BgpAsServiceIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<BgpAsServiceIndexResourceMapSandesh, Map>(&map_);
 }
 
 void BgpAsServiceBackUpResourceTable::RestoreResource() {
@@ -612,6 +839,7 @@ void MirrorBackUpResourceTable::ReadFromFile() {
     ReadMapFromFile<MirrorIndexResourceMapSandesh>
         (&sandesh_data, backup_dir());
     map_ = sandesh_data.get_index_map();
+    ReplayJournal<MirrorIndexResourceMapSandesh, Map>(&map_);
 }
 
 void MirrorBackUpResourceTable::RestoreResource() {
@@ -712,81 +940,103 @@ void ResourceSandeshMaps::AddInterfaceMplsResourceEntry(uint32_t index,
                                        InterfaceIndexResource data ) {
     interface_mpls_index_table_.map().insert(InterfaceMplsResourcePair(index,
                                                                     data));
+    interface_mpls_index_table_.
+        JournalAdd<InterfaceIndexResourceMapSandesh>(index, data);
 }
 void ResourceSandeshMaps::DeleteInterfaceMplsResourceEntry(uint32_t index) {
     interface_mpls_index_table_.map().erase(index);
+    interface_mpls_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddVrfMplsResourceEntry(uint32_t index,
                                                   VrfMplsResource data) {
     vrf_mpls_index_table_.map().insert(VrfMplsResourcePair(index, data));
+    vrf_mpls_index_table_.JournalAdd<VrfMplsResourceMapSandesh>(index, data);
 }
 
 void ResourceSandeshMaps::DeleteVrfMplsResourceEntry(uint32_t index) {
     vrf_mpls_index_table_.map().erase(index);
+    vrf_mpls_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddVlanMplsResourceEntry(uint32_t index,
                                                    VlanMplsResource data) {
     vlan_mpls_index_table_.map().insert(VlanMplsResourcePair(index, data));
+    vlan_mpls_index_table_.JournalAdd<VlanMplsResourceMapSandesh>(index, data);
 }
 
 void ResourceSandeshMaps::DeleteVlanMplsResourceEntry(uint32_t index) {
     vlan_mpls_index_table_.map().erase(index);
+    vlan_mpls_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddRouteMplsResourceEntry(uint32_t index,
                                                     RouteMplsResource data) {
     route_mpls_index_table_.map().insert(RouteMplsResourcePair(index, data));
+    route_mpls_index_table_.
+        JournalAdd<RouteMplsResourceMapSandesh>(index, data);
 }
 
 void ResourceSandeshMaps::DeleteRouteMplsResourceEntry(uint32_t index) {
     route_mpls_index_table_.map().erase(index);
+    route_mpls_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddVmInterfaceResourceEntry(uint32_t index,
                                        VmInterfaceIndexResource data ) {
     vm_interface_index_table_.map().insert(VmInterfaceIndexResourcePair
             (index, data));
+    vm_interface_index_table_.
+        JournalAdd<VmInterfaceIndexResourceMapSandesh>(index, data);
 }
 void ResourceSandeshMaps::DeleteVmInterfaceResourceEntry(uint32_t index) {
     vm_interface_index_table_.map().erase(index);
+    vm_interface_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddVrfResourceEntry(uint32_t index,
                                               VrfIndexResource data ) {
     vrf_index_table_.map().insert(VrfIndexResourcePair
             (index, data));
+    vrf_index_table_.JournalAdd<VrfIndexResourceMapSandesh>(index, data);
 }
 void ResourceSandeshMaps::DeleteVrfResourceEntry(uint32_t index) {
     vrf_index_table_.map().erase(index);
+    vrf_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddQosResourceEntry(uint32_t index,
                                               QosIndexResource data ) {
     qos_index_table_.map().insert(QosIndexResourcePair
             (index, data));
+    qos_index_table_.JournalAdd<QosIndexResourceMapSandesh>(index, data);
 }
 void ResourceSandeshMaps::DeleteQosResourceEntry(uint32_t index) {
     qos_index_table_.map().erase(index);
+    qos_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddBgpAsServiceResourceEntry
 (uint32_t index, BgpAsServiceIndexResource data ) {
     bgp_as_service_index_table_.map().insert(BgpAsServiceIndexResourcePair
             (index, data));
+    bgp_as_service_index_table_.
+        JournalAdd<BgpAsServiceIndexResourceMapSandesh>(index, data);
 }
 
 void ResourceSandeshMaps::DeleteBgpAsServiceResourceEntry(uint32_t index) {
     bgp_as_service_index_table_.map().erase(index);
+    bgp_as_service_index_table_.JournalDelete(index);
 }
 
 void ResourceSandeshMaps::AddMirrorResourceEntry(uint32_t index,
                                                  MirrorIndexResource data ) {
     mirror_index_table_.map().insert(MirrorIndexResourcePair
             (index, data));
+    mirror_index_table_.JournalAdd<MirrorIndexResourceMapSandesh>(index, data);
 }
 
 void ResourceSandeshMaps::DeleteMirrorResourceEntry(uint32_t index) {
     mirror_index_table_.map().erase(index);
+    mirror_index_table_.JournalDelete(index);
 }
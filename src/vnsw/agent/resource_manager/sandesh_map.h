@@ -15,9 +15,44 @@ class ResourceBackupManager;
 // Trigger will be intiated Only when we don't see any frequent Changes
 // in the Data modifications with in the idle time out period otherwise
 // Write to file will happens upon fallback.
+//
+// Every change to the map is also appended to a journal file next to the
+// snapshot, as a record carrying the sandesh encoding of the single entry.
+// Restore maps the snapshot and replays the journal over it, so snapshot
+// only needs to be rewritten to compact the journal. Backup I/O is then
+// proportional to the churn rather than to the size of the map.
 class BackUpResourceTable {
 public:
     static const uint8_t  kFallBackCount = 6;
+    static const uint32_t kJournalMagic = 0x4A524E4C;
+    // Maximum size of encoded entry in a journal record
+    static const uint32_t kJournalMaxRecordSize = 4096;
+    // Journal is compacted once it grows beyond size of snapshot or
+    // kJournalMinCompactSize whichever is bigger
+    static const uint32_t kJournalMinCompactSize = (64 * 1024);
+    enum JournalOp {
+        JOURNAL_ADD = 1,
+        JOURNAL_DELETE,
+    };
+    struct JournalHeader {
+        uint32_t magic;
+        uint16_t op;
+        uint16_t reserved;
+        uint32_t index;
+        uint32_t length;
+        uint32_t hashsum;
+    };
+    // Latest state of an index seen while scanning the journal. data points
+    // to encoded entry in the mapped journal and is decoded only if the
+    // record survives the scan.
+    struct JournalState {
+        JournalState() : deleted(false), data(NULL), length(0) { }
+        bool deleted;
+        uint8_t *data;
+        uint32_t length;
+    };
+    typedef std::map<uint32_t, JournalState> JournalStateMap;
+
     BackUpResourceTable(ResourceBackupManager *manager,
                         const std::string &name,
                         const std::string& file_name);
@@ -43,14 +78,33 @@ public:
                                  uint32_t *hashsum);
     const std::string& file_name_str() {return file_name_str_;}
     const std::string& file_name_prefix() {return file_name_prefix_;}
+    const std::string& journal_file() {return journal_file_;}
+
+    // Type T1 is map sandesh used to encode the entry of type T2
+    template <typename T1, typename T2>
+    void JournalAdd(uint32_t index, const T2 &data);
+    void JournalDelete(uint32_t index);
+    bool CompactionRequired() const;
+    uint64_t journal_size() const {return journal_size_;}
+    uint64_t journal_records() const {return journal_records_;}
+    uint64_t snapshot_size() const {return snapshot_size_;}
 protected:
     template <typename T1, typename T2>
     bool WriteMapToFile(T1* sandesh_data, const T2& index_map);
     template <typename T>
     void ReadMapFromFile(T* sandesh_data, const std::string &root);
+    template <typename T1, typename T2>
+    void ReplayJournal(T2 *index_map);
     std::string backup_dir_;
 
 private:
+    bool AppendJournal(JournalOp op, uint32_t index, const uint8_t *data,
+                       uint32_t length);
+    uint32_t ScanJournal(uint8_t *buf, uint32_t size,
+                         JournalStateMap *state_map);
+    void OpenJournal(uint32_t valid_size);
+    void CloseJournal();
+
     ResourceBackupManager *backup_manager_;
     Agent *agent_;
     std::string name_;
@@ -60,6 +114,14 @@ private:
     uint8_t fall_back_count_;
     std::string file_name_str_;
     std::string file_name_prefix_;
+    std::string journal_file_;
+    int journal_fd_;
+    uint64_t journal_size_;
+    uint64_t journal_records_;
+    uint64_t snapshot_size_;
+    // Set when a change could not be journaled, snapshot must be written
+    // before the journal is usable again
+    bool snapshot_pending_;
     DISALLOW_COPY_AND_ASSIGN(BackUpResourceTable);
 };
 
@@ -184,6 +184,78 @@ TEST_F(SandeshReadWriteUnitTest, MplsLabelReuse) {
     client->WaitForIdle();
 }
 
+// Journal route label allocations, compact them in to snapshot and time
+// the restore of snapshot and journal after a churn of labels.
+// Count can be overridden with AGENT_RESOURCE_RESTORE_BENCH_COUNT.
+TEST_F(SandeshReadWriteUnitTest, JournalRestoreBench) {
+    uint32_t count = 10000;
+    if (getenv("AGENT_RESOURCE_RESTORE_BENCH_COUNT")) {
+        count = strtoul(getenv("AGENT_RESOURCE_RESTORE_BENCH_COUNT"), NULL, 0);
+    }
+    // Index range not used by labels allocated in test
+    const uint32_t base = 500000;
+    client->WaitForIdle();
+
+    ResourceSandeshMaps &maps =
+        agent->resource_manager()->backup_mgr()->sandesh_maps();
+    RouteMplsBackUpResourceTable &table = maps.route_mpls_index_table();
+    // Start with a snapshot so that journal holds only the changes below
+    EXPECT_TRUE(table.WriteToFile());
+    EXPECT_TRUE(table.journal_size() == 0);
+    size_t initial_size = table.map().size();
+
+    uint64_t t1 = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < count; i++) {
+        std::stringstream prefix;
+        prefix << "10." << ((i >> 16) & 0xFF) << "." << ((i >> 8) & 0xFF)
+            << "." << (i & 0xFF) << "/32";
+        RouteMplsResource data;
+        data.set_vrf_name("vrf1");
+        data.set_route_prefix(prefix.str());
+        data.set_time_stamp(UTCTimestampUsec());
+        maps.AddRouteMplsResourceEntry(base + i, data);
+    }
+    uint64_t t2 = ClockMonotonicUsec();
+    EXPECT_TRUE(table.journal_records() == count);
+    uint64_t journal_size = table.journal_size();
+
+    // Full snapshot, cost paid for every change without journal
+    EXPECT_TRUE(table.WriteToFile());
+    uint64_t t3 = ClockMonotonicUsec();
+    EXPECT_TRUE(table.journal_size() == 0);
+
+    // Churn 10% of labels
+    uint32_t churn = count / 10;
+    for (uint32_t i = 0; i < churn; i++) {
+        maps.DeleteRouteMplsResourceEntry(base + i);
+    }
+    uint64_t t4 = ClockMonotonicUsec();
+    EXPECT_TRUE(table.journal_records() == churn);
+    EXPECT_TRUE(table.map().size() == initial_size + count - churn);
+
+    // Restore snapshot and replay journal
+    table.map().clear();
+    uint64_t t5 = ClockMonotonicUsec();
+    table.ReadFromFile();
+    uint64_t t6 = ClockMonotonicUsec();
+    EXPECT_TRUE(table.map().size() == initial_size + count - churn);
+    EXPECT_TRUE(table.map().find(base) == table.map().end());
+    EXPECT_TRUE(table.map().find(base + churn) != table.map().end());
+
+    cout << "Entries " << count << " journal bytes " << journal_size
+        << " snapshot bytes " << table.snapshot_size() << endl;
+    cout << "Journal append " << (t2 - t1) << " usec, snapshot write "
+        << (t3 - t2) << " usec, churn of " << churn << " journaled in "
+        << (t4 - t3) << " usec" << endl;
+    cout << "Restore " << (t6 - t5) << " usec" << endl;
+
+    for (uint32_t i = churn; i < count; i++) {
+        maps.DeleteRouteMplsResourceEntry(base + i);
+    }
+    EXPECT_TRUE(table.map().size() == initial_size);
+    EXPECT_TRUE(table.WriteToFile());
+}
+
 int main(int argc, char **argv) {
     GETUSERARGS();
     client = TestInit(init_file, ksync_init, true, true, true,
@@ -14,16 +14,16 @@ ArpEntry::ArpEntry(boost::asio::io_service &io, ArpHandler *handler,
     : io_(io), key_(key), nh_vrf_(vrf), state_(state), retry_count_(0),
       handler_(handler), arp_timer_(NULL), interface_(itf) {
     if (!IsDerived()) {
-        arp_timer_ = TimerManager::CreateTimer(io, "Arp Entry timer",
-                TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
-                PktHandler::ARP);
+        ArpProto::ArpShard *shard =
+            handler->agent()->GetArpProto()->Shard(key.ip);
+        arp_timer_ = new WheelTimer(&shard->timer_wheel);
     }
 }
 
 ArpEntry::~ArpEntry() {
+    handler_->agent()->GetArpProto()->DeleteRouteUpdate(this);
     if (!IsDerived()) {
-        arp_timer_->Cancel();
-        TimerManager::DeleteTimer(arp_timer_);
+        delete arp_timer_;
     }
     handler_.reset(NULL);
 }
@@ -237,6 +237,10 @@ void ArpEntry::SendArpRequest() {
 }
 
 void ArpEntry::AddArpRoute(bool resolved) {
+    handler_->agent()->GetArpProto()->AddRouteUpdate(this, resolved);
+}
+
+void ArpEntry::UpdateArpRoute(bool resolved) {
     if (key_.vrf->GetName() == handler_->agent()->linklocal_vrf_name()) {
         // Do not squash existing route entry.
         // should be smarter and not replace an existing route.
@@ -309,6 +313,8 @@ void ArpEntry::AddArpRoute(bool resolved) {
 }
 
 bool ArpEntry::DeleteArpRoute() {
+    // Pending route update is superseded by delete
+    handler_->agent()->GetArpProto()->DeleteRouteUpdate(this);
     if (key_.vrf->GetName() == handler_->agent()->linklocal_vrf_name()) {
         return true;
     }
@@ -44,6 +44,8 @@ public:
     bool AgingExpiry();
     void SendGratuitousArp();
     bool DeleteArpRoute();
+    // Send route and nexthop of the entry to oper DB
+    void UpdateArpRoute(bool resolved);
     bool IsResolved();
     void Resync(bool policy, const VnListType &vnlist,
                 const SecurityGroupList &sg,
@@ -64,7 +66,7 @@ private:
     State state_;
     int retry_count_;
     boost::intrusive_ptr<ArpHandler> handler_;
-    Timer *arp_timer_;
+    WheelTimer *arp_timer_;
     InterfaceConstRef interface_;
     DISALLOW_COPY_AND_ASSIGN(ArpEntry);
 };
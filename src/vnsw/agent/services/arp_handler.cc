@@ -295,8 +295,39 @@ bool ArpHandler::HandleMessage() {
             break;
         }
 
+        case ArpProto::RETRY_TIMER_EXPIRED:
+        case ArpProto::AGING_TIMER_EXPIRED:
+        case ArpProto::GRATUITOUS_TIMER_EXPIRED: {
+            TimerExpiry(pkt_info_->ipc->cmd, ipc->key, ipc->interface_.get());
+            break;
+        }
+
+        case ArpProto::TIMER_EXPIRED_BATCH: {
+            ArpProto::ArpTimerIpc *timer_ipc =
+                static_cast<ArpProto::ArpTimerIpc *>(ipc);
+            ArpProto::ArpTimerEventList::iterator it =
+                timer_ipc->events.begin();
+            for (; it != timer_ipc->events.end(); ++it) {
+                TimerExpiry(it->type, it->key, it->interface_.get());
+            }
+            break;
+        }
+
+        default:
+            ARP_TRACE(Error, "Received Invalid internal ARP message : " +
+                      integerToString(pkt_info_->ipc->cmd));
+            break;
+    }
+    delete ipc;
+    return ret;
+}
+
+void ArpHandler::TimerExpiry(uint32_t type, ArpKey &key,
+                             const Interface *itf) {
+    ArpProto *arp_proto = agent()->GetArpProto();
+    switch (type) {
         case ArpProto::RETRY_TIMER_EXPIRED: {
-            ArpEntry *entry = arp_proto->FindArpEntry(ipc->key);
+            ArpEntry *entry = arp_proto->FindArpEntry(key);
             if (entry && !entry->RetryExpiry()) {
                 arp_proto->DeleteArpEntry(entry);
             }
@@ -304,7 +335,7 @@ bool ArpHandler::HandleMessage() {
         }
 
         case ArpProto::AGING_TIMER_EXPIRED: {
-            ArpEntry *entry = arp_proto->FindArpEntry(ipc->key);
+            ArpEntry *entry = arp_proto->FindArpEntry(key);
             if (entry && !entry->AgingExpiry()) {
                 arp_proto->DeleteArpEntry(entry);
             }
@@ -312,13 +343,12 @@ bool ArpHandler::HandleMessage() {
         }
 
         case ArpProto::GRATUITOUS_TIMER_EXPIRED: {
-            ArpEntry *entry =
-                arp_proto->GratuitousArpEntry(ipc->key, ipc->interface_.get());
+            ArpEntry *entry = arp_proto->GratuitousArpEntry(key, itf);
             if (entry && entry->retry_count() <= ArpProto::kGratRetries) {
                 entry->SendGratuitousArp();
             } else {
                 // Need to validate deleting the Arp entry upon fabric vrf Delete only
-                if (ipc->key.vrf->GetName() != agent()->fabric_vrf_name()) {
+                if (key.vrf->GetName() != agent()->fabric_vrf_name()) {
                     arp_proto->DeleteGratuitousArpEntry(entry);
                 }
             }
@@ -326,12 +356,8 @@ bool ArpHandler::HandleMessage() {
         }
 
         default:
-            ARP_TRACE(Error, "Received Invalid internal ARP message : " +
-                      integerToString(pkt_info_->ipc->cmd));
             break;
     }
-    delete ipc;
-    return ret;
 }
 
 void ArpHandler::EntryDelete(ArpKey &key) {
@@ -36,6 +36,7 @@ private:
     bool HandlePacket();
     bool HandleMessage();
     void EntryDelete(ArpKey &key);
+    void TimerExpiry(uint32_t type, ArpKey &key, const Interface *itf);
     uint16_t ArpHdr(const MacAddress &smac, in_addr_t sip,
                     const MacAddress &tmac, in_addr_t tip, uint16_t op);
 
@@ -22,9 +22,14 @@ ArpProto::ArpProto(Agent *agent, boost::asio::io_service &io,
     run_with_vrouter_(run_with_vrouter), ip_fabric_interface_index_(-1),
     ip_fabric_interface_(NULL), max_retries_(kMaxRetries),
     retry_timeout_(kRetryTimeout), aging_timeout_(kAgingTimeout) {
-    // limit the number of entries in the workqueue
-    work_queue_.SetSize(agent->params()->services_queue_limit());
-    work_queue_.SetBounded(true);
+    // First shard uses work queue of the protocol, running in task instance
+    // of ARP module. Others run in instances beyond the modules so that they
+    // do not serialize with other protocols
+    for (uint32_t i = 0; i < kShardCount; i++) {
+        int instance = (i == 0) ? PktHandler::ARP :
+            (PktHandler::MAX_MODULES + i - 1);
+        shards_.push_back(new ArpShard(this, i, instance, io));
+    }
 
     vrf_table_listener_id_ = agent->vrf_table()->Register(
                              boost::bind(&ArpProto::VrfNotify, this, _1, _2));
@@ -36,29 +41,118 @@ ArpProto::ArpProto(Agent *agent, boost::asio::io_service &io,
 }
 
 ArpProto::~ArpProto() {
+    STLDeleteValues(&shards_);
+}
+
+ArpProto::ArpShard::ArpShard(ArpProto *arp_proto, uint32_t shard_index,
+                             int task_instance, boost::asio::io_service &io) :
+    proto(arp_proto), index(shard_index), work_queue(NULL),
+    timer_wheel(io, "Arp timer wheel",
+                TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
+                task_instance) {
+    if (index == 0) {
+        work_queue = &proto->work_queue_;
+    } else {
+        work_queue = new ProtoWorkQueue(
+            TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
+            task_instance,
+            boost::bind(&ArpProto::ProcessProto, arp_proto, _1));
+    }
+    std::ostringstream str;
+    str << "Arp work queue. Shard " << index;
+    work_queue->set_name(str.str());
+    // limit the number of entries in the workqueue
+    work_queue->SetSize(proto->agent()->params()->services_queue_limit());
+    work_queue->SetBounded(true);
+    work_queue->SetExitCallback(boost::bind(&ArpProto::RouteUpdateDone, proto,
+                                            this, _1));
+    timer_wheel.set_tick_done_cb(boost::bind(&ArpProto::TimerTickDone, proto,
+                                             this));
+}
+
+// Work queue of first shard is owned by Proto, shut it down anyway since
+// its exit callback refers to the shard
+ArpProto::ArpShard::~ArpShard() {
+    work_queue->Shutdown();
+    if (work_queue != &proto->work_queue_) {
+        delete work_queue;
+    }
 }
 
 void ArpProto::Shutdown() {
-    // we may have arp entries in arp cache without ArpNH, empty them
-    for (ArpIterator it = arp_cache_.begin(); it != arp_cache_.end(); ) {
-        it = DeleteArpEntry(it);
-    }
-
-    for (GratuitousArpIterator it = gratuitous_arp_cache_.begin();
-            it != gratuitous_arp_cache_.end(); it++) {
-        for (ArpEntrySet::iterator sit = it->second.begin();
-             sit != it->second.end();) {
-            ArpEntry *entry = *sit;
-            it->second.erase(sit++);
-            delete entry;
+    for (ArpShardList::iterator sh = shards_.begin(); sh != shards_.end();
+         ++sh) {
+        ArpShard *shard = *sh;
+        // we may have arp entries in arp cache without ArpNH, empty them
+        for (ArpIterator it = shard->arp_cache.begin();
+             it != shard->arp_cache.end(); ) {
+            it = DeleteArpEntry(shard, it);
+        }
+
+        for (GratuitousArpIterator it = shard->gratuitous_arp_cache.begin();
+                it != shard->gratuitous_arp_cache.end(); it++) {
+            for (ArpEntrySet::iterator sit = it->second.begin();
+                 sit != it->second.end();) {
+                ArpEntry *entry = *sit;
+                it->second.erase(sit++);
+                delete entry;
+            }
         }
+        shard->gratuitous_arp_cache.clear();
+        shard->timer_events.clear();
     }
-    gratuitous_arp_cache_.clear();
     agent_->vrf_table()->Unregister(vrf_table_listener_id_);
     agent_->interface_table()->Unregister(interface_table_listener_id_);
     agent_->nexthop_table()->Unregister(nexthop_table_listener_id_);
 }
 
+// Mix the octets so that addresses of a subnet spread over the shards
+uint32_t ArpProto::ShardIndex(in_addr_t ip) const {
+    uint32_t hash = ip ^ (ip >> 16);
+    hash ^= (hash >> 8);
+    return hash % shards_.size();
+}
+
+// Shard of a message is picked from address being resolved, same as the key
+// of ArpEntry looked up by ArpHandler for the message
+uint32_t ArpProto::ShardIndex(const PktInfo *msg) const {
+    if (msg->type == PktType::MESSAGE) {
+        const ArpIpc *ipc = static_cast<const ArpIpc *>(msg->ipc);
+        if (ipc == NULL)
+            return 0;
+        if (ipc->cmd == TIMER_EXPIRED_BATCH)
+            return static_cast<const ArpTimerIpc *>(ipc)->shard;
+        return ShardIndex(ipc->key.ip);
+    }
+
+    if (msg->ip) {
+        return ShardIndex(ntohl(msg->ip->ip_dst.s_addr));
+    }
+
+    if (msg->arp) {
+        in_addr_t addr;
+        if (ntohs(msg->arp->ea_hdr.ar_op) == ARPOP_REQUEST) {
+            memcpy(&addr, msg->arp->arp_tpa, sizeof(in_addr_t));
+        } else {
+            memcpy(&addr, msg->arp->arp_spa, sizeof(in_addr_t));
+        }
+        return ShardIndex(ntohl(addr));
+    }
+    return 0;
+}
+
+bool ArpProto::Enqueue(boost::shared_ptr<PktInfo> msg) {
+    if (Validate(msg.get()) == false) {
+        return true;
+    }
+
+    if (free_buffer_) {
+        FreeBuffer(msg.get());
+    }
+
+    return shards_[ShardIndex(msg.get())]->work_queue->Enqueue(msg);
+}
+
 ProtoHandler *ArpProto::AllocProtoHandler(boost::shared_ptr<PktInfo> info,
                                           boost::asio::io_service &io) {
     return new ArpHandler(agent(), info, io);
@@ -72,28 +166,34 @@ void ArpProto::VrfNotify(DBTablePartBase *part, DBEntryBase *entry) {
                                                    vrf_table_listener_id_));
     if (entry->IsDeleted()) {
         if (state) {
-            for (ArpProto::ArpIterator it = arp_cache_.begin();
-                 it != arp_cache_.end();) {
-                ArpEntry *arp_entry = it->second;
-                if (arp_entry->key().vrf == vrf && arp_entry->DeleteArpRoute()) {
-                    it = DeleteArpEntry(it);
-                } else
-                    it++;
-            }
-            for (GratuitousArpIterator it = gratuitous_arp_cache_.begin();
-                 it != gratuitous_arp_cache_.end(); ) {
-                 ArpKey key = it->first;
-                 if (key.vrf == vrf) {
-                     for (ArpEntrySet::iterator sit = it->second.begin();
-                          sit != it->second.end();) {
-                         ArpEntry *entry = *sit;
-                         it->second.erase(sit++);
-                         delete entry;
+            for (ArpShardList::iterator sh = shards_.begin();
+                 sh != shards_.end(); ++sh) {
+                ArpShard *shard = *sh;
+                for (ArpProto::ArpIterator it = shard->arp_cache.begin();
+                     it != shard->arp_cache.end();) {
+                    ArpEntry *arp_entry = it->second;
+                    if (arp_entry->key().vrf == vrf &&
+                        arp_entry->DeleteArpRoute()) {
+                        it = DeleteArpEntry(shard, it);
+                    } else
+                        it++;
+                }
+                for (GratuitousArpIterator it =
+                     shard->gratuitous_arp_cache.begin();
+                     it != shard->gratuitous_arp_cache.end(); ) {
+                     ArpKey key = it->first;
+                     if (key.vrf == vrf) {
+                         for (ArpEntrySet::iterator sit = it->second.begin();
+                              sit != it->second.end();) {
+                             ArpEntry *entry = *sit;
+                             it->second.erase(sit++);
+                             delete entry;
+                         }
+                        shard->gratuitous_arp_cache.erase(it++);
+                     }else {
+                        it++;
                      }
-                    gratuitous_arp_cache_.erase(it++);
-                 }else {
-                    it++;
-                 }
+                }
             }
             state->Delete();
         }
@@ -137,19 +237,16 @@ ArpPathPreferenceState::ArpPathPreferenceState(ArpVrfState *state,
 
 ArpPathPreferenceState::~ArpPathPreferenceState() {
     if (arp_req_timer_) {
-        arp_req_timer_->Cancel();
-        TimerManager::DeleteTimer(arp_req_timer_);
+        delete arp_req_timer_;
     }
     assert(refcount_ == 0);
 }
 
 void ArpPathPreferenceState::StartTimer() {
     if (arp_req_timer_ == NULL) {
-        arp_req_timer_ = TimerManager::CreateTimer(
-                *(vrf_state_->agent->event_manager()->io_service()),
-                "Arp Entry timer for VM",
-                TaskScheduler::GetInstance()->
-                GetTaskId("Agent::Services"), PktHandler::ARP);
+        ArpProto::ArpShard *shard =
+            vrf_state_->arp_proto->Shard(vm_ip_.to_v4().to_ulong());
+        arp_req_timer_ = new WheelTimer(&shard->timer_wheel);
     }
     arp_req_timer_->Start(kTimeout,
                           boost::bind(&ArpPathPreferenceState::SendArpRequest,
@@ -231,6 +328,7 @@ bool ArpPathPreferenceState::SendArpRequest(WaitForTrafficIntfMap
 }
 
 bool ArpPathPreferenceState::SendArpRequest() {
+    tbb::mutex::scoped_lock lock(mutex_);
     if (l3_wait_for_traffic_map_.size() == 0 &&
         evpn_wait_for_traffic_map_.size() == 0) {
         return false;
@@ -333,21 +431,26 @@ void ArpDBState::UpdateMac(const InterfaceNH *nh) {
     return;
 }
 
+// Addresses of the subnet are spread over all the shards, walk the range of
+// subnet in each of them
 void ArpDBState::UpdateArpRoutes(const InetUnicastRouteEntry *rt) {
     int plen = rt->plen();
     uint32_t start_ip = rt->addr().to_v4().to_ulong();
     ArpKey start_key(start_ip, rt->vrf());
-
-    ArpProto::ArpIterator start_iter =
-        vrf_state_->arp_proto->FindUpperBoundArpEntry(start_key);
-
-
-    while (start_iter != vrf_state_->arp_proto->arp_cache().end() &&
-           start_iter->first.vrf == rt->vrf() &&
-           IsIp4SubnetMember(Ip4Address(start_iter->first.ip),
-                             rt->addr().to_v4(), plen)) {
-        start_iter->second->Resync(policy_, vn_list_, sg_list_, tag_list_);
-        start_iter++;
+    ArpProto *arp_proto = vrf_state_->arp_proto;
+
+    for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+        ArpProto::ArpCache &cache = arp_proto->shard(i)->arp_cache;
+        ArpProto::ArpIterator start_iter = cache.upper_bound(start_key);
+
+        while (start_iter != cache.end() &&
+               start_iter->first.vrf == rt->vrf() &&
+               IsIp4SubnetMember(Ip4Address(start_iter->first.ip),
+                                 rt->addr().to_v4(), plen)) {
+            start_iter->second->Resync(policy_, vn_list_, sg_list_,
+                                       tag_list_);
+            start_iter++;
+        }
     }
 }
 
@@ -356,17 +459,20 @@ void ArpDBState::Delete(const InetUnicastRouteEntry *rt) {
     uint32_t start_ip = rt->addr().to_v4().to_ulong();
 
     ArpKey start_key(start_ip, rt->vrf());
-
-    ArpProto::ArpIterator start_iter =
-        vrf_state_->arp_proto->FindUpperBoundArpEntry(start_key);
-
-    while (start_iter != vrf_state_->arp_proto->arp_cache().end() &&
-           start_iter->first.vrf == rt->vrf() &&
-           IsIp4SubnetMember(Ip4Address(start_iter->first.ip),
-                             rt->addr().to_v4(), plen)) {
-        ArpProto::ArpIterator tmp = start_iter++;
-        if (tmp->second->DeleteArpRoute()) {
-            vrf_state_->arp_proto->DeleteArpEntry(tmp->second);
+    ArpProto *arp_proto = vrf_state_->arp_proto;
+
+    for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+        ArpProto::ArpCache &cache = arp_proto->shard(i)->arp_cache;
+        ArpProto::ArpIterator start_iter = cache.upper_bound(start_key);
+
+        while (start_iter != cache.end() &&
+               start_iter->first.vrf == rt->vrf() &&
+               IsIp4SubnetMember(Ip4Address(start_iter->first.ip),
+                                 rt->addr().to_v4(), plen)) {
+            ArpProto::ArpIterator tmp = start_iter++;
+            if (tmp->second->DeleteArpRoute()) {
+                arp_proto->DeleteArpEntry(tmp->second);
+            }
         }
     }
 }
@@ -629,11 +735,12 @@ void ArpProto::InterfaceNotify(DBEntryBase *entry) {
             while (key_it != intf_entry.arp_key_list.end()) {
                 ArpKey key = *key_it;
                 ++key_it;
-                ArpIterator arp_it = arp_cache_.find(key);
-                if (arp_it != arp_cache_.end()) {
+                ArpShard *shard = Shard(key.ip);
+                ArpIterator arp_it = shard->arp_cache.find(key);
+                if (arp_it != shard->arp_cache.end()) {
                     ArpEntry *arp_entry = arp_it->second;
                     if (arp_entry->DeleteArpRoute()) {
-                        DeleteArpEntry(arp_it);
+                        DeleteArpEntry(shard, arp_it);
                     }
                 }
             }
@@ -686,6 +793,7 @@ void ArpProto::InterfaceNotify(DBEntryBase *entry) {
 }
 
 ArpProto::InterfaceArpInfo& ArpProto::ArpMapIndexToEntry(uint32_t idx) {
+    tbb::mutex::scoped_lock lock(interface_arp_map_mutex_);
     InterfaceArpMap::iterator it = interface_arp_map_.find(idx);
     if (it == interface_arp_map_.end()) {
         InterfaceArpInfo entry;
@@ -755,40 +863,79 @@ void ArpProto::NextHopNotify(DBEntryBase *entry) {
 
 bool ArpProto::TimerExpiry(ArpKey &key, uint32_t timer_type,
                            const Interface* itf) {
-    if (arp_cache_.find(key) != arp_cache_.end() ||
-        gratuitous_arp_cache_.find(key) != gratuitous_arp_cache_.end()) {
+    ArpShard *shard = Shard(key.ip);
+    if (shard->arp_cache.find(key) != shard->arp_cache.end() ||
+        shard->gratuitous_arp_cache.find(key) !=
+        shard->gratuitous_arp_cache.end()) {
         if (itf) {
-            SendArpIpc((ArpProto::ArpMsgType)timer_type, key, itf);
+            shard->timer_events.push_back(ArpTimerEvent
+                                          ((ArpProto::ArpMsgType)timer_type,
+                                           key, itf));
         }
     }
     return false;
 }
 
+// Send expiries of a tick of the timer wheel in single message
+void ArpProto::TimerTickDone(ArpShard *shard) {
+    if (shard->timer_events.empty())
+        return;
+
+    ArpTimerIpc *ipc = new ArpTimerIpc(shard->index);
+    ipc->events.swap(shard->timer_events);
+    agent_->pkt()->pkt_handler()->SendMessage(PktHandler::ARP, ipc);
+}
+
+// Route update of an entry is deferred till the shard is done with current
+// batch of messages. Only the last update of an entry in the batch is sent
+// to oper DB, so a burst of requests and replies for an address results in
+// a single route and nexthop update
+void ArpProto::AddRouteUpdate(ArpEntry *entry, bool resolved) {
+    Shard(entry->key().ip)->route_updates[entry] = resolved;
+}
+
+void ArpProto::DeleteRouteUpdate(ArpEntry *entry) {
+    Shard(entry->key().ip)->route_updates.erase(entry);
+}
+
+void ArpProto::RouteUpdateDone(ArpShard *shard, bool done) {
+    ArpRouteUpdateMap updates;
+    updates.swap(shard->route_updates);
+    for (ArpRouteUpdateMap::iterator it = updates.begin();
+         it != updates.end(); ++it) {
+        it->first->UpdateArpRoute(it->second);
+    }
+}
+
  void ArpProto::AddGratuitousArpEntry(ArpKey &key) {
      ArpEntrySet empty_set;
-     gratuitous_arp_cache_.insert(GratuitousArpCachePair(key, empty_set));
+     Shard(key.ip)->gratuitous_arp_cache.insert
+         (GratuitousArpCachePair(key, empty_set));
 }
 
 void ArpProto::DeleteGratuitousArpEntry(ArpEntry *entry) {
     if (!entry)
         return ;
 
-    ArpProto::GratuitousArpIterator iter = gratuitous_arp_cache_.find(entry->key());
-    if (iter == gratuitous_arp_cache_.end()) {
+    ArpShard *shard = Shard(entry->key().ip);
+    ArpProto::GratuitousArpIterator iter =
+        shard->gratuitous_arp_cache.find(entry->key());
+    if (iter == shard->gratuitous_arp_cache.end()) {
         return;
     }
 
     iter->second.erase(entry);
     delete entry;
     if (iter->second.empty()) {
-        gratuitous_arp_cache_.erase(iter);
+        shard->gratuitous_arp_cache.erase(iter);
     }
 }
 
 ArpEntry *
 ArpProto::GratuitousArpEntry(const ArpKey &key, const Interface *intf) {
-    ArpProto::GratuitousArpIterator it = gratuitous_arp_cache_.find(key);
-    if (it == gratuitous_arp_cache_.end())
+    ArpShard *shard = Shard(key.ip);
+    ArpProto::GratuitousArpIterator it = shard->gratuitous_arp_cache.find(key);
+    if (it == shard->gratuitous_arp_cache.end())
         return NULL;
 
     for (ArpEntrySet::iterator sit = it->second.begin();
@@ -803,8 +950,9 @@ ArpProto::GratuitousArpEntry(const ArpKey &key, const Interface *intf) {
 
 ArpProto::GratuitousArpIterator
 ArpProto::GratuitousArpEntryIterator(const ArpKey &key, bool *key_valid) {
-    ArpProto::GratuitousArpIterator it = gratuitous_arp_cache_.find(key);
-    if (it == gratuitous_arp_cache_.end())
+    ArpShard *shard = Shard(key.ip);
+    ArpProto::GratuitousArpIterator it = shard->gratuitous_arp_cache.find(key);
+    if (it == shard->gratuitous_arp_cache.end())
         return it;
     const VrfEntry *vrf = key.vrf;
     if (!vrf)
@@ -840,8 +988,11 @@ bool ArpProto::AddArpEntry(ArpEntry *entry) {
     if (state == NULL || state->deleted == true)
         return false;
 
-    bool ret = arp_cache_.insert(ArpCachePair(entry->key(), entry)).second;
+    ArpShard *shard = Shard(entry->key().ip);
+    bool ret =
+        shard->arp_cache.insert(ArpCachePair(entry->key(), entry)).second;
     uint32_t intf_id = entry->get_interface()->id();
+    tbb::mutex::scoped_lock lock(interface_arp_map_mutex_);
     InterfaceArpMap::iterator it = interface_arp_map_.find(intf_id);
     if (it == interface_arp_map_.end()) {
         InterfaceArpInfo intf_entry;
@@ -861,30 +1012,41 @@ bool ArpProto::DeleteArpEntry(ArpEntry *entry) {
     if (!entry)
         return false;
 
-    ArpProto::ArpIterator iter = arp_cache_.find(entry->key());
-    if (iter == arp_cache_.end()) {
+    ArpShard *shard = Shard(entry->key().ip);
+    ArpProto::ArpIterator iter = shard->arp_cache.find(entry->key());
+    if (iter == shard->arp_cache.end()) {
         return false;
     }
 
-    DeleteArpEntry(iter);
+    DeleteArpEntry(shard, iter);
     return true;
 }
 
 ArpProto::ArpIterator
-ArpProto::DeleteArpEntry(ArpProto::ArpIterator iter) {
+ArpProto::DeleteArpEntry(ArpShard *shard, ArpProto::ArpIterator iter) {
     ArpEntry *entry = iter->second;
-    arp_cache_.erase(iter++);
+    shard->arp_cache.erase(iter++);
     delete entry;
     return iter;
 }
 
 ArpEntry *ArpProto::FindArpEntry(const ArpKey &key) {
-    ArpIterator it = arp_cache_.find(key);
-    if (it == arp_cache_.end())
+    ArpShard *shard = Shard(key.ip);
+    ArpIterator it = shard->arp_cache.find(key);
+    if (it == shard->arp_cache.end())
         return NULL;
     return it->second;
 }
 
+std::size_t ArpProto::GetArpCacheSize() {
+    std::size_t size = 0;
+    for (ArpShardList::const_iterator it = shards_.begin();
+         it != shards_.end(); ++it) {
+        size += (*it)->arp_cache.size();
+    }
+    return size;
+}
+
 bool ArpProto::ValidateAndClearVrfState(VrfEntry *vrf,
                                         const ArpVrfState *vrf_state) {
     if (!vrf_state->deleted) {
@@ -918,17 +1080,8 @@ bool ArpProto::ValidateAndClearVrfState(VrfEntry *vrf,
     return true;
 }
 
-ArpProto::ArpIterator
-ArpProto::FindUpperBoundArpEntry(const ArpKey &key) {
-        return arp_cache_.upper_bound(key);
-}
-
-ArpProto::ArpIterator
-ArpProto::FindLowerBoundArpEntry(const ArpKey &key) {
-        return arp_cache_.lower_bound(key);
-}
-
 void ArpPathPreferenceState::HandleArpReply(Ip4Address sip, uint32_t itf) {
+    tbb::mutex::scoped_lock lock(mutex_);
     WaitForTrafficIntfMap::iterator it = l3_wait_for_traffic_map_.find(itf);
     if (it == l3_wait_for_traffic_map_.end()) {
         return;
@@ -5,8 +5,11 @@
 #ifndef vnsw_agent_arp_proto_hpp
 #define vnsw_agent_arp_proto_hpp
 
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
 #include "pkt/proto.h"
 #include "services/arp_handler.h"
+#include "services/timer_wheel.h"
 #include "services/arp_entry.h"
 
 #define ARP_TRACE(obj, ...)                                                 \
@@ -24,6 +27,7 @@ public:
     static const uint16_t kMaxRetries = 8;
     static const uint32_t kRetryTimeout = 2000;            // milli seconds
     static const uint32_t kAgingTimeout = (5 * 60 * 1000); // milli seconds
+    static const uint32_t kShardCount = 4;
 
     typedef std::map<ArpKey, ArpEntry *> ArpCache;
     typedef std::pair<ArpKey, ArpEntry *> ArpCachePair;
@@ -41,7 +45,9 @@ public:
         RETRY_TIMER_EXPIRED,
         AGING_TIMER_EXPIRED,
         GRATUITOUS_TIMER_EXPIRED,
+        TIMER_EXPIRED_BATCH,
     };
+    typedef std::map<ArpEntry *, bool> ArpRouteUpdateMap;
 
     struct ArpIpc : InterTaskMsg {
         ArpIpc(ArpProto::ArpMsgType msg, ArpKey &akey, InterfaceConstRef itf)
@@ -54,6 +60,28 @@ public:
         InterfaceConstRef interface_;
     };
 
+    // Timer expiry of an entry, expiries of a tick of the timer wheel are
+    // sent to ArpHandler in one ArpTimerIpc
+    struct ArpTimerEvent {
+        ArpTimerEvent(ArpProto::ArpMsgType msg, const ArpKey &akey,
+                      InterfaceConstRef itf) :
+            type(msg), key(akey), interface_(itf) {}
+
+        ArpProto::ArpMsgType type;
+        ArpKey key;
+        InterfaceConstRef interface_;
+    };
+    typedef std::vector<ArpTimerEvent> ArpTimerEventList;
+
+    struct ArpTimerIpc : ArpIpc {
+        explicit ArpTimerIpc(uint32_t index) :
+            ArpIpc(TIMER_EXPIRED_BATCH, 0, NULL, InterfaceConstRef()),
+            shard(index) {}
+
+        uint32_t shard;
+        ArpTimerEventList events;
+    };
+
     struct ArpStats {
         ArpStats() { Reset(); }
         void Reset() {
@@ -64,20 +92,20 @@ public:
             ipfabric_not_inst = 0;
         }
 
-        uint32_t arp_req;
-        uint32_t arp_replies;
-        uint32_t arp_gratuitous;
-        uint32_t resolved;
-        uint32_t max_retries_exceeded;
-        uint32_t errors;
-        uint32_t arp_invalid_packets;
-        uint32_t arp_invalid_interface;
-        uint32_t arp_invalid_vrf;
-        uint32_t arp_invalid_address;
-        uint32_t vm_arp_req;
-        uint32_t vm_garp_req;
-        uint32_t agent_not_inst;
-        uint32_t ipfabric_not_inst;
+        tbb::atomic<uint32_t> arp_req;
+        tbb::atomic<uint32_t> arp_replies;
+        tbb::atomic<uint32_t> arp_gratuitous;
+        tbb::atomic<uint32_t> resolved;
+        tbb::atomic<uint32_t> max_retries_exceeded;
+        tbb::atomic<uint32_t> errors;
+        tbb::atomic<uint32_t> arp_invalid_packets;
+        tbb::atomic<uint32_t> arp_invalid_interface;
+        tbb::atomic<uint32_t> arp_invalid_vrf;
+        tbb::atomic<uint32_t> arp_invalid_address;
+        tbb::atomic<uint32_t> vm_arp_req;
+        tbb::atomic<uint32_t> vm_garp_req;
+        tbb::atomic<uint32_t> agent_not_inst;
+        tbb::atomic<uint32_t> ipfabric_not_inst;
     };
 
     struct InterfaceArpInfo {
@@ -88,21 +116,54 @@ public:
     typedef std::map<uint32_t, InterfaceArpInfo> InterfaceArpMap;
     typedef std::pair<uint32_t, InterfaceArpInfo> InterfaceArpPair;
 
+    // ARP entries are hashed on IP address in to kShardCount shards. Each
+    // shard has its own work queue, running in its own instance of
+    // Agent::Services, caches and timer wheel, so that ARP packets and
+    // timers of addresses in different shards are processed in parallel.
+    // All entries of an address, including derived entries in other VRFs,
+    // belong to the same shard.
+    struct ArpShard {
+        ArpShard(ArpProto *proto, uint32_t index, int task_instance,
+                 boost::asio::io_service &io);
+        ~ArpShard();
+
+        ArpProto *proto;
+        uint32_t index;
+        ProtoWorkQueue *work_queue;
+        ArpCache arp_cache;
+        GratuitousArpCache gratuitous_arp_cache;
+        // Retry, aging and gratuitous timers of entries in the shard
+        TimerWheel timer_wheel;
+        // Expiries in current tick of timer_wheel, yet to be sent to handler
+        ArpTimerEventList timer_events;
+        // Route updates of entries, coalesced and sent to oper DB when
+        // work_queue is done with a batch of messages
+        ArpRouteUpdateMap route_updates;
+    };
+    typedef std::vector<ArpShard *> ArpShardList;
+
     void Shutdown();
     ArpProto(Agent *agent, boost::asio::io_service &io, bool run_with_vrouter);
     virtual ~ArpProto();
 
+    virtual bool Enqueue(boost::shared_ptr<PktInfo> msg);
     ProtoHandler *AllocProtoHandler(boost::shared_ptr<PktInfo> info,
                                     boost::asio::io_service &io);
     bool TimerExpiry(ArpKey &key, uint32_t timer_type, const Interface *itf);
 
+    uint32_t shard_count() const { return shards_.size(); }
+    ArpShard *shard(uint32_t index) const { return shards_[index]; }
+    ArpShard *Shard(in_addr_t ip) const { return shards_[ShardIndex(ip)]; }
+    uint32_t ShardIndex(in_addr_t ip) const;
+    uint32_t ShardIndex(const PktInfo *msg) const;
+
     bool AddArpEntry(ArpEntry *entry);
     bool DeleteArpEntry(ArpEntry *entry);
     ArpEntry *FindArpEntry(const ArpKey &key);
-    std::size_t GetArpCacheSize() { return arp_cache_.size(); }
-    const ArpCache& arp_cache() { return arp_cache_; }
-    const GratuitousArpCache& gratuitous_arp_cache() { return gratuitous_arp_cache_; }
+    std::size_t GetArpCacheSize();
     const InterfaceArpMap& interface_arp_map() { return interface_arp_map_; }
+    void AddRouteUpdate(ArpEntry *entry, bool resolved);
+    void DeleteRouteUpdate(ArpEntry *entry);
 
     Interface *ip_fabric_interface() const { return ip_fabric_interface_; }
     uint32_t ip_fabric_interface_index() const {
@@ -172,8 +233,6 @@ public:
     void SendArpIpc(ArpProto::ArpMsgType type, in_addr_t ip,
                     const VrfEntry *vrf, InterfaceConstRef itf);
     bool ValidateAndClearVrfState(VrfEntry *vrf, const ArpVrfState *vrf_state);
-    ArpIterator FindUpperBoundArpEntry(const ArpKey &key);
-    ArpIterator FindLowerBoundArpEntry(const ArpKey &key);
     void HandlePathPreferenceArpReply(const VrfEntry *vrf, uint32_t itf,
                                       Ip4Address sip);
 
@@ -189,11 +248,13 @@ private:
     void InterfaceNotify(DBEntryBase *entry);
     void SendArpIpc(ArpProto::ArpMsgType type, ArpKey &key,
                     InterfaceConstRef itf);
-    ArpProto::ArpIterator DeleteArpEntry(ArpProto::ArpIterator iter);
+    ArpProto::ArpIterator DeleteArpEntry(ArpShard *shard,
+                                         ArpProto::ArpIterator iter);
+    void TimerTickDone(ArpShard *shard);
+    void RouteUpdateDone(ArpShard *shard, bool done);
 
-    ArpCache arp_cache_;
+    ArpShardList shards_;
     ArpStats arp_stats_;
-    GratuitousArpCache gratuitous_arp_cache_;
     bool run_with_vrouter_;
     uint32_t ip_fabric_interface_index_;
     MacAddress ip_fabric_interface_mac_;
@@ -202,6 +263,8 @@ private:
     DBTableBase::ListenerId interface_table_listener_id_;
     DBTableBase::ListenerId nexthop_table_listener_id_;
     InterfaceArpMap interface_arp_map_;
+    // Shards update interface_arp_map_ in parallel
+    tbb::mutex interface_arp_map_mutex_;
 
     uint16_t max_retries_;
     uint32_t retry_timeout_;   // milli seconds
@@ -311,13 +374,16 @@ private:
     friend void intrusive_ptr_add_ref(ArpPathPreferenceState *aps);
     friend void intrusive_ptr_release(ArpPathPreferenceState *aps);
     ArpVrfState *vrf_state_;
-    Timer *arp_req_timer_;
+    WheelTimer *arp_req_timer_;
     uint32_t vrf_id_;
     IpAddress vm_ip_;
     uint8_t plen_;
     MacAddress mac_;
     WaitForTrafficIntfMap l3_wait_for_traffic_map_;
     WaitForTrafficIntfMap evpn_wait_for_traffic_map_;
+    // Reply of an address in subnet can be handled in a shard other than
+    // the shard running arp_req_timer_
+    tbb::mutex mutex_;
     tbb::atomic<int> refcount_;
 };
 
@@ -1,7 +1,12 @@
 
-#include <pugixml/pugixml.hpp>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include "base/address_util.h"
+#include "base/string_util.h"
+#include "base/task_trigger.h"
 #include "base/timer.h"
 #include "cmn/agent_cmn.h"
 #include "init/agent_param.h"
@@ -10,20 +15,21 @@
 #include "services/dhcp_lease_db.h"
 #include "services/dhcp_proto.h"
 
-using namespace pugi;
-
 DhcpLeaseDb::DhcpLeaseDb(const Ip4Address &subnet, uint8_t plen,
                          const std::vector<Ip4Address> &reserve_addresses,
                          const std::string &lease_filename,
                          boost::asio::io_service &io) :
     subnet_(subnet), plen_(plen),
     max_lease_update_count_(0), lease_update_count_(0),
-    lease_timeout_(kDhcpLeaseTimer), lease_filename_(lease_filename) {
+    lease_timeout_(kDhcpLeaseTimer), lease_filename_(lease_filename),
+    lease_fd_(-1), lease_commits_(0), lease_compactions_(0) {
     ReserveAddresses(reserve_addresses, true);
     LoadLeaseFile();
-    timer_ = TimerManager::CreateTimer(io, "DhcpLeaseTimer",
-                                       TaskScheduler::GetInstance()->
-                                       GetTaskId("Agent::Services"),
+    int task_id = TaskScheduler::GetInstance()->GetTaskId("Agent::Services");
+    commit_trigger_ =
+        new TaskTrigger(boost::bind(&DhcpLeaseDb::CommitLeaseRecords, this),
+                        task_id, PktHandler::DHCP);
+    timer_ = TimerManager::CreateTimer(io, "DhcpLeaseTimer", task_id,
                                        PktHandler::DHCP);
     timer_->Start(lease_timeout_,
                   boost::bind(&DhcpLeaseDb::LeaseTimerExpiry, this));
@@ -34,6 +40,10 @@ DhcpLeaseDb::~DhcpLeaseDb() {
     released_lease_bitmap_.clear();
     timer_->Cancel();
     TimerManager::DeleteTimer(timer_);
+    commit_trigger_->Reset();
+    delete commit_trigger_;
+    CommitLeaseRecords();
+    CloseLeaseFile();
     // remove(lease_filename_.c_str());
 }
 
@@ -48,6 +58,8 @@ void DhcpLeaseDb::Update(const Ip4Address &subnet, uint8_t plen,
         leases_.clear();
         lease_bitmap_.clear();
         released_lease_bitmap_.clear();
+        pending_records_.clear();
+        CloseLeaseFile();
         remove(lease_filename_.c_str());
         subnet_change = true;
     }
@@ -131,19 +143,28 @@ bool DhcpLeaseDb::LeaseTimerExpiry() {
     }
 
     lease_update_count_ += changed_leases.size();
-    if (lease_update_count_ >= max_lease_update_count_) {
-        // Re-create the lease file, so that it is compacted
-        CreateLeaseFile();
-        lease_update_count_ = 0;
-    } else if (changed_leases.size()) {
-        PersistLeaseRecords(changed_leases);
+    for (std::vector<DhcpLease>::const_iterator it = changed_leases.begin();
+         it != changed_leases.end(); ++it) {
+        PersistLeaseRecord(it->mac_, it->ip_, it->lease_expiry_time_,
+                           it->released_);
     }
+    // Compaction is done from commit, even if no lease has changed
+    if (lease_update_count_ >= max_lease_update_count_)
+        commit_trigger_->Set();
 
     return true;
 }
 
 void DhcpLeaseDb::UpdateLease(const MacAddress &mac, const Ip4Address &ip,
                               uint64_t expiry, bool released) {
+    SetLease(mac, ip, expiry, released);
+    DHCP_TRACE(Trace, "DHCP Lease : " << mac.ToString() << " " <<
+               ip.to_string() << " " << expiry << " " <<
+               (released ? "released" : "valid"));
+}
+
+void DhcpLeaseDb::SetLease(const MacAddress &mac, const Ip4Address &ip,
+                           uint64_t expiry, bool released) {
     size_t index = AddressToIndex(ip);
     lease_bitmap_[index] = 0;
     released_lease_bitmap_[index] = (released) ? 1 : 0;
@@ -156,9 +177,6 @@ void DhcpLeaseDb::UpdateLease(const MacAddress &mac, const Ip4Address &ip,
     } else {
         leases_.insert(DhcpLease(mac, ip, expiry, released));
     }
-    DHCP_TRACE(Trace, "DHCP Lease : " << mac.ToString() << " " <<
-               ip.to_string() << " " << expiry << " " <<
-               (released ? "released" : "valid"));
 }
 
 // block the reserved addresses
@@ -224,83 +242,126 @@ void DhcpLeaseDb::set_lease_timeout(uint32_t timeout) {
     }
 }
 
-// Write the complete lease file
-void DhcpLeaseDb::CreateLeaseFile() {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(),
-                        std::ofstream::out | std::ofstream::trunc);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
-        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << lease_filename_);
-        return;
-    }
-
+// Write the complete lease file. Leases are written to a temporary file,
+// which is synced and renamed to the lease file, so that the lease file is
+// never partially written
+bool DhcpLeaseDb::CreateLeaseFile() {
+    std::string records;
     for (std::set<DhcpLease>::const_iterator it = leases_.begin();
          it != leases_.end(); ++it) {
-        WriteLeaseRecord(lease_ofstream, it->mac_, it->ip_,
-                         it->lease_expiry_time_, it->released_);
+        FormatLeaseRecord(&records, it->mac_, it->ip_,
+                          it->lease_expiry_time_, it->released_);
     }
 
-    lease_ofstream.flush();
-    lease_ofstream.close();
+    std::string tmp_filename = lease_filename_ + ".tmp";
+    int fd = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << tmp_filename);
+        return false;
+    }
+
+    bool ret = WriteLeaseFile(fd, records);
+    close(fd);
+    if (ret == false || rename(tmp_filename.c_str(),
+                               lease_filename_.c_str()) != 0) {
+        DHCP_TRACE(Error, "Cannot create DHCP Lease file: " << lease_filename_);
+        remove(tmp_filename.c_str());
+        return false;
+    }
+
+    // Subsequent records are appended to the new file
+    CloseLeaseFile();
+    lease_compactions_++;
+    return true;
 }
 
-// Append lease record
-void DhcpLeaseDb::PersistLeaseRecord(const MacAddress &mac,
-                                     const Ip4Address &ip,
-                                     const uint64_t &expiry,
-                                     bool released) {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(), std::ofstream::app);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
+bool DhcpLeaseDb::OpenLeaseFile() {
+    if (lease_fd_ >= 0)
+        return true;
+
+    lease_fd_ = open(lease_filename_.c_str(),
+                     O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (lease_fd_ < 0) {
         DHCP_TRACE(Error, "Cannot open DHCP Lease file for writing : " <<
                    lease_filename_);
-        return;
+        return false;
     }
+    return true;
+}
 
-    WriteLeaseRecord(lease_ofstream, mac, ip, expiry, released);
+void DhcpLeaseDb::CloseLeaseFile() {
+    if (lease_fd_ >= 0) {
+        close(lease_fd_);
+        lease_fd_ = -1;
+    }
+}
 
-    lease_ofstream.flush();
-    lease_ofstream.close();
+// Write records and sync them to disk
+bool DhcpLeaseDb::WriteLeaseFile(int fd, const std::string &records) {
+    const char *buf = records.data();
+    size_t len = records.size();
+    while (len) {
+        ssize_t ret = write(fd, buf, len);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        buf += ret;
+        len -= ret;
+    }
+    return (fdatasync(fd) == 0);
 }
 
-void DhcpLeaseDb::PersistLeaseRecords(const std::vector<DhcpLease> &leases) {
-    std::ofstream lease_ofstream;
-    lease_ofstream.open(lease_filename_.c_str(), std::ofstream::app);
-    if (!lease_ofstream.good()) {
-        lease_ofstream.close();
-        DHCP_TRACE(Error, "Cannot open DHCP Lease file for writing : "
-                   << lease_filename_);
-        return;
+// Commit the records buffered since last commit with a single write. Once
+// enough lease updates are accumulated, lease file is compacted instead,
+// which also covers the buffered records.
+bool DhcpLeaseDb::CommitLeaseRecords() {
+    if (lease_update_count_ >= max_lease_update_count_) {
+        if (CreateLeaseFile()) {
+            pending_records_.clear();
+            lease_update_count_ = 0;
+            return true;
+        }
     }
 
-    for (std::vector<DhcpLease>::const_iterator it = leases.begin();
-         it != leases.end(); ++it) {
-        WriteLeaseRecord(lease_ofstream, it->mac_, it->ip_,
-                         it->lease_expiry_time_, it->released_);
+    if (pending_records_.empty())
+        return true;
+
+    if (OpenLeaseFile()) {
+        if (WriteLeaseFile(lease_fd_, pending_records_) == false) {
+            DHCP_TRACE(Error, "Lease write to " << lease_filename_ <<
+                       " failed");
+            CloseLeaseFile();
+        }
+        lease_commits_++;
     }
+    pending_records_.clear();
+    return true;
+}
 
-    lease_ofstream.flush();
-    lease_ofstream.close();
+// Buffer lease record, to be committed along with other updates
+void DhcpLeaseDb::PersistLeaseRecord(const MacAddress &mac,
+                                     const Ip4Address &ip,
+                                     const uint64_t &expiry,
+                                     bool released) {
+    FormatLeaseRecord(&pending_records_, mac, ip, expiry, released);
+    commit_trigger_->Set();
 }
 
-void DhcpLeaseDb::WriteLeaseRecord(std::ofstream &lease_ofstream,
-                                   const MacAddress &mac, const Ip4Address &ip,
-                                   const uint64_t &expiry, bool released) {
-    lease_ofstream << "<lease>";
-    lease_ofstream << " <mac>" << mac.ToString() << "</mac>";
-    lease_ofstream << " <ip>" << ip.to_string() << "</ip>";
-    lease_ofstream << " <expiry>" << expiry << "</expiry>";
-    lease_ofstream << " <released>" <<
-        (released ? "true" : "false") << "</released>";
-    lease_ofstream << " </lease>" << std::endl;
-
-    if (!lease_ofstream.good()) {
-        DHCP_TRACE(Error, "Lease write to " << lease_filename_ <<
-                   " failed : " << mac.ToString() << " " << ip.to_string() <<
-                   (released ? " released" : " valid"));
-    }
+void DhcpLeaseDb::FormatLeaseRecord(std::string *records,
+                                    const MacAddress &mac,
+                                    const Ip4Address &ip,
+                                    const uint64_t &expiry, bool released) {
+    records->append("<lease> <mac>");
+    records->append(mac.ToString());
+    records->append("</mac> <ip>");
+    records->append(ip.to_string());
+    records->append("</ip> <expiry>");
+    records->append(integerToString(expiry));
+    records->append("</expiry> <released>");
+    records->append(released ? "true" : "false");
+    records->append("</released> </lease>\n");
 }
 
 void DhcpLeaseDb::LoadLeaseFile() {
@@ -327,67 +388,95 @@ void DhcpLeaseDb::ReadLeaseFile(std::string &leases) {
     ifile.close();
 }
 
+// Each line of the file is a lease record, records are applied in order so
+// that the last record of a client is retained
 void DhcpLeaseDb::ParseLeaseFile(const std::string &leases) {
-    if (leases.empty())
-        return;
-
-    std::istringstream sstream(leases);
-    xml_document xdoc;
-    xml_parse_result result = xdoc.load(sstream);
-    if (!result) {
-        DHCP_TRACE(Error, "Unable to load DHCP leases. status=" <<
-                   result.status << ", offset=" << result.offset);
-        return;
+    const char *record = leases.data();
+    const char *end = record + leases.size();
+    uint32_t count = 0;
+    while (record < end) {
+        const char *eol =
+            static_cast<const char *>(memchr(record, '\n', end - record));
+        if (eol == NULL) {
+            // Record was not completely written before a crash, ignore it.
+            // Remove it from the file, so that records appended later do
+            // not get merged with it
+            DHCP_TRACE(Error, "Ignoring partial DHCP Lease record in " <<
+                       lease_filename_);
+            if (truncate(lease_filename_.c_str(),
+                         record - leases.data()) != 0) {
+                DHCP_TRACE(Error, "Cannot truncate DHCP Lease file : " <<
+                           lease_filename_);
+            }
+            break;
+        }
+        if (eol != record && ParseLease(record, eol))
+            count++;
+        record = eol + 1;
     }
 
-    for (xml_node root = xdoc.first_child(); root; root = root.next_sibling()) {
-        if (strcmp(root.name(), "lease") == 0) {
-            ParseLease(root);
-        }
+    if (count) {
+        DHCP_TRACE(Trace, "Loaded " << count << " DHCP Lease records from " <<
+                   lease_filename_);
     }
 }
 
-void DhcpLeaseDb::ParseLease(const xml_node &lease) {
+// Get value of element tag in the record
+static bool LeaseRecordValue(const char *record, const char *end,
+                             const std::string &tag, std::string *value) {
+    std::string start_tag = "<" + tag + ">";
+    std::string end_tag = "</" + tag + ">";
+    const char *begin = std::search(record, end, start_tag.begin(),
+                                    start_tag.end());
+    if (begin == end)
+        return false;
+    begin += start_tag.size();
+    const char *last = std::search(begin, end, end_tag.begin(), end_tag.end());
+    if (last == end)
+        return false;
+    value->assign(begin, last);
+    return true;
+}
+
+bool DhcpLeaseDb::ParseLease(const char *record, const char *end) {
     MacAddress mac;
     Ip4Address ip;
     uint64_t expiry = 0;
     boost::system::error_code ec;
     bool released = false;
     bool error = false;
-    for (xml_node root = lease.first_child(); root; root = root.next_sibling()) {
-        if (strcmp(root.name(), "mac") == 0) {
-            mac = MacAddress::FromString(root.child_value(), &ec);
-            if (ec)
-                error = true;
-            continue;
-        }
-        if (strcmp(root.name(), "ip") == 0) {
-            ip = Ip4Address::from_string(root.child_value(), ec);
-            if (ec)
-                error = true;
-            continue;
-        }
-        if (strcmp(root.name(), "expiry") == 0) {
-            char *endp;
-            expiry = strtoull(root.child_value(), &endp, 10);
-            while (isspace(*endp)) endp++;
-            if (endp[0] != '\0')
-                error = true;
-            continue;
-        }
-        if (strcmp(root.name(), "released") == 0) {
-            if (strcmp(root.child_value(), "true") == 0)
-                released = true;
-        }
+    std::string value;
+
+    if (LeaseRecordValue(record, end, "mac", &value)) {
+        mac = MacAddress::FromString(value, &ec);
+        if (ec)
+            error = true;
+    }
+    if (LeaseRecordValue(record, end, "ip", &value)) {
+        ip = Ip4Address::from_string(value, ec);
+        if (ec)
+            error = true;
+    }
+    if (LeaseRecordValue(record, end, "expiry", &value)) {
+        char *endp;
+        expiry = strtoull(value.c_str(), &endp, 10);
+        while (isspace(*endp)) endp++;
+        if (endp[0] != '\0')
+            error = true;
+    }
+    if (LeaseRecordValue(record, end, "released", &value)) {
+        if (value == "true")
+            released = true;
     }
 
     if (mac.IsZero() || ip.is_unspecified() || error) {
         DHCP_TRACE(Error, "Invalid DHCP Lease record : " << mac.ToString() << " " <<
                    ip.to_string() << " " << expiry);
-        return;
+        return false;
     }
 
-    UpdateLease(mac, ip, expiry, released);
+    SetLease(mac, ip, expiry, released);
+    return true;
 }
 
 void ShowGwDhcpLeases::HandleRequest() const {
@@ -5,13 +5,10 @@
 #ifndef vnsw_agent_dhcp_lease_h__
 #define vnsw_agent_dhcp_lease_h__
 
-#include <fstream>
 #include <boost/dynamic_bitset.hpp>
 
 class Timer;
-namespace pugi {
-class xml_node;
-}
+class TaskTrigger;
 
 // DHCP lease management is implemented here for a given subnet - used by
 // Gateway interfaces. Hosts on the gateway interface get addresses allocated
@@ -26,9 +23,15 @@ class xml_node;
 // is allocated. When lease_bitmap is exhausted, a released address from
 // released_lease_bitmap is allocated.
 //
-// Lease records are persisted in a file. Records are appended to the file,
-// with the last record being the latest for a client. The lease file is
-// compacted after a certain number of lease updates.
+// Lease records are persisted in a file, one record per line. Records are
+// appended to the file, with the last record being the latest for a client.
+// The file is kept open and lease changes are buffered; buffered records are
+// written together and synced from a TaskTrigger, so a burst of lease
+// updates is committed with a single write. After a certain number of lease
+// updates the file is compacted, by writing a snapshot of the leases to a
+// temporary file which is renamed over the lease file. A crash leaves either
+// the old or the new file; a partial record at the end of the file is
+// ignored on load.
 
 class DhcpLeaseDb {
 public:
@@ -67,6 +70,8 @@ public:
     const std::set<DhcpLease> &leases() const { return leases_; }
     void ClearLeases();
     void set_lease_timeout(uint32_t timeout);
+    uint64_t lease_commits() const { return lease_commits_; }
+    uint64_t lease_compactions() const { return lease_compactions_; }
 
 private:
     friend class DhcpTest;
@@ -75,23 +80,28 @@ private:
     bool LeaseTimerExpiry();
     void UpdateLease(const MacAddress &mac, const Ip4Address &ip,
                      uint64_t expiry, bool released);
+    void SetLease(const MacAddress &mac, const Ip4Address &ip,
+                  uint64_t expiry, bool released);
     void ReserveAddresses(const std::vector<Ip4Address> &addresses,
                           bool subnet_change);
     void IndexToAddress(size_t index, Ip4Address *address) const;
     size_t AddressToIndex(const Ip4Address &address) const;
     bool IsReservedAddress(const Ip4Address &address) const;
     void UpdateLeaseFileName(const std::string &name);
-    void CreateLeaseFile();
+    bool CreateLeaseFile();
+    bool OpenLeaseFile();
+    void CloseLeaseFile();
+    bool WriteLeaseFile(int fd, const std::string &records);
+    bool CommitLeaseRecords();
     void PersistLeaseRecord(const MacAddress &mac, const Ip4Address &ip,
                             const uint64_t &expiry, bool released);
-    void PersistLeaseRecords(const std::vector<DhcpLease> &leases);
-    void WriteLeaseRecord(std::ofstream &lease_ofstream,
-                          const MacAddress &mac, const Ip4Address &ip,
-                          const uint64_t &expiry, bool released);
+    void FormatLeaseRecord(std::string *records,
+                           const MacAddress &mac, const Ip4Address &ip,
+                           const uint64_t &expiry, bool released);
     void LoadLeaseFile();
     void ReadLeaseFile(std::string &leases);
     void ParseLeaseFile(const std::string &leases);
-    void ParseLease(const pugi::xml_node &lease);
+    bool ParseLease(const char *record, const char *end);
 
     Ip4Address subnet_;
     uint8_t    plen_;
@@ -105,6 +115,13 @@ private:
     uint32_t lease_timeout_;
     Timer *timer_;
     std::string lease_filename_;
+    // Lease file open for append, -1 if not open
+    int lease_fd_;
+    // Records yet to be committed to lease file
+    std::string pending_records_;
+    TaskTrigger *commit_trigger_;
+    uint64_t lease_commits_;
+    uint64_t lease_compactions_;
 
     DISALLOW_COPY_AND_ASSIGN(DhcpLeaseDb);
 };
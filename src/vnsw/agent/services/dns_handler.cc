@@ -20,7 +20,7 @@
 DnsHandler::DnsHandler(Agent *agent, boost::shared_ptr<PktInfo> info,
                        boost::asio::io_service &io)
     : ProtoHandler(agent, info, io), resp_ptr_(NULL), dns_resp_size_(0),
-      xid_(-1), action_(NONE), rkey_(NULL),
+      xid_(-1), action_(NONE), rkey_(NULL), cache_key_(NULL),
       query_name_update_(false), pend_req_(0), default_method_(false),
       curr_index_(0) {
     dns_ = (dnshdr *) pkt_info_->data;
@@ -35,6 +35,20 @@ DnsHandler::~DnsHandler() {
         delete rkey_;
     }
 
+    DnsProto *dns_proto = agent()->GetDnsProto();
+    if (cache_key_) {
+        if (dns_proto)
+            dns_proto->DelPendingQuery(*cache_key_, this);
+        delete cache_key_;
+    }
+    // Queries waiting on this one are not answered, VMs retry them
+    for (HandlerList::iterator it = pending_queries_.begin();
+         it != pending_queries_.end(); ++it) {
+        if (dns_proto)
+            dns_proto->DelVmRequest((*it)->rkey_);
+        delete *it;
+    }
+
     uint8_t count = 0;
     while (count < dns_resolvers_.size()) {
         if (dns_resolvers_[count]) {
@@ -246,6 +260,14 @@ bool DnsHandler::HandleDefaultDnsRequest(const VmInterface *vmitf) {
         return true;
     }
 
+    if (ResolveFromCache("")) {
+        dns_proto->DelVmRequest(rkey_);
+        return true;
+    }
+    if (WaitForPendingQuery()) {
+        return false;
+    }
+
     if (!def_dns_resolvers_.size()) {
         DNS_BIND_TRACE(DnsBindTrace, "No DNS resolvers for Default DNS query"
                        " with xid = " << dns_->xid << ";interface = "
@@ -334,6 +356,14 @@ bool DnsHandler::HandleVirtualDnsRequest(const VmInterface *vmitf) {
                 break;
             }
             UpdateQueryNames();
+            if (ResolveFromCache(ipam_type_.ipam_dns_server.
+                                 virtual_dns_server_name)) {
+                break;
+            }
+            if (WaitForPendingQuery()) {
+                // response to the pending query is sent for this as well
+                return false;
+            }
 
             uint8_t count = 0;
             bool query_success = false;
@@ -574,6 +604,9 @@ bool DnsHandler::HandleBindResponse() {
                                        DnsItemsToString(linklocal_items_));
                     } else {
                         valid_response = true;
+                        handler->CacheResponse(flags, ans, auth, add);
+                        handler->ResolvePendingQueries(flags, ques, ans,
+                                                       auth, add);
                         handler->Resolve(flags, ques, ans, auth, add);
                         DNS_BIND_TRACE(DnsBindTrace,
                                        "Query successful : xid = " <<
@@ -641,6 +674,8 @@ void DnsHandler::HandleInvalidBindResponse(DnsHandler *handler, dns_flags flags,
     DnsProto *dns_proto = agent()->GetDnsProto();
     if (flags.ret) {
         /* Send last invalid response to requesting VM */
+        handler->CacheResponse(flags, ans, auth, add);
+        handler->ResolvePendingQueries(flags, ques, ans, auth, add);
         handler->Resolve(flags, ques, ans, auth, add);
         DNS_BIND_TRACE(DnsBindTrace,
                        "Send invalid BIND response: xid = " << xid);
@@ -684,6 +719,69 @@ bool DnsHandler::SendToDefaultServer() {
     return false;
 }
 
+// Answer a single question query from the response cache
+bool DnsHandler::ResolveFromCache(const std::string &vdns) {
+    if (items_.size() != 1)
+        return false;
+
+    DnsProto *dns_proto = agent()->GetDnsProto();
+    cache_key_ = new CacheKey(vdns, items_.front());
+    dns_flags flags;
+    DnsItems ans, auth, add;
+    if (!dns_proto->LookupCache(*cache_key_, &flags, &ans, &auth, &add))
+        return false;
+
+    DNS_BIND_TRACE(DnsBindTrace, "Query resolved from cache : xid = " <<
+                   dns_->xid << " " << DnsItemsToString(items_));
+    Resolve(flags, items_, ans, auth, add);
+    return true;
+}
+
+// Wait for the response to an identical query already sent to the DNS
+// servers, instead of sending another one
+bool DnsHandler::WaitForPendingQuery() {
+    if (!cache_key_)
+        return false;
+
+    DnsProto *dns_proto = agent()->GetDnsProto();
+    DnsHandler *handler = dns_proto->GetPendingQuery(*cache_key_);
+    if (handler == NULL) {
+        dns_proto->AddPendingQuery(*cache_key_, this);
+        return false;
+    }
+
+    DNS_BIND_TRACE(DnsBindTrace, "Query waiting for pending query : xid = " <<
+                   dns_->xid << " " << DnsItemsToString(items_));
+    handler->pending_queries_.push_back(this);
+    dns_proto->IncrStatsCoalesced();
+    return true;
+}
+
+void DnsHandler::CacheResponse(dns_flags flags, const DnsItems &ans,
+                               const DnsItems &auth, const DnsItems &add) {
+    if (cache_key_) {
+        agent()->GetDnsProto()->AddCacheEntry(*cache_key_, flags,
+                                              ans, auth, add);
+    }
+}
+
+// Send the response to the queries waiting on this one
+void DnsHandler::ResolvePendingQueries(dns_flags flags, const DnsItems &ques,
+                                       const DnsItems &ans,
+                                       const DnsItems &auth,
+                                       const DnsItems &add) {
+    DnsProto *dns_proto = agent()->GetDnsProto();
+    for (HandlerList::iterator it = pending_queries_.begin();
+         it != pending_queries_.end(); ++it) {
+        DnsHandler *handler = *it;
+        DnsItems handler_ans(ans), handler_auth(auth), handler_add(add);
+        handler->Resolve(flags, ques, handler_ans, handler_auth, handler_add);
+        dns_proto->DelVmRequest(handler->rkey_);
+        delete handler;
+    }
+    pending_queries_.clear();
+}
+
 bool DnsHandler::HandleRetryExpiry() {
     DnsProto::DnsIpc *ipc = static_cast<DnsProto::DnsIpc *>(pkt_info_->ipc);
     DnsProto *dns_proto = agent()->GetDnsProto();
@@ -740,6 +838,9 @@ bool DnsHandler::HandleModifyVdns() {
     DnsProto *dns_proto = agent()->GetDnsProto();
     std::vector<DnsProto::DnsUpdateIpc *> change_list;
     const DnsProto::DnsUpdateSet &update_set = dns_proto->update_set();
+    dns_proto->FlushCache(ipc->old_vdns);
+    if (!ipc->new_vdns.empty())
+        dns_proto->FlushCache(ipc->new_vdns);
     for (DnsProto::DnsUpdateSet::const_iterator it = update_set.begin();
          it != update_set.end(); ++it) {
         if ((ipc->itf &&
@@ -1018,6 +1119,7 @@ void DnsHandler::Update(InterTaskMsg *msg) {
     DnsProto::DnsUpdateIpc *update = static_cast<DnsProto::DnsUpdateIpc *>(msg);
     bool free_update = true;
     DnsProto *dns_proto = agent()->GetDnsProto();
+    dns_proto->FlushCache(update->xmpp_data->virtual_dns);
     DnsProto::DnsUpdateIpc *update_req = dns_proto->FindUpdateRequest(update);
     if (update_req) {
         DnsUpdateData *data = update_req->xmpp_data;
@@ -1061,6 +1163,7 @@ void DnsHandler::DelUpdate(InterTaskMsg *msg) {
     DnsProto *dns_proto = agent()->GetDnsProto();
     DnsProto::DnsUpdateIpc *update_req = dns_proto->FindUpdateRequest(update);
     while (update_req) {
+        dns_proto->FlushCache(update_req->xmpp_data->virtual_dns);
         for (DnsItems::iterator item = update_req->xmpp_data->items.begin();
              item != update_req->xmpp_data->items.end(); ++item) {
             // in case of delete, set the class to NONE and ttl to 0
@@ -1163,6 +1266,22 @@ void DnsHandler::GetBaseName(const std::string &name, std::string *base) const {
     }
 }
 
+DnsHandler::CacheKey::CacheKey(const std::string &vdns_name,
+                               const DnsItem &item)
+    : vdns(vdns_name), name(boost::to_lower_copy(item.name)),
+      type(item.type), eclass(item.eclass) {
+}
+
+bool DnsHandler::CacheKey::operator<(const CacheKey &rhs) const {
+    if (vdns != rhs.vdns)
+        return vdns < rhs.vdns;
+    if (name != rhs.name)
+        return name < rhs.name;
+    if (type != rhs.type)
+        return type < rhs.type;
+    return eclass < rhs.eclass;
+}
+
 std::string DnsHandler::DnsItemsToString(DnsItems &items) const {
     std::string str;
     for (DnsItems::const_iterator it = items.begin(); it != items.end(); ++it) {
@@ -37,6 +37,19 @@ public:
         uint16_t xid;
     };
 
+    // Response cache is keyed on the virtual DNS server (empty for default
+    // DNS) and the question in a single question query
+    struct CacheKey {
+        CacheKey(const std::string &vdns, const DnsItem &item);
+        bool operator<(const CacheKey &rhs) const;
+
+        std::string vdns;
+        std::string name;
+        uint16_t type;
+        uint16_t eclass;
+    };
+    typedef std::list<DnsHandler *> HandlerList;
+
     enum Action {
         NONE,
         DNS_QUERY,
@@ -93,6 +106,13 @@ private:
                                    DnsItems &auth, DnsItems &add, uint16_t xid);
     bool NeedRetryForNextServer(uint16_t code);
     bool SendToDefaultServer();
+    bool ResolveFromCache(const std::string &vdns);
+    bool WaitForPendingQuery();
+    void CacheResponse(dns_flags flags, const DnsItems &ans,
+                       const DnsItems &auth, const DnsItems &add);
+    void ResolvePendingQueries(dns_flags flags, const DnsItems &ques,
+                               const DnsItems &ans, const DnsItems &auth,
+                               const DnsItems &add);
     bool DefaultMethodInUse() { return default_method_; }
     uint8_t curr_index() { return curr_index_; }
     uint8_t last_index() { return def_dns_resolvers_.size() - 1; }
@@ -104,6 +124,9 @@ private:
     uint16_t xid_;
     Action action_;
     QueryKey *rkey_;
+    CacheKey *cache_key_;
+    // identical queries from other VMs, answered with the response to this
+    HandlerList pending_queries_;
     struct DnsResolverInfo {
         boost::asio::ip::udp::endpoint ep_;
         uint32_t retries_;
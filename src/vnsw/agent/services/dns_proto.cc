@@ -4,6 +4,7 @@
 
 #include <sys/types.h>
 #include "base/address_util.h"
+#include "base/time_util.h"
 #include "init/agent_init.h"
 #include "oper/interface_common.h"
 #include "services/dns_proto.h"
@@ -30,6 +31,8 @@ void DnsProto::IoShutdown() {
     }
 
     curr_vm_requests_.clear();
+    pending_query_map_.clear();
+    FlushCache();
     // Following tables should be deleted when all VMs are gone
     assert(update_set_.empty());
     assert(all_vms_.empty());
@@ -62,7 +65,8 @@ void DnsProto::ConfigInit() {
 
 DnsProto::DnsProto(Agent *agent, boost::asio::io_service &io) :
     Proto(agent, "Agent::Services", PktHandler::DNS, io),
-    xid_(0), timeout_(agent->params()->dns_timeout()),
+    xid_(0), cache_size_(0), max_cache_size_(kDnsCacheMaxSize),
+    timeout_(agent->params()->dns_timeout()),
     max_retries_(agent->params()->dns_max_retries()) {
     // limit the number of entries in the workqueue
     work_queue_.SetSize(agent->params()->services_queue_limit());
@@ -714,6 +718,188 @@ bool DnsProto::IsVmRequestDuplicate(DnsHandler::QueryKey *key) {
     return curr_vm_requests_.find(*key) != curr_vm_requests_.end();
 }
 
+static uint32_t DnsItemsSize(const DnsItems &items) {
+    uint32_t size = 0;
+    for (DnsItems::const_iterator it = items.begin(); it != items.end(); ++it) {
+        size += sizeof(DnsItem) + it->name.size() + it->source_name.size() +
+                it->data.size() + it->soa.primary_ns.size() +
+                it->soa.mailbox.size() + it->srv.hostname.size();
+    }
+    return size;
+}
+
+static void DnsItemsAgeTtl(DnsItems *items, uint32_t elapsed) {
+    for (DnsItems::iterator it = items->begin(); it != items->end(); ++it) {
+        it->ttl = (it->ttl > elapsed) ? it->ttl - elapsed : 0;
+    }
+}
+
+// Get the time for which a response can be cached. A positive response is
+// cached for the least TTL of its records. Name error and no data responses
+// are cached for the SOA minimum TTL (RFC 2308), limited to
+// kDnsNegativeCacheMaxTtl. Other responses are not cached.
+uint32_t DnsProto::GetCacheTtl(dns_flags flags, const DnsItems &ans,
+                               const DnsItems &auth, const DnsItems &add,
+                               bool *negative) const {
+    if (flags.trunc)
+        return 0;
+
+    if (flags.ret == DNS_ERR_NO_ERROR && ans.size()) {
+        *negative = false;
+        uint32_t ttl = ans.front().ttl;
+        const DnsItems *sections[] = { &ans, &auth, &add };
+        for (uint32_t i = 0; i < 3; ++i) {
+            for (DnsItems::const_iterator it = sections[i]->begin();
+                 it != sections[i]->end(); ++it) {
+                if (it->ttl < ttl)
+                    ttl = it->ttl;
+            }
+        }
+        return ttl;
+    }
+
+    if (flags.ret != DNS_ERR_NO_ERROR && flags.ret != DNS_ERR_NO_SUCH_NAME)
+        return 0;
+
+    *negative = true;
+    for (DnsItems::const_iterator it = auth.begin(); it != auth.end(); ++it) {
+        if (it->type != DNS_TYPE_SOA)
+            continue;
+        uint32_t ttl = (it->ttl < it->soa.ttl) ? it->ttl : it->soa.ttl;
+        if (ttl > kDnsNegativeCacheMaxTtl)
+            ttl = kDnsNegativeCacheMaxTtl;
+        return ttl;
+    }
+    return 0;
+}
+
+// Get a cached response for the query, with the TTL of the records reduced
+// by the time they have been in the cache
+bool DnsProto::LookupCache(const DnsCacheKey &key, dns_flags *flags,
+                           DnsItems *ans, DnsItems *auth, DnsItems *add) {
+    if (!max_cache_size_)
+        return false;
+
+    DnsCacheMap::iterator it = cache_.find(key);
+    uint64_t now = ClockMonotonicUsec();
+    if (it != cache_.end() && it->second.expiry_time <= now) {
+        DelCacheEntry(it);
+        it = cache_.end();
+    }
+    if (it == cache_.end()) {
+        stats_.cache_misses++;
+        return false;
+    }
+
+    DnsCacheEntry &entry = it->second;
+    cache_lru_.splice(cache_lru_.end(), cache_lru_, entry.lru);
+    if (entry.negative)
+        stats_.negative_cache_hits++;
+    else
+        stats_.cache_hits++;
+
+    uint32_t elapsed = (now - entry.insert_time) / 1000000;
+    *flags = entry.flags;
+    *ans = entry.ans;
+    *auth = entry.auth;
+    *add = entry.add;
+    DnsItemsAgeTtl(ans, elapsed);
+    DnsItemsAgeTtl(auth, elapsed);
+    DnsItemsAgeTtl(add, elapsed);
+    return true;
+}
+
+void DnsProto::AddCacheEntry(const DnsCacheKey &key, dns_flags flags,
+                             const DnsItems &ans, const DnsItems &auth,
+                             const DnsItems &add) {
+    if (!max_cache_size_)
+        return;
+
+    bool negative = false;
+    uint32_t ttl = GetCacheTtl(flags, ans, auth, add, &negative);
+    if (!ttl)
+        return;
+
+    DnsCacheMap::iterator it = cache_.find(key);
+    if (it != cache_.end())
+        DelCacheEntry(it);
+
+    uint32_t size = sizeof(DnsCacheEntry) + 2 * sizeof(DnsCacheKey) +
+                    2 * (key.vdns.size() + key.name.size()) +
+                    DnsItemsSize(ans) + DnsItemsSize(auth) + DnsItemsSize(add);
+    if (size > max_cache_size_)
+        return;
+
+    // Evict least recently used entries to keep within the cache size
+    while (cache_size_ + size > max_cache_size_) {
+        DelCacheEntry(cache_.find(cache_lru_.front()));
+        stats_.cache_evictions++;
+    }
+
+    uint64_t now = ClockMonotonicUsec();
+    DnsCacheEntry &entry = cache_[key];
+    entry.flags = flags;
+    entry.ans = ans;
+    entry.auth = auth;
+    entry.add = add;
+    entry.insert_time = now;
+    entry.expiry_time = now + ttl * 1000000ULL;
+    entry.size = size;
+    entry.negative = negative;
+    entry.lru = cache_lru_.insert(cache_lru_.end(), key);
+    cache_size_ += size;
+}
+
+void DnsProto::DelCacheEntry(DnsCacheMap::iterator it) {
+    cache_size_ -= it->second.size;
+    cache_lru_.erase(it->second.lru);
+    cache_.erase(it);
+}
+
+// Remove the cached responses from a virtual DNS server, when its records
+// or configuration change
+void DnsProto::FlushCache(const std::string &vdns) {
+    std::string name(vdns);
+    BindUtil::RemoveSpecialChars(name);
+    DnsItem item;
+    item.eclass = 0;
+    DnsCacheMap::iterator it = cache_.lower_bound(DnsCacheKey(name, item));
+    while (it != cache_.end() && it->first.vdns == name) {
+        DelCacheEntry(it++);
+    }
+}
+
+void DnsProto::FlushCache() {
+    cache_.clear();
+    cache_lru_.clear();
+    cache_size_ = 0;
+}
+
+void DnsProto::set_max_cache_size(uint32_t size) {
+    max_cache_size_ = size;
+    while (cache_size_ > max_cache_size_) {
+        DelCacheEntry(cache_.find(cache_lru_.front()));
+        stats_.cache_evictions++;
+    }
+}
+
+void DnsProto::AddPendingQuery(const DnsCacheKey &key, DnsHandler *handler) {
+    pending_query_map_.insert(std::make_pair(key, handler));
+}
+
+void DnsProto::DelPendingQuery(const DnsCacheKey &key, DnsHandler *handler) {
+    DnsPendingQueryMap::iterator it = pending_query_map_.find(key);
+    if (it != pending_query_map_.end() && it->second == handler)
+        pending_query_map_.erase(it);
+}
+
+DnsHandler *DnsProto::GetPendingQuery(const DnsCacheKey &key) {
+    DnsPendingQueryMap::iterator it = pending_query_map_.find(key);
+    if (it != pending_query_map_.end())
+        return it->second;
+    return NULL;
+}
+
 DnsProto::DnsFipEntry::DnsFipEntry(const VnEntry *vn, const Ip4Address &fip,
                                    const VmInterface *itf)
     : vn_(vn), floating_ip_(fip), interface_(itf) {
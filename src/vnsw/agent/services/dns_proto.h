@@ -17,6 +17,8 @@ public:
     static const uint32_t kDnsDefaultTtl = 84600;
     static const uint32_t kDnsDefaultSlistInterval =
         10 * 60 * 1000;   //10 minutes
+    static const uint32_t kDnsCacheMaxSize = 4 * 1024 * 1024;   // bytes
+    static const uint32_t kDnsNegativeCacheMaxTtl = 30;        // seconds
 
     enum InterTaskMessage {
         DNS_NONE,
@@ -103,6 +105,8 @@ public:
         DnsStats() { Reset(); }
         void Reset() {
             requests = resolved = retransmit_reqs = unsupported = fail = drop = 0;
+            cache_hits = cache_misses = negative_cache_hits = 0;
+            coalesced = cache_evictions = 0;
         }
 
         uint32_t requests;
@@ -111,8 +115,30 @@ public:
         uint32_t unsupported;
         uint32_t fail;
         uint32_t drop;
+        uint32_t cache_hits;
+        uint32_t cache_misses;
+        uint32_t negative_cache_hits;
+        uint32_t coalesced;
+        uint32_t cache_evictions;
     };
 
+    typedef DnsHandler::CacheKey DnsCacheKey;
+    // Least recently used entry is at the front
+    typedef std::list<DnsCacheKey> DnsCacheLruList;
+
+    struct DnsCacheEntry {
+        dns_flags flags;
+        DnsItems ans;
+        DnsItems auth;
+        DnsItems add;
+        uint64_t insert_time;   // usec
+        uint64_t expiry_time;   // usec
+        uint32_t size;
+        bool negative;
+        DnsCacheLruList::iterator lru;
+    };
+    typedef std::map<DnsCacheKey, DnsCacheEntry> DnsCacheMap;
+
     struct DnsFipEntry {
         DnsFipEntry(const VnEntry *vn, const Ip4Address &fip,
                     const VmInterface *itf);
@@ -144,6 +170,9 @@ public:
     typedef std::map<uint32_t, int16_t> DnsBindQueryIndexMap;
     typedef std::pair<uint32_t, int16_t> DnsBindQueryIndexPair;
     typedef std::vector<IpAddress> DefaultServerList;
+    // Query sent to the DNS servers for a cache key; identical queries from
+    // other VMs wait on it
+    typedef std::map<DnsCacheKey, DnsHandler *> DnsPendingQueryMap;
 
     void ConfigInit();
     void Shutdown();
@@ -203,6 +232,22 @@ public:
     void DelVmRequest(DnsHandler::QueryKey *key);
     bool IsVmRequestDuplicate(DnsHandler::QueryKey *key);
 
+    bool LookupCache(const DnsCacheKey &key, dns_flags *flags, DnsItems *ans,
+                     DnsItems *auth, DnsItems *add);
+    void AddCacheEntry(const DnsCacheKey &key, dns_flags flags,
+                       const DnsItems &ans, const DnsItems &auth,
+                       const DnsItems &add);
+    void FlushCache(const std::string &vdns);
+    void FlushCache();
+    uint32_t cache_entries() const { return cache_.size(); }
+    uint32_t cache_size() const { return cache_size_; }
+    uint32_t max_cache_size() const { return max_cache_size_; }
+    void set_max_cache_size(uint32_t size);
+
+    void AddPendingQuery(const DnsCacheKey &key, DnsHandler *handler);
+    void DelPendingQuery(const DnsCacheKey &key, DnsHandler *handler);
+    DnsHandler *GetPendingQuery(const DnsCacheKey &key);
+
     uint32_t timeout() const { return timeout_; }
     void set_timeout(uint32_t timeout) { timeout_ = timeout; }
     uint32_t max_retries() const { return max_retries_; }
@@ -214,6 +259,7 @@ public:
     void IncrStatsUnsupp() { stats_.unsupported++; }
     void IncrStatsFail() { stats_.fail++; }
     void IncrStatsDrop() { stats_.drop++; }
+    void IncrStatsCoalesced() { stats_.coalesced++; }
     const DnsStats &GetStats() const { return stats_; }
     void ClearStats() { stats_.Reset(); }
     const VmDataMap& all_vms() const { return all_vms_; }
@@ -247,6 +293,10 @@ private:
     bool GetFipName(const VmInterface *vmitf,
                     const  autogen::VirtualDnsType &vdns_type,
                     const Ip4Address &ip, std::string &fip_name) const;
+    uint32_t GetCacheTtl(dns_flags flags, const DnsItems &ans,
+                         const DnsItems &auth, const DnsItems &add,
+                         bool *negative) const;
+    void DelCacheEntry(DnsCacheMap::iterator it);
 
     uint16_t xid_;
     DnsUpdateSet update_set_;
@@ -254,6 +304,11 @@ private:
     DnsVmRequestSet curr_vm_requests_;
     DnsBindQueryIndexMap dns_query_index_map_;
     DefaultServerList def_server_list_;
+    DnsCacheMap cache_;
+    DnsCacheLruList cache_lru_;
+    uint32_t cache_size_;
+    uint32_t max_cache_size_;
+    DnsPendingQueryMap pending_query_map_;
     DnsStats stats_;
     uint32_t timeout_;   // milli seconds
     uint32_t max_retries_;
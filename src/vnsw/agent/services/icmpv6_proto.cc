@@ -11,7 +11,10 @@
 #include "mac_learning/mac_learning_proto.h"
 
 Icmpv6Proto::Icmpv6Proto(Agent *agent, boost::asio::io_service &io) :
-    Proto(agent, "Agent::Services", PktHandler::ICMPV6, io) {
+    Proto(agent, "Agent::Services", PktHandler::ICMPV6, io),
+    timer_wheel_(new TimerWheel(io, "Icmpv6 timer wheel",
+                 TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
+                 PktHandler::ICMPV6)) {
     // limit the number of entries in the workqueue
     work_queue_.SetSize(agent->params()->services_queue_limit());
     work_queue_.SetBounded(true);
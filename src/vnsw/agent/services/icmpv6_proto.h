@@ -155,6 +155,7 @@ public:
     DBTableBase::ListenerId vrf_table_listener_id() const {
         return vrf_table_listener_id_;
     }
+    TimerWheel *timer_wheel() const { return timer_wheel_.get(); }
 
 private:
     Timer *timer_;
@@ -170,6 +171,8 @@ private:
                        InterfaceConstRef itf);
     // handler to send router advertisements and neighbor solicits
     boost::scoped_ptr<Icmpv6Handler> icmpv6_handler_;
+    // Delay, retransmit and reachable timers of all NDP entries
+    boost::scoped_ptr<TimerWheel> timer_wheel_;
     DBTableBase::ListenerId vn_table_listener_id_;
     DBTableBase::ListenerId vrf_table_listener_id_;
     DBTableBase::ListenerId interface_listener_id_;
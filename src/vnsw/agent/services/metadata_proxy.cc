@@ -7,11 +7,13 @@
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/algorithm/string.hpp>
 
 #include <isc/hmacmd5.h>
 #include <isc/hmacsha.h>
 
 #include "base/contrail_ports.h"
+#include "base/time_util.h"
 #include "http/http_request.h"
 #include "http/http_session.h"
 #include "http/http_server.h"
@@ -84,7 +86,9 @@ MetadataProxy::MetadataProxy(ServicesModule *module,
                              const std::string &secret)
     : services_(module), shared_secret_(secret),
       http_server_(new MetadataServer(services_->agent()->event_manager())),
-      http_client_(new MetadataClient(services_->agent()->event_manager())) {
+      http_client_(new MetadataClient(services_->agent()->event_manager())),
+      active_requests_(0), max_active_requests_(kMaxActiveRequests),
+      dispatching_(false) {
 
     // Register wildcard entry to match any URL coming on the metadata port
     http_server_->RegisterHandler(HTTP_WILDCARD_ENTRY,
@@ -108,6 +112,18 @@ void MetadataProxy::CloseSessions() {
         it = next;
     }
 
+    for (IdleConnectionList::iterator it = idle_connections_.begin();
+         it != idle_connections_.end(); ++it) {
+        it->conn->client()->RemoveConnection(it->conn);
+    }
+    idle_connections_.clear();
+
+    for (PendingRequestQueue::iterator it = pending_requests_.begin();
+         it != pending_requests_.end(); ++it) {
+        delete it->request;
+    }
+    pending_requests_.clear();
+
     assert(metadata_sessions_.empty());
     assert(metadata_proxy_sessions_.empty());
 }
@@ -128,10 +144,58 @@ MetadataProxy::Shutdown() {
 
 void
 MetadataProxy::HandleMetadataRequest(HttpSession *session, const HttpRequest *request) {
+    metadata_stats_.requests++;
+    if (active_requests_ < max_active_requests_ && pending_requests_.empty()) {
+        ProxyRequest(session, request);
+        DispatchPendingRequests();
+        return;
+    }
+
+    // Too many requests relayed to nova, queue the request till a response
+    // completes
+    if (pending_requests_.size() >= kMaxQueuedRequests) {
+        METADATA_TRACE(Trace, "Error: Request queue full; Request for VM : "
+                       << session->remote_endpoint().address());
+        metadata_stats_.queue_drops++;
+        ErrorClose(session, 503);
+        http_server_->DeleteSession(session);
+        delete request;
+        return;
+    }
+    metadata_stats_.queued_requests++;
+    pending_requests_.push_back(PendingRequest(session, request,
+                                               ClockMonotonicUsec()));
+}
+
+void
+MetadataProxy::DispatchPendingRequests() {
+    if (dispatching_)
+        return;
+
+    dispatching_ = true;
+    while (!pending_requests_.empty() &&
+           active_requests_ < max_active_requests_) {
+        PendingRequest req = pending_requests_.front();
+        pending_requests_.pop_front();
+        if (req.session->IsClosed()) {
+            delete req.request;
+            continue;
+        }
+
+        uint64_t wait = ClockMonotonicUsec() - req.enqueue_time;
+        metadata_stats_.queue_wait_usecs += wait;
+        if (wait > metadata_stats_.max_queue_wait_usecs)
+            metadata_stats_.max_queue_wait_usecs = wait;
+        ProxyRequest(req.session.get(), req.request);
+    }
+    dispatching_ = false;
+}
+
+void
+MetadataProxy::ProxyRequest(HttpSession *session, const HttpRequest *request) {
     bool conn_close = false;
     std::vector<std::string> header_options;
     std::string vm_ip, vm_uuid, vm_project_uuid;
-    metadata_stats_.requests++;
     boost::asio::ip::address_v4 ip = session->remote_endpoint().address().to_v4();
 
     if (!services_->agent()->interface_table()->
@@ -184,6 +248,14 @@ MetadataProxy::HandleMetadataRequest(HttpSession *session, const HttpRequest *re
         }
 
         if (conn) {
+            SessionData &data = metadata_sessions_.find(session)->second;
+            data.ResetResponse();
+            data.head_req = (request->GetMethod() == HTTP_HEAD);
+            data.vm_ip = vm_ip;
+            if (!data.active) {
+                data.active = true;
+                active_requests_++;
+            }
             switch(request->GetMethod()) {
                 case HTTP_GET: {
                     conn->HttpGet(uri, true, false, true, header_options,
@@ -251,7 +323,8 @@ MetadataProxy::HandleMetadataRequest(HttpSession *session, const HttpRequest *re
     delete request;
 }
 
-// Metadata Response from Nova API service
+// Metadata Response from Nova API service. Header lines and body chunks are
+// relayed to the VM as they are received, without buffering the response
 void
 MetadataProxy::HandleMetadataResponse(HttpConnection *conn, HttpSessionPtr session,
                                       std::string &msg, boost::system::error_code &ec) {
@@ -262,17 +335,14 @@ MetadataProxy::HandleMetadataResponse(HttpConnection *conn, HttpSessionPtr sessi
         if (it == metadata_sessions_.end())
             return;
 
-        std::string vm_ip, vm_uuid, vm_project_uuid;
-        boost::asio::ip::address_v4 ip = session->remote_endpoint().address().to_v4();
-        services_->agent()->interface_table()->
-            FindVmUuidFromMetadataIp(ip, &vm_ip, &vm_uuid, &vm_project_uuid);
-
+        SessionData &data = it->second;
         if (!ec) {
-            METADATA_TRACE(Trace, "Metadata for VM : " << vm_ip << " Response : " << msg);
+            METADATA_TRACE(Trace, "Metadata for VM : " << data.vm_ip
+                           << " Response length : " << msg.length());
             session->Send(reinterpret_cast<const u_int8_t *>(msg.c_str()),
                           msg.length(), NULL);
         } else {
-            METADATA_TRACE(Trace, "Metadata for VM : " << vm_ip << " Error : " <<
+            METADATA_TRACE(Trace, "Metadata for VM : " << data.vm_ip << " Error : " <<
                                   boost::system::system_error(ec).what());
             CloseClientSession(conn);
             ErrorClose(session.get(), 502);
@@ -281,26 +351,15 @@ MetadataProxy::HandleMetadataResponse(HttpConnection *conn, HttpSessionPtr sessi
         }
 
         metadata_stats_.responses++;
-        if (!ec && it->second.close_req) {
-            std::stringstream str(msg);
-            std::string option;
-            str >> option;
-            if (option == "Content-Length:") {
-                str >> it->second.content_len;
-            } else if (msg == "\r\n") {
-                it->second.header_end = true;
-                if (it->second.header_end && !it->second.content_len) {
-                    CloseClientSession(it->second.conn);
-                    CloseServerSession(session.get());
-                    delete_session = true;
-                }
-            } else if (it->second.header_end) {
-                it->second.data_sent += msg.length();
-                if (it->second.data_sent >= it->second.content_len) {
-                    CloseClientSession(it->second.conn);
-                    CloseServerSession(session.get());
-                    delete_session = true;
-                }
+        ParseResponse(&data, msg);
+        if (ResponseDone(data)) {
+            data.reusable = true;
+            if (data.close_req) {
+                ReleaseClientSession(data.conn, data.reusable);
+                CloseServerSession(session.get());
+                delete_session = true;
+            } else {
+                RequestDone(&data);
             }
         }
     }
@@ -309,6 +368,127 @@ done:
     if (delete_session) {
         http_server_->DeleteSession(session.get());
     }
+    DispatchPendingRequests();
+}
+
+// Track end of response from nova. Header lines are received one at a time
+// and body as received on the connection
+void
+MetadataProxy::ParseResponse(SessionData *data, const std::string &msg) {
+    if (!data->header_end) {
+        if (msg == "\r\n") {
+            if (data->interim) {
+                data->interim = false;
+            } else {
+                data->header_end = true;
+            }
+            return;
+        }
+
+        std::stringstream str(msg);
+        std::string option;
+        str >> option;
+        if (boost::istarts_with(option, "HTTP/")) {
+            uint32_t status = 0;
+            str >> status;
+            data->interim = (status / 100 == 1);
+            data->no_body = (status == 204 || status == 304);
+        } else if (boost::iequals(option, "Content-Length:")) {
+            str >> data->content_len;
+            data->content_len_known = true;
+        } else if (boost::iequals(option, "Transfer-Encoding:")) {
+            std::string value;
+            str >> value;
+            data->chunked = boost::iequals(value, "chunked");
+        }
+        return;
+    }
+
+    data->data_sent += msg.length();
+    if (data->chunked) {
+        // Transfer decoding is disabled, chunks are relayed as received
+        // from nova. Response ends with a zero length chunk
+        ParseChunks(data, msg);
+    }
+}
+
+// Parse chunk framing of the body to find the end of response. Parse state
+// is kept in session data, as chunk size lines, data and trailers may be
+// split across messages
+void
+MetadataProxy::ParseChunks(SessionData *data, const std::string &msg) {
+    const char *ptr = msg.data();
+    const char *end = ptr + msg.length();
+    while (ptr < end && !data->chunk_end) {
+        char c = *ptr;
+        switch (data->chunk_state) {
+        case CHUNK_SIZE:
+            if (isxdigit(c)) {
+                int digit = isdigit(c) ? (c - '0') : (tolower(c) - 'a' + 10);
+                data->chunk_len = (data->chunk_len << 4) | digit;
+                break;
+            }
+            if (c != '\n') {
+                data->chunk_state = CHUNK_EXTENSION;
+                break;
+            }
+            // fall through
+        case CHUNK_EXTENSION:
+            if (c != '\n')
+                break;
+            data->chunk_state =
+                data->chunk_len ? CHUNK_DATA : CHUNK_TRAILER;
+            break;
+        case CHUNK_DATA: {
+            uint32_t len = std::min(data->chunk_len, (uint32_t)(end - ptr));
+            data->chunk_len -= len;
+            ptr += len;
+            if (data->chunk_len == 0)
+                data->chunk_state = CHUNK_DATA_END;
+            continue;
+        }
+        case CHUNK_DATA_END:
+            if (c == '\n')
+                data->chunk_state = CHUNK_SIZE;
+            break;
+        case CHUNK_TRAILER:
+            if (c == '\n') {
+                data->chunk_end = true;
+            } else if (c != '\r') {
+                data->chunk_state = CHUNK_TRAILER_LINE;
+            }
+            break;
+        case CHUNK_TRAILER_LINE:
+            if (c == '\n')
+                data->chunk_state = CHUNK_TRAILER;
+            break;
+        }
+        ptr++;
+    }
+}
+
+// Response is complete only when its framing is explicit. A response
+// without Content-Length or chunked encoding ends when nova closes the
+// connection, which is then not reused
+bool
+MetadataProxy::ResponseDone(const SessionData &data) const {
+    if (!data.header_end)
+        return false;
+    if (data.head_req || data.no_body)
+        return true;
+    if (data.chunked)
+        return data.chunk_end;
+    if (data.content_len_known)
+        return (data.data_sent >= data.content_len);
+    return false;
+}
+
+void
+MetadataProxy::RequestDone(SessionData *data) {
+    if (data->active) {
+        data->active = false;
+        active_requests_--;
+    }
 }
 
 void
@@ -318,8 +498,13 @@ MetadataProxy::OnServerSessionEvent(HttpSession *session, TcpSession::Event even
             SessionMap::iterator it = metadata_sessions_.find(session);
             if (it == metadata_sessions_.end())
                 break;
-            CloseClientSession(it->second.conn);
+            // Connection to nova is reused only if the response on it was
+            // fully received
+            bool reuse = !it->second.active && it->second.reusable;
+            RequestDone(&it->second);
+            ReleaseClientSession(it->second.conn, reuse);
             metadata_sessions_.erase(it);
+            DispatchPendingRequests();
             break;
         }
 
@@ -332,6 +517,16 @@ void
 MetadataProxy::OnClientSessionEvent(HttpClientSession *session, TcpSession::Event event) {
     switch (event) {
         case TcpSession::CLOSE: {
+            // Idle connection closed by nova
+            for (IdleConnectionList::iterator idle = idle_connections_.begin();
+                 idle != idle_connections_.end(); ++idle) {
+                if (idle->conn == session->Connection()) {
+                    HttpConnection *conn = idle->conn;
+                    idle_connections_.erase(idle);
+                    conn->client()->RemoveConnection(conn);
+                    return;
+                }
+            }
             {
                 ConnectionSessionMap::iterator it =
                     metadata_proxy_sessions_.find(session->Connection());
@@ -341,6 +536,7 @@ MetadataProxy::OnClientSessionEvent(HttpClientSession *session, TcpSession::Even
                 CloseClientSession(session->Connection());
             }
             http_server_->DeleteSession(session);
+            DispatchPendingRequests();
             break;
         }
 
@@ -365,25 +561,34 @@ MetadataProxy::GetProxyConnection(HttpSession *session, bool conn_close,
         nova_hostname, &nova_server, &nova_port))
         return NULL;
 
-    HttpConnection *conn = (nova_hostname != 0 && !nova_hostname->empty()) ? 
-       http_client_->CreateConnection(*nova_hostname, nova_port) :
-       http_client_->CreateConnection(boost::asio::ip::tcp::endpoint(nova_server, nova_port));
-
-    map<CURLoption, int> *curl_options = conn->curl_options();
-    curl_options->insert(std::make_pair(CURLOPT_HTTP_TRANSFER_DECODING, 0L));
-    conn->set_use_ssl(services_->agent()->params()->metadata_use_ssl());
-    if (conn->use_ssl()) {
-        conn->set_client_cert(
-              services_->agent()->params()->metadata_client_cert());
-        conn->set_client_cert_type(
-              services_->agent()->params()->metadata_client_cert_type());
-        conn->set_client_key(
-              services_->agent()->params()->metadata_client_key());
-        conn->set_ca_cert(
-              services_->agent()->params()->metadata_ca_cert());
+    HttpConnection *conn = GetIdleConnection(*nova_hostname, nova_server,
+                                             nova_port);
+    if (conn) {
+        metadata_stats_.connection_reuses++;
+    } else {
+        conn = (nova_hostname != 0 && !nova_hostname->empty()) ?
+           http_client_->CreateConnection(*nova_hostname, nova_port) :
+           http_client_->CreateConnection(boost::asio::ip::tcp::endpoint(nova_server, nova_port));
+
+        map<CURLoption, int> *curl_options = conn->curl_options();
+        curl_options->insert(std::make_pair(CURLOPT_HTTP_TRANSFER_DECODING, 0L));
+        conn->set_use_ssl(services_->agent()->params()->metadata_use_ssl());
+        if (conn->use_ssl()) {
+            conn->set_client_cert(
+                  services_->agent()->params()->metadata_client_cert());
+            conn->set_client_cert_type(
+                  services_->agent()->params()->metadata_client_cert_type());
+            conn->set_client_key(
+                  services_->agent()->params()->metadata_client_key());
+            conn->set_ca_cert(
+                  services_->agent()->params()->metadata_ca_cert());
+        }
+        conn->RegisterEventCb(
+                 boost::bind(&MetadataProxy::OnClientSessionEvent, this, _1, _2));
+        connection_endpoints_.insert(std::make_pair(conn,
+            IdleConnection(conn, *nova_hostname, nova_server, nova_port)));
+        metadata_stats_.connections++;
     }
-    conn->RegisterEventCb(
-             boost::bind(&MetadataProxy::OnClientSessionEvent, this, _1, _2));
     session->RegisterEventCb(
              boost::bind(&MetadataProxy::OnServerSessionEvent, this, _1, _2));
     SessionData data(conn, conn_close);
@@ -393,10 +598,51 @@ MetadataProxy::GetProxyConnection(HttpSession *session, bool conn_close,
     return conn;
 }
 
+// Get an idle connection to the same nova endpoint, left by an earlier VM
+// session
+HttpConnection *
+MetadataProxy::GetIdleConnection(const std::string &nova_hostname,
+                                 const Ip4Address &nova_server,
+                                 uint16_t nova_port) {
+    for (IdleConnectionList::iterator it = idle_connections_.begin();
+         it != idle_connections_.end(); ++it) {
+        if (it->hostname != nova_hostname || it->port != nova_port)
+            continue;
+        if (nova_hostname.empty() && it->server != nova_server)
+            continue;
+        HttpConnection *conn = it->conn;
+        connection_endpoints_.insert(std::make_pair(conn, *it));
+        idle_connections_.erase(it);
+        return conn;
+    }
+    return NULL;
+}
+
+// Keep connection to nova for reuse if response on it is complete,
+// close it otherwise
+void
+MetadataProxy::ReleaseClientSession(HttpConnection *conn, bool reuse) {
+    std::map<HttpConnection *, IdleConnection>::iterator it =
+        connection_endpoints_.find(conn);
+    if (!reuse || it == connection_endpoints_.end() ||
+        idle_connections_.size() >= kMaxIdleConnections) {
+        CloseClientSession(conn);
+        return;
+    }
+
+    metadata_proxy_sessions_.erase(conn);
+    idle_connections_.push_back(it->second);
+    connection_endpoints_.erase(it);
+}
+
 void
 MetadataProxy::CloseServerSession(HttpSession *session) {
     session->Close();
-    metadata_sessions_.erase(session);
+    SessionMap::iterator it = metadata_sessions_.find(session);
+    if (it != metadata_sessions_.end()) {
+        RequestDone(&it->second);
+        metadata_sessions_.erase(it);
+    }
 }
 
 void
@@ -404,6 +650,7 @@ MetadataProxy::CloseClientSession(HttpConnection *conn) {
     HttpClient *client = conn->client();
     client->RemoveConnection(conn);
     metadata_proxy_sessions_.erase(conn);
+    connection_endpoints_.erase(conn);
 }
 
 void
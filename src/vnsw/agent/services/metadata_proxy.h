@@ -5,6 +5,9 @@
 #ifndef vnsw_agent_metadata_proxy_h_
 #define vnsw_agent_metadata_proxy_h_
 
+#include <deque>
+#include <list>
+#include <base/address.h>
 #include "http/client/http_client.h"
 #include "http/http_session.h"
 
@@ -13,26 +16,104 @@ class MetadataClient;
 
 class MetadataProxy {
 public:
+    // Max requests relayed to nova at a time, further requests are queued
+    static const uint32_t kMaxActiveRequests = 64;
+    static const uint32_t kMaxQueuedRequests = 1024;
+    // Connections to nova kept open for reuse by new VM sessions
+    static const uint32_t kMaxIdleConnections = 32;
+
+    // Position in chunked response body, chunks may be split across
+    // the body messages received from nova
+    enum ChunkState {
+        CHUNK_SIZE,         // chunk size line, before extensions if any
+        CHUNK_EXTENSION,    // rest of the chunk size line
+        CHUNK_DATA,         // chunk_len bytes of data
+        CHUNK_DATA_END,     // CRLF after the chunk data
+        CHUNK_TRAILER,      // start of a trailer line after last chunk
+        CHUNK_TRAILER_LINE, // rest of a trailer line
+    };
+
     struct SessionData {
         SessionData(HttpConnection *c, bool conn_close)
             : conn(c), content_len(0), data_sent(0),
-              close_req(conn_close), header_end(false) {}
+              close_req(conn_close), header_end(false), head_req(false),
+              interim(false), content_len_known(false), no_body(false),
+              chunked(false), chunk_end(false), chunk_state(CHUNK_SIZE),
+              chunk_len(0), reusable(false), active(false) {}
+
+        void ResetResponse() {
+            content_len = data_sent = 0;
+            header_end = head_req = interim = false;
+            content_len_known = no_body = chunked = chunk_end = false;
+            chunk_state = CHUNK_SIZE;
+            chunk_len = 0;
+            reusable = false;
+        }
 
         HttpConnection *conn;
         uint32_t content_len;
         uint32_t data_sent;
         bool close_req;
         bool header_end;
+        bool head_req;
+        // 1xx response from nova, final response follows
+        bool interim;
+        bool content_len_known;
+        // 204 or 304 response from nova, no body follows the header
+        bool no_body;
+        bool chunked;
+        bool chunk_end;
+        ChunkState chunk_state;
+        // Size of chunk being parsed, remaining data in CHUNK_DATA state
+        uint32_t chunk_len;
+        // Response framing was explicit and it is fully received, connection
+        // to nova can be used for another request
+        bool reusable;
+        // Request is relayed and response is not complete
+        bool active;
+        std::string vm_ip;
     };
 
     struct MetadataStats {
         MetadataStats() { Reset(); }
-        void Reset() { requests = responses = proxy_sessions = internal_errors = 0; }
+        void Reset() {
+            requests = responses = proxy_sessions = internal_errors = 0;
+            connections = connection_reuses = queued_requests = 0;
+            queue_drops = queue_wait_usecs = max_queue_wait_usecs = 0;
+        }
 
         uint32_t requests;
         uint32_t responses;
         uint32_t proxy_sessions;
         uint32_t internal_errors;
+        // Connections opened to nova
+        uint32_t connections;
+        // VM sessions which used an idle connection to nova
+        uint32_t connection_reuses;
+        uint32_t queued_requests;
+        uint32_t queue_drops;
+        uint64_t queue_wait_usecs;
+        uint64_t max_queue_wait_usecs;
+    };
+
+    struct PendingRequest {
+        PendingRequest(HttpSession *s, const HttpRequest *r, uint64_t t)
+            : session(s), request(r), enqueue_time(t) {}
+
+        boost::intrusive_ptr<HttpSession> session;
+        const HttpRequest *request;
+        uint64_t enqueue_time;
+    };
+
+    struct IdleConnection {
+        IdleConnection(HttpConnection *c, const std::string &name,
+                       const Ip4Address &addr, uint16_t p)
+            : conn(c), hostname(name), server(addr), port(p) {}
+
+        HttpConnection *conn;
+        std::string hostname;
+        Ip4Address server;
+        uint16_t port;
     };
 
     typedef std::map<HttpSession *, SessionData> SessionMap;
@@ -40,6 +121,8 @@ public:
     typedef std::map<HttpConnection *, HttpSession *> ConnectionSessionMap;
     typedef std::pair<HttpConnection *, HttpSession *> ConnectionSessionPair;
     typedef boost::intrusive_ptr<HttpSession> HttpSessionPtr;
+    typedef std::deque<PendingRequest> PendingRequestQueue;
+    typedef std::list<IdleConnection> IdleConnectionList;
 
     MetadataProxy(ServicesModule *module, const std::string &secret);
     virtual ~MetadataProxy();
@@ -55,10 +138,27 @@ public:
 
     const MetadataStats &metadatastats() const { return metadata_stats_; }
     void ClearStats() { metadata_stats_.Reset(); }
+    uint32_t active_requests() const { return active_requests_; }
+    size_t pending_requests() const { return pending_requests_.size(); }
+    size_t idle_connections() const { return idle_connections_.size(); }
+    uint32_t max_active_requests() const { return max_active_requests_; }
+    void set_max_active_requests(uint32_t count) {
+        max_active_requests_ = count;
+    }
 
 private:
+    void ProxyRequest(HttpSession *session, const HttpRequest *request);
+    void DispatchPendingRequests();
+    void RequestDone(SessionData *data);
+    bool ResponseDone(const SessionData &data) const;
+    void ParseResponse(SessionData *data, const std::string &msg);
+    void ParseChunks(SessionData *data, const std::string &msg);
     HttpConnection *GetProxyConnection(HttpSession *session, bool conn_close,
                                        std::string *nova_hostname);
+    HttpConnection *GetIdleConnection(const std::string &nova_hostname,
+                                      const Ip4Address &nova_server,
+                                      uint16_t nova_port);
+    void ReleaseClientSession(HttpConnection *conn, bool reuse);
     void CloseServerSession(HttpSession *session);
     void CloseClientSession(HttpConnection *conn);
     void ErrorClose(HttpSession *sesion, uint16_t error);
@@ -70,6 +170,13 @@ private:
     SessionMap metadata_sessions_;
     ConnectionSessionMap metadata_proxy_sessions_;
     MetadataStats metadata_stats_;
+    uint32_t active_requests_;
+    uint32_t max_active_requests_;
+    bool dispatching_;
+    PendingRequestQueue pending_requests_;
+    IdleConnectionList idle_connections_;
+    // nova endpoint of connections in use, to add them back to idle list
+    std::map<HttpConnection *, IdleConnection> connection_endpoints_;
 
     DISALLOW_COPY_AND_ASSIGN(MetadataProxy);
 };
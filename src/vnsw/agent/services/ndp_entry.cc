@@ -621,18 +621,12 @@ NdpEntry::NdpEntry(boost::asio::io_service &io, Icmpv6Handler *handler,
     : work_queue_(TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
       NULL,
       boost::bind(&NdpEntry::DequeueEvent, this, _1)),
-      delay_timer_(TimerManager::CreateTimer(
-                  io, "Delay timer",
-                  TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
-                  PktHandler::ICMPV6)),
-      retransmit_timer_(TimerManager::CreateTimer(
-                  io, "Retransmit timer",
-                  TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
-                  PktHandler::ICMPV6)),
-      reachable_timer_(TimerManager::CreateTimer(
-                  io, "Reachable timer",
-                  TaskScheduler::GetInstance()->GetTaskId("Agent::Services"),
-                  PktHandler::ICMPV6)),
+      delay_timer_(new WheelTimer(
+                  handler->agent()->icmpv6_proto()->timer_wheel())),
+      retransmit_timer_(new WheelTimer(
+                  handler->agent()->icmpv6_proto()->timer_wheel())),
+      reachable_timer_(new WheelTimer(
+                  handler->agent()->icmpv6_proto()->timer_wheel())),
       retransmit_time_(1000),
       delay_time_(5000),
       reachable_time_(30000),
@@ -653,9 +647,9 @@ NdpEntry::~NdpEntry() {
 }
 
 void NdpEntry::DeleteAllTimers() {
-    TimerManager::DeleteTimer(delay_timer_);
-    TimerManager::DeleteTimer(retransmit_timer_);
-    TimerManager::DeleteTimer(reachable_timer_);
+    delete delay_timer_;
+    delete retransmit_timer_;
+    delete reachable_timer_;
 }
 
 void NdpEntry::StartDelayTimer() {
@@ -664,7 +658,7 @@ void NdpEntry::StartDelayTimer() {
 
     delay_timer_->Cancel();
     delay_timer_->Start(delay_time_,
-        boost::bind(&NdpEntry::DelayTimerExpired, this), NULL);
+        boost::bind(&NdpEntry::DelayTimerExpired, this));
 }
 
 void NdpEntry::StartReachableTimer() {
@@ -673,7 +667,7 @@ void NdpEntry::StartReachableTimer() {
 
     reachable_timer_->Cancel();
     reachable_timer_->Start(reachable_time_,
-        boost::bind(&NdpEntry::ReachableTimerExpired, this), NULL);
+        boost::bind(&NdpEntry::ReachableTimerExpired, this));
 }
 
 bool NdpEntry::ReachableTimerExpired() {
@@ -688,7 +682,7 @@ void NdpEntry::StartRetransmitTimer() {
     retry_count_inc();
     retransmit_timer_->Cancel();
     retransmit_timer_->Start(retransmit_time_,
-        boost::bind(&NdpEntry::RetransmitTimerExpired, this), NULL);
+        boost::bind(&NdpEntry::RetransmitTimerExpired, this));
 }
 
 bool NdpEntry::RetransmitTimerExpired() {
@@ -10,6 +10,7 @@
 #include <boost/statechart/state_machine.hpp>
 #include <netinet/icmp6.h>
 #include "services/icmpv6_handler.h"
+#include "services/timer_wheel.h"
 
 namespace sc = boost::statechart;
 class NdpEntry;
@@ -113,9 +114,9 @@ public:
     bool DequeueEvent(EventContainer ec);
     void DequeueEventDone(bool done);
     void UpdateFlapCount();
-    Timer* retransmit_timer() { return retransmit_timer_; };
-    Timer* reachable_timer() { return reachable_timer_; };
-    Timer* delay_timer() { return delay_timer_; };
+    WheelTimer* retransmit_timer() { return retransmit_timer_; };
+    WheelTimer* reachable_timer() { return reachable_timer_; };
+    WheelTimer* delay_timer() { return delay_timer_; };
 
     bool DeleteNdpRoute();
     bool IsResolved();
@@ -130,9 +131,9 @@ private:
     bool IsDerived();
 
     WorkQueue<EventContainer> work_queue_;
-    Timer *delay_timer_;
-    Timer *retransmit_timer_;
-    Timer *reachable_timer_;
+    WheelTimer *delay_timer_;
+    WheelTimer *retransmit_timer_;
+    WheelTimer *reachable_timer_;
     int retransmit_time_;
     int delay_time_;
     int reachable_time_;
@@ -305,6 +305,15 @@ void ServicesSandesh::DnsStatsSandesh(std::string ctxt, bool more) {
     dns->set_dns_unsupported(nstats.unsupported);
     dns->set_dns_failures(nstats.fail);
     dns->set_dns_drops(nstats.drop);
+    dns->set_dns_cache_hits(nstats.cache_hits);
+    dns->set_dns_cache_misses(nstats.cache_misses);
+    dns->set_dns_negative_cache_hits(nstats.negative_cache_hits);
+    dns->set_dns_coalesced_reqs(nstats.coalesced);
+    dns->set_dns_cache_evictions(nstats.cache_evictions);
+    const DnsProto *dns_proto = Agent::GetInstance()->GetDnsProto();
+    dns->set_dns_cache_entries(dns_proto->cache_entries());
+    dns->set_dns_cache_size(dns_proto->cache_size());
+    dns->set_dns_max_cache_size(dns_proto->max_cache_size());
     dns->set_context(ctxt);
     dns->set_more(more);
     dns->Response();
@@ -939,12 +948,26 @@ void ServicesSandesh::MetadataHandleRequest(std::string ctxt, bool more = false)
     MetadataResponse *resp = new MetadataResponse();
     resp->set_metadata_server_port(
           Agent::GetInstance()->metadata_server_port());
-    const MetadataProxy::MetadataStats &stats =
-          Agent::GetInstance()->services()->metadataproxy()->metadatastats();
+    const MetadataProxy *proxy =
+          Agent::GetInstance()->services()->metadataproxy();
+    const MetadataProxy::MetadataStats &stats = proxy->metadatastats();
     resp->set_metadata_requests(stats.requests);
     resp->set_metadata_responses(stats.responses);
     resp->set_metadata_proxy_sessions(stats.proxy_sessions);
     resp->set_metadata_internal_errors(stats.internal_errors);
+    resp->set_metadata_connections(stats.connections);
+    resp->set_metadata_connection_reuses(stats.connection_reuses);
+    resp->set_metadata_idle_connections(proxy->idle_connections());
+    resp->set_metadata_active_requests(proxy->active_requests());
+    resp->set_metadata_max_active_requests(proxy->max_active_requests());
+    resp->set_metadata_pending_requests(proxy->pending_requests());
+    resp->set_metadata_queued_requests(stats.queued_requests);
+    resp->set_metadata_queue_drops(stats.queue_drops);
+    uint64_t avg_wait = 0;
+    if (stats.queued_requests)
+        avg_wait = stats.queue_wait_usecs / stats.queued_requests;
+    resp->set_metadata_avg_queue_wait_usecs(avg_wait);
+    resp->set_metadata_max_queue_wait_usecs(stats.max_queue_wait_usecs);
     resp->set_context(ctxt);
     resp->set_more(more);
     resp->Response();
@@ -1289,12 +1312,14 @@ void ShowArpCache::HandleRequest() const {
     ArpCacheResp *resp = new ArpCacheResp();
     resp->set_context(context());
     ArpSandesh *arp_sandesh = new ArpSandesh(resp);
-    const ArpProto::ArpCache &cache =
-              (Agent::GetInstance()->GetArpProto()->arp_cache());
-    for (ArpProto::ArpCache::const_iterator it = cache.begin();
-         it != cache.end(); it++) {
-        if (!arp_sandesh->SetArpEntry(it->first, it->second))
-            break;
+    ArpProto *arp_proto = Agent::GetInstance()->GetArpProto();
+    for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+        const ArpProto::ArpCache &cache = arp_proto->shard(i)->arp_cache;
+        for (ArpProto::ArpCache::const_iterator it = cache.begin();
+             it != cache.end(); it++) {
+            if (!arp_sandesh->SetArpEntry(it->first, it->second))
+                break;
+        }
     }
     arp_sandesh->Response();
     delete arp_sandesh;
@@ -1304,13 +1329,16 @@ void ShowGratuitousArpCache::HandleRequest() const {
     ArpCacheResp *resp = new ArpCacheResp();
     resp->set_context(context());
     ArpSandesh *arp_sandesh = new ArpSandesh(resp);
-    const ArpProto::GratuitousArpCache &cache =
-              (Agent::GetInstance()->GetArpProto()->gratuitous_arp_cache());
-    for (ArpProto::GratuitousArpCache::const_iterator it = cache.begin();
-         it != cache.end(); it++) {
-        for (ArpProto::ArpEntrySet::iterator sit = it->second.begin();
-             sit != it->second.end(); sit++) {
-            arp_sandesh->SetArpEntry(it->first, *sit);
+    ArpProto *arp_proto = Agent::GetInstance()->GetArpProto();
+    for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+        const ArpProto::GratuitousArpCache &cache =
+            arp_proto->shard(i)->gratuitous_arp_cache;
+        for (ArpProto::GratuitousArpCache::const_iterator it = cache.begin();
+             it != cache.end(); it++) {
+            for (ArpProto::ArpEntrySet::iterator sit = it->second.begin();
+                 sit != it->second.end(); sit++) {
+                arp_sandesh->SetArpEntry(it->first, *sit);
+            }
         }
     }
 
@@ -3,9 +3,11 @@
  */
 
 #include "base/os.h"
+#include "base/time_util.h"
 #include "testing/gunit.h"
 
 #include <sys/socket.h>
+#include <sys/resource.h>
 #include <netinet/if_ether.h>
 #include <base/logging.h>
 
@@ -239,6 +241,24 @@ public:
                                 itf_name);
     }
 
+    uint64_t WheelWakeups() {
+        ArpProto *arp_proto = agent->GetArpProto();
+        uint64_t wakeups = 0;
+        for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+            wakeups += arp_proto->shard(i)->timer_wheel.wakeups();
+        }
+        return wakeups;
+    }
+
+    uint64_t WheelExpired() {
+        ArpProto *arp_proto = agent->GetArpProto();
+        uint64_t expired = 0;
+        for (uint32_t i = 0; i < arp_proto->shard_count(); i++) {
+            expired += arp_proto->shard(i)->timer_wheel.expired();
+        }
+        return expired;
+    }
+
     void WaitForCompletion(unsigned int size) {
         int count = 0;
         do {
@@ -1143,6 +1163,131 @@ TEST_F(ArpTest, ArpReqOnVmInterface) {
     WAIT_FOR(500, 1000, (VrfFind("vrf1") == false));
 }
 
+// Resolve a number of entries and measure wakeups of ARP timer wheel and
+// CPU consumed while entries are retrying. Number of entries can be
+// overridden with AGENT_ARP_SCALE_COUNT for a scale run.
+TEST_F(ArpTest, ArpTimerWheelScale) {
+    uint32_t count = 1000;
+    if (getenv("AGENT_ARP_SCALE_COUNT")) {
+        count = strtoul(getenv("AGENT_ARP_SCALE_COUNT"), NULL, 0);
+    }
+    const uint32_t retry_timeout = 200;
+    ArpProto *arp_proto = agent->GetArpProto();
+    std::size_t initial_size = arp_proto->GetArpCacheSize();
+    uint16_t orig_max_retries = arp_proto->max_retries();
+    uint32_t orig_retry_timeout = arp_proto->retry_timeout();
+    arp_proto->set_max_retries(ArpProto::kMaxRetries);
+    arp_proto->set_retry_timeout(retry_timeout);
+
+    in_addr_t base = ntohl(inet_addr("10.128.0.1"));
+    uint64_t t1 = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < count; i++) {
+        SendArpMessage(ArpProto::ARP_RESOLVE, base + i);
+    }
+    WAIT_FOR(10000, 1000,
+             (arp_proto->GetArpCacheSize() == initial_size + count));
+    uint64_t t2 = ClockMonotonicUsec();
+
+    // Entries retry every retry_timeout, sample over few retries
+    struct rusage r1, r2;
+    uint64_t wakeups = WheelWakeups();
+    uint64_t expired = WheelExpired();
+    getrusage(RUSAGE_SELF, &r1);
+    usleep(3 * retry_timeout * 1000);
+    getrusage(RUSAGE_SELF, &r2);
+    wakeups = WheelWakeups() - wakeups;
+    expired = WheelExpired() - expired;
+    uint64_t cpu_usec =
+        ((r2.ru_utime.tv_sec - r1.ru_utime.tv_sec) * 1000000) +
+        (r2.ru_utime.tv_usec - r1.ru_utime.tv_usec) +
+        ((r2.ru_stime.tv_sec - r1.ru_stime.tv_sec) * 1000000) +
+        (r2.ru_stime.tv_usec - r1.ru_stime.tv_usec);
+    EXPECT_TRUE(expired >= count);
+    EXPECT_TRUE(wakeups < expired);
+
+    cout << "Entries " << count << " resolved in " << (t2 - t1)
+        << " usec" << endl;
+    cout << "Retry window " << (3 * retry_timeout) << " msec, "
+        << "timer expiries " << expired << " wheel wakeups " << wakeups
+        << " cpu " << cpu_usec << " usec" << endl;
+
+    for (uint32_t i = 0; i < count; i++) {
+        ArpNHUpdate(DBRequest::DB_ENTRY_DELETE, base + i);
+    }
+    WAIT_FOR(10000, 1000, (arp_proto->GetArpCacheSize() == initial_size));
+    arp_proto->set_max_retries(orig_max_retries);
+    arp_proto->set_retry_timeout(orig_retry_timeout);
+    client->WaitForIdle();
+}
+
+// ARP storm, replies for large number of entries being resolved arrive
+// together. Reports rate at which replies are processed and percentiles of
+// time to resolve an entry from start of the storm. Default number of entries
+// is small to keep the unit test quick, set AGENT_ARP_STORM_COUNT (e.g. 20000)
+// to run it at scale.
+TEST_F(ArpTest, ArpStormBench) {
+    uint32_t count = 1000;
+    if (getenv("AGENT_ARP_STORM_COUNT")) {
+        count = strtoul(getenv("AGENT_ARP_STORM_COUNT"), NULL, 0);
+    }
+    ArpProto *arp_proto = agent->GetArpProto();
+    std::size_t initial_size = arp_proto->GetArpCacheSize();
+    uint16_t orig_max_retries = arp_proto->max_retries();
+    uint32_t orig_retry_timeout = arp_proto->retry_timeout();
+    arp_proto->set_max_retries(ArpProto::kMaxRetries);
+    arp_proto->set_retry_timeout(ArpProto::kRetryTimeout);
+
+    in_addr_t base = ntohl(inet_addr("10.129.0.1"));
+    for (uint32_t i = 0; i < count; i++) {
+        SendArpMessage(ArpProto::ARP_RESOLVE, base + i);
+    }
+    WAIT_FOR(10000, 1000,
+             (arp_proto->GetArpCacheSize() == initial_size + count));
+    client->WaitForIdle();
+
+    uint32_t resolved = arp_proto->GetStats().resolved;
+    uint32_t done = 0;
+    std::vector<uint64_t> latency;
+    latency.reserve(count);
+    uint64_t start = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < count; i++) {
+        SendArpReply(reply_ifindex, 0, src_ip, base + i);
+    }
+    // Replies resolved between two samples are given latency of the sample
+    uint64_t end = start;
+    uint32_t wait = 0;
+    while (done < count && wait++ < 100000) {
+        uint32_t now_done = arp_proto->GetStats().resolved - resolved;
+        end = ClockMonotonicUsec();
+        for (; done < now_done; done++) {
+            latency.push_back(end - start);
+        }
+        usleep(100);
+    }
+    EXPECT_EQ(count, done);
+
+    uint64_t p50 = 0, p90 = 0, p99 = 0;
+    if (latency.empty() == false) {
+        p50 = latency[(latency.size() * 50) / 100];
+        p90 = latency[(latency.size() * 90) / 100];
+        p99 = latency[(latency.size() * 99) / 100];
+    }
+    uint64_t usec = (end > start) ? (end - start) : 1;
+    cout << "Shards " << arp_proto->shard_count() << " replies " << done
+        << " in " << usec << " usec, " << ((done * 1000000ULL) / usec)
+        << " replies/sec" << endl;
+    cout << "Resolve latency p50 " << p50 << " usec p90 " << p90
+        << " usec p99 " << p99 << " usec" << endl;
+
+    for (uint32_t i = 0; i < count; i++) {
+        ArpNHUpdate(DBRequest::DB_ENTRY_DELETE, base + i);
+    }
+    WAIT_FOR(10000, 1000, (arp_proto->GetArpCacheSize() == initial_size));
+    arp_proto->set_max_retries(orig_max_retries);
+    arp_proto->set_retry_timeout(orig_retry_timeout);
+    client->WaitForIdle();
+}
+
 void RouterIdDepInit(Agent *agent) {
 }
 
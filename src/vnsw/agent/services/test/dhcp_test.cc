@@ -3,6 +3,7 @@
  */
 
 #include "base/os.h"
+#include "base/time_util.h"
 #include "testing/gunit.h"
 
 #include <sys/socket.h>
@@ -2824,6 +2825,157 @@ TEST_F(DhcpTest, DhcpReqv6PortTest) {
     Agent::GetInstance()->GetDhcpProto()->ClearStats();
 }
 
+// Allocate leases from a lease DB and time the commit of lease records to
+// the lease file, and the load of the lease file on restart. Number of
+// leases can be overridden with AGENT_DHCP_LEASE_BENCH_COUNT.
+TEST_F(DhcpTest, DhcpLeaseDbBench) {
+    uint32_t count = 1000;
+    if (getenv("AGENT_DHCP_LEASE_BENCH_COUNT")) {
+        count = strtoul(getenv("AGENT_DHCP_LEASE_BENCH_COUNT"), NULL, 0);
+    }
+    const std::string lease_file = "./dhcp.lease_bench.leases";
+    remove(lease_file.c_str());
+
+    // Subnet large enough for count leases
+    uint8_t plen = 30;
+    while (plen > 8 && (1U << (32 - plen)) < (count + 2))
+        plen--;
+    boost::system::error_code ec;
+    Ip4Address subnet = Ip4Address::from_string("10.0.0.0", ec);
+    const std::vector<Ip4Address> reserve_addresses;
+    boost::asio::io_service *io =
+        Agent::GetInstance()->event_manager()->io_service();
+    DhcpLeaseDb *lease_db = new DhcpLeaseDb(subnet, plen, reserve_addresses,
+                                            lease_file, *io);
+
+    // Hold the scheduler, lease records of the burst are committed together
+    // once the scheduler is started
+    uint64_t t1 = ClockMonotonicUsec();
+    TaskScheduler::GetInstance()->Stop();
+    for (uint32_t i = 0; i < count; i++) {
+        MacAddress mac(0x00, 0x0a, (i >> 24) & 0xFF, (i >> 16) & 0xFF,
+                       (i >> 8) & 0xFF, i & 0xFF);
+        Ip4Address ip;
+        EXPECT_TRUE(lease_db->Allocate(mac, &ip, 86400));
+    }
+    TaskScheduler::GetInstance()->Start();
+    client->WaitForIdle();
+    uint64_t t2 = ClockMonotonicUsec();
+    EXPECT_EQ(count, lease_db->leases().size());
+    uint64_t commits = lease_db->lease_commits();
+    delete lease_db;
+
+    uint64_t t3 = ClockMonotonicUsec();
+    lease_db = new DhcpLeaseDb(subnet, plen, reserve_addresses, lease_file,
+                               *io);
+    uint64_t t4 = ClockMonotonicUsec();
+    EXPECT_EQ(count, lease_db->leases().size());
+
+    uint64_t usec = (t2 > t1) ? (t2 - t1) : 1;
+    cout << "Leases " << count << " written in " << usec << " usec, "
+        << ((count * 1000000ULL) / usec) << " leases/sec, commits "
+        << commits << endl;
+    cout << "Lease file load " << (t4 - t3) << " usec" << endl;
+
+    delete lease_db;
+    remove(lease_file.c_str());
+}
+
+// A burst of lease updates is committed to the lease file together
+TEST_F(DhcpTest, DhcpLeaseDbGroupCommit) {
+    const uint32_t count = 500;
+    const std::string lease_file = "./dhcp.lease_group_commit.leases";
+    remove(lease_file.c_str());
+
+    boost::system::error_code ec;
+    Ip4Address subnet = Ip4Address::from_string("10.0.0.0", ec);
+    const std::vector<Ip4Address> reserve_addresses;
+    boost::asio::io_service *io =
+        Agent::GetInstance()->event_manager()->io_service();
+    DhcpLeaseDb *lease_db = new DhcpLeaseDb(subnet, 22, reserve_addresses,
+                                            lease_file, *io);
+
+    // Allocate and release every lease with the scheduler held, so that all
+    // the updates are pending when the commit runs
+    TaskScheduler::GetInstance()->Stop();
+    for (uint32_t i = 0; i < count; i++) {
+        MacAddress mac(0x00, 0x0a, 0x00, 0x00, (i >> 8) & 0xFF, i & 0xFF);
+        Ip4Address ip;
+        EXPECT_TRUE(lease_db->Allocate(mac, &ip, 86400));
+        EXPECT_TRUE(lease_db->Release(mac));
+    }
+    TaskScheduler::GetInstance()->Start();
+    client->WaitForIdle();
+    EXPECT_EQ(1U, lease_db->lease_commits());
+    EXPECT_EQ(0U, lease_db->lease_compactions());
+    delete lease_db;
+
+    // Every update was written by the commit
+    lease_db = new DhcpLeaseDb(subnet, 22, reserve_addresses, lease_file,
+                               *io);
+    EXPECT_EQ(count, lease_db->leases().size());
+    for (std::set<DhcpLeaseDb::DhcpLease>::const_iterator it =
+         lease_db->leases().begin(); it != lease_db->leases().end(); ++it) {
+        EXPECT_TRUE(it->released_);
+    }
+
+    delete lease_db;
+    remove(lease_file.c_str());
+}
+
+// A partial record at the end of the lease file, left by a crash during
+// append, is ignored on load and the earlier leases are retained
+TEST_F(DhcpTest, DhcpLeaseDbPartialRecord) {
+    const std::string lease_file = "./dhcp.lease_partial.leases";
+    remove(lease_file.c_str());
+
+    boost::system::error_code ec;
+    Ip4Address subnet = Ip4Address::from_string("10.0.0.0", ec);
+    MacAddress mac[] = {
+        MacAddress(0x00, 0x0a, 0x00, 0x00, 0x00, 0x01),
+        MacAddress(0x00, 0x0a, 0x00, 0x00, 0x00, 0x02),
+        MacAddress(0x00, 0x0a, 0x00, 0x00, 0x00, 0x03),
+    };
+    Ip4Address ip[3];
+    LoadDhcpLeaseFile(subnet, 24, lease_file);
+    for (uint32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(lease_db_->Allocate(mac[i], &ip[i], 86400));
+    }
+    client->WaitForIdle();
+    CloseDhcpLeaseFile();
+
+    // Append a release of the first lease, cut short before end of record
+    FILE *fp = fopen(lease_file.c_str(), "a");
+    ASSERT_TRUE(fp != NULL);
+    fprintf(fp, "<lease> <mac>%s</mac> <ip>%s</ip> <expiry>0</expiry> "
+            "<released>true</released> </le", mac[0].ToString().c_str(),
+            ip[0].to_string().c_str());
+    fclose(fp);
+
+    LoadDhcpLeaseFile(subnet, 24, lease_file);
+    EXPECT_EQ(3U, lease_db_->leases().size());
+    for (uint32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(CheckDhcpLease(mac[i], ip[i], false));
+    }
+
+    // Partial record is removed on load, lease added later is not lost
+    MacAddress new_mac(0x00, 0x0a, 0x00, 0x00, 0x00, 0x04);
+    Ip4Address new_ip;
+    EXPECT_TRUE(lease_db_->Allocate(new_mac, &new_ip, 86400));
+    client->WaitForIdle();
+    CloseDhcpLeaseFile();
+
+    LoadDhcpLeaseFile(subnet, 24, lease_file);
+    EXPECT_EQ(4U, lease_db_->leases().size());
+    for (uint32_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(CheckDhcpLease(mac[i], ip[i], false));
+    }
+    EXPECT_TRUE(CheckDhcpLease(new_mac, new_ip, false));
+
+    CloseDhcpLeaseFile();
+    remove(lease_file.c_str());
+}
+
 // Check the DHCP queue limit
 #ifdef DHCP_FLAKY
 TEST_F(DhcpTest, QueueLimitTest) {
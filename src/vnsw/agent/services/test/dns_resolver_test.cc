@@ -153,6 +153,8 @@ public:
             add_items[i].soa.refresh = add_items[i].soa.retry = 500;
             add_items[i].soa.expiry = add_items[i].soa.ttl = 1000;
         }
+        // Responses are not cached, so that queries are sent to the server
+        Agent::GetInstance()->GetDnsProto()->set_max_cache_size(0);
     }
     ~DnsTest() {
         Agent::GetInstance()->interface_table()->Unregister(rid_);
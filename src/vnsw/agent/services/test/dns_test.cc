@@ -8,6 +8,7 @@
 #include <sys/socket.h>
 #include <netinet/if_ether.h>
 #include <base/logging.h>
+#include <base/time_util.h>
 
 #include <io/event_manager.h>
 #include <cmn/agent_cmn.h>
@@ -143,6 +144,9 @@ public:
             add_items[i].soa.refresh = add_items[i].soa.retry = 500;
             add_items[i].soa.expiry = add_items[i].soa.ttl = 1000;
         }
+        // Responses are not cached, so that queries are sent to the server;
+        // DnsCacheTest enables the cache
+        Agent::GetInstance()->GetDnsProto()->set_max_cache_size(0);
     }
     ~DnsTest() {
         Agent::GetInstance()->interface_table()->Unregister(rid_);
@@ -194,12 +198,13 @@ public:
     void CheckSandeshResponse(Sandesh *sandesh) {
     }
 
-    int SendDnsQuery(dnshdr *dns, int numItems, DnsItem *items, dns_flags flags) {
+    int SendDnsQuery(dnshdr *dns, int numItems, DnsItem *items, dns_flags flags,
+                     uint16_t xid) {
         DnsItems questions;
         for (int i = 0; i < numItems; i++) {
             questions.push_back(items[i]);
         }
-        int len = BindUtil::BuildDnsQuery((uint8_t *)dns, 0x0102,
+        int len = BindUtil::BuildDnsQuery((uint8_t *)dns, xid,
                                           "default-vdns", questions);
         dns->flags = flags;
         return len;
@@ -217,7 +222,7 @@ public:
 
     void SendDnsReq(int type, short itf_index, int numItems,
                     DnsItem *items, dns_flags flags = default_flags,
-                    bool update = false) {
+                    bool update = false, uint16_t xid = 0x0102) {
         int len = 1024;
         uint8_t *buf  = new uint8_t[len];
         memset(buf, 0, len);
@@ -256,7 +261,7 @@ public:
 
         dnshdr *dns = (dnshdr *) (udp + 1);
         if (type == DNS_OPCODE_QUERY) {
-            len = SendDnsQuery(dns, numItems, items, flags);
+            len = SendDnsQuery(dns, numItems, items, flags, xid);
         } else if (type == DNS_OPCODE_UPDATE) {
             BindUtil::Operation op =
                 update ? BindUtil::ADD_UPDATE : BindUtil::DELETE_UPDATE;
@@ -1209,6 +1214,162 @@ TEST_F(DnsTest, DefaultDnsLinklocalReqTest) {
     client->WaitForIdle();
 }
 
+// Responses from the server are cached and identical queries pending at
+// the server are answered together
+TEST_F(DnsTest, DnsCacheTest) {
+    struct PortInfo input[] = {
+        {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    };
+    IpamInfo ipam_info[] = {
+        {"1.2.3.128", 27, "1.2.3.129", true},
+        {"7.8.9.0", 24, "7.8.9.12", true},
+        {"1.1.1.0", 24, "1.1.1.200", true},
+    };
+
+    char vdns_attr[] =
+        "<virtual-DNS-data>\
+            <domain-name>test.contrail.juniper.net</domain-name>\
+            <dynamic-records-from-client>true</dynamic-records-from-client>\
+            <record-order>fixed</record-order>\
+            <default-ttl-seconds>120</default-ttl-seconds>\
+        </virtual-DNS-data>\n";
+    char ipam_attr[] = "<network-ipam-mgmt>\n <ipam-dns-method>virtual-dns-server</ipam-dns-method>\n <ipam-dns-server><virtual-dns-server-name>vdns1</virtual-dns-server-name></ipam-dns-server>\n </network-ipam-mgmt>\n";
+
+    uint32_t bench_count = 1000;
+    char env[100];
+    if (getenv("AGENT_DNS_CACHE_BENCH_COUNT")) {
+        strcpy(env, getenv("AGENT_DNS_CACHE_BENCH_COUNT"));
+        bench_count = strtoul(env, NULL, 0);
+    }
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+    IntfCfgAdd(input, 0);
+    WaitForItfUpdate(1);
+
+    AddIPAM("vn1", ipam_info, 3, ipam_attr, "vdns1");
+    client->WaitForIdle();
+    AddVDNS("vdns1", vdns_attr);
+    client->WaitForIdle();
+
+    DnsProto *dns_proto = Agent::GetInstance()->GetDnsProto();
+    dns_proto->set_timeout(2000);
+    dns_proto->set_max_retries(1);
+    dns_proto->set_max_cache_size(DnsProto::kDnsCacheMaxSize);
+    dns_proto->ClearStats();
+    DnsProto::DnsStats stats;
+    int count = 0;
+
+    // Response from the server is cached
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    CHECK_CONDITION(stats.requests < 1);
+    client->WaitForIdle();
+    g_xid++;
+    SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 1);
+    EXPECT_EQ(1U, stats.cache_misses);
+    EXPECT_EQ(1U, dns_proto->cache_entries());
+
+    // Same query is answered from the cache
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    CHECK_CONDITION(stats.resolved < 2);
+    EXPECT_EQ(1U, stats.cache_hits);
+    EXPECT_EQ(1U, stats.cache_misses);
+
+    // Name error, with SOA in authority section, is cached
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    CHECK_CONDITION(stats.requests < 3);
+    client->WaitForIdle();
+    g_xid++;
+    SendDnsResp(1, &a_items[1], 1, add_items, 0, NULL, true);
+    CHECK_CONDITION(stats.fail < 1);
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    CHECK_CONDITION(stats.fail < 2);
+    EXPECT_EQ(1U, stats.negative_cache_hits);
+    EXPECT_EQ(2U, dns_proto->cache_entries());
+
+    // Identical queries wait for the query already sent to the server
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[2], default_flags,
+               false, 0x0201);
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[2], default_flags,
+               false, 0x0202);
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[2], default_flags,
+               false, 0x0203);
+    CHECK_CONDITION(stats.coalesced < 2);
+    g_xid++;
+    SendDnsResp(1, &a_items[2], 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 5);
+    EXPECT_EQ(2U, stats.coalesced);
+    EXPECT_EQ(5U, stats.cache_misses);
+    EXPECT_EQ(3U, dns_proto->cache_entries());
+
+    // Least recently used entry is evicted to keep within the cache size
+    dns_proto->set_max_cache_size(dns_proto->cache_size() - 1);
+    stats = dns_proto->GetStats();
+    EXPECT_EQ(2U, dns_proto->cache_entries());
+    EXPECT_EQ(1U, stats.cache_evictions);
+    dns_proto->set_max_cache_size(DnsProto::kDnsCacheMaxSize);
+
+    // Update to the virtual DNS records flushes its cached responses
+    SendDnsReq(DNS_OPCODE_UPDATE, GetItfId(0), 1, a_items, default_flags, true);
+    CHECK_CONDITION(stats.resolved < 6);
+    EXPECT_EQ(0U, dns_proto->cache_entries());
+    EXPECT_EQ(0U, dns_proto->cache_size());
+
+    // Compare queries answered from the cache with queries to the server
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    client->WaitForIdle();
+    g_xid++;
+    SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 7);
+
+    uint32_t resolved = stats.resolved;
+    uint64_t start = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < bench_count; i++) {
+        SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items, default_flags,
+                   false, 0x1000 + i);
+        if ((i % 64) == 63)
+            client->WaitForIdle();
+    }
+    CHECK_CONDITION(stats.resolved < resolved + bench_count);
+    uint64_t cached_time = ClockMonotonicUsec() - start;
+
+    dns_proto->set_max_cache_size(0);
+    uint32_t server_count = bench_count / 10 + 1;
+    resolved = stats.resolved;
+    start = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < server_count; i++) {
+        SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items, default_flags,
+                   false, 0x1000 + i);
+        SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+        CHECK_CONDITION(stats.resolved < resolved + i + 1);
+    }
+    uint64_t server_time = ClockMonotonicUsec() - start;
+
+    cout << "DNS queries from cache " << bench_count << " Time "
+         << cached_time << "us Queries/sec "
+         << (bench_count * 1000000ULL) / (cached_time + 1) << endl;
+    cout << "DNS queries to server " << server_count << " Time "
+         << server_time << "us Queries/sec "
+         << (server_count * 1000000ULL) / (server_time + 1) << endl;
+    EXPECT_EQ(bench_count + 1, stats.cache_hits);
+
+    client->Reset();
+    DeleteVmportEnv(input, 1, 1, 0);
+    client->WaitForIdle();
+
+    IntfCfgDel(input, 0);
+    WaitForItfUpdate(0);
+    dns_proto->ClearStats();
+
+    client->Reset();
+    DelIPAM("vn1", "vdns1");
+    client->WaitForIdle();
+    DelVDNS("vdns1");
+    client->WaitForIdle();
+}
+
 TEST_F(DnsTest, DnsDropTest) {
     struct PortInfo input[] = {
         {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
@@ -5,8 +5,10 @@
 #include "base/os.h"
 #include "testing/gunit.h"
 
+#include <algorithm>
 #include <boost/scoped_array.hpp>
 #include <base/logging.h>
+#include <base/time_util.h>
 
 #include <pugixml/pugixml.hpp>
 #include <io/event_manager.h>
@@ -115,7 +117,9 @@ public:
     }
 
     MetadataTest() : nova_api_proxy_(NULL), vm_http_client_(NULL),
-                     done_(0), itf_count_(0), data_size_(0) {
+                     done_(0), itf_count_(0), data_size_(0),
+                     load_done_(0), load_errors_(0), close_delimited_(false),
+                     chunked_(false) {
         rid_ = Agent::GetInstance()->interface_table()->Register(
                 boost::bind(&MetadataTest::ItfUpdate, this, _2));
         Agent::GetInstance()->set_compute_node_ip(Ip4Address::from_string("127.0.0.1"));
@@ -278,6 +282,79 @@ public:
         done_++;
     }
 
+    // Send a GET on a new VM connection, recording the send time so that
+    // the response latency can be computed in HandleLoadResponse
+    void SendLoadRequest(uint32_t index) {
+        boost::system::error_code ec;
+        boost::asio::ip::tcp::endpoint http_ep;
+        http_ep.address(Ip4Address::from_string("127.0.0.1", ec));
+        http_ep.port(Agent::GetInstance()->metadata_server_port());
+
+        std::string uri("openstack");
+        std::vector<std::string> header_options;
+        header_options.push_back(std::string("Connection: close"));
+        HttpConnection *conn = vm_http_client_->CreateConnection(http_ep);
+        conn->RegisterEventCb(
+              boost::bind(&MetadataTest::OnClientSessionEvent, this, _1, _2));
+        {
+            tbb::mutex::scoped_lock lock(mutex_);
+            load_start_[index] = ClockMonotonicUsec();
+        }
+        conn->HttpGet(uri, false, false, true, header_options,
+                      boost::bind(&MetadataTest::HandleLoadResponse,
+                                  this, conn, index, _1, _2));
+    }
+
+    void HandleLoadResponse(HttpConnection *conn, uint32_t index,
+                            std::string &msg, boost::system::error_code &ec) {
+        {
+            tbb::mutex::scoped_lock lock(mutex_);
+            if (load_latency_[index])
+                return;
+            load_latency_[index] = ClockMonotonicUsec() - load_start_[index] + 1;
+            if (ec)
+                load_errors_++;
+            load_done_++;
+        }
+        CloseClientSession(conn);
+    }
+
+    void StartLoad(uint32_t count) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        data_size_ = 0;
+        load_done_ = 0;
+        load_errors_ = 0;
+        load_start_.assign(count, 0);
+        load_latency_.assign(count, 0);
+    }
+
+    uint32_t GetLoadDone() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return load_done_;
+    }
+
+    uint32_t GetLoadErrors() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return load_errors_;
+    }
+
+    std::vector<uint64_t> GetLoadLatency() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return load_latency_;
+    }
+
+    // Respond from nova without Content-Length and close the connection
+    // to end the response
+    void set_close_delimited(bool close_delimited) {
+        close_delimited_ = close_delimited;
+    }
+
+    // Respond from nova with chunked encoding, the last chunk is split
+    // across writes
+    void set_chunked(bool chunked) {
+        chunked_ = chunked;
+    }
+
     void CloseClientSession(HttpConnection *conn) {
         HttpClient *client = conn->client();
         client->RemoveConnection(conn);
@@ -338,14 +415,47 @@ public:
                             "</head>\n"
                             "</html>\n";
         char response[512];
-        snprintf(response, sizeof(response),
-                 "HTTP/1.1 200 OK\r\n"
-                 "Content-Type: text/html; charset=UTF-8\r\n"
-                 "Content-Length: %u\r\n"
-                 "\r\n%s", (unsigned int)strlen(body), body);
+        if (chunked_) {
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/html; charset=UTF-8\r\n"
+                     "Transfer-Encoding: chunked\r\n"
+                     "\r\n%x\r\n%s\r\n", (unsigned int)strlen(body), body);
+            session->Send(reinterpret_cast<const u_int8_t *>(response),
+                          strlen(response), NULL);
+            // Last chunk with an extension and a trailer, written in pieces
+            // so that the proxy receives it across messages
+            const char *last_chunk[] = {
+                "0", ";name=value\r", "\nExpires: 0\r\n", "\r", "\n"
+            };
+            for (uint32_t i = 0;
+                 i < sizeof(last_chunk) / sizeof(last_chunk[0]); i++) {
+                usleep(10000);
+                session->Send(
+                    reinterpret_cast<const u_int8_t *>(last_chunk[i]),
+                    strlen(last_chunk[i]), NULL);
+            }
+            delete request;
+            return;
+        }
+
+        if (close_delimited_) {
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/html; charset=UTF-8\r\n"
+                     "\r\n%s", body);
+        } else {
+            snprintf(response, sizeof(response),
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/html; charset=UTF-8\r\n"
+                     "Content-Length: %u\r\n"
+                     "\r\n%s", (unsigned int)strlen(body), body);
+        }
 
         session->Send(reinterpret_cast<const u_int8_t *>(response),
                       strlen(response), NULL);
+        if (close_delimited_)
+            session->Close();
         delete request;
     }
 
@@ -358,7 +468,13 @@ private:
     uint32_t data_size_;
     DBTableBase::ListenerId rid_;
     std::vector<std::size_t> itf_id_;
+    uint32_t load_done_;
+    uint32_t load_errors_;
+    std::vector<uint64_t> load_start_;
+    std::vector<uint64_t> load_latency_;
     tbb::mutex mutex_;
+    bool close_delimited_;
+    bool chunked_;
 };
 
 TEST_F(MetadataTest, MetadataReqTest) {
@@ -696,6 +812,186 @@ TEST_F(MetadataTest, MetadataCloseServerTest) {
     Agent::GetInstance()->services()->metadataproxy()->ClearStats();
 }
 
+// Send a burst of requests from many VM connections, with the number of
+// requests relayed to nova limited so that requests get queued, and
+// report the throughput and tail latency seen by the VMs
+TEST_F(MetadataTest, MetadataLoadTest) {
+    int count = 0;
+    uint32_t load_count = 256;
+    char env[100];
+    if (getenv("AGENT_METADATA_LOAD_COUNT")) {
+        strcpy(env, getenv("AGENT_METADATA_LOAD_COUNT"));
+        load_count = strtoul(env, NULL, 0);
+    }
+
+    MetadataProxy::MetadataStats stats;
+    MetadataProxy *proxy = Agent::GetInstance()->services()->metadataproxy();
+    struct PortInfo input[] = {
+        {"vnet1", 1, vm1_ip, "00:00:00:01:01:01", 1, 1},
+    };
+
+    StartNovaApiProxy();
+    SetupLinkLocalConfig();
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+
+    StartHttpClient();
+
+    InterfaceTable *intf_table = Agent::GetInstance()->interface_table();
+    std::auto_ptr<InterfaceTable> interface_table(new TestInterfaceTable());
+    Agent::GetInstance()->set_interface_table(interface_table.get());
+
+    proxy->set_max_active_requests(8);
+    StartLoad(load_count);
+
+    uint64_t start = ClockMonotonicUsec();
+    for (uint32_t i = 0; i < load_count; i++) {
+        SendLoadRequest(i);
+    }
+    METADATA_CHECK (GetLoadDone() < load_count);
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+
+    std::vector<uint64_t> latency(GetLoadLatency());
+    std::sort(latency.begin(), latency.end());
+    uint64_t p99 = latency[(load_count * 99) / 100];
+    cout << "Metadata requests " << load_count
+         << " Time " << elapsed << "us"
+         << " Requests/sec " << (load_count * 1000000ULL) / (elapsed + 1)
+         << " p99 latency " << p99 << "us"
+         << " Connections " << stats.connections
+         << " Reused " << stats.connection_reuses
+         << " Queued " << stats.queued_requests << endl;
+
+    EXPECT_EQ(0U, GetLoadErrors());
+    EXPECT_EQ(load_count, stats.requests);
+    EXPECT_EQ(0U, stats.queue_drops);
+    // Upstream connections are reused once requests are queued
+    EXPECT_TRUE(stats.queued_requests > 0);
+    EXPECT_TRUE(stats.connection_reuses > 0);
+    EXPECT_TRUE(stats.connections < load_count);
+    EXPECT_EQ(0U, proxy->pending_requests());
+    METADATA_CHECK (proxy->active_requests() != 0);
+
+    proxy->set_max_active_requests(MetadataProxy::kMaxActiveRequests);
+    Agent::GetInstance()->set_interface_table(intf_table);
+    client->Reset();
+    StopHttpClient();
+    DeleteVmportEnv(input, 1, 1, 0);
+    client->WaitForIdle();
+
+    ClearLinkLocalConfig();
+    StopNovaApiProxy();
+    client->WaitForIdle();
+
+    proxy->ClearStats();
+}
+
+// Response from nova without Content-Length or chunked encoding ends when
+// nova closes the connection, the connection must not be given to the
+// next request
+TEST_F(MetadataTest, MetadataCloseDelimitedResponseTest) {
+    int count = 0;
+    MetadataProxy::MetadataStats stats;
+    MetadataProxy *proxy = Agent::GetInstance()->services()->metadataproxy();
+    struct PortInfo input[] = {
+        {"vnet1", 1, vm1_ip, "00:00:00:01:01:01", 1, 1},
+    };
+
+    StartNovaApiProxy();
+    SetupLinkLocalConfig();
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+
+    StartHttpClient();
+
+    InterfaceTable *intf_table = Agent::GetInstance()->interface_table();
+    std::auto_ptr<InterfaceTable> interface_table(new TestInterfaceTable());
+    Agent::GetInstance()->set_interface_table(interface_table.get());
+
+    set_close_delimited(true);
+    size_t idle = proxy->idle_connections();
+    SendHttpClientRequest(GET_METHOD);
+    METADATA_CHECK (stats.responses < 1);
+    METADATA_CHECK (proxy->active_requests() != 0);
+    EXPECT_EQ(idle, proxy->idle_connections());
+
+    SendHttpClientRequest(GET_METHOD);
+    METADATA_CHECK ((stats.connections + stats.connection_reuses) < 2);
+    METADATA_CHECK (proxy->active_requests() != 0);
+    EXPECT_EQ(2U, stats.requests);
+    EXPECT_EQ(2U, stats.connections);
+    EXPECT_EQ(0U, stats.connection_reuses);
+    EXPECT_EQ(idle, proxy->idle_connections());
+    set_close_delimited(false);
+
+    Agent::GetInstance()->set_interface_table(intf_table);
+    client->Reset();
+    StopHttpClient();
+    DeleteVmportEnv(input, 1, 1, 0);
+    client->WaitForIdle();
+
+    ClearLinkLocalConfig();
+    StopNovaApiProxy();
+    client->WaitForIdle();
+
+    proxy->ClearStats();
+}
+
+// Chunked response from nova ends with the last chunk, even when it is
+// received across messages along with chunk extensions and trailers
+TEST_F(MetadataTest, MetadataChunkedResponseTest) {
+    int count = 0;
+    MetadataProxy::MetadataStats stats;
+    MetadataProxy *proxy = Agent::GetInstance()->services()->metadataproxy();
+    struct PortInfo input[] = {
+        {"vnet1", 1, vm1_ip, "00:00:00:01:01:01", 1, 1},
+    };
+
+    StartNovaApiProxy();
+    SetupLinkLocalConfig();
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+
+    StartHttpClient();
+
+    InterfaceTable *intf_table = Agent::GetInstance()->interface_table();
+    std::auto_ptr<InterfaceTable> interface_table(new TestInterfaceTable());
+    Agent::GetInstance()->set_interface_table(interface_table.get());
+
+    set_chunked(true);
+    SendHttpClientRequest(GET_METHOD);
+    METADATA_CHECK (stats.responses < 1);
+    METADATA_CHECK (proxy->active_requests() != 0);
+    EXPECT_EQ(1U, stats.requests);
+    EXPECT_EQ(0U, proxy->active_requests());
+
+    // Next request is relayed once the chunked response is complete
+    SendHttpClientRequest(GET_METHOD);
+    METADATA_CHECK (stats.requests < 2);
+    METADATA_CHECK (proxy->active_requests() != 0);
+    EXPECT_EQ(0U, proxy->active_requests());
+    EXPECT_EQ(0U, proxy->pending_requests());
+    set_chunked(false);
+
+    Agent::GetInstance()->set_interface_table(intf_table);
+    client->Reset();
+    StopHttpClient();
+    DeleteVmportEnv(input, 1, 1, 0);
+    client->WaitForIdle();
+
+    ClearLinkLocalConfig();
+    StopNovaApiProxy();
+    client->WaitForIdle();
+
+    proxy->ClearStats();
+}
+
 void RouterIdDepInit(Agent *agent) {
 }
 
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2026 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "base/os.h"
+#include "testing/gunit.h"
+
+#include <boost/bind.hpp>
+#include <tbb/atomic.h>
+#include <base/logging.h>
+#include <io/event_manager.h>
+#include <cmn/agent_cmn.h>
+#include <pkt/pkt_handler.h>
+#include <services/timer_wheel.h>
+#include <test/test_cmn_util.h>
+
+void RouterIdDepInit(Agent *agent) {
+}
+
+// Wheel is run on a clock controlled by the test. Ticks are advanced by the
+// test and the wheel is run for them, as the timer of the wheel would
+class TimerWheelTest : public ::testing::Test {
+public:
+    static const uint64_t kWheelSpan =
+        (1ULL << (TimerWheel::kSlotBits * TimerWheel::kLevels));
+
+    TimerWheelTest() : wheel_(NULL), tick_done_count_(0) {
+        now_usec_ = 1000000;
+    }
+
+    virtual void SetUp() {
+        Agent *agent = Agent::GetInstance();
+        wheel_ = new TimerWheel(*(agent->event_manager()->io_service()),
+                                "Test timer wheel",
+                                agent->task_scheduler()->
+                                GetTaskId("Agent::Services"),
+                                PktHandler::ARP);
+        wheel_->set_clock(boost::bind(&TimerWheelTest::NowUsec, this));
+        wheel_->set_tick_done_cb(boost::bind(&TimerWheelTest::TickDone,
+                                             this));
+        tick_ = 0;
+    }
+
+    virtual void TearDown() {
+        delete wheel_;
+        wheel_ = NULL;
+    }
+
+    uint64_t NowUsec() {
+        return now_usec_;
+    }
+
+    void TickDone() {
+        tick_done_count_++;
+    }
+
+    // Advance clock by ticks and run the wheel once for all of them
+    void Advance(uint64_t ticks) {
+        now_usec_ += ticks * wheel_->tick_msec() * 1000;
+        tick_ += ticks;
+        wheel_->TimerRun();
+    }
+
+    // Advance clock a tick at a time, running the wheel on every tick
+    void Step(uint64_t ticks) {
+        for (uint64_t i = 0; i < ticks; i++) {
+            Advance(1);
+        }
+    }
+
+    uint32_t TickTime(uint64_t ticks) const {
+        return ticks * wheel_->tick_msec();
+    }
+
+    // Handler recording the tick at which the timer expired
+    bool Expired(uint32_t id, bool restart) {
+        fired_[id].push_back(tick_);
+        return restart;
+    }
+
+    TimerWheel *wheel_;
+    tbb::atomic<uint64_t> now_usec_;
+    // Ticks elapsed since start of test
+    uint64_t tick_;
+    uint32_t tick_done_count_;
+    std::map<uint32_t, std::vector<uint64_t> > fired_;
+};
+
+// Timer expiry is rounded up to start of tick after the timeout, so a timer
+// of n ticks started at start of a tick expires n + 1 ticks later
+TEST_F(TimerWheelTest, Cascade) {
+    const uint64_t ticks[] = {
+        5,
+        TimerWheel::kSlots + 7,
+        TimerWheel::kSlots * TimerWheel::kSlots + 9,
+        TimerWheel::kSlots * TimerWheel::kSlots * TimerWheel::kSlots + 11,
+    };
+    const uint32_t count = sizeof(ticks) / sizeof(ticks[0]);
+
+    std::vector<WheelTimer *> timers;
+    for (uint32_t i = 0; i < count; i++) {
+        WheelTimer *timer = new WheelTimer(wheel_);
+        timer->Start(TickTime(ticks[i]),
+                     boost::bind(&TimerWheelTest::Expired, this, i, false));
+        timers.push_back(timer);
+    }
+    EXPECT_EQ(count, wheel_->size());
+
+    // Timers of higher levels are cascaded down to level 0 and expire on
+    // their tick
+    Step(ticks[count - 1] + 1);
+    for (uint32_t i = 0; i < count; i++) {
+        ASSERT_EQ(1U, fired_[i].size());
+        EXPECT_EQ(ticks[i] + 1, fired_[i][0]);
+        EXPECT_FALSE(timers[i]->running());
+        delete timers[i];
+    }
+    EXPECT_EQ(0U, wheel_->size());
+}
+
+// Timeout beyond span of the wheel is parked in the top level and is
+// re-inserted on cascade until it is within the span of the wheel
+TEST_F(TimerWheelTest, LongTimeout) {
+    const uint64_t ticks = kWheelSpan + 100;
+    WheelTimer timer(wheel_);
+    timer.Start(TickTime(ticks),
+                boost::bind(&TimerWheelTest::Expired, this, 0, true));
+
+    Advance(ticks);
+    EXPECT_EQ(0U, fired_[0].size());
+    Advance(1);
+    ASSERT_EQ(1U, fired_[0].size());
+    EXPECT_EQ(ticks + 1, fired_[0][0]);
+
+    // Handler returned true, timer is re-armed with same timeout
+    EXPECT_TRUE(timer.running());
+    Advance(ticks);
+    EXPECT_EQ(1U, fired_[0].size());
+    Advance(1);
+    ASSERT_EQ(2U, fired_[0].size());
+    EXPECT_EQ(2 * (ticks + 1), fired_[0][1]);
+
+    EXPECT_TRUE(timer.Cancel());
+    EXPECT_EQ(0U, wheel_->size());
+}
+
+// Handler of a timer cancelling, starting and rescheduling timers
+class TimerOps {
+public:
+    TimerOps(TimerWheelTest *test, WheelTimer *self, WheelTimer *cancel,
+             WheelTimer *start, uint32_t start_time, uint32_t reschedule) :
+        test_(test), self_(self), cancel_(cancel), start_(start),
+        start_time_(start_time), reschedule_(reschedule) {
+    }
+
+    bool Expired() {
+        test_->Expired(0, false);
+        EXPECT_TRUE(cancel_->Cancel());
+        EXPECT_TRUE(start_->Start(start_time_,
+                    boost::bind(&TimerWheelTest::Expired, test_, 2, false)));
+        EXPECT_TRUE(self_->Reschedule(reschedule_));
+        return true;
+    }
+
+private:
+    TimerWheelTest *test_;
+    WheelTimer *self_;
+    WheelTimer *cancel_;
+    WheelTimer *start_;
+    uint32_t start_time_;
+    uint32_t reschedule_;
+};
+
+TEST_F(TimerWheelTest, HandlerTimerOps) {
+    WheelTimer timer(wheel_);
+    WheelTimer cancel(wheel_);
+    WheelTimer start(wheel_);
+    TimerOps ops(this, &timer, &cancel, &start, TickTime(3), TickTime(20));
+
+    // Timer to be cancelled expires in the same tick, after the timer
+    // cancelling it
+    timer.Start(TickTime(5), boost::bind(&TimerOps::Expired, &ops));
+    cancel.Start(TickTime(5),
+                 boost::bind(&TimerWheelTest::Expired, this, 1, false));
+    // Reschedule is allowed only from the handler of the timer
+    EXPECT_FALSE(timer.Reschedule(TickTime(1)));
+
+    Step(6);
+    ASSERT_EQ(1U, fired_[0].size());
+    EXPECT_EQ(6U, fired_[0][0]);
+    EXPECT_EQ(0U, fired_[1].size());
+    EXPECT_FALSE(cancel.running());
+    EXPECT_TRUE(start.running());
+    EXPECT_TRUE(timer.running());
+    EXPECT_EQ(TickTime(20), timer.time());
+
+    // Timer started from handler expires on its own timeout
+    Step(4);
+    ASSERT_EQ(1U, fired_[2].size());
+    EXPECT_EQ(10U, fired_[2][0]);
+
+    // Timer restarted with rescheduled time
+    Step(17);
+    ASSERT_EQ(2U, fired_[0].size());
+    EXPECT_EQ(27U, fired_[0][1]);
+    EXPECT_EQ(0U, fired_[1].size());
+
+    timer.Cancel();
+    start.Cancel();
+    EXPECT_EQ(0U, wheel_->size());
+}
+
+// Handler deleting its own timer
+class TimerDelete {
+public:
+    TimerDelete(TimerWheelTest *test, WheelTimer *timer) :
+        test_(test), timer_(timer) {
+    }
+
+    bool Expired() {
+        test_->Expired(0, false);
+        delete timer_;
+        timer_ = NULL;
+        return true;
+    }
+
+private:
+    TimerWheelTest *test_;
+    WheelTimer *timer_;
+};
+
+TEST_F(TimerWheelTest, DeleteInHandler) {
+    WheelTimer *timer = new WheelTimer(wheel_);
+    WheelTimer other(wheel_);
+    TimerDelete del(this, timer);
+
+    timer->Start(TickTime(5), boost::bind(&TimerDelete::Expired, &del));
+    other.Start(TickTime(5),
+                boost::bind(&TimerWheelTest::Expired, this, 1, false));
+
+    // Timer is not restarted though handler returned true, and other
+    // timers of the tick are run
+    Step(6);
+    EXPECT_EQ(1U, fired_[0].size());
+    EXPECT_EQ(1U, fired_[1].size());
+    EXPECT_EQ(0U, wheel_->size());
+
+    Step(10);
+    EXPECT_EQ(1U, fired_[0].size());
+}
+
+// tick_done callback is invoked once for all the timers expiring in a tick,
+// and not for ticks without expiry
+TEST_F(TimerWheelTest, TickDone) {
+    std::vector<WheelTimer *> timers;
+    for (uint32_t i = 0; i < 10; i++) {
+        WheelTimer *timer = new WheelTimer(wheel_);
+        timer->Start(TickTime(5),
+                     boost::bind(&TimerWheelTest::Expired, this, 0, false));
+        timers.push_back(timer);
+    }
+    for (uint32_t i = 0; i < 5; i++) {
+        WheelTimer *timer = new WheelTimer(wheel_);
+        timer->Start(TickTime(TimerWheel::kSlots + 3),
+                     boost::bind(&TimerWheelTest::Expired, this, 1, false));
+        timers.push_back(timer);
+    }
+
+    Step(5);
+    EXPECT_EQ(0U, tick_done_count_);
+    Step(1);
+    EXPECT_EQ(10U, fired_[0].size());
+    EXPECT_EQ(1U, tick_done_count_);
+    EXPECT_EQ(10U, wheel_->max_batch());
+
+    Step(TimerWheel::kSlots);
+    EXPECT_EQ(5U, fired_[1].size());
+    EXPECT_EQ(2U, tick_done_count_);
+    EXPECT_EQ(15U, wheel_->expired());
+    EXPECT_EQ(0U, wheel_->size());
+
+    for (uint32_t i = 0; i < timers.size(); i++) {
+        delete timers[i];
+    }
+}
+
+int main(int argc, char *argv[]) {
+    GETUSERARGS();
+
+    client = TestInit(init_file, ksync_init, true, true);
+    client->WaitForIdle();
+
+    int ret = RUN_ALL_TESTS();
+    client->WaitForIdle();
+    TestShutdown();
+    delete client;
+    return ret;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include "base/logging.h"
+#include "base/time_util.h"
+#include "base/timer.h"
+#include "services/timer_wheel.h"
+
+WheelTimer::WheelTimer(TimerWheel *wheel) :
+    wheel_(wheel), time_(0), expiry_tick_(0) {
+    wheel_->Register(this);
+}
+
+WheelTimer::~WheelTimer() {
+    if (wheel_) {
+        wheel_->Unregister(this);
+    }
+}
+
+// Start of a running timer is ignored, same as Timer
+bool WheelTimer::Start(uint32_t time, Handler handler) {
+    if (wheel_ == NULL)
+        return false;
+
+    tbb::recursive_mutex::scoped_lock lock(wheel_->mutex_);
+    if (hook_.is_linked())
+        return true;
+
+    time_ = time;
+    handler_ = handler;
+    wheel_->Add(this);
+    return true;
+}
+
+bool WheelTimer::Cancel() {
+    if (wheel_ == NULL)
+        return false;
+
+    tbb::recursive_mutex::scoped_lock lock(wheel_->mutex_);
+    if (hook_.is_linked() == false)
+        return false;
+    wheel_->Remove(this);
+    return true;
+}
+
+bool WheelTimer::Fire() {
+    if (wheel_ == NULL)
+        return false;
+
+    tbb::recursive_mutex::scoped_lock lock(wheel_->mutex_);
+    if (hook_.is_linked() == false)
+        return false;
+    wheel_->Remove(this);
+    wheel_->RunTimer(this);
+    return true;
+}
+
+bool WheelTimer::Reschedule(uint32_t time) {
+    if (wheel_ == NULL)
+        return false;
+
+    tbb::recursive_mutex::scoped_lock lock(wheel_->mutex_);
+    if (wheel_->running_timer_ != this)
+        return false;
+    time_ = time;
+    return true;
+}
+
+bool WheelTimer::running() const {
+    return hook_.is_linked();
+}
+
+TimerWheel::TimerWheel(boost::asio::io_service &io, const std::string &name,
+                       int task_id, int task_instance, uint32_t tick_msec) :
+    timer_(TimerManager::CreateTimer(io, name, task_id, task_instance)),
+    tick_msec_(tick_msec ? tick_msec : kTickMsec),
+    start_usec_(ClockMonotonicUsec()), tick_(0), scheduled_tick_(0),
+    in_run_(false), running_timer_(NULL), size_(0), wakeups_(0),
+    expired_count_(0), max_batch_(0) {
+    tick_ = CurrentTick();
+}
+
+TimerWheel::~TimerWheel() {
+    timer_->Cancel();
+    TimerManager::DeleteTimer(timer_);
+
+    // Entries owning the timers may be freed after the wheel, detach them
+    tbb::recursive_mutex::scoped_lock lock(mutex_);
+    while (registry_.empty() == false) {
+        WheelTimer *timer = &registry_.front();
+        registry_.pop_front();
+        if (timer->hook_.is_linked())
+            timer->hook_.unlink();
+        timer->wheel_ = NULL;
+    }
+    size_ = 0;
+}
+
+void TimerWheel::Register(WheelTimer *timer) {
+    tbb::recursive_mutex::scoped_lock lock(mutex_);
+    registry_.push_back(*timer);
+}
+
+void TimerWheel::Unregister(WheelTimer *timer) {
+    tbb::recursive_mutex::scoped_lock lock(mutex_);
+    if (timer->hook_.is_linked())
+        Remove(timer);
+    registry_.erase(registry_.iterator_to(*timer));
+    if (running_timer_ == timer)
+        running_timer_ = NULL;
+}
+
+void TimerWheel::set_clock(ClockFn clock) {
+    tbb::recursive_mutex::scoped_lock lock(mutex_);
+    assert(size_ == 0);
+    clock_ = clock;
+    start_usec_ = NowUsec();
+    tick_ = CurrentTick();
+}
+
+uint64_t TimerWheel::NowUsec() const {
+    if (clock_.empty())
+        return ClockMonotonicUsec();
+    return clock_();
+}
+
+// Ticks start from 1, so that 0 can be used for timer not scheduled
+uint64_t TimerWheel::CurrentTick() const {
+    return ((NowUsec() - start_usec_) / (tick_msec_ * 1000)) + 1;
+}
+
+// Delay in msec to the start of tick
+uint32_t TimerWheel::TickDelay(uint64_t tick) const {
+    uint64_t tick_usec = start_usec_ + ((tick - 1) * tick_msec_ * 1000);
+    uint64_t now = NowUsec();
+    if (tick_usec <= now)
+        return 1;
+    return (uint32_t)(((tick_usec - now) + 999) / 1000);
+}
+
+// Link the timer in slot for its expiry tick. Returns tick at which the
+// wheel needs to run for the timer, either its expiry or cascade of slot.
+// Expiry beyond the span of the wheel is kept in the timer, the timer is
+// linked in the farthest slot and is inserted again when that slot cascades
+uint64_t TimerWheel::Insert(WheelTimer *timer) {
+    uint64_t tick = timer->expiry_tick_;
+    uint64_t delta = tick - tick_;
+    if (delta >= (1ULL << (kSlotBits * kLevels))) {
+        tick = tick_ + (1ULL << (kSlotBits * kLevels)) - 1;
+        delta = tick - tick_;
+    }
+
+    uint32_t level = 0;
+    while (level < (kLevels - 1) &&
+           delta >= (1ULL << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+
+    uint32_t shift = kSlotBits * level;
+    uint32_t index = (tick >> shift) & kSlotMask;
+    slots_[level][index].push_back(*timer);
+    return ((tick >> shift) << shift);
+}
+
+void TimerWheel::Add(WheelTimer *timer) {
+    if (size_ == 0 && in_run_ == false) {
+        // Wheel was idle, skip the ticks without timers
+        tick_ = std::max(tick_, CurrentTick());
+    }
+
+    // Current tick is partly elapsed, round up to start of tick after the
+    // timeout so that timer never expires early
+    uint64_t ticks = (timer->time_ + tick_msec_ - 1) / tick_msec_;
+    timer->expiry_tick_ = std::max(CurrentTick() + ticks + 1, tick_);
+    size_++;
+    uint64_t run_tick = std::max(Insert(timer), tick_);
+
+    // Run of wheel reschedules the timer at the end
+    if (in_run_ == false)
+        ScheduleAt(run_tick);
+}
+
+void TimerWheel::Remove(WheelTimer *timer) {
+    timer->hook_.unlink();
+    size_--;
+    if (size_ == 0 && in_run_ == false && scheduled_tick_) {
+        timer_->Cancel();
+        scheduled_tick_ = 0;
+    }
+}
+
+void TimerWheel::ScheduleAt(uint64_t tick) {
+    if (scheduled_tick_ && scheduled_tick_ <= tick)
+        return;
+
+    // Start fails if run of wheel is already triggered, which will
+    // reschedule the timer anyway
+    if (timer_->running())
+        timer_->Cancel();
+    scheduled_tick_ = tick;
+    timer_->Start(TickDelay(tick), boost::bind(&TimerWheel::TimerRun, this));
+}
+
+// Move timers of slot in level to lower levels, returns index of the slot
+uint32_t TimerWheel::Cascade(uint32_t level) {
+    uint32_t index = (tick_ >> (kSlotBits * level)) & kSlotMask;
+    TimerList list;
+    list.splice(list.end(), slots_[level][index]);
+    while (list.empty() == false) {
+        WheelTimer *timer = &list.front();
+        list.pop_front();
+        Insert(timer);
+    }
+    return index;
+}
+
+// Next tick at which wheel has to run, either for a non-empty slot in level
+// 0 or for cascade of higher levels. Returns 0 if wheel is empty
+uint64_t TimerWheel::NextTick() const {
+    if (size_ == 0)
+        return 0;
+
+    for (uint64_t tick = tick_; tick < tick_ + kSlots; tick++) {
+        uint32_t index = tick & kSlotMask;
+        if (index == 0 || slots_[0][index].empty() == false)
+            return tick;
+    }
+    return tick_ + kSlots;
+}
+
+// Handler is moved out of the timer while it runs, so that it can delete
+// or restart the timer.
+void TimerWheel::RunTimer(WheelTimer *timer) {
+    WheelTimer::Handler handler;
+    handler.swap(timer->handler_);
+    WheelTimer *prev_running = running_timer_;
+    running_timer_ = timer;
+    bool restart = handler.empty() ? false : handler();
+    bool deleted = (running_timer_ != timer);
+    running_timer_ = prev_running;
+    if (deleted || timer->hook_.is_linked())
+        return;
+
+    timer->handler_.swap(handler);
+    if (restart)
+        Add(timer);
+}
+
+bool TimerWheel::TimerRun() {
+    tbb::recursive_mutex::scoped_lock lock(mutex_);
+    wakeups_++;
+    scheduled_tick_ = 0;
+    in_run_ = true;
+
+    uint64_t now = CurrentTick();
+    while (tick_ <= now && size_ != 0) {
+        uint32_t index = tick_ & kSlotMask;
+        if (index == 0) {
+            for (uint32_t level = 1; level < kLevels; level++) {
+                if (Cascade(level) != 0)
+                    break;
+            }
+        }
+        expired_list_.splice(expired_list_.end(), slots_[0][index]);
+        tick_++;
+    }
+    if (tick_ <= now)
+        tick_ = now + 1;
+
+    uint32_t batch = 0;
+    while (expired_list_.empty() == false) {
+        WheelTimer *timer = &expired_list_.front();
+        expired_list_.pop_front();
+        size_--;
+        batch++;
+        RunTimer(timer);
+    }
+    expired_count_ += batch;
+    max_batch_ = std::max(max_batch_, batch);
+    if (batch && tick_done_cb_.empty() == false)
+        tick_done_cb_();
+    in_run_ = false;
+
+    uint64_t next = NextTick();
+    if (next == 0)
+        return false;
+    scheduled_tick_ = next;
+    timer_->Reschedule(TickDelay(next));
+    return true;
+}
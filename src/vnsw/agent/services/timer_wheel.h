@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_timer_wheel_hpp
+#define vnsw_agent_timer_wheel_hpp
+
+#include <boost/asio/io_service.hpp>
+#include <boost/function.hpp>
+#include <boost/intrusive/list.hpp>
+#include <tbb/recursive_mutex.h>
+#include "base/util.h"
+
+class Timer;
+class TimerWheel;
+
+// Timer of a services protocol entry (ARP, NDP ...). Semantics follow the
+// base Timer, handler returning true restarts the timer with same time.
+// Unlike Timer it does not own an asio timer, it is linked in a slot of the
+// TimerWheel of its protocol.
+class WheelTimer {
+public:
+    typedef boost::function<bool(void)> Handler;
+    typedef boost::intrusive::list_member_hook<
+        boost::intrusive::link_mode<boost::intrusive::auto_unlink> > Hook;
+    typedef boost::intrusive::list_member_hook<> RegistryHook;
+
+    explicit WheelTimer(TimerWheel *wheel);
+    ~WheelTimer();
+
+    // time in milli seconds
+    bool Start(uint32_t time, Handler handler);
+    bool Cancel();
+    // Run the handler of a running timer right away. Only for tests
+    bool Fire();
+    // Change time of the timer from its handler, handler returns true to
+    // restart the timer with new time
+    bool Reschedule(uint32_t time);
+    bool running() const;
+    uint32_t time() const { return time_; }
+
+private:
+    friend class TimerWheel;
+    // Link in slot or expired list of the wheel
+    Hook hook_;
+    // Link in list of all timers of the wheel
+    RegistryHook registry_hook_;
+    TimerWheel *wheel_;
+    Handler handler_;
+    uint32_t time_;
+    uint64_t expiry_tick_;
+    DISALLOW_COPY_AND_ASSIGN(WheelTimer);
+};
+
+// Hierarchical timer wheel shared by all entries of a services protocol.
+// Entries of a protocol run thousands of retry/aging timers with few
+// distinct timeouts, so instead of an asio timer per entry timers are kept
+// in kLevels wheels of kSlots slots each. Level 0 slot is one tick, level n
+// slot spans kSlots^n ticks and is cascaded to lower level when the wheel
+// reaches it.
+//
+// A single Timer runs the wheel in context of task_id/task_instance of the
+// protocol, so handlers run in the same context as per entry timers did.
+// All timers expiring in a tick are run in one wakeup, tick_done callback
+// is invoked after the batch so that the protocol can send them together.
+// Timer is not scheduled while wheel is empty and skips ticks with empty
+// slots, so idle or long lived timers do not cause periodic wakeups.
+class TimerWheel {
+public:
+    typedef boost::function<void(void)> TickDoneCb;
+    typedef boost::function<uint64_t(void)> ClockFn;
+    typedef boost::intrusive::list<WheelTimer,
+        boost::intrusive::member_hook<WheelTimer, WheelTimer::Hook,
+                                      &WheelTimer::hook_>,
+        boost::intrusive::constant_time_size<false> > TimerList;
+    typedef boost::intrusive::list<WheelTimer,
+        boost::intrusive::member_hook<WheelTimer, WheelTimer::RegistryHook,
+                                      &WheelTimer::registry_hook_> >
+        TimerRegistry;
+
+    static const uint32_t kTickMsec = 10;
+    static const uint32_t kSlotBits = 6;
+    static const uint32_t kSlots = (1 << kSlotBits);
+    static const uint32_t kSlotMask = (kSlots - 1);
+    // 64^4 ticks of 10 msec covers ~46 hours. Longer timers are parked in
+    // the last slot of top level and re-inserted on its cascade until their
+    // expiry is within the span of the wheel
+    static const uint32_t kLevels = 4;
+
+    TimerWheel(boost::asio::io_service &io, const std::string &name,
+               int task_id, int task_instance,
+               uint32_t tick_msec = kTickMsec);
+    ~TimerWheel();
+
+    void set_tick_done_cb(TickDoneCb cb) { tick_done_cb_ = cb; }
+    uint32_t tick_msec() const { return tick_msec_; }
+    uint32_t size() const { return size_; }
+    uint64_t wakeups() const { return wakeups_; }
+    uint64_t expired() const { return expired_count_; }
+    uint32_t max_batch() const { return max_batch_; }
+    // Clock of the wheel in usec, to be set while wheel is empty. For
+    // testing only
+    void set_clock(ClockFn clock);
+
+private:
+    friend class WheelTimer;
+    friend class TimerWheelTest;
+    void Register(WheelTimer *timer);
+    void Unregister(WheelTimer *timer);
+    void Add(WheelTimer *timer);
+    void Remove(WheelTimer *timer);
+    uint64_t Insert(WheelTimer *timer);
+    uint32_t Cascade(uint32_t level);
+    void RunTimer(WheelTimer *timer);
+    uint64_t NowUsec() const;
+    uint64_t CurrentTick() const;
+    uint64_t NextTick() const;
+    uint32_t TickDelay(uint64_t tick) const;
+    void ScheduleAt(uint64_t tick);
+    bool TimerRun();
+
+    tbb::recursive_mutex mutex_;
+    Timer *timer_;
+    uint32_t tick_msec_;
+    uint64_t start_usec_;
+    // Next tick to be processed by the wheel
+    uint64_t tick_;
+    // Tick for which timer_ is scheduled, 0 if not scheduled
+    uint64_t scheduled_tick_;
+    bool in_run_;
+    TimerList slots_[kLevels][kSlots];
+    // Timers expired in current tick and yet to be run
+    TimerList expired_list_;
+    TimerRegistry registry_;
+    // Timer whose handler is being run, reset if timer is deleted by handler
+    WheelTimer *running_timer_;
+    uint32_t size_;
+    uint64_t wakeups_;
+    uint64_t expired_count_;
+    uint32_t max_batch_;
+    TickDoneCb tick_done_cb_;
+    ClockFn clock_;
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+#endif // vnsw_agent_timer_wheel_hpp
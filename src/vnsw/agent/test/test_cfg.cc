@@ -12,6 +12,8 @@
 
 #include "base/logging.h"
 #include "base/task.h"
+#include "base/test/task_test_util.h"
+#include "base/time_util.h"
 #include "base/util.h"
 #include "db/db.h"
 #include "db/db_graph.h"
@@ -2360,6 +2362,60 @@ TEST_F(CfgTest, AssymetricLinkSeqTest) {
     delete cl;
 }
 
+static int GetReplayNodeCount() {
+    char *str = getenv("TEST_CFG_REPLAY_NODE_COUNT");
+    return str ? strtoul(str, NULL, 0) : 10000;
+}
+
+// Replay a startup config download, i.e. a single large update with nodes
+// and the links between them, and report the parse rate.
+TEST_F(CfgTest, StartupReplay) {
+    const int kNodeCount = GetReplayNodeCount();
+
+    ostringstream download;
+    download << "<config>\n<update>\n";
+    for (int idx = 0; idx < kNodeCount; ++idx) {
+        download << "<node type=\"foo\"><name>foo" << idx
+                 << "</name></node>\n";
+        download << "<node type=\"bar\"><name>bar" << idx
+                 << "</name></node>\n";
+        download << "<link><node type=\"foo\"><name>foo" << idx
+                 << "</name></node><node type=\"bar\"><name>bar" << idx
+                 << "</name></node></link>\n";
+    }
+    download << "</update>\n</config>\n";
+    string content = download.str();
+
+    uint64_t start = UTCTimestampUsec();
+    pugi::xml_parse_result result = xdoc_.load(content.c_str());
+    EXPECT_TRUE(result);
+    parser_->ConfigParse(xdoc_.first_child(), 0);
+    uint64_t parse_usec = UTCTimestampUsec() - start;
+
+    EXPECT_EQ(2 * kNodeCount, parser_->node_updates());
+    EXPECT_EQ(kNodeCount, parser_->link_updates());
+    EXPECT_EQ(0, parser_->node_update_parse_errors());
+    EXPECT_EQ(0, parser_->link_update_parse_errors());
+
+    // Replay is complete once all the nodes and links are in the tables
+    IFMapTable *ftable = IFMapTable::FindTable(&db_, "foo");
+    ASSERT_TRUE(ftable != NULL);
+    IFMapTable *btable = IFMapTable::FindTable(&db_, "bar");
+    ASSERT_TRUE(btable != NULL);
+    IFMapLinkTable *ltable = static_cast<IFMapLinkTable *>(
+        db_.FindTable(IFMAP_AGENT_LINK_DB_NAME));
+    ASSERT_TRUE(ltable != NULL);
+    TASK_UTIL_EXPECT_EQ(kNodeCount, ftable->Size());
+    TASK_UTIL_EXPECT_EQ(kNodeCount, btable->Size());
+    TASK_UTIL_EXPECT_EQ(kNodeCount, ltable->Size());
+
+    uint64_t objects = 3 * kNodeCount;
+    cout << "Startup replay: " << objects << " objects (" << content.size()
+         << " bytes) parsed in " << parse_usec / 1000 << " msec, "
+         << (parse_usec ? objects * 1000000 / parse_usec : objects)
+         << " objects/sec" << endl;
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
@@ -26,7 +26,8 @@ bool InterfaceUveStatsTable::FrameInterfaceObjectLog(UveInterfaceEntry* entry,
 }
 
 bool InterfaceUveStatsTable::FrameInterfaceStatsMsg(UveInterfaceEntry* entry,
-                                                    VMIStats *uve) const {
+                                                    VMIStats *uve) {
+    uint32_t sent = 0, suppressed = 0;
     uint64_t in_band = 0, out_band = 0;
     bool diff_fip_list_non_zero = false;
     VmInterfaceStats if_stats;
@@ -71,10 +72,16 @@ bool InterfaceUveStatsTable::FrameInterfaceStatsMsg(UveInterfaceEntry* entry,
     if (entry->InBandChanged(in_band)) {
         uve->set_in_bw_usage(in_band);
         entry->uve_stats_.set_in_bw_usage(in_band);
+        sent++;
+    } else {
+        suppressed++;
     }
     if (entry->OutBandChanged(out_band)) {
         uve->set_out_bw_usage(out_band);
         entry->uve_stats_.set_out_bw_usage(out_band);
+        sent++;
+    } else {
+        suppressed++;
     }
     s->stats_time = UTCTimestampUsec();
 
@@ -89,19 +96,33 @@ bool InterfaceUveStatsTable::FrameInterfaceStatsMsg(UveInterfaceEntry* entry,
     if (entry->PortBitmapChanged(map)) {
         uve->set_port_bucket_bmap(map);
         entry->uve_stats_.set_port_bucket_bmap(map);
+        sent++;
+    } else {
+        suppressed++;
     }
 
-    FrameFipStatsMsg(vm_intf, agg_fip_list, diff_fip_list,
-                     diff_fip_list_non_zero);
-    if (entry->FipAggStatsChanged(agg_fip_list)) {
-        uve->set_fip_agg_stats(agg_fip_list);
+    /* Floating-ip lists are built only if floating-ips or their stats have
+     * changed since last send */
+    if (entry->FipStatsChanged() ||
+        !entry->uve_stats_.__isset.fip_agg_stats) {
+        entry->FillFloatingIpStats(agg_fip_list, diff_fip_list,
+                                   diff_fip_list_non_zero);
+        entry->fip_stats_changed_ = false;
+        if (entry->FipAggStatsChanged(agg_fip_list)) {
+            uve->set_fip_agg_stats(agg_fip_list);
+            sent++;
+        } else {
+            suppressed++;
+        }
         entry->uve_stats_.set_fip_agg_stats(agg_fip_list);
-    }
-    /* Diff stats need not be sent if the value of the stats is 0.
-     * If any of the entry in diff_fip_list has non-zero stats, then
-     * diff_fip_list_non_zero is expected to be true */
-    if (diff_fip_list_non_zero) {
-        uve->set_fip_diff_stats(diff_fip_list);
+        /* Diff stats need not be sent if the value of the stats is 0.
+         * If any of the entry in diff_fip_list has non-zero stats, then
+         * diff_fip_list_non_zero is expected to be true */
+        if (diff_fip_list_non_zero) {
+            uve->set_fip_diff_stats(diff_fip_list);
+        }
+    } else {
+        suppressed++;
     }
 
     VrouterFlowRate flow_rate;
@@ -118,6 +139,12 @@ bool InterfaceUveStatsTable::FrameInterfaceStatsMsg(UveInterfaceEntry* entry,
     }
     /* Populate TagSet and policy-list in UVE */
     entry->FillTagSetAndPolicyList(uve);
+    if (uve->__isset.policy_rules) {
+        sent++;
+    } else {
+        suppressed++;
+    }
+    UpdateAttributeCounters(sent, suppressed);
 
     return true;
 }
@@ -198,23 +225,6 @@ void InterfaceUveStatsTable::UpdateFloatingIpStats(const FipInfo &fip_info) {
     }
 }
 
-bool InterfaceUveStatsTable::FrameFipStatsMsg(const VmInterface *itf,
-                          vector<VmFloatingIPStats> &fip_list,
-                          vector<VmFloatingIPStats> &diff_list,
-                          bool &diff_list_send) const {
-    bool changed = false;
-    diff_list_send = false;
-    InterfaceMap::const_iterator it = interface_tree_.find(itf->cfg_name());
-
-    if (it != interface_tree_.end()) {
-        UveInterfaceEntry *entry = it->second.get();
-        changed = entry->FillFloatingIpStats(fip_list, diff_list,
-                                             diff_list_send);
-    }
-    return changed;
-}
-
-
 void InterfaceUveStatsTable::UpdatePortBitmap
     (const string &name, uint8_t proto, uint16_t sport, uint16_t dport) {
     tbb::mutex::scoped_lock lock(interface_tree_mutex_);
@@ -250,6 +260,7 @@ void InterfaceUveStatsTable::IncrInterfaceAceStats
     if (intf_it != interface_tree_.end()) {
         UveInterfaceEntry *entry = intf_it->second.get();
         entry->UpdateInterfaceAceStats(req->sg_rule_uuid());
+        MarkChanged(req->interface());
     }
 }
 
@@ -268,6 +279,7 @@ bool InterfaceUveStatsTable::IncrInterfaceEndpointHits(const string &itf,
             return false;
         }
         entry->UpdateInterfaceFwPolicyStats(info);
+        MarkChanged(itf);
         return true;
     }
     return false;
@@ -37,12 +37,8 @@ private:
     void SendInterfaceStatsMsg(UveInterfaceEntry* entry);
     uint64_t GetVmPortBandwidth
         (StatsManager::InterfaceStats *s, bool dir_in) const;
-    bool FrameFipStatsMsg(const VmInterface *vm_intf,
-                          vector<VmFloatingIPStats> &fip_list,
-                          vector<VmFloatingIPStats> &diff_list,
-                          bool &diff_list_send) const;
     bool FrameInterfaceStatsMsg(UveInterfaceEntry* entry,
-                                VMIStats *uve) const;
+                                VMIStats *uve);
 
     DISALLOW_COPY_AND_ASSIGN(InterfaceUveStatsTable);
 };
@@ -11,12 +11,13 @@
 InterfaceUveTable::InterfaceUveTable(Agent *agent, uint32_t default_intvl)
     : agent_(agent), interface_tree_(), interface_tree_mutex_(),
       intf_listener_id_(DBTableBase::kInvalidId),
-      timer_last_visited_(""),
       timer_(TimerManager::CreateTimer
              (*(agent->event_manager())->io_service(),
               "InterfaceUveTimer",
               TaskScheduler::GetInstance()->GetTaskId(kTaskDBExclude), 0)) {
       expiry_time_ = default_intvl;
+      attributes_sent_ = 0;
+      attributes_suppressed_ = 0;
       timer_->Start(expiry_time_,
                     boost::bind(&InterfaceUveTable::TimerExpiry, this));
 }
@@ -24,27 +25,36 @@ InterfaceUveTable::InterfaceUveTable(Agent *agent, uint32_t default_intvl)
 InterfaceUveTable::~InterfaceUveTable() {
 }
 
+/* Only the entries marked in change_set_ are visited. Atmost
+ * 'kUveCountPerTimer' of them are picked in a run, remaining are picked in
+ * subsequent runs at incremental interval */
 bool InterfaceUveTable::TimerExpiry() {
-    InterfaceMap::iterator it = interface_tree_.lower_bound(timer_last_visited_);
-    if (it == interface_tree_.end()) {
-        timer_last_visited_ = "";
-        return true;
+    std::vector<std::string> batch;
+    {
+        tbb::mutex::scoped_lock lock(change_set_mutex_);
+        InterfaceChangeSet::iterator it = change_set_.begin();
+        while (it != change_set_.end() &&
+               batch.size() < AgentUveBase::kUveCountPerTimer) {
+            batch.push_back(*it);
+            change_set_.erase(it++);
+        }
     }
 
-    uint32_t count = 0;
-    while (it != interface_tree_.end() &&
-           count < AgentUveBase::kUveCountPerTimer) {
-        string cfg_name = it->first;
-        UveInterfaceEntry* entry = it->second.get();
-        InterfaceMap::iterator prev = it;
-        it++;
-        count++;
+    std::vector<std::string>::const_iterator it = batch.begin();
+    while (it != batch.end()) {
+        const string &cfg_name = *it;
+        ++it;
+        InterfaceMap::iterator entry_it = interface_tree_.find(cfg_name);
+        if (entry_it == interface_tree_.end()) {
+            continue;
+        }
+        UveInterfaceEntry* entry = entry_it->second.get();
 
         if (entry->deleted_) {
             SendInterfaceDeleteMsg(cfg_name);
             if (!entry->renewed_) {
                 tbb::mutex::scoped_lock lock(interface_tree_mutex_);
-                interface_tree_.erase(prev);
+                interface_tree_.erase(entry_it);
             } else {
                 entry->deleted_ = false;
                 entry->renewed_ = false;
@@ -65,18 +75,31 @@ bool InterfaceUveTable::TimerExpiry() {
         }
     }
 
-
-    if (it == interface_tree_.end()) {
-        timer_last_visited_ = "";
-        set_expiry_time(agent_->uve()->default_interval());
-    } else {
-        timer_last_visited_ = it->first;
+    bool pending;
+    {
+        tbb::mutex::scoped_lock lock(change_set_mutex_);
+        pending = !change_set_.empty();
+    }
+    if (pending) {
         set_expiry_time(agent_->uve()->incremental_interval());
+    } else {
+        set_expiry_time(agent_->uve()->default_interval());
     }
     /* Return true to trigger auto-restart of timer */
     return true;
 }
 
+void InterfaceUveTable::MarkChanged(const string &name) {
+    tbb::mutex::scoped_lock lock(change_set_mutex_);
+    change_set_.insert(name);
+}
+
+void InterfaceUveTable::UpdateAttributeCounters(uint32_t sent,
+                                                uint32_t suppressed) {
+    attributes_sent_ += sent;
+    attributes_suppressed_ += suppressed;
+}
+
 void InterfaceUveTable::set_expiry_time(int time) {
     if (time != expiry_time_) {
         expiry_time_ = time;
@@ -238,6 +261,58 @@ bool InterfaceUveTable::UveInterfaceEntry::FrameInterfaceMsg(const string &name,
     return true;
 }
 
+/* Copy the attribute to delta only if it is different from the value sent
+ * last. Attributes not set in uve are skipped */
+#define INTERFACE_UVE_DELTA(field)                                      \
+    if (uve.__isset.field) {                                            \
+        if (!prev_uve_.__isset.field ||                                 \
+            (prev_uve_.get_##field() != uve.get_##field())) {           \
+            delta->set_##field(uve.get_##field());                      \
+            prev_uve_.set_##field(uve.get_##field());                   \
+            sent++;                                                     \
+        } else {                                                        \
+            (*suppressed)++;                                            \
+        }                                                               \
+    }
+
+/* Build UVE with attributes of uve which changed since last send. Returns
+ * number of attributes in delta, UVE need not be sent if it is 0 */
+uint32_t InterfaceUveTable::UveInterfaceEntry::FrameInterfaceDeltaMsg
+    (const UveVMInterfaceAgent &uve, UveVMInterfaceAgent *delta,
+     uint32_t *suppressed) {
+    uint32_t sent = 0;
+    delta->set_name(uve.get_name());
+    INTERFACE_UVE_DELTA(vm_name);
+    INTERFACE_UVE_DELTA(virtual_network);
+    INTERFACE_UVE_DELTA(vn_uuid);
+    INTERFACE_UVE_DELTA(vm_uuid);
+    INTERFACE_UVE_DELTA(ip_address);
+    INTERFACE_UVE_DELTA(mac_address);
+    INTERFACE_UVE_DELTA(ip6_address);
+    INTERFACE_UVE_DELTA(ip6_active);
+    INTERFACE_UVE_DELTA(is_health_check_active);
+    INTERFACE_UVE_DELTA(tx_vlan);
+    INTERFACE_UVE_DELTA(rx_vlan);
+    INTERFACE_UVE_DELTA(vhostuser_mode);
+    INTERFACE_UVE_DELTA(port_mirror_enabled);
+    INTERFACE_UVE_DELTA(parent_interface);
+    INTERFACE_UVE_DELTA(floating_ips);
+    INTERFACE_UVE_DELTA(health_check_instance_list);
+    INTERFACE_UVE_DELTA(label);
+    INTERFACE_UVE_DELTA(ip4_active);
+    INTERFACE_UVE_DELTA(l2_active);
+    INTERFACE_UVE_DELTA(active);
+    INTERFACE_UVE_DELTA(admin_state);
+    INTERFACE_UVE_DELTA(uuid);
+    INTERFACE_UVE_DELTA(gateway);
+    INTERFACE_UVE_DELTA(fixed_ip4_list);
+    INTERFACE_UVE_DELTA(fixed_ip6_list);
+    INTERFACE_UVE_DELTA(hbf_intf_type);
+    return sent;
+}
+
+#undef INTERFACE_UVE_DELTA
+
 void InterfaceUveTable::UveInterfaceEntry::Reset() {
     intf_ = NULL;
     port_bitmap_.Reset();
@@ -245,8 +320,12 @@ void InterfaceUveTable::UveInterfaceEntry::Reset() {
     fip_tree_.clear();
     ace_set_.clear();
     security_policy_stats_map_.clear();
+    /* Send all attributes if the entry is renewed */
+    prev_uve_ = UveVMInterfaceAgent();
 
     ace_stats_changed_ = false;
+    fip_stats_changed_ = true;
+    policy_rules_changed_ = true;
     deleted_ = true;
     renewed_ = false;
 }
@@ -402,7 +481,14 @@ void InterfaceUveTable::SendInterfaceMsg(const string &name,
                                          UveInterfaceEntry *entry) {
     UveVMInterfaceAgent uve;
     if (entry->FrameInterfaceMsg(name, &uve)) {
-        DispatchInterfaceMsg(uve);
+        UveVMInterfaceAgent delta;
+        uint32_t suppressed = 0;
+        uint32_t sent = entry->FrameInterfaceDeltaMsg(uve, &delta,
+                                                      &suppressed);
+        UpdateAttributeCounters(sent, suppressed);
+        if (sent) {
+            DispatchInterfaceMsg(delta);
+        }
     }
     VMITags tags_uve;
     if (entry->FrameTagsUveMsg(agent_, name, &tags_uve)) {
@@ -424,6 +510,8 @@ void InterfaceUveTable::InterfaceAddHandler(const VmInterface* itf,
 
     /* Mark the entry as changed to account for change in any fields of VMI */
     entry->changed_ = true;
+    entry->fip_stats_changed_ = true;
+    MarkChanged(itf->cfg_name());
 
     const VmInterface::FloatingIpSet &new_list = itf->floating_ip_list().list_;
     /* Remove old entries, by checking entries which are present in old list,
@@ -469,6 +557,7 @@ void InterfaceUveTable::InterfaceDeleteHandler(const string &name) {
      * values since the entry is getting re-used. Also update the 'deleted_'
      * and 'renewed_' flags */
     entry->Reset();
+    MarkChanged(name);
     return;
 }
 
@@ -641,6 +730,31 @@ void InterfaceUveTable::FloatingIp::UpdateFloatingIpStats(const FipInfo &fip_inf
 }
 
 
+/* Stats of a floating-ip can also be updated from flows of other interface
+ * (rev_fip_), so compare with stats sent last instead of tracking updates */
+bool InterfaceUveTable::UveInterfaceEntry::FipStatsChanged() const {
+    if (fip_stats_changed_) {
+        return true;
+    }
+    FloatingIpSet::const_iterator it = fip_tree_.begin();
+    while (it != fip_tree_.end()) {
+        const FloatingIp *fip = (*it).get();
+        FloatingIpSet::const_iterator prev_it = prev_fip_tree_.find(*it);
+        ++it;
+        if (prev_it == prev_fip_tree_.end()) {
+            return true;
+        }
+        const FloatingIp *pfip = (*prev_it).get();
+        if ((fip->in_bytes_ != pfip->in_bytes_) ||
+            (fip->in_packets_ != pfip->in_packets_) ||
+            (fip->out_bytes_ != pfip->out_bytes_) ||
+            (fip->out_packets_ != pfip->out_packets_)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool InterfaceUveTable::UveInterfaceEntry::FillFloatingIpStats
     (vector<VmFloatingIPStats> &result,
      vector<VmFloatingIPStats> &diff_list,
@@ -742,6 +856,7 @@ void InterfaceUveTable::UveInterfaceEntry::AddFloatingIp
         return;
     }
     fip_tree_.insert(key);
+    fip_stats_changed_ = true;
 }
 
 void InterfaceUveTable::UveInterfaceEntry::RemoveFloatingIp
@@ -755,6 +870,7 @@ void InterfaceUveTable::UveInterfaceEntry::RemoveFloatingIp
     if (prev_it != prev_fip_tree_.end()) {
         prev_fip_tree_.erase(prev_it);
     }
+    fip_stats_changed_ = true;
 }
 
 void InterfaceUveTable::UveInterfaceEntry::UpdateInterfaceAceStats
@@ -825,6 +941,7 @@ void InterfaceUveTable::UveInterfaceEntry::UpdateInterfaceFwPolicyStats
         remote_ep_list.insert(ep_key);
         security_policy_stats_map_.insert(SecurityPolicyStatsPair
                                           (info.fw_policy_, cont));
+        policy_rules_changed_ = true;
     }
 }
 
@@ -879,6 +996,7 @@ void InterfaceUveTable::UveInterfaceEntry::UpdateSecurityPolicyStats
         stats_set.insert(stats);
         security_policy_stats_map_.insert(SecurityPolicyStatsPair(info.policy,
                                                                   cont));
+        policy_rules_changed_ = true;
     } else {
         EndpointStatsContainer &cont = it->second;
         SecurityPolicyStatsSet &stats_set = cont.ToList(info.client);
@@ -973,7 +1091,10 @@ void InterfaceUveTable::UveInterfaceEntry::FillSecurityPolicyList
 
 void InterfaceUveTable::UveInterfaceEntry::FillTagSetAndPolicyList
     (VMIStats *obj) {
-
+    /* List of rules changes only when a policy is added */
+    if (!policy_rules_changed_ && uve_stats_.__isset.policy_rules) {
+        return;
+    }
     vector<string> rule_list;
     SecurityPolicyStatsMap::const_iterator it =
         security_policy_stats_map_.begin();
@@ -982,6 +1103,8 @@ void InterfaceUveTable::UveInterfaceEntry::FillTagSetAndPolicyList
         ++it;
     }
     obj->set_policy_rules(rule_list);
+    uve_stats_.set_policy_rules(rule_list);
+    policy_rules_changed_ = false;
 }
 
 void InterfaceUveTable::UveInterfaceEntry::BuildSandeshUveTagList
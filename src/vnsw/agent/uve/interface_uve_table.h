@@ -11,6 +11,7 @@
 #include <map>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <tbb/atomic.h>
 #include <interface_types.h>
 #include <uve/l4_port_bitmap.h>
 #include <oper/vm.h>
@@ -211,7 +212,16 @@ public:
         bool deleted_;
         bool renewed_;
         bool ace_stats_changed_;
+        /* Set when list of floating-ips is modified. fip_agg_stats of
+         * VMIStats is built only when set or when stats of a floating-ip
+         * changed */
+        bool fip_stats_changed_;
+        /* Set when a policy is added to security_policy_stats_map_ */
+        bool policy_rules_changed_;
         VMIStats uve_stats_;
+        /* Attributes of UveVMInterfaceAgent sent last. Only attributes which
+         * differ from it are sent */
+        UveVMInterfaceAgent prev_uve_;
         AceStatsSet ace_set_;
         TagList local_tagset_;
         SecurityPolicyStatsMap security_policy_stats_map_;
@@ -233,7 +243,9 @@ public:
         UveInterfaceEntry(const VmInterface *i) : intf_(i),
             uuid_(i->GetUuid()), port_bitmap_(),
             fip_tree_(), prev_fip_tree_(), changed_(true), deleted_(false),
-            renewed_(false), uve_stats_() { }
+            renewed_(false), ace_stats_changed_(false),
+            fip_stats_changed_(true), policy_rules_changed_(true),
+            uve_stats_(), prev_uve_() { }
         virtual ~UveInterfaceEntry() {}
         void UpdateFloatingIpStats(const FipInfo &fip_info);
         bool FillFloatingIpStats(vector<VmFloatingIPStats> &result,
@@ -250,6 +262,9 @@ public:
                                                 const std::string &vn);
         bool FrameInterfaceMsg(const std::string &name,
                                UveVMInterfaceAgent *s_intf) const;
+        uint32_t FrameInterfaceDeltaMsg(const UveVMInterfaceAgent &uve,
+                                        UveVMInterfaceAgent *delta,
+                                        uint32_t *suppressed);
         bool FrameTagsUveMsg(Agent *agent, const std::string &name,
                              VMITags *uve);
         bool FrameInterfaceAceStatsMsg(const std::string &name,
@@ -257,6 +272,7 @@ public:
         bool GetVmInterfaceGateway(const VmInterface *vm_intf,
                                    std::string &gw) const;
         bool FipAggStatsChanged(const vector<VmFloatingIPStats>  &list) const;
+        bool FipStatsChanged() const;
         bool PortBitmapChanged(const PortBucketBitmap &bmap) const;
         bool InBandChanged(uint64_t in_band) const;
         bool OutBandChanged(uint64_t out_band) const;
@@ -289,6 +305,8 @@ public:
 
     typedef std::map<std::string, UveInterfaceEntryPtr> InterfaceMap;
     typedef std::pair<std::string, UveInterfaceEntryPtr> InterfacePair;
+    // Names of entries to be visited by the UVE timer
+    typedef std::set<std::string> InterfaceChangeSet;
 
     InterfaceUveTable(Agent *agent, uint32_t default_intvl);
     virtual ~InterfaceUveTable();
@@ -303,14 +321,22 @@ public:
                                        UveInterfaceEntry *entry) {
     }
     void HandleVmiTagListChange(const std::string &name);
+    uint64_t attributes_sent() const { return attributes_sent_; }
+    uint64_t attributes_suppressed() const { return attributes_suppressed_; }
 
 protected:
     void SendInterfaceDeleteMsg(const std::string &config_name);
+    void MarkChanged(const std::string &name);
+    void UpdateAttributeCounters(uint32_t sent, uint32_t suppressed);
 
     Agent *agent_;
     InterfaceMap interface_tree_;
     /* For exclusion between kTaskFlowStatsCollector and kTaskDBExclude */
     tbb::mutex interface_tree_mutex_;
+    /* Entries marked by DB notifications (kTaskDBExclude) and ACE stats
+     * updates (kTaskFlowStatsCollector), protected by change_set_mutex_ */
+    InterfaceChangeSet change_set_;
+    tbb::mutex change_set_mutex_;
 private:
     virtual UveInterfaceEntryPtr Allocate(const VmInterface *vm);
     void InterfaceNotify(DBTablePartBase *partition, DBEntryBase *e);
@@ -321,10 +347,11 @@ private:
     void SendInterfaceMsg(const std::string &name, UveInterfaceEntry *entry);
 
     DBTableBase::ListenerId intf_listener_id_;
-    // Last visited Interface by timer
-    std::string timer_last_visited_;
     Timer *timer_;
     int expiry_time_;
+    /* Count of UVE attributes sent and suppressed as unchanged */
+    tbb::atomic<uint64_t> attributes_sent_;
+    tbb::atomic<uint64_t> attributes_suppressed_;
     DISALLOW_COPY_AND_ASSIGN(InterfaceUveTable);
 };
 
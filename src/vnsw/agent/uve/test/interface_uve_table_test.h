@@ -17,6 +17,10 @@ public:
     uint32_t vmi_stats_send_count() const { return vmi_stats_send_count_; }
     uint32_t vmi_stats_delete_count() const { return vmi_stats_delete_count_; }
     uint32_t InterfaceUveCount() const { return interface_tree_.size(); }
+    uint32_t ChangeSetSize() {
+        tbb::mutex::scoped_lock lock(change_set_mutex_);
+        return change_set_.size();
+    }
     void ClearCount();
     L4PortBitmap* GetVmIntfPortBitmap(const VmInterface* intf);
     VMIStats* InterfaceUveObject(const VmInterface *itf);
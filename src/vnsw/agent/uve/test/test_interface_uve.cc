@@ -3,6 +3,8 @@
  */
 
 #include "base/os.h"
+#include <sys/resource.h>
+#include "base/time_util.h"
 #include <cfg/cfg_init.h>
 #include <oper/operdb_init.h>
 #include <controller/controller_init.h>
@@ -1239,6 +1241,96 @@ TEST_F(InterfaceUveTest, PhysicalIntfAddDel_1) {
 TEST_F(InterfaceUveTest, LogicalIntfAddDel_1) {
 }
 
+// Create interfaces and measure time and CPU used by the UVE timer to send
+// UVEs of all interfaces, and by the timer and stats send once interfaces
+// are unchanged. Number of interfaces can be overridden with
+// AGENT_INTERFACE_UVE_BENCH_COUNT.
+TEST_F(InterfaceUveTest, InterfaceUveBench) {
+    uint32_t count = 512;
+    if (getenv("AGENT_INTERFACE_UVE_BENCH_COUNT")) {
+        count = strtoul(getenv("AGENT_INTERFACE_UVE_BENCH_COUNT"), NULL, 0);
+    }
+    InterfaceUveTableTest *vmut = static_cast<InterfaceUveTableTest *>
+        (Agent::GetInstance()->uve()->interface_uve_table());
+    vmut->ClearCount();
+
+    std::vector<struct PortInfo> ports(count);
+    memset(&ports[0], 0, sizeof(struct PortInfo) * count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t host = i + 2;
+        snprintf(ports[i].name, sizeof(ports[i].name), "uvebench%u", i);
+        ports[i].intf_id = 100 + i;
+        snprintf(ports[i].addr, sizeof(ports[i].addr), "21.1.%u.%u",
+                 (host >> 8) & 0xFF, host & 0xFF);
+        snprintf(ports[i].mac, sizeof(ports[i].mac), "00:00:21:01:%02x:%02x",
+                 (host >> 8) & 0xFF, host & 0xFF);
+        ports[i].vn_id = 21;
+        ports[i].vm_id = 100 + i;
+    }
+    CreateVmportEnv(&ports[0], count);
+    client->WaitForIdle();
+    EXPECT_TRUE(vmut->InterfaceUveCount() >= count);
+
+    // Send UVEs of all new interfaces
+    struct rusage r1, r2, r3, r4;
+    uint64_t sent = vmut->attributes_sent();
+    uint64_t suppressed = vmut->attributes_suppressed();
+    uint32_t runs = 0;
+    uint64_t t1 = ClockMonotonicUsec();
+    getrusage(RUSAGE_SELF, &r1);
+    while (vmut->ChangeSetSize() && runs < (count + 1)) {
+        util_.EnqueueSendVmiUveTask();
+        client->WaitForIdle();
+        runs++;
+    }
+    getrusage(RUSAGE_SELF, &r2);
+    uint64_t t2 = ClockMonotonicUsec();
+    EXPECT_EQ(0U, vmut->ChangeSetSize());
+    uint64_t add_sent = vmut->attributes_sent() - sent;
+    uint64_t add_suppressed = vmut->attributes_suppressed() - suppressed;
+
+    // Nothing changed, timer visits no interface and stats send builds
+    // only the attributes that are always sent
+    uint32_t send_count = vmut->send_count();
+    sent = vmut->attributes_sent();
+    suppressed = vmut->attributes_suppressed();
+    uint64_t t3 = ClockMonotonicUsec();
+    getrusage(RUSAGE_SELF, &r3);
+    util_.EnqueueSendVmiUveTask();
+    client->WaitForIdle();
+    vmut->SendInterfaceStats();
+    vmut->SendInterfaceStats();
+    getrusage(RUSAGE_SELF, &r4);
+    uint64_t t4 = ClockMonotonicUsec();
+    EXPECT_EQ(send_count, vmut->send_count());
+    uint64_t idle_sent = vmut->attributes_sent() - sent;
+    uint64_t idle_suppressed = vmut->attributes_suppressed() - suppressed;
+
+    uint64_t add_cpu =
+        ((r2.ru_utime.tv_sec - r1.ru_utime.tv_sec) * 1000000) +
+        (r2.ru_utime.tv_usec - r1.ru_utime.tv_usec);
+    uint64_t idle_cpu =
+        ((r4.ru_utime.tv_sec - r3.ru_utime.tv_sec) * 1000000) +
+        (r4.ru_utime.tv_usec - r3.ru_utime.tv_usec);
+    cout << "Interfaces " << count << " UVE send in " << runs << " runs "
+        << (t2 - t1) << " usec, cpu " << add_cpu << " usec, attributes sent "
+        << add_sent << " suppressed " << add_suppressed << endl;
+    cout << "Unchanged interfaces timer and 2 stats sends " << (t4 - t3)
+        << " usec, cpu " << idle_cpu << " usec, attributes sent "
+        << idle_sent << " suppressed " << idle_suppressed << endl;
+
+    DeleteVmportEnv(&ports[0], count, true);
+    client->WaitForIdle();
+    runs = 0;
+    while (vmut->ChangeSetSize() && runs < (count + 1)) {
+        util_.EnqueueSendVmiUveTask();
+        client->WaitForIdle();
+        runs++;
+    }
+    WAIT_FOR(1000, 500, ((vmut->InterfaceUveCount() == 0U)));
+    vmut->ClearCount();
+}
+
 int main(int argc, char **argv) {
     GETUSERARGS();
     client = TestInit(init_file, ksync_init, true, false, true,
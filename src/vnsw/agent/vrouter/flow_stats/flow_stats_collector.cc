@@ -60,7 +60,10 @@ FlowStatsCollector::FlowStatsCollector(boost::asio::io_service &io, int intvl,
                                    this, _1)),
         flow_aging_key_(*key), instance_id_(instance_id),
         flow_stats_manager_(aging_module), parent_(obj), ageing_task_(NULL),
-        current_time_(GetCurrentTime()), ageing_task_starts_(0) {
+        current_time_(GetCurrentTime()), ageing_task_starts_(0),
+        flows_visited_(0), flows_aged_(0), flows_evicted_(0),
+        ageing_scans_(0), ageing_flows_scanned_(0), ageing_scan_time_(0),
+        scan_start_time_(0), last_scan_time_(0), ageing_scan_overruns_(0) {
         if (flow_cache_timeout) {
             // Convert to usec
             flow_age_time_intvl_ = 1000000L * (uint64_t)flow_cache_timeout;
@@ -121,6 +124,11 @@ uint32_t FlowStatsCollector::TimersPerScan() {
     return scan_time_millisec / kFlowStatsTimerInterval;
 }
 
+// Time in usec within which complete flow-table must be scanned
+uint64_t FlowStatsCollector::ScanDeadline() const {
+    return (uint64_t)timers_per_scan_ * kFlowStatsTimerInterval * 1000;
+}
+
 // Update entries_to_visit_ based on total flows
 // Timer fires every kFlowScanTime. Its possible that we may not have visited
 // all entries by the time next timer fires. So, keep accumulating the number
@@ -715,6 +723,11 @@ uint32_t FlowStatsCollector::ProcessFlow(FlowExportInfoList::iterator &it,
     return count;
 }
 
+static bool FlowExportInfoHandleCmp(const FlowExportInfo *lhs,
+                                    const FlowExportInfo *rhs) {
+    return lhs->flow_handle() < rhs->flow_handle();
+}
+
 uint32_t FlowStatsCollector::RunAgeing(uint32_t max_count) {
     FlowExportInfoList::iterator it;
     if (flow_iteration_key_ == NULL) {
@@ -733,21 +746,54 @@ uint32_t FlowStatsCollector::RunAgeing(uint32_t max_count) {
     KSyncFlowMemory *ksync_obj = agent_uve_->agent()->ksync()->
         ksync_flow_memory();
     uint64_t curr_time = GetCurrentTime();
+    uint64_t start_time = ClockMonotonicUsec();
+    if (scan_start_time_ == 0) {
+        scan_start_time_ = start_time;
+    }
+
+    FlowExportInfo *batch[kFlowsPerBatch];
     uint32_t count = 0;
     while (count < max_count) {
         if (it == flow_export_info_list_.end()) {
             break;
         }
 
-        FlowExportInfo *info = &(*it);
-        it++;
-        flows_visited_++;
-        count += ProcessFlow(it, ksync_obj, info, curr_time);
+        // Pick the next batch and prefetch its flows
+        uint32_t batch_size = 0;
+        while (batch_size < kFlowsPerBatch &&
+               (count + batch_size) < max_count &&
+               it != flow_export_info_list_.end()) {
+            FlowExportInfo *info = &(*it);
+            it++;
+            ksync_obj->PrefetchKFlowEntry(info->flow_handle());
+            __builtin_prefetch(info->flow());
+            batch[batch_size++] = info;
+        }
+        std::sort(batch, batch + batch_size, FlowExportInfoHandleCmp);
+
+        for (uint32_t i = 0; i < batch_size; i++) {
+            FlowExportInfo *info = batch[i];
+            // Skip flow removed from list along with its reverse flow visited
+            // earlier in the batch
+            if (info->is_linked() == false)
+                continue;
+            flows_visited_++;
+            ageing_flows_scanned_++;
+            count += ProcessFlow(it, ksync_obj, info, curr_time);
+        }
     }
 
+    uint64_t end_time = ClockMonotonicUsec();
+    ageing_scan_time_ += end_time - start_time;
+
     // Update iterator for next pass
     if (it == flow_export_info_list_.end()) {
         flow_iteration_key_ = NULL;
+        ageing_scans_++;
+        last_scan_time_ = end_time - scan_start_time_;
+        if (last_scan_time_ > ScanDeadline())
+            ageing_scan_overruns_++;
+        scan_start_time_ = 0;
     } else {
         flow_iteration_key_ = it->flow();
     }
@@ -53,6 +53,11 @@ public:
 // On every visit of flow, check if flow is idle for configured ageing time and
 // delete the idle flows
 //
+// Flows are visited in batches of kFlowsPerBatch. The vrouter flow entries
+// and FlowEntry for a batch are prefetched first, and the batch is visited
+// in the order of flow-handle, so that the vrouter flow-table is read in
+// index order
+//
 // The flow_tree_ maintains flows sorted on flow pointer. This tree cannot be
 // used to scan flows for ageing since entries can be added/deleted between
 // ageing tasks. Alternatively, another list is maintained in the sequence
@@ -73,6 +78,8 @@ public:
     static const uint32_t kMinFlowsPerTimer = 3000;
     // Number of flows to visit per task
     static const uint32_t kFlowsPerTask = 256;
+    // Number of flows prefetched and visited together in a task
+    static const uint32_t kFlowsPerBatch = 32;
 
     // Retry flow-delete after 5 second
     static const uint64_t kFlowDeleteRetryTime = (5 * 1000 * 1000);
@@ -151,6 +158,12 @@ public:
     static uint64_t GetFlowStats(const uint16_t &oflow_data, const uint32_t &data);
     size_t Size() const { return flow_tree_.size(); }
     size_t AgeTreeSize() const { return flow_export_info_list_.size(); }
+    uint64_t ageing_scans() const { return ageing_scans_; }
+    uint64_t ageing_flows_scanned() const { return ageing_flows_scanned_; }
+    uint64_t ageing_scan_time() const { return ageing_scan_time_; }
+    uint64_t last_scan_time() const { return last_scan_time_; }
+    uint64_t ageing_scan_overruns() const { return ageing_scan_overruns_; }
+    uint64_t ScanDeadline() const;
     void NewFlow(FlowEntry *flow);
     void set_deleted(bool val) {
         deleted_ = val;
@@ -263,6 +276,18 @@ private:
     uint32_t flows_visited_;
     uint32_t flows_aged_;
     uint32_t flows_evicted_;
+
+    // Ageing scan statistics
+    // Number of complete scans of flow-table
+    uint64_t ageing_scans_;
+    // Number of flows visited and time spent visiting them in usec
+    uint64_t ageing_flows_scanned_;
+    uint64_t ageing_scan_time_;
+    // Start time of current scan and time taken by last complete scan in usec
+    uint64_t scan_start_time_;
+    uint64_t last_scan_time_;
+    // Number of scans not completed in ScanDeadline()
+    uint64_t ageing_scan_overruns_;
     DISALLOW_COPY_AND_ASSIGN(FlowStatsCollector);
 };
 
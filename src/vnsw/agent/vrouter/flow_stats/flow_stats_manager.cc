@@ -30,11 +30,32 @@
 #include <vrouter/flow_stats/flow_stats_types.h>
 #include <oper/global_vrouter.h>
 #include <init/agent_param.h>
+#include <sandesh/sandesh_client.h>
+#include <sandesh/sandesh_session.h>
 
 SandeshTraceBufferPtr FlowExportStatsTraceBuf(SandeshTraceBufferCreate(
     "FlowExportStats", 3000));
 const uint8_t FlowStatsManager::kCatchAllProto;
 
+size_t FlowStatsManager::SandeshSendQueueLength() {
+    SandeshClient *client = Sandesh::client();
+    if (client == NULL) {
+        return 0;
+    }
+    SandeshSession *session = client->session();
+    if (session == NULL || session->send_queue() == NULL) {
+        return 0;
+    }
+    return session->send_queue()->Length();
+}
+
+size_t FlowStatsManager::SessionExportQueueLength() const {
+    if (export_queue_length_cb_.empty()) {
+        return 0;
+    }
+    return export_queue_length_cb_();
+}
+
 void FlowStatsManager::UpdateThreshold(uint64_t new_value, bool check_oflow) {
     if (check_oflow && new_value < threshold_) {
         /* Retain the same value for threshold if it results in overflow */
@@ -87,7 +108,8 @@ FlowStatsManager::FlowStatsManager(Agent *agent) : agent_(agent),
     session_exports_(), session_export_disable_drops_(),
     session_export_sampling_drops_(), session_export_without_sampling_(),
     session_export_drops_(), session_global_slo_logging_drops_(),
-    session_slo_logging_drops_(),
+    session_slo_logging_drops_(), session_export_backpressure_updates_(0),
+    export_queue_length_cb_(&FlowStatsManager::SandeshSendQueueLength),
     timer_(TimerManager::CreateTimer(*(agent_->event_manager())->io_service(),
            "FlowThresholdTimer",
            TaskScheduler::GetInstance()->GetTaskId("Agent::FlowStatsManager"), 0)),
@@ -439,6 +461,86 @@ void ShowAgingConfig::HandleRequest() const {
     return;
 }
 
+void ShowFlowAgeingScanStats::HandleRequest() const {
+    FlowAgeingScanStatsResponse *resp = new FlowAgeingScanStatsResponse();
+    std::vector<FlowAgeingScanStats> &list =
+        const_cast<std::vector<FlowAgeingScanStats>&>(resp->get_stats_list());
+
+    FlowStatsManager *fam = Agent::GetInstance()->flow_stats_manager();
+    FlowStatsManager::FlowAgingTableMap::const_iterator it = fam->begin();
+    while (it != fam->end()) {
+        for (int i = 0; i < FlowStatsCollectorObject::kMaxCollectors; i++) {
+            const FlowStatsCollector *fsc = it->second->GetCollector(i);
+            FlowAgeingScanStats stats;
+            stats.set_protocol(it->first.proto);
+            stats.set_port(it->first.port);
+            stats.set_instance(fsc->instance_id());
+            stats.set_flow_count(fsc->Size());
+            stats.set_flows_scanned(fsc->ageing_flows_scanned());
+            stats.set_scan_time_usec(fsc->ageing_scan_time());
+            uint64_t rate = 0;
+            if (fsc->ageing_scan_time()) {
+                rate = (fsc->ageing_flows_scanned() * 1000) /
+                    fsc->ageing_scan_time();
+            }
+            stats.set_flows_per_msec(rate);
+            stats.set_scans(fsc->ageing_scans());
+            stats.set_last_scan_msec(fsc->last_scan_time() / 1000);
+            stats.set_scan_deadline_msec(fsc->ScanDeadline() / 1000);
+            stats.set_scan_overruns(fsc->ageing_scan_overruns());
+            list.push_back(stats);
+        }
+        it++;
+    }
+
+    resp->set_context(context());
+    resp->Response();
+    return;
+}
+
+void ShowSessionExportStats::HandleRequest() const {
+    SessionExportStatsResponse *resp = new SessionExportStatsResponse();
+    std::vector<SessionExportCollectorStats> &list =
+        const_cast<std::vector<SessionExportCollectorStats>&>
+        (resp->get_collector_stats());
+
+    FlowStatsManager *fam = Agent::GetInstance()->flow_stats_manager();
+    resp->set_send_queue_length(fam->SessionExportQueueLength());
+    resp->set_send_queue_low_watermark
+        (FlowStatsManager::kSessionExportQueueLowWatermark);
+    resp->set_send_queue_high_watermark
+        (FlowStatsManager::kSessionExportQueueHighWatermark);
+    resp->set_sampling_threshold(fam->threshold());
+    resp->set_export_rate(fam->session_export_rate());
+    resp->set_msg_exports(fam->session_msg_exports());
+    resp->set_sample_exports(fam->session_sample_exports());
+    resp->set_session_exports(fam->session_exports());
+    resp->set_sampling_drops(fam->session_export_sampling_drops());
+    resp->set_disable_drops(fam->session_export_disable_drops());
+    resp->set_export_drops(fam->session_export_drops());
+    resp->set_backpressure_threshold_updates
+        (fam->session_export_backpressure_updates());
+
+    SessionStatsCollectorObject *obj = fam->session_stats_collector_obj();
+    for (int i = 0; obj && i < SessionStatsCollectorObject::kMaxSessionCollectors;
+         i++) {
+        const SessionStatsCollector *ssc = obj->GetCollector(i);
+        SessionExportCollectorStats stats;
+        stats.set_instance(ssc->instance_id());
+        stats.set_session_endpoints(ssc->Size());
+        stats.set_passes(ssc->export_passes());
+        stats.set_last_pass_msec(ssc->last_pass_time() / 1000);
+        stats.set_export_lag_msec(ssc->ExportLag() / 1000);
+        stats.set_backpressure_defers(ssc->backpressure_defers());
+        stats.set_msg_batch_size(ssc->session_msg_batch());
+        list.push_back(stats);
+    }
+
+    resp->set_context(context());
+    resp->Response();
+    return;
+}
+
 void AddAgingConfig::HandleRequest() const {
     FlowStatsManager *fam = Agent::GetInstance()->flow_stats_manager();
     fam->Add(FlowAgingTableKey(get_protocol(), get_port()),
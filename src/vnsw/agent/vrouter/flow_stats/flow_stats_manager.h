@@ -5,6 +5,7 @@
 #ifndef vnsw_agent_flow_stats_maanger_h
 #define vnsw_agent_flow_stats_maanger_h
 
+#include <boost/function.hpp>
 #include <cmn/agent_cmn.h>
 #include <cmn/index_vector.h>
 #include <uve/stats_collector.h>
@@ -73,6 +74,12 @@ public:
     static const uint64_t FlowThresoldUpdateTime = 1000 * 2;
     static const uint32_t kDefaultFlowSamplingThreshold = 500;
     static const uint32_t kMinFlowSamplingThreshold = 20;
+    // Session export backs off based on number of messages pending in send
+    // queue to collector. Above low watermark, sampling threshold is not
+    // reduced and session messages are batched. Above high watermark,
+    // sampling threshold is raised and export of live sessions is deferred
+    static const uint32_t kSessionExportQueueLowWatermark = 256;
+    static const uint32_t kSessionExportQueueHighWatermark = 1024;
 
     typedef boost::shared_ptr<FlowStatsCollectorObject> FlowAgingTablePtr;
     typedef boost::shared_ptr<SessionStatsCollectorObject> SessionStatsCollectorPtr;
@@ -81,6 +88,7 @@ public:
                      FlowAgingTableMap;
     typedef std::pair<const FlowAgingTableKey, FlowAgingTablePtr>
                      FlowAgingTableEntry;
+    typedef boost::function<size_t(void)> ExportQueueLengthCb;
 
     FlowStatsManager(Agent *agent);
     ~FlowStatsManager();
@@ -173,6 +181,17 @@ public:
     }
 
     uint64_t threshold() const { return threshold_;}
+    void set_threshold(uint64_t value) { threshold_ = value; }
+    uint64_t session_export_backpressure_updates() const {
+        return session_export_backpressure_updates_;
+    }
+    size_t SessionExportQueueLength() const;
+    // Callback returning send queue length to collector. Tests use it to
+    // stand in for collector
+    void set_export_queue_length_cb(ExportQueueLengthCb cb) {
+        export_queue_length_cb_ = cb;
+    }
+    static size_t SandeshSendQueueLength();
     bool delete_short_flow() const {
         return delete_short_flow_;
     }
@@ -222,6 +241,8 @@ private:
     tbb::atomic<bool> sessions_sampled_atleast_once_;
     tbb::atomic<uint64_t> session_global_slo_logging_drops_;
     tbb::atomic<uint64_t> session_slo_logging_drops_;
+    uint64_t session_export_backpressure_updates_;
+    ExportQueueLengthCb export_queue_length_cb_;
     Timer* timer_;
     bool delete_short_flow_;
     //Protocol based array for minimal tree comparision
@@ -3,6 +3,8 @@
  */
 
 #include <bitset>
+#include <boost/functional/hash.hpp>
+#include <base/address_util.h>
 #include <pkt/flow_table.h>
 #include <pkt/flow_mgmt/flow_mgmt_request.h>
 #include <uve/stats_collector.h>
@@ -37,8 +39,8 @@ SessionStatsCollector::SessionStatsCollector(boost::asio::io_service &io,
         agent_uve_(uve),
         task_id_(uve->agent()->task_scheduler()->GetTaskId
                  (kTaskSessionStatsCollector)),
-        session_ep_iteration_key_(), session_agg_iteration_key_(),
-        session_iteration_key_(),
+        session_endpoint_map_(), session_endpoint_list_(),
+        session_ep_cursor_(0), flow_session_map_(),
         request_queue_(agent_uve_->agent()->task_scheduler()->
                        GetTaskId(kTaskSessionStatsCollectorEvent),
                        instance_id,
@@ -46,11 +48,17 @@ SessionStatsCollector::SessionStatsCollector(boost::asio::io_service &io,
                                    this, _1),
                        DEFAULT_SSC_REQUEST_QUEUE_SIZE,
                        MAX_SSC_REQUEST_QUEUE_ITERATIONS ),
-        session_msg_list_(agent_uve_->agent()->params()->max_endpoints_per_session_msg(),
-                          SessionEndpoint()),
-        session_msg_index_(0), instance_id_(instance_id),
+        session_msg_list_(agent_uve_->agent()->params()->max_endpoints_per_session_msg()
+                          * kSessionMsgBatchScale, SessionEndpoint()),
+        session_msg_index_(0),
+        session_msg_batch_(agent_uve_->agent()->params()->
+                           max_endpoints_per_session_msg()),
+        export_backpressure_(false), backpressure_defers_(0),
+        instance_id_(instance_id),
         flow_stats_manager_(aging_module), parent_(obj), session_task_(NULL),
-        current_time_(GetCurrentTime()), session_task_starts_(0) {
+        current_time_(GetCurrentTime()), session_task_starts_(0),
+        session_ep_visited_(0), pass_start_time_(0), last_pass_time_(0),
+        export_passes_(0) {
         request_queue_.set_name("Session stats collector event queue");
         request_queue_.set_measure_busy_time
             (agent_uve_->agent()->MeasureQueueDelay());
@@ -100,6 +108,7 @@ bool SessionStatsCollector::Run() {
                 << " Request count " << request_queue_.Length());
         }
         session_ep_visited_ = 0;
+        pass_start_time_ = GetCurrentTime();
         session_task_ = new SessionTask(this);
         agent_uve_->agent()->task_scheduler()->Enqueue(session_task_);
     }
@@ -112,6 +121,19 @@ bool FlowStatsManager::UpdateSessionThreshold() {
     bool export_rate_calculated = false;
     uint32_t exp_rate_without_sampling = 0;
 
+    /* Collector is not draining the send queue. Raise the threshold
+     * irrespective of export rate so that sessions are dropped by sampling
+     * before messages are built for them */
+    size_t queue_len = SessionExportQueueLength();
+    if (queue_len >= kSessionExportQueueHighWatermark) {
+        uint64_t cur_t = threshold();
+        UpdateThreshold((threshold_ * 2), true);
+        sessions_sampled_atleast_once_ = true;
+        session_export_backpressure_updates_++;
+        FLOW_EXPORT_STATS_TRACE(session_export_rate_, 0, cur_t, threshold());
+        return true;
+    }
+
     /* If flows are not being exported, no need to update threshold */
     if (!session_export_count_) {
         return true;
@@ -156,8 +178,10 @@ bool FlowStatsManager::UpdateSessionThreshold() {
          * 2. In scale setups, the threshold was updated to high value because
          *    of which flow-export-rate has dropped drastically.
          * Threshold should be updated here depending on which of the above two
-         * situations we are in. */
-        if (!sessions_sampled_atleast_once_) {
+         * situations we are in. Don't reduce threshold till send queue to
+         * collector drains */
+        if (queue_len >= kSessionExportQueueLowWatermark) {
+        } else if (!sessions_sampled_atleast_once_) {
             UpdateThreshold(kDefaultFlowSamplingThreshold, false);
         } else {
             if (session_export_rate_ < ((double)cfg_rate) * 0.5) {
@@ -217,10 +241,10 @@ void SessionStatsCollector::DispatchSessionMsg(const std::vector<SessionEndpoint
 
 void SessionStatsCollector::EnqueueSessionMsg() {
     session_msg_index_++;
-    if (session_msg_index_ ==
-        agent_uve_->agent()->params()->max_endpoints_per_session_msg()) {
-        DispatchSessionMsg(session_msg_list_);
-        session_msg_index_ = 0;
+    /* session_msg_list_ is sized for the largest batch, send only the
+     * SessionEndpoints filled in this batch */
+    if (session_msg_index_ >= session_msg_batch_) {
+        DispatchPendingSessionMsg();
     }
 }
 
@@ -237,12 +261,34 @@ void SessionStatsCollector::DispatchPendingSessionMsg() {
     session_msg_index_ = 0;
 }
 
-uint8_t SessionStatsCollector::GetSessionMsgIdx() {
+uint16_t SessionStatsCollector::GetSessionMsgIdx() {
     SessionEndpoint &obj = session_msg_list_[session_msg_index_];
     obj = SessionEndpoint();
     return session_msg_index_;
 }
 
+// Sample the send queue to collector once per run of SessionTask. Above low
+// watermark, more SessionEndpoints are packed in a message. Above high
+// watermark, only sessions which are deleted or evicted are exported
+void SessionStatsCollector::UpdateExportBackpressure() {
+    size_t queue_len = flow_stats_manager_->SessionExportQueueLength();
+    uint16_t batch =
+        agent_uve_->agent()->params()->max_endpoints_per_session_msg();
+    if (queue_len >= FlowStatsManager::kSessionExportQueueLowWatermark) {
+        batch = batch * kSessionMsgBatchScale;
+    }
+    session_msg_batch_ = batch;
+    export_backpressure_ =
+        (queue_len >= FlowStatsManager::kSessionExportQueueHighWatermark);
+}
+
+uint64_t SessionStatsCollector::ExportLag() const {
+    if (session_task_ == NULL) {
+        return 0;
+    }
+    return GetCurrentTime() - pass_start_time_;
+}
+
 bool SessionStatsCollector::RequestHandlerEntry() {
     current_time_ = GetCurrentTime();
     return true;
@@ -280,6 +326,50 @@ bool SessionStatsCollector::RequestHandler(boost::shared_ptr<SessionStatsReq> re
     return true;
 }
 
+static std::size_t HashCombine(std::size_t hash, uint64_t val) {
+    boost::hash_combine(hash, val);
+    return hash;
+}
+
+static std::size_t HashIp(std::size_t hash, const IpAddress &ip) {
+    if (ip.is_v6()) {
+        uint64_t val[2];
+        Ip6AddressToU64Array(ip.to_v6(), val, 2);
+        hash = HashCombine(hash, val[0]);
+        hash = HashCombine(hash, val[1]);
+    } else if (ip.is_v4()) {
+        hash = HashCombine(hash, ip.to_v4().to_ulong());
+    }
+    return hash;
+}
+
+std::size_t SessionEndpointKey::Hash() const {
+    std::size_t hash = 0;
+    boost::hash_combine(hash, vmi_cfg_name);
+    boost::hash_combine(hash, local_vn);
+    boost::hash_combine(hash, remote_vn);
+    boost::hash_combine(hash, local_tagset);
+    boost::hash_combine(hash, remote_tagset);
+    boost::hash_combine(hash, remote_prefix);
+    boost::hash_combine(hash, match_policy);
+    boost::hash_combine(hash, is_client_session);
+    boost::hash_combine(hash, is_si);
+    return hash;
+}
+
+std::size_t SessionAggKey::Hash() const {
+    std::size_t hash = HashIp(0, local_ip);
+    hash = HashCombine(hash, server_port);
+    return HashCombine(hash, proto);
+}
+
+std::size_t SessionKey::Hash() const {
+    std::size_t hash = HashIp(0, remote_ip);
+    hash = HashCombine(hash, client_port);
+    boost::hash_combine(hash, uuid);
+    return hash;
+}
+
 bool SessionEndpointKey::IsLess(const SessionEndpointKey &rhs) const {
     if (vmi_cfg_name != rhs.vmi_cfg_name) {
         return vmi_cfg_name < rhs.vmi_cfg_name;
@@ -555,16 +645,36 @@ static void TraceSession(const string &op, const SessionEndpointKey &ep,
     SESSION_STATS_TRACE(Trace, op, info, rev_flow_params);
 }
 
+SessionStatsCollector::SessionEndpointEntry *
+SessionStatsCollector::LocateSessionEndpoint(const SessionEndpointKey &key) {
+    SessionEndpointMap::iterator it = session_endpoint_map_.find(key);
+    if (it != session_endpoint_map_.end()) {
+        return &(*it);
+    }
+    it = session_endpoint_map_.insert(make_pair(key,
+                                                SessionEndpointInfo())).first;
+    session_endpoint_list_.push_back(&(*it));
+    return &(*it);
+}
+
+SessionEndpointInfo::SessionAggEntry *
+SessionStatsCollector::LocateSessionAgg(SessionEndpointInfo *session_ep_info,
+                                        const SessionAggKey &key) {
+    SessionEndpointInfo::SessionAggMap &agg_map =
+        session_ep_info->session_agg_map_;
+    SessionEndpointInfo::SessionAggMap::iterator it = agg_map.find(key);
+    if (it != agg_map.end()) {
+        return &(*it);
+    }
+    it = agg_map.insert(make_pair(key, SessionPreAggInfo())).first;
+    session_ep_info->session_agg_list_.push_back(&(*it));
+    return &(*it);
+}
+
 void SessionStatsCollector::AddSession(FlowEntry* fe, uint64_t setup_time) {
     SessionAggKey session_agg_key;
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionPreAggInfo session_agg_info;
-    SessionStatsInfo session;
     SessionKey session_key;
-    SessionPreAggInfo::SessionMap::iterator session_map_iter;
-    SessionEndpointInfo  session_endpoint_info = {};
     SessionEndpointKey session_endpoint_key;
-    SessionEndpointMap::iterator session_endpoint_map_iter;
     FlowEntry *fe_fwd = fe;
     bool success;
 
@@ -594,73 +704,44 @@ void SessionStatsCollector::AddSession(FlowEntry* fe, uint64_t setup_time) {
     FlowSessionMap::iterator flow_session_map_iter;
     flow_session_map_iter = flow_session_map_.find(fe_fwd);
     if (flow_session_map_iter != flow_session_map_.end()) {
-
-        FlowToSessionMap &flow_to_session_map = flow_session_map_iter->second;
-        FlowToSessionMap rhs_flow_to_session_map(session_key,
-                                                 session_agg_key,
-                                                 session_endpoint_key);
-        if (!(flow_to_session_map.IsEqual(rhs_flow_to_session_map))) {
-            DeleteSession(fe_fwd, flow_to_session_map.session_key().uuid,
-                          GetCurrentTime(), NULL);
+        const FlowToSessionMap &flow_to_session_map =
+            flow_session_map_iter->second;
+        if (!(flow_to_session_map.IsEqual(session_key, session_agg_key,
+                                          session_endpoint_key))) {
+            boost::uuids::uuid del_uuid =
+                flow_to_session_map.session_key().uuid;
+            DeleteSession(fe_fwd, del_uuid, GetCurrentTime(), NULL);
         }
     }
 
     TraceSession("Add", session_endpoint_key, session_agg_key, session_key,
                  false);
-    UpdateSessionStatsInfo(fe_fwd, setup_time, &session);
-
-    session_endpoint_map_iter = session_endpoint_map_.find(
-                                            session_endpoint_key);
-    if (session_endpoint_map_iter == session_endpoint_map_.end()) {
-        session_agg_info.session_map_.insert(make_pair(session_key, session));
-        session_endpoint_info.session_agg_map_.insert(
-                                make_pair(session_agg_key, session_agg_info));
-        session_endpoint_map_.insert(make_pair(session_endpoint_key,
-                                                session_endpoint_info));
-        AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                            session_endpoint_key);
-    } else {
-        session_agg_map_iter = session_endpoint_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_agg_key);
-        if (session_agg_map_iter ==
-                session_endpoint_map_iter->second.session_agg_map_.end()) {
-            session_agg_info.session_map_.insert(make_pair(session_key, session));
-            session_endpoint_map_iter->second.session_agg_map_.insert(
-                                make_pair(session_agg_key, session_agg_info));
-            AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                                session_endpoint_key);
-        } else {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_key);
-            if (session_map_iter ==
-                    session_agg_map_iter->second.session_map_.end()) {
-                session_agg_map_iter->second.session_map_.insert(
-                                        make_pair(session_key, session));
-                AddFlowToSessionMap(fe_fwd, session_key, session_agg_key,
-                                    session_endpoint_key);
-            } else {
-                /*
-                 * existing flow should match with the incoming add flow
-                 */
-        assert(session.fwd_flow.uuid == fe_fwd->uuid());
-            }
-        }
+
+    SessionEndpointEntry *session_ep =
+        LocateSessionEndpoint(session_endpoint_key);
+    SessionEndpointInfo::SessionAggEntry *session_agg =
+        LocateSessionAgg(&session_ep->second, session_agg_key);
+    SessionPreAggInfo &session_agg_info = session_agg->second;
+    std::pair<SessionPreAggInfo::SessionMap::iterator, bool> ret =
+        session_agg_info.session_map_.insert(make_pair(session_key,
+                                                       SessionStatsInfo()));
+    if (ret.second == false) {
+        /*
+         * existing flow should match with the incoming add flow
+         */
+        return;
     }
+
+    SessionPreAggInfo::SessionEntry *session = &(*ret.first);
+    UpdateSessionStatsInfo(fe_fwd, setup_time, &session->second);
+    session_agg_info.session_list_.push_back(session);
+    AddFlowToSessionMap(fe_fwd, session_ep, session_agg, session);
 }
 
 void SessionStatsCollector::DeleteSession(FlowEntry* fe,
                                           const boost::uuids::uuid &del_uuid,
                                           uint64_t teardown_time,
                                           const RevFlowDepParams *params) {
-    SessionAggKey session_agg_key;
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionPreAggInfo  session_agg_info;
-    SessionKey session_key;
-    SessionPreAggInfo::SessionMap::iterator session_map_iter;
-    SessionEndpointInfo  session_endpoint_info;
-    SessionEndpointKey session_endpoint_key;
-    SessionEndpointMap::iterator session_endpoint_map_iter;
     bool read_flow = true;
 
     if (del_uuid != fe->uuid()) {
@@ -674,26 +755,23 @@ void SessionStatsCollector::DeleteSession(FlowEntry* fe,
     FlowSessionMap::iterator flow_session_map_iter;
 
     flow_session_map_iter = flow_session_map_.find(fe);
-    if (flow_session_map_iter != flow_session_map_.end()) {
-        if (del_uuid != flow_session_map_iter->second.session_key().uuid) {
-            /* We had never seen ADD for del_uuid, ignore delete request. This
-             * can happen when the following events occur
-             * 1. Add with UUID x
-             * 2. Delete with UUID x
-             * 3. Add with UUID y
-             * 4. Delete with UUID y
-             * When events 2 and 3 are suppressed and we receive only 1 and 4
-             * In this case initiated delete for entry with UUID x */
-            read_flow = false;
-            /* Reset params because they correspond to entry with UUID y */
-            params = NULL;
-        }
-        session_endpoint_key = flow_session_map_iter->second.session_endpoint_key();
-        session_agg_key = flow_session_map_iter->second.session_agg_key();
-        session_key = flow_session_map_iter->second.session_key();
-    } else {
+    if (flow_session_map_iter == flow_session_map_.end()) {
         return;
     }
+    const FlowToSessionMap &flow_to_session_map = flow_session_map_iter->second;
+    if (del_uuid != flow_to_session_map.session_key().uuid) {
+        /* We had never seen ADD for del_uuid, ignore delete request. This
+         * can happen when the following events occur
+         * 1. Add with UUID x
+         * 2. Delete with UUID x
+         * 3. Add with UUID y
+         * 4. Delete with UUID y
+         * When events 2 and 3 are suppressed and we receive only 1 and 4
+         * In this case initiated delete for entry with UUID x */
+        read_flow = false;
+        /* Reset params because they correspond to entry with UUID y */
+        params = NULL;
+    }
     if (params && params->action_info_.action == 0) {
         params = NULL;
     }
@@ -703,41 +781,28 @@ void SessionStatsCollector::DeleteSession(FlowEntry* fe,
         params_valid = false;
     }
 
-    TraceSession("Del", session_endpoint_key, session_agg_key, session_key,
-                 params_valid);
-    session_endpoint_map_iter = session_endpoint_map_.find(
-                                            session_endpoint_key);
-    if (session_endpoint_map_iter != session_endpoint_map_.end()) {
-        session_agg_map_iter = session_endpoint_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_agg_key);
-        if (session_agg_map_iter !=
-                session_endpoint_map_iter->second.session_agg_map_.end()) {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_key);
-            if (session_map_iter !=
-                    session_agg_map_iter->second.session_map_.end()) {
-                /*
-                 * Process the stats collector
-                 */
-                session_map_iter->second.teardown_time = teardown_time;
-                session_map_iter->second.deleted = true;
-                /* Don't read stats for evicted flow, during delete */
-                if (!session_map_iter->second.evicted) {
-                    SessionStatsChangedUnlocked(session_map_iter,
-                        &session_map_iter->second.del_stats);
-                }
-                if (read_flow) {
-                    CopyFlowInfo(session_map_iter->second, params);
-                }
+    TraceSession("Del", flow_to_session_map.session_endpoint_key(),
+                 flow_to_session_map.session_agg_key(),
+                 flow_to_session_map.session_key(), params_valid);
 
-                assert(session_map_iter->second.fwd_flow.flow.get() == fe);
-                DeleteFlowToSessionMap(fe);
-                session_map_iter->second.fwd_flow.flow = NULL;
-                session_map_iter->second.rev_flow.flow = NULL;
-            }
-        }
+    SessionPreAggInfo::SessionEntry *session = flow_to_session_map.session();
+    /*
+     * Process the stats collector
+     */
+    session->second.teardown_time = teardown_time;
+    session->second.deleted = true;
+    /* Don't read stats for evicted flow, during delete */
+    if (!session->second.evicted) {
+        SessionStatsChangedUnlocked(session, &session->second.del_stats);
+    }
+    if (read_flow) {
+        CopyFlowInfo(session->second, params);
     }
+
+    assert(session->second.fwd_flow.flow.get() == fe);
+    flow_session_map_.erase(flow_session_map_iter);
+    session->second.fwd_flow.flow = NULL;
+    session->second.rev_flow.flow = NULL;
 }
 
 void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
@@ -746,13 +811,6 @@ void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
                                                 uint32_t oflow_bytes,
                                                 const boost::uuids::uuid &u) {
     FlowSessionMap::iterator flow_session_map_iter;
-    SessionInfo session_info;
-    SessionIpPort session_key;
-    SessionAggInfo session_agg_info;
-    SessionIpPortProtocol session_agg_key;
-    SessionEndpointMap::iterator session_ep_map_iter;
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionPreAggInfo::SessionMap::iterator session_map_iter;
 
     /* TODO: Evicted msg coming for reverse flow. We currently don't have
      * mapping from reverse_flow to flow_session_map */
@@ -765,73 +823,47 @@ void SessionStatsCollector::EvictedSessionStatsUpdate(const FlowEntryPtr &flow,
         return;
     }
 
-    SessionEndpointKey session_db_ep_key = flow_session_map_iter->second.session_endpoint_key();
-    SessionAggKey session_db_agg_key = flow_session_map_iter->second.session_agg_key();
-    SessionKey session_db_key = flow_session_map_iter->second.session_key();
-
-    session_ep_map_iter = session_endpoint_map_.find(session_db_ep_key);
-    if (session_ep_map_iter != session_endpoint_map_.end()) {
-        session_agg_map_iter = session_ep_map_iter->
-                                        second.session_agg_map_.find(
-                                                        session_db_agg_key);
-        if (session_agg_map_iter !=
-                session_ep_map_iter->second.session_agg_map_.end()) {
-            session_map_iter =
-                session_agg_map_iter->second.session_map_.find(session_db_key);
-            if (session_map_iter !=
-                    session_agg_map_iter->second.session_map_.end()) {
-                /*
-                 * update the latest statistics
-                 */
-                SessionFlowStatsInfo &session_flow = session_map_iter->second.fwd_flow;
-                uint64_t k_bytes, total_bytes, diff_bytes = 0;
-                uint64_t k_packets, total_packets, diff_packets = 0;
-                k_bytes = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF),
-                                                           bytes);
-                k_packets = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF0000),
-                                                             packets);
-                total_bytes = GetUpdatedSessionFlowBytes(session_flow.total_bytes,
-                                                         k_bytes);
-                total_packets = GetUpdatedSessionFlowPackets(session_flow.total_packets,
-                                                             k_packets);
-                diff_bytes = total_bytes - session_flow.total_bytes;
-                diff_packets = total_packets - session_flow.total_packets;
-                session_flow.total_bytes = total_bytes;
-                session_flow.total_packets = total_packets;
-
-                SessionStatsParams &estats = session_map_iter->second.
-                    evict_stats;
-                session_map_iter->second.evicted = true;
-                estats.fwd_flow.valid = true;
-                estats.fwd_flow.diff_bytes = diff_bytes;
-                estats.fwd_flow.diff_packets = diff_packets;
-            }
-        }
-    }
+    SessionStatsInfo &session = flow_session_map_iter->second.session()->second;
+    /*
+     * update the latest statistics
+     */
+    SessionFlowStatsInfo &session_flow = session.fwd_flow;
+    uint64_t k_bytes, total_bytes, diff_bytes = 0;
+    uint64_t k_packets, total_packets, diff_packets = 0;
+    k_bytes = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF),
+                                               bytes);
+    k_packets = FlowStatsCollector::GetFlowStats((oflow_bytes & 0xFFFF0000),
+                                                 packets);
+    total_bytes = GetUpdatedSessionFlowBytes(session_flow.total_bytes,
+                                             k_bytes);
+    total_packets = GetUpdatedSessionFlowPackets(session_flow.total_packets,
+                                                 k_packets);
+    diff_bytes = total_bytes - session_flow.total_bytes;
+    diff_packets = total_packets - session_flow.total_packets;
+    session_flow.total_bytes = total_bytes;
+    session_flow.total_packets = total_packets;
+
+    SessionStatsParams &estats = session.evict_stats;
+    session.evicted = true;
+    estats.fwd_flow.valid = true;
+    estats.fwd_flow.diff_bytes = diff_bytes;
+    estats.fwd_flow.diff_packets = diff_packets;
 }
 
 void SessionStatsCollector::AddFlowToSessionMap(FlowEntry *fe,
-                                                SessionKey session_key,
-                                                SessionAggKey session_agg_key,
-                                                SessionEndpointKey session_endpoint_key) {
-    FlowToSessionMap flow_to_session_map(session_key, session_agg_key,
-                                         session_endpoint_key);
+                        SessionEndpointEntry *session_ep,
+                        SessionEndpointInfo::SessionAggEntry *session_agg,
+                        SessionPreAggInfo::SessionEntry *session) {
+    FlowToSessionMap flow_to_session_map(&session_ep->first, session_agg,
+                                         session);
     std::pair<FlowSessionMap::iterator, bool> ret =
         flow_session_map_.insert(make_pair(fe, flow_to_session_map));
     if (ret.second == false) {
-        FlowToSessionMap &prev = ret.first->second;
+        const FlowToSessionMap &prev = ret.first->second;
         assert(prev.session_key().uuid == fe->uuid());
     }
 }
 
-void SessionStatsCollector::DeleteFlowToSessionMap(FlowEntry *fe) {
-    FlowSessionMap::iterator flow_session_map_iter;
-    flow_session_map_iter = flow_session_map_.find(fe);
-    if (flow_session_map_iter != flow_session_map_.end()) {
-        flow_session_map_.erase(flow_session_map_iter);
-    }
-}
-
 int SessionStatsCollector::ComputeSloRate(int rate, SecurityLoggingObject *slo)
     const {
     /* If rate is not configured, it will have -1 as value
@@ -1465,12 +1497,12 @@ void SessionStatsCollector::FillSessionFlowInfo
 }
 
 bool SessionStatsCollector::CheckAndDeleteSessionStatsFlow(
-    SessionPreAggInfo::SessionMap::iterator session_map_iter) {
-    FlowEntry *fe = session_map_iter->second.fwd_flow.flow.get();
-    FlowEntry *rfe = session_map_iter->second.rev_flow.flow.get();
+    SessionPreAggInfo::SessionEntry *session_entry) {
+    FlowEntry *fe = session_entry->second.fwd_flow.flow.get();
+    FlowEntry *rfe = session_entry->second.rev_flow.flow.get();
     FLOW_LOCK(fe, rfe, FlowEvent::FLOW_MESSAGE);
     if (fe->deleted()) {
-        DeleteSession(fe, session_map_iter->first.uuid,
+        DeleteSession(fe, session_entry->first.uuid,
                           GetCurrentTime(), NULL);
         return true;
     }
@@ -1478,21 +1510,21 @@ bool SessionStatsCollector::CheckAndDeleteSessionStatsFlow(
 }
 
 bool SessionStatsCollector::SessionStatsChangedLocked
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      SessionStatsParams *params) const {
-    FlowEntry *fe = session_map_iter->second.fwd_flow.flow.get();
-    FlowEntry *rfe = session_map_iter->second.rev_flow.flow.get();
+    FlowEntry *fe = session_entry->second.fwd_flow.flow.get();
+    FlowEntry *rfe = session_entry->second.rev_flow.flow.get();
     FLOW_LOCK(fe, rfe, FlowEvent::FLOW_MESSAGE);
-    return SessionStatsChangedUnlocked(session_map_iter, params);
+    return SessionStatsChangedUnlocked(session_entry, params);
 }
 
 bool SessionStatsCollector::SessionStatsChangedUnlocked
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      SessionStatsParams *params) const {
 
-    bool fwd_updated = FetchFlowStats(&session_map_iter->second.fwd_flow,
+    bool fwd_updated = FetchFlowStats(&session_entry->second.fwd_flow,
                                       &params->fwd_flow);
-    bool rev_updated = FetchFlowStats(&session_map_iter->second.rev_flow,
+    bool rev_updated = FetchFlowStats(&session_entry->second.rev_flow,
                                       &params->rev_flow);
     return (fwd_updated || rev_updated);
 }
@@ -1555,20 +1587,20 @@ bool SessionStatsCollector::FetchFlowStats
 }
 
 void SessionStatsCollector::FillSessionInfoLocked
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      const SessionStatsParams &stats, SessionInfo *session_info,
      SessionIpPort *session_key, bool is_sampling, bool is_logging) const {
-    FlowEntry *fe = session_map_iter->second.fwd_flow.flow.get();
-    FlowEntry *rfe = session_map_iter->second.rev_flow.flow.get();
+    FlowEntry *fe = session_entry->second.fwd_flow.flow.get();
+    FlowEntry *rfe = session_entry->second.rev_flow.flow.get();
     FLOW_LOCK(fe, rfe, FlowEvent::FLOW_MESSAGE);
-    FillSessionInfoUnlocked(session_map_iter, stats, session_info, session_key, NULL,
+    FillSessionInfoUnlocked(session_entry, stats, session_info, session_key, NULL,
                             true, is_sampling, is_logging);
 }
 
 void SessionStatsCollector::FillSessionEvictStats
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      SessionInfo *session_info, bool is_sampling, bool is_logging) const {
-    const SessionStatsParams &estats = session_map_iter->second.evict_stats;
+    const SessionStatsParams &estats = session_entry->second.evict_stats;
     if (!estats.fwd_flow.valid) {
         return;
     }
@@ -1593,48 +1625,48 @@ void SessionStatsCollector::FillSessionEvictStats
 }
 
 void SessionStatsCollector::FillSessionInfoUnlocked
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      const SessionStatsParams &stats,
      SessionInfo *session_info,
      SessionIpPort *session_key,
      const RevFlowDepParams *params,
      bool read_flow, bool is_sampling, bool is_logging) const {
     string rid = agent_uve_->agent()->router_id().to_string();
-    FlowEntry *fe = session_map_iter->second.fwd_flow.flow.get();
-    FlowEntry *rfe = session_map_iter->second.rev_flow.flow.get();
+    FlowEntry *fe = session_entry->second.fwd_flow.flow.get();
+    FlowEntry *rfe = session_entry->second.rev_flow.flow.get();
     boost::system::error_code ec;
     /*
      * Fill the session Key
      */
-    session_key->set_ip(session_map_iter->first.remote_ip);
-    session_key->set_port(session_map_iter->first.client_port);
-    FillSessionFlowInfo(session_map_iter->second.fwd_flow,
-                        session_map_iter->second,
-                        session_map_iter->second.export_info.fwd_flow,
+    session_key->set_ip(session_entry->first.remote_ip);
+    session_key->set_port(session_entry->first.client_port);
+    FillSessionFlowInfo(session_entry->second.fwd_flow,
+                        session_entry->second,
+                        session_entry->second.export_info.fwd_flow,
                         &session_info->forward_flow_info);
-    FillSessionFlowInfo(session_map_iter->second.rev_flow,
-                        session_map_iter->second,
-                        session_map_iter->second.export_info.rev_flow,
+    FillSessionFlowInfo(session_entry->second.rev_flow,
+                        session_entry->second,
+                        session_entry->second.export_info.rev_flow,
                         &session_info->reverse_flow_info);
     bool first_time_export = false;
-    if (!session_map_iter->second.exported_atleast_once) {
+    if (!session_entry->second.exported_atleast_once) {
         first_time_export = true;
         /* Mark the flow as exported */
-        session_map_iter->second.exported_atleast_once = true;
+        session_entry->second.exported_atleast_once = true;
     }
 
-    const bool &evicted = session_map_iter->second.evicted;
-    const bool &deleted = session_map_iter->second.deleted;
+    const bool &evicted = session_entry->second.evicted;
+    const bool &deleted = session_entry->second.deleted;
     if (evicted) {
-        const SessionStatsParams &estats = session_map_iter->second.evict_stats;
-        FillSessionEvictStats(session_map_iter, session_info, is_sampling,
+        const SessionStatsParams &estats = session_entry->second.evict_stats;
+        FillSessionEvictStats(session_entry, session_info, is_sampling,
                               is_logging);
         flow_stats_manager_->UpdateSessionExportStats(1, first_time_export,
                                                       estats.sampled);
     } else {
         const SessionStatsParams *real_stats = &stats;
         if (deleted) {
-            real_stats = &session_map_iter->second.del_stats;
+            real_stats = &session_entry->second.del_stats;
         }
         FillSessionFlowStats(real_stats->fwd_flow,
                              &session_info->forward_flow_info, is_sampling,
@@ -1646,7 +1678,7 @@ void SessionStatsCollector::FillSessionInfoUnlocked
                                                       real_stats->sampled);
     }
     if (deleted) {
-        SessionExportInfo &info = session_map_iter->second.export_info;
+        SessionExportInfo &info = session_entry->second.export_info;
         if (info.valid) {
             if (!info.vm_cfg_name.empty()) {
                 session_info->set_vm(info.vm_cfg_name);
@@ -1698,14 +1730,14 @@ void SessionStatsCollector::UpdateAggregateStats(const SessionInfo &sinfo,
 }
 
 void SessionStatsCollector::FillSessionAggInfo
-(SessionEndpointInfo::SessionAggMap::iterator it, SessionIpPortProtocol *key)
+(const SessionEndpointInfo::SessionAggEntry *entry, SessionIpPortProtocol *key)
  const {
     /*
      * Fill the session agg key
      */
-    key->set_local_ip(it->first.local_ip);
-    key->set_service_port(it->first.server_port);
-    key->set_protocol(it->first.proto);
+    key->set_local_ip(entry->first.local_ip);
+    key->set_service_port(entry->first.server_port);
+    key->set_protocol(entry->first.proto);
 }
 
 void SessionStatsCollector::FillSessionTags(const TagList &list,
@@ -1756,62 +1788,120 @@ void SessionStatsCollector::FillSessionRemoteTags(const TagList &list,
     }
 }
 
-void SessionStatsCollector::FillSessionEndpoint(SessionEndpointMap::iterator it,
-                                                SessionEndpoint *session_ep)
-                                                const {
+void SessionStatsCollector::FillSessionEndpoint
+(const SessionEndpointEntry *entry, SessionEndpoint *session_ep) const {
     string rid = agent_uve_->agent()->router_id().to_string();
     boost::system::error_code ec;
 
-    session_ep->set_vmi(it->first.vmi_cfg_name);
-    session_ep->set_vn(it->first.local_vn);
-    session_ep->set_remote_vn(it->first.remote_vn);
-    session_ep->set_is_client_session(it->first.is_client_session);
-    session_ep->set_is_si(it->first.is_si);
-    if (!it->first.remote_prefix.empty()) {
-        session_ep->set_remote_prefix(it->first.remote_prefix);
+    session_ep->set_vmi(entry->first.vmi_cfg_name);
+    session_ep->set_vn(entry->first.local_vn);
+    session_ep->set_remote_vn(entry->first.remote_vn);
+    session_ep->set_is_client_session(entry->first.is_client_session);
+    session_ep->set_is_si(entry->first.is_si);
+    if (!entry->first.remote_prefix.empty()) {
+        session_ep->set_remote_prefix(entry->first.remote_prefix);
     }
-    session_ep->set_security_policy_rule(it->first.match_policy);
-    if (it->first.local_tagset.size() > 0) {
-        FillSessionTags(it->first.local_tagset, session_ep);
+    session_ep->set_security_policy_rule(entry->first.match_policy);
+    if (entry->first.local_tagset.size() > 0) {
+        FillSessionTags(entry->first.local_tagset, session_ep);
     }
-    if (it->first.remote_tagset.size() > 0) {
-        FillSessionRemoteTags(it->first.remote_tagset, session_ep);
+    if (entry->first.remote_tagset.size() > 0) {
+        FillSessionRemoteTags(entry->first.remote_tagset, session_ep);
     }
     session_ep->set_vrouter_ip(AddressFromString(rid, &ec));
 }
 
-bool SessionStatsCollector::ProcessSessionEndpoint
-    (const SessionEndpointMap::iterator &it) {
-    SessionEndpointInfo::SessionAggMap::iterator session_agg_map_iter;
-    SessionEndpointInfo::SessionAggMap::iterator prev_agg_iter;
-    SessionPreAggInfo::SessionMap::iterator session_map_iter, prev;
+// Entries are removed only at the cursor of export walk. Move the last entry,
+// which is yet to be visited in this pass, into the hole
+template <typename Map, typename List>
+static void EraseEntryAtCursor(Map *map, List *list, uint32_t cursor) {
+    typename Map::iterator it = map->find((*list)[cursor]->first);
+    assert(it != map->end());
+    (*list)[cursor] = list->back();
+    list->pop_back();
+    map->erase(it);
+}
+
+void SessionStatsCollector::NextSession(SessionPreAggInfo *session_agg_info) {
+    uint32_t cursor = session_agg_info->cursor_;
+    if (session_agg_info->session_list_[cursor]->second.deleted) {
+        EraseEntryAtCursor(&session_agg_info->session_map_,
+                           &session_agg_info->session_list_, cursor);
+    } else {
+        session_agg_info->cursor_++;
+    }
+}
 
+void SessionStatsCollector::NextSessionAgg
+    (SessionEndpointInfo *session_ep_info) {
+    uint32_t cursor = session_ep_info->cursor_;
+    SessionPreAggInfo &session_agg_info =
+        session_ep_info->session_agg_list_[cursor]->second;
+    session_agg_info.cursor_ = 0;
+    if (session_agg_info.session_list_.size() == 0) {
+        EraseEntryAtCursor(&session_ep_info->session_agg_map_,
+                           &session_ep_info->session_agg_list_, cursor);
+    } else {
+        session_ep_info->cursor_++;
+    }
+}
+
+void SessionStatsCollector::NextSessionEndpoint() {
+    SessionEndpointInfo &session_ep_info =
+        session_endpoint_list_[session_ep_cursor_]->second;
+    session_ep_info.cursor_ = 0;
+    if (session_ep_info.session_agg_list_.size() == 0) {
+        EraseEntryAtCursor(&session_endpoint_map_, &session_endpoint_list_,
+                           session_ep_cursor_);
+    } else {
+        session_ep_cursor_++;
+    }
+}
+
+bool SessionStatsCollector::ProcessSessionEndpoint
+    (SessionEndpointEntry *session_ep_entry) {
+    SessionEndpointInfo &session_ep_info = session_ep_entry->second;
     SessionInfo session_info;
     SessionIpPort session_key;
     uint32_t session_count = 0, session_agg_count = 0;
-    bool exit = false, ep_completed = true;
+    uint32_t max_sessions =
+        agent_uve_->agent()->params()->max_sessions_per_aggregate();
+    uint32_t max_aggregates =
+        agent_uve_->agent()->params()->max_aggregates_per_session_endpoint();
+    bool exit = false;
 
     SessionEndpoint &session_ep = session_msg_list_[GetSessionMsgIdx()];
 
-    session_agg_map_iter = it->second.session_agg_map_.
-        lower_bound(session_agg_iteration_key_);
-    while (session_agg_map_iter != it->second.session_agg_map_.end()) {
+    while (session_ep_info.cursor_ < session_ep_info.session_agg_list_.size()) {
+        SessionEndpointInfo::SessionAggEntry *session_agg_entry =
+            session_ep_info.session_agg_list_[session_ep_info.cursor_];
+        SessionPreAggInfo &session_pre_agg_info = session_agg_entry->second;
+        SessionPreAggInfo::SessionList &session_list =
+            session_pre_agg_info.session_list_;
         SessionAggInfo session_agg_info;
         SessionIpPortProtocol session_agg_key;
         session_count = 0;
-        session_map_iter = session_agg_map_iter->second.session_map_.
-            lower_bound(session_iteration_key_);
-        while (session_map_iter != session_agg_map_iter->second.session_map_.end()) {
-            prev = session_map_iter;
+        while (session_pre_agg_info.cursor_ < session_list.size()) {
+            SessionPreAggInfo::SessionEntry *session_entry =
+                session_list[session_pre_agg_info.cursor_];
             SessionStatsParams params;
-            if (!session_map_iter->second.deleted &&
-                !session_map_iter->second.evicted) {
-                bool delete_marked = CheckAndDeleteSessionStatsFlow(session_map_iter);
+            if (!session_entry->second.deleted &&
+                !session_entry->second.evicted) {
+                /* Stats of deferred session are accumulated in the next
+                 * export */
+                if (export_backpressure_) {
+                    backpressure_defers_++;
+                    session_pre_agg_info.cursor_++;
+                    continue;
+                }
+                bool delete_marked =
+                    CheckAndDeleteSessionStatsFlow(session_entry);
                 if (!delete_marked) {
-                    bool changed = SessionStatsChangedLocked(session_map_iter,
-                                                    &params);
-                    if (!changed && session_map_iter->second.exported_atleast_once) {
-                        ++session_map_iter;
+                    bool changed = SessionStatsChangedLocked(session_entry,
+                                                             &params);
+                    if (!changed &&
+                        session_entry->second.exported_atleast_once) {
+                        session_pre_agg_info.cursor_++;
                         continue;
                     }
                 }
@@ -1819,153 +1909,95 @@ bool SessionStatsCollector::ProcessSessionEndpoint
 
             bool is_sampling = true;
             if (IsSamplingEnabled()) {
-                is_sampling = SampleSession(session_map_iter, &params);
+                is_sampling = SampleSession(session_entry, &params);
             }
-            bool is_logging = CheckSessionLogging(session_map_iter->second);
+            bool is_logging = CheckSessionLogging(session_entry->second);
 
             /* Ignore session export if sampling & logging drop the session */
             if (!is_sampling && !is_logging) {
-                ++session_map_iter;
-                if (prev->second.deleted) {
-                    session_agg_map_iter->second.session_map_.erase(prev);
-                }
+                NextSession(&session_pre_agg_info);
                 continue;
             }
-            if (session_map_iter->second.deleted) {
-                FillSessionInfoUnlocked(session_map_iter, params, &session_info,
+            if (session_entry->second.deleted) {
+                FillSessionInfoUnlocked(session_entry, params, &session_info,
                                         &session_key, NULL, true, is_sampling,
                                         is_logging);
             } else {
-                FillSessionInfoLocked(session_map_iter, params, &session_info,
+                FillSessionInfoLocked(session_entry, params, &session_info,
                                       &session_key, is_sampling, is_logging);
             }
             session_agg_info.sessionMap.insert(make_pair(session_key,
                                                          session_info));
             UpdateAggregateStats(session_info, &session_agg_info, is_sampling,
                                  is_logging);
-            ++session_map_iter;
+            NextSession(&session_pre_agg_info);
             ++session_count;
-            if (prev->second.deleted) {
-                session_agg_map_iter->second.session_map_.erase(prev);
-            }
-            if (session_count ==
-                agent_uve_->agent()->params()->max_sessions_per_aggregate()) {
+            if (session_count == max_sessions) {
                 exit = true;
                 break;
             }
         }
         if (session_count) {
-            FillSessionAggInfo(session_agg_map_iter, &session_agg_key);
+            FillSessionAggInfo(session_agg_entry, &session_agg_key);
             session_ep.sess_agg_info.insert(make_pair(session_agg_key,
                                                       session_agg_info));
         }
-        if (exit) {
+        /* Resume from the same aggregate in next run, if sessions of the
+         * aggregate are not completely visited */
+        if (exit && session_pre_agg_info.cursor_ < session_list.size()) {
             break;
         }
-        session_iteration_key_.Reset();
-        prev_agg_iter = session_agg_map_iter;
-        session_agg_map_iter++;
-        if (prev_agg_iter->second.session_map_.size() == 0) {
-            it->second.session_agg_map_.erase(prev_agg_iter);
+        NextSessionAgg(&session_ep_info);
+        if (exit) {
+            break;
         }
         ++session_agg_count;
-        if (session_agg_count ==
-            agent_uve_->agent()->params()->max_aggregates_per_session_endpoint()) {
+        if (session_agg_count == max_aggregates) {
             break;
         }
     }
     /* Don't export SessionEndpoint if there are 0 aggregates */
     if (session_ep.sess_agg_info.size()) {
-        FillSessionEndpoint(it, &session_ep);
+        FillSessionEndpoint(session_ep_entry, &session_ep);
         EnqueueSessionMsg();
     }
 
-    if (session_count ==
-        agent_uve_->agent()->params()->max_sessions_per_aggregate()) {
-        ep_completed = false;
-        session_ep_iteration_key_ = it->first;
-        session_agg_iteration_key_ = session_agg_map_iter->first;
-        if (session_map_iter == session_agg_map_iter->second.session_map_.end()) {
-            prev_agg_iter = session_agg_map_iter;
-            ++session_agg_map_iter;
-            if (prev_agg_iter->second.session_map_.size() == 0) {
-                it->second.session_agg_map_.erase(prev_agg_iter);
-            }
-            if (session_agg_map_iter == it->second.session_agg_map_.end()) {
-                /* session_iteration_key_ and session_agg_iteration_key_ are
-                 * both reset when ep_completed is returned as true in the
-                 * calling function */
-                ep_completed = true;
-            } else {
-                session_iteration_key_.Reset();
-                session_agg_iteration_key_ = session_agg_map_iter->first;
-            }
-        } else {
-            session_iteration_key_ = session_map_iter->first;
-        }
-    } else if (session_agg_count ==
-               agent_uve_->agent()->params()->
-               max_aggregates_per_session_endpoint()) {
-        ep_completed = false;
-        session_ep_iteration_key_ = it->first;
-        if (session_agg_map_iter == it->second.session_agg_map_.end()) {
-            /* session_iteration_key_ and session_agg_iteration_key_ are both
-             * reset when ep_completed is returned as true in the calling
-             * function */
-            ep_completed = true;
-        } else {
-            session_agg_iteration_key_ = session_agg_map_iter->first;
-            session_iteration_key_.Reset();
-        }
-    }
-    return ep_completed;
+    return (session_ep_info.cursor_ ==
+            session_ep_info.session_agg_list_.size());
 }
 
 uint32_t SessionStatsCollector::RunSessionEndpointStats(uint32_t max_count) {
-    SessionEndpointMap::iterator it = session_endpoint_map_.
-        lower_bound(session_ep_iteration_key_);
-    if (it == session_endpoint_map_.end()) {
-        it = session_endpoint_map_.begin();
-    }
-    if (it == session_endpoint_map_.end()) {
-        return 0;
-    }
-
     uint32_t count = 0;
-    while (count < max_count) {
-        if (it == session_endpoint_map_.end()) {
-            break;
-        }
-
+    UpdateExportBackpressure();
+    while (count < max_count &&
+           session_ep_cursor_ < session_endpoint_list_.size()) {
         /* ProcessSessionEndpoint will build 1 SessionEndpoint message. This
          * may or may not include all aggregates and all sessions within each
          * aggregate. It returns true if the built message includes all
          * aggregates and all sessions of each aggregate */
-        bool ep_completed = ProcessSessionEndpoint(it);
+        bool ep_completed =
+            ProcessSessionEndpoint(session_endpoint_list_[session_ep_cursor_]);
         ++count;
         if (ep_completed) {
-            SessionEndpointMap::iterator prev = it;
-            ++it;
             ++session_ep_visited_;
-            session_agg_iteration_key_.Reset();
-            session_iteration_key_.Reset();
-            if (prev->second.session_agg_map_.size() == 0) {
-                session_endpoint_map_.erase(prev);
-            }
+            NextSessionEndpoint();
         }
     }
 
     //Send any pending session export messages
     DispatchPendingSessionMsg();
 
-    // Update iterator for next pass
-    if (it == session_endpoint_map_.end()) {
-        session_ep_iteration_key_.Reset();
+    /* Continue the pass in a new task, so that a pass completes irrespective
+     * of number of sessions. Next pass starts on timer */
+    if (session_ep_cursor_ < session_endpoint_list_.size()) {
+        session_task_ = new SessionTask(this);
+        agent_uve_->agent()->task_scheduler()->Enqueue(session_task_);
     } else {
-        session_ep_iteration_key_ = it->first;
+        session_ep_cursor_ = 0;
+        session_task_ = NULL;
+        export_passes_++;
+        last_pass_time_ = GetCurrentTime() - pass_start_time_;
     }
-
-    session_task_ = NULL;
     return count;
 }
 /////////////////////////////////////////////////////////////////////////////
@@ -2002,7 +2034,7 @@ bool SessionStatsCollector::IsSamplingEnabled() const {
 }
 
 bool SessionStatsCollector::SampleSession
-    (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    (SessionPreAggInfo::SessionEntry *session_entry,
      SessionStatsParams *params) const {
     int32_t cfg_rate = agent_uve_->agent()->oper_db()->global_vrouter()->
                         flow_export_rate();
@@ -2011,20 +2043,20 @@ bool SessionStatsCollector::SampleSession
         flow_stats_manager_->session_export_disable_drops_++;
         return false;
     }
-    const bool &deleted = session_map_iter->second.deleted;
-    const bool &evicted = session_map_iter->second.evicted;
+    const bool &deleted = session_entry->second.deleted;
+    const bool &evicted = session_entry->second.evicted;
     SessionStatsParams *stats = params;
     if (evicted) {
-        stats = &session_map_iter->second.evict_stats;
+        stats = &session_entry->second.evict_stats;
     } else if (deleted) {
-        stats = &session_map_iter->second.del_stats;
+        stats = &session_entry->second.del_stats;
     }
     stats->sampled = false;
     /* For session-sampling diff_bytes should consider the diff bytes for both
      * forward and reverse flow */
     uint64_t diff_bytes = stats->fwd_flow.diff_bytes +
                           stats->rev_flow.diff_bytes;
-    const SessionStatsInfo &info = session_map_iter->second;
+    const SessionStatsInfo &info = session_entry->second;
     /* Subject a flow to sampling algorithm only when all of below is met:-
      * a. actual session-export-rate is >= 80% of configured flow-export-rate.
      *    This is done only for first time.
@@ -2095,6 +2127,8 @@ SessionStatsCollectorObject::SessionStatsCollectorObject(Agent *agent,
                                                    FlowStatsManager *mgr) {
     for (int i = 0; i < kMaxSessionCollectors; i++) {
         uint32_t instance_id = mgr->AllocateIndex();
+        // Task policy for collectors assumes collector i uses instance i
+        assert(instance_id == (uint32_t)i);
         collectors[i].reset(
             AgentObjectFactory::Create<SessionStatsCollector>(
                 *(agent->event_manager()->io_service()),
@@ -2162,14 +2196,17 @@ FlowEntry* SessionStatsReq::reverse_flow() const {
     return rflow;
 }
 
-bool FlowToSessionMap::IsEqual(FlowToSessionMap &rhs) {
-    if (!(session_key_.IsEqual(rhs.session_key()))) {
+bool FlowToSessionMap::IsEqual(const SessionKey &session_key,
+                               const SessionAggKey &session_agg_key,
+                               const SessionEndpointKey &session_endpoint_key)
+    const {
+    if (!(session_->first.IsEqual(session_key))) {
         return false;
     }
-    if (!(session_agg_key_.IsEqual(rhs.session_agg_key()))) {
+    if (!(session_agg_->first.IsEqual(session_agg_key))) {
         return false;
     }
-    if (!(session_endpoint_key_.IsEqual(rhs.session_endpoint_key()))) {
+    if (!(session_endpoint_key_->IsEqual(session_endpoint_key))) {
         return false;
     }
     return true;
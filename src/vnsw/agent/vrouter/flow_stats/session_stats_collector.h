@@ -5,11 +5,11 @@
 #ifndef vnsw_agent_session_stats_collector_h
 #define vnsw_agent_session_stats_collector_h
 
+#include <boost/unordered_map.hpp>
 #include <vrouter/flow_stats/flow_stats_manager.h>
 // Forward declaration
 class FlowStatsManager;
 class SessionStatsReq;
-class FlowToSessionMap;
 struct SessionSloRuleEntry;
 class SessionSloState;
 
@@ -36,6 +36,7 @@ public:
     void Reset();
     bool IsLess(const SessionEndpointKey &rhs) const;
     bool IsEqual(const SessionEndpointKey &rhs) const;
+    std::size_t Hash() const;
 };
 
 struct SessionAggKey {
@@ -47,6 +48,7 @@ public:
     void Reset();
     bool IsLess(const SessionAggKey &rhs) const;
     bool IsEqual(const SessionAggKey &rhs) const;
+    std::size_t Hash() const;
 };
 
 struct SessionKey {
@@ -59,11 +61,18 @@ public:
     void Reset();
     bool IsLess(const SessionKey &rhs) const;
     bool IsEqual(const SessionKey &rhs) const;
+    std::size_t Hash() const;
 };
 
-struct SessionKeyCmp {
+struct SessionKeyHash {
+    std::size_t operator()(const SessionKey &key) const {
+        return key.Hash();
+    }
+};
+
+struct SessionKeyEqual {
     bool operator()(const SessionKey &lhs, const SessionKey &rhs) const {
-        return lhs.IsLess(rhs);
+        return lhs.IsEqual(rhs);
     }
 };
 
@@ -136,43 +145,110 @@ public:
         evicted(false), evict_stats(), export_info(), fwd_flow(), rev_flow() {}
 };
 
-struct SessionPreAggInfo {
-public:
-    typedef std::map<const SessionKey, SessionStatsInfo,
-                     SessionKeyCmp> SessionMap;
-    SessionMap session_map_;
+struct SessionAggKeyHash {
+    std::size_t operator()(const SessionAggKey &key) const {
+        return key.Hash();
+    }
 };
 
-struct SessionAggKeyCmp {
+struct SessionAggKeyEqual {
     bool operator()(const SessionAggKey &lhs, const SessionAggKey &rhs) const {
-        return lhs.IsLess(rhs);
+        return lhs.IsEqual(rhs);
     }
 };
 
+struct SessionEndpointKeyHash {
+    std::size_t operator()(const SessionEndpointKey &key) const {
+        return key.Hash();
+    }
+};
+
+struct SessionEndpointKeyEqual {
+    bool operator()(const SessionEndpointKey &lhs,
+                    const SessionEndpointKey &rhs) const {
+        return lhs.IsEqual(rhs);
+    }
+};
+
+// Sessions are looked up on every flow add, delete and evict. So, every level
+// of the aggregation is kept in a hash table. Export walks each level using
+// a flat list of the entries and a cursor saved across task runs. Entries
+// are removed only by the export walk at the cursor, hence the list is
+// compacted by moving its last entry into the hole
+struct SessionPreAggInfo {
+public:
+    typedef boost::unordered_map<SessionKey, SessionStatsInfo,
+                                 SessionKeyHash, SessionKeyEqual> SessionMap;
+    typedef SessionMap::value_type SessionEntry;
+    typedef std::vector<SessionEntry *> SessionList;
+    SessionPreAggInfo() : session_map_(), session_list_(), cursor_(0) {}
+    SessionMap session_map_;
+    SessionList session_list_;
+    uint32_t cursor_;
+};
+
 struct SessionEndpointInfo {
 public:
-    typedef std::map<const SessionAggKey, SessionPreAggInfo,
-                     SessionAggKeyCmp> SessionAggMap;
+    typedef boost::unordered_map<SessionAggKey, SessionPreAggInfo,
+                                 SessionAggKeyHash,
+                                 SessionAggKeyEqual> SessionAggMap;
+    typedef SessionAggMap::value_type SessionAggEntry;
+    typedef std::vector<SessionAggEntry *> SessionAggList;
+    SessionEndpointInfo() : session_agg_map_(), session_agg_list_(),
+        cursor_(0) {}
     SessionAggMap session_agg_map_;
+    SessionAggList session_agg_list_;
+    uint32_t cursor_;
 };
 
-struct SessionEndpointKeyCmp {
-    bool operator() (const SessionEndpointKey &lhs,
-                     const SessionEndpointKey &rhs) const {
-        return lhs.IsLess(rhs);
+// Maps a flow to its session. Holds pointers into the session tables which
+// are valid till the session is marked deleted
+class FlowToSessionMap {
+public:
+    FlowToSessionMap(const SessionEndpointKey *session_endpoint_key,
+                     SessionEndpointInfo::SessionAggEntry *session_agg,
+                     SessionPreAggInfo::SessionEntry *session) :
+        session_endpoint_key_(session_endpoint_key),
+        session_agg_(session_agg), session_(session) {
+    }
+    bool IsEqual(const SessionKey &session_key,
+                 const SessionAggKey &session_agg_key,
+                 const SessionEndpointKey &session_endpoint_key) const;
+    const SessionKey &session_key() const { return session_->first; }
+    const SessionAggKey &session_agg_key() const {
+        return session_agg_->first;
+    }
+    const SessionEndpointKey &session_endpoint_key() const {
+        return *session_endpoint_key_;
     }
+    SessionPreAggInfo::SessionEntry *session() const { return session_; }
+private:
+    const SessionEndpointKey *session_endpoint_key_;
+    SessionEndpointInfo::SessionAggEntry *session_agg_;
+    SessionPreAggInfo::SessionEntry *session_;
 };
 
 class SessionStatsCollector : public StatsCollector {
 public:
-    typedef std::map<const SessionEndpointKey, SessionEndpointInfo,
-                     SessionEndpointKeyCmp> SessionEndpointMap;
+    typedef boost::unordered_map<SessionEndpointKey, SessionEndpointInfo,
+                                 SessionEndpointKeyHash,
+                                 SessionEndpointKeyEqual> SessionEndpointMap;
+    typedef SessionEndpointMap::value_type SessionEndpointEntry;
+    typedef std::vector<SessionEndpointEntry *> SessionEndpointList;
     typedef WorkQueue<boost::shared_ptr<SessionStatsReq> > Queue;
-    typedef std::map<FlowEntryPtr, FlowToSessionMap> FlowSessionMap;
+    // Session holds reference to the flow till the session is deleted. So,
+    // the flow pointer is used as key
+    typedef boost::unordered_map<const FlowEntry *,
+                                 FlowToSessionMap> FlowSessionMap;
     typedef std::map<std::string, SessionSloRuleEntry> SessionSloRuleMap;
 
     static const uint32_t kSessionStatsTimerInterval = 1000;
+    // Number of session endpoints visited in one run of SessionTask. The
+    // task is re-enqueued till all endpoints are visited in a pass
     static const uint32_t kSessionsPerTask = 256;
+    // SessionEndpoints per message are scaled up by this factor when send
+    // queue to collector builds up, so that fewer and larger messages are sent
+    static const uint32_t kSessionMsgBatchScale = 4;
 
     uint32_t RunSessionEndpointStats(uint32_t max_count);
 
@@ -197,6 +273,11 @@ public:
     uint32_t instance_id() const { return instance_id_; }
     const Queue *queue() const { return &request_queue_; }
     size_t Size() const { return session_endpoint_map_.size(); }
+    uint64_t backpressure_defers() const { return backpressure_defers_; }
+    uint16_t session_msg_batch() const { return session_msg_batch_; }
+    uint64_t export_passes() const { return export_passes_; }
+    uint64_t last_pass_time() const { return last_pass_time_; }
+    uint64_t ExportLag() const;
     friend class FlowStatsManager;
     friend class SessionStatsCollectorObject;
 protected:
@@ -212,21 +293,27 @@ private:
                         SessionFlowStatsParams *params) const;
     uint64_t threshold() const;
     bool IsSamplingEnabled() const;
-    bool SampleSession(SessionPreAggInfo::SessionMap::iterator session_map_iter,
+    bool SampleSession(SessionPreAggInfo::SessionEntry *session_entry,
                        SessionStatsParams *params) const;
     bool SessionStatsChangedLocked
-        (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+        (SessionPreAggInfo::SessionEntry *session_entry,
          SessionStatsParams *params) const;
     bool SessionStatsChangedUnlocked
-        (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+        (SessionPreAggInfo::SessionEntry *session_entry,
          SessionStatsParams *params) const;
-    bool ProcessSessionEndpoint(const SessionEndpointMap::iterator &it);
+    bool ProcessSessionEndpoint(SessionEndpointEntry *session_ep_entry);
+    void NextSession(SessionPreAggInfo *session_agg_info);
+    void NextSessionAgg(SessionEndpointInfo *session_ep_info);
+    void NextSessionEndpoint();
+    SessionEndpointEntry *LocateSessionEndpoint(const SessionEndpointKey &key);
+    SessionEndpointInfo::SessionAggEntry *LocateSessionAgg
+        (SessionEndpointInfo *session_ep_info, const SessionAggKey &key);
     uint64_t GetUpdatedSessionFlowBytes(uint64_t info_bytes,
                                         uint64_t k_flow_bytes) const;
     uint64_t GetUpdatedSessionFlowPackets(uint64_t info_packets,
                                           uint64_t k_flow_pkts) const;
     void FillSessionEvictStats
-        (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+        (SessionPreAggInfo::SessionEntry *session_entry,
          SessionInfo *session_info, bool is_sampling, bool is_logging) const;
     void FillSessionFlowStats(const SessionFlowStatsParams &stats,
                               SessionFlowInfo *flow_info,
@@ -245,18 +332,18 @@ private:
                               SessionAggInfo *agg_info,
                               bool is_sampling, bool is_logging) const;
     void FillSessionInfoLocked
-        (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+        (SessionPreAggInfo::SessionEntry *session_entry,
          const SessionStatsParams &stats, SessionInfo *session_info,
          SessionIpPort *session_key, bool is_sampling, bool is_logging) const;
     void FillSessionInfoUnlocked
-        (SessionPreAggInfo::SessionMap::iterator session_map_iter,
+        (SessionPreAggInfo::SessionEntry *session_entry,
          const SessionStatsParams &stats, SessionInfo *session_info,
          SessionIpPort *session_key,
          const RevFlowDepParams *params,
          bool read_flow, bool is_sampling, bool is_logging) const;
-    void FillSessionAggInfo(SessionEndpointInfo::SessionAggMap::iterator it,
+    void FillSessionAggInfo(const SessionEndpointInfo::SessionAggEntry *entry,
                             SessionIpPortProtocol *session_agg_key) const;
-    void FillSessionEndpoint(SessionEndpointMap::iterator it,
+    void FillSessionEndpoint(const SessionEndpointEntry *entry,
                              SessionEndpoint *session_ep) const;
     void FillSessionTags(const TagList &list, SessionEndpoint *ep) const;
     void FillSessionRemoteTags(const TagList &list, SessionEndpoint *ep) const;
@@ -278,10 +365,9 @@ private:
                        SessionKey    &session_key,
                        SessionEndpointKey &session_endpoint_key);
     void AddFlowToSessionMap(FlowEntry *fe,
-                             SessionKey session_key,
-                             SessionAggKey session_agg_key,
-                             SessionEndpointKey session_endpoint_key);
-    void DeleteFlowToSessionMap(FlowEntry *fe);
+                             SessionEndpointEntry *session_ep,
+                             SessionEndpointInfo::SessionAggEntry *session_agg,
+                             SessionPreAggInfo::SessionEntry *session);
     void Shutdown();
     void RegisterDBClients();
     void AddEvent(const FlowEntryPtr &flow);
@@ -296,7 +382,8 @@ private:
     bool RequestHandler(boost::shared_ptr<SessionStatsReq> req);
     void EnqueueSessionMsg();
     void DispatchPendingSessionMsg();
-    uint8_t GetSessionMsgIdx();
+    uint16_t GetSessionMsgIdx();
+    void UpdateExportBackpressure();
 
     bool UpdateSloMatchRuleEntry(const boost::uuids::uuid &slo_uuid,
                                  const std::string &match_uuid,
@@ -375,18 +462,23 @@ private:
     void UpdateSloStateRules(SecurityLoggingObject *slo,
                              SessionSloState *state);
     bool CheckAndDeleteSessionStatsFlow(
-        SessionPreAggInfo::SessionMap::iterator session_map_iter);
+        SessionPreAggInfo::SessionEntry *session_entry);
 
     AgentUveBase *agent_uve_;
     int task_id_;
-    SessionEndpointKey session_ep_iteration_key_;
-    SessionAggKey session_agg_iteration_key_;
-    SessionKey session_iteration_key_;
     SessionEndpointMap session_endpoint_map_;
+    SessionEndpointList session_endpoint_list_;
+    uint32_t session_ep_cursor_;
     FlowSessionMap flow_session_map_;
     Queue request_queue_;
     std::vector<SessionEndpoint> session_msg_list_;
-    uint8_t session_msg_index_;
+    uint16_t session_msg_index_;
+    // Number of SessionEndpoints sent in one message for current pass
+    uint16_t session_msg_batch_;
+    // Set when send queue to collector is above high watermark. Sessions
+    // not deleted or evicted are not exported till queue drains
+    bool export_backpressure_;
+    uint64_t backpressure_defers_;
     uint32_t instance_id_;
     FlowStatsManager *flow_stats_manager_;
     SessionStatsCollectorObject *parent_;
@@ -397,13 +489,18 @@ private:
     uint64_t current_time_;
     uint64_t session_task_starts_;
     uint32_t session_ep_visited_;
+    uint64_t pass_start_time_;
+    uint64_t last_pass_time_;
+    uint64_t export_passes_;
     DBTable::ListenerId slo_listener_id_;
     DISALLOW_COPY_AND_ASSIGN(SessionStatsCollector);
 };
 
 class SessionStatsCollectorObject {
 public:
-    static const int kMaxSessionCollectors = 1;
+    // One collector per flow-table partition. Collector at index i runs with
+    // task instance i, see Agent::SetAgentTaskPolicy()
+    static const int kMaxSessionCollectors = Agent::kSessionStatsCollectorCount;
     typedef boost::shared_ptr<SessionStatsCollector> SessionStatsCollectorPtr;
     SessionStatsCollectorObject(Agent *agent, FlowStatsManager *mgr);
     SessionStatsCollector* GetCollector(uint8_t idx) const;
@@ -465,25 +562,6 @@ private:
     DISALLOW_COPY_AND_ASSIGN(SessionStatsReq);
 };
 
-class FlowToSessionMap {
-public:
-    FlowToSessionMap(SessionKey &session_key,
-                     SessionAggKey &session_agg_key,
-                     SessionEndpointKey &session_endpoint_key) :
-        session_key_(session_key),
-        session_agg_key_(session_agg_key),
-        session_endpoint_key_(session_endpoint_key) {
-    }
-    bool IsEqual(FlowToSessionMap &rhs);
-    SessionKey session_key() { return session_key_; }
-    SessionAggKey session_agg_key() { return session_agg_key_; }
-    SessionEndpointKey session_endpoint_key() { return session_endpoint_key_; }
-private:
-    SessionKey session_key_;
-    SessionAggKey session_agg_key_;
-    SessionEndpointKey session_endpoint_key_;
-};
-
 struct SessionSloRuleEntry {
 public:
     SessionSloRuleEntry(int rate, const boost::uuids::uuid &uuid):
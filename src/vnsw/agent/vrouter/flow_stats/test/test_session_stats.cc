@@ -2,8 +2,10 @@
  * Copyright (c) 2015 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <algorithm>
 #include <vector>
 #include "base/os.h"
+#include "base/time_util.h"
 #include <boost/array.hpp>
 #include "test/test_init.h"
 #include "test/test_cmn_util.h"
@@ -215,6 +217,158 @@ TEST_F(SessionStatsTest, RemoteFlowAddVerify) {
     WAIT_FOR(1000, 500, (ssc->Size() == 0));
 }
 
+// Measure export walk throughput of session collectors. Flow count is doubled
+// in every step till AGENT_SESSION_EXPORT_BENCH_COUNT. Run with config files
+// having different "FLOWS.thread_count" to measure parallel collectors
+TEST_F(SessionStatsTest, SessionExportBench) {
+    char env[100];
+    int max_count = 4096;
+    if (getenv("AGENT_SESSION_EXPORT_BENCH_COUNT")) {
+        strcpy(env, getenv("AGENT_SESSION_EXPORT_BENCH_COUNT"));
+        max_count = strtoul(env, NULL, 0);
+    }
+
+    SessionStatsCollectorObject *ssc_obj = agent_->flow_stats_manager()->
+                                           session_stats_collector_obj();
+    FlowSetup();
+    CreateRemoteRoute("vrf5", "5.0.0.0", 8, remote_router_ip, 30, "vn5");
+
+    int session_count = 0;
+    for (int count = 256; count <= max_count; count *= 2) {
+        for (; session_count < count; session_count++) {
+            Ip4Address dip(0x05000000 + session_count);
+            TxTcpPacket(flow0->id(), "1.1.1.1", dip.to_string().c_str(),
+                        1000 + (session_count % 1000),
+                        1 + (session_count % 256), false);
+        }
+        int flow_count = count * 2;
+        WAIT_FOR(flow_count * 10, 1000,
+                 (flow_count == (int) flow_proto_->FlowCount()));
+        client->WaitForIdle();
+
+        // Sessions are spread over one collector per flow-table
+        std::vector<uint64_t> passes;
+        int collector_count = 0;
+        for (int i = 0; i < SessionStatsCollectorObject::kMaxSessionCollectors;
+             i++) {
+            SessionStatsCollector *ssc = ssc_obj->GetCollector(i);
+            passes.push_back(ssc->export_passes());
+            if (ssc->Size())
+                collector_count++;
+        }
+        EXPECT_EQ(std::min(flow_proto_->flow_table_count(),
+                  (uint32_t)SessionStatsCollectorObject::kMaxSessionCollectors),
+                  (uint32_t)collector_count);
+
+        uint64_t exports = agent_->flow_stats_manager()->session_exports();
+        uint64_t start = ClockMonotonicUsec();
+        EnqueueSessionTask();
+        client->WaitForIdle();
+        uint64_t walk_time = ClockMonotonicUsec() - start;
+
+        // Walk of every collector with sessions must complete its pass
+        for (int i = 0; i < SessionStatsCollectorObject::kMaxSessionCollectors;
+             i++) {
+            SessionStatsCollector *ssc = ssc_obj->GetCollector(i);
+            if (ssc->Size())
+                EXPECT_LT(passes[i], ssc->export_passes());
+        }
+        if (walk_time == 0)
+            walk_time = 1;
+        cout << "Session collectors : "
+            << SessionStatsCollectorObject::kMaxSessionCollectors
+            << " Sessions : " << count << " Exported : "
+            << (agent_->flow_stats_manager()->session_exports() - exports)
+            << " Time : " << walk_time << " usec Rate : "
+            << ((uint64_t)count * 1000000) / walk_time << " sessions/sec"
+            << endl;
+    }
+
+    client->EnqueueFlowFlush();
+    WAIT_FOR(session_count * 20, 1000, (0 == flow_proto_->FlowCount()));
+    client->WaitForIdle();
+    FlowTeardown();
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    WAIT_FOR(1000, 500, (ssc_obj->Size() == 0));
+}
+
+// Stand-in for send queue to collector
+static size_t export_queue_len;
+static size_t ExportQueueLength() {
+    return export_queue_len;
+}
+
+// Build up of send queue to collector should defer export of live sessions,
+// batch more session endpoints per message and raise sampling threshold
+TEST_F(SessionStatsTest, ExportBackpressure) {
+    FlowStatsManager *fsm = agent_->flow_stats_manager();
+    SessionStatsCollectorObject *ssc_obj = fsm->session_stats_collector_obj();
+    uint16_t max_eps = agent_->params()->max_endpoints_per_session_msg();
+    uint64_t orig_threshold = fsm->threshold();
+    fsm->set_export_queue_length_cb(&ExportQueueLength);
+
+    FlowSetup();
+    TestFlow flow[] = {
+        {
+            TestFlowPkt(Address::INET, "1.1.1.1", "1.1.1.2", 6, 1000, 2000, "vrf5",
+                        flow0->id()),
+            {
+            }
+        }
+    };
+    CreateFlow(flow, 1);
+    client->WaitForIdle();
+    EXPECT_EQ(2U, flow_proto_->FlowCount());
+
+    FlowEntry *fe = flow[0].pkt_.FlowFetch();
+    EXPECT_TRUE(fe != NULL);
+    SessionStatsCollector *ssc = ssc_obj->FlowToCollector(fe);
+    EXPECT_TRUE(ssc != NULL);
+
+    // Below low watermark, nothing is deferred
+    export_queue_len = FlowStatsManager::kSessionExportQueueLowWatermark - 1;
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    EXPECT_EQ(0U, ssc->backpressure_defers());
+    EXPECT_EQ(max_eps, ssc->session_msg_batch());
+
+    // Above low watermark, messages are batched
+    export_queue_len = FlowStatsManager::kSessionExportQueueLowWatermark;
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    EXPECT_EQ(0U, ssc->backpressure_defers());
+    EXPECT_EQ(max_eps * SessionStatsCollector::kSessionMsgBatchScale,
+              ssc->session_msg_batch());
+
+    // Above high watermark, live sessions are deferred and threshold raised
+    uint64_t threshold = fsm->threshold();
+    export_queue_len = FlowStatsManager::kSessionExportQueueHighWatermark;
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    EXPECT_TRUE(ssc->backpressure_defers() > 0);
+    WAIT_FOR(1000, 5000, (fsm->threshold() > threshold));
+    EXPECT_TRUE(fsm->session_export_backpressure_updates() > 0);
+
+    // Nothing is deferred once the queue drains
+    uint64_t defers = ssc->backpressure_defers();
+    export_queue_len = 0;
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    EXPECT_EQ(defers, ssc->backpressure_defers());
+    EXPECT_EQ(max_eps, ssc->session_msg_batch());
+    EXPECT_TRUE(ssc->export_passes() > 0);
+
+    DeleteFlow(flow, 1);
+    client->WaitForIdle();
+    FlowTeardown();
+    EnqueueSessionTask();
+    client->WaitForIdle();
+    WAIT_FOR(1000, 500, (ssc->Size() == 0));
+    fsm->set_export_queue_length_cb(&FlowStatsManager::SandeshSendQueueLength);
+    fsm->set_threshold(orig_threshold);
+}
+
 int main(int argc, char *argv[]) {
     int ret;
     GETUSERARGS();
@@ -41,6 +41,11 @@ public:
                                               vr_flow_stats *stats,
                                               KFlowData *info) const;
     bool GetFlowKey(uint32_t index, FlowKey *key, bool *is_nat_flow);
+    // Prefetch vrouter flow entry at index into cache
+    void PrefetchKFlowEntry(uint32_t idx) const {
+        if (idx < table_entries_count_)
+            __builtin_prefetch(&flow_table_[idx]);
+    }
 
     bool IsEvictionMarked(const vr_flow_entry *entry, uint16_t flags) const;
 